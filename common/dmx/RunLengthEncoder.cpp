@@ -19,71 +19,84 @@
  */
 
 #include <string.h>
+#include <stdint.h>
+#include <ola/BaseTypes.h>
 #include <ola/dmx/RunLengthEncoder.h>
+#include <algorithm>
 
 namespace ola {
 namespace dmx {
 
+using std::min;
+
+// A word with 0x01 in every byte & one with 0x80 in every byte.
+static const uint64_t LOW_BITS = (static_cast<uint64_t>(0x01010101) << 32) |
+                                 0x01010101;
+static const uint64_t HIGH_BITS = LOW_BITS << 7;
+static const unsigned int WORD_SIZE = sizeof(uint64_t);
+
+
+/*
+ * Load a word from a possibly unaligned address.
+ */
+static inline uint64_t LoadWord(const uint8_t *data) {
+  uint64_t word;
+  memcpy(&word, data, WORD_SIZE);
+  return word;
+}
+
+
+/*
+ * Returns true if any of the bytes in the word are 0.
+ */
+static inline bool HasZeroByte(uint64_t word) {
+  return (word - LOW_BITS) & ~word & HIGH_BITS;
+}
+
+
 bool RunLengthEncoder::Encode(const DmxBuffer &src,
                               uint8_t *data,
                               unsigned int &data_size) {
   unsigned int src_size = src.Size();
+  const uint8_t *src_data = src.GetRaw();
   unsigned int dst_size = data_size;
   unsigned int &dst_index = data_size;
   dst_index = 0;
 
   unsigned int i;
   for (i = 0; i < src_size && dst_index < dst_size;) {
-    // j points to the first non-repeating value
-    unsigned int j = i + 1;
-    while (j < src_size && src.Get(i) == src.Get(j) && j - i < 0x7f) {
-      j++;
-    }
+    unsigned int run_length = RepeatLength(src_data, src_size, i);
 
     // if the number of repeats is more than 2
     // don't encode only two repeats,
-    if (j - i > 2) {
+    if (run_length > 2) {
       // if room left in dst buffer
       if (dst_size - dst_index > 1) {
-        data[dst_index++] = (REPEAT_FLAG | (j - i));
-        data[dst_index++] = src.Get(i);
+        data[dst_index++] = (REPEAT_FLAG | run_length);
+        data[dst_index++] = src_data[i];
       } else {
         // else return what we have done so far
         return false;
       }
-      i = j;
+      i += run_length;
 
     } else {
       // this value doesn't repeat more than twice
       // find out where the next repeat starts
-
-      // postcondition: j is one more than the last value we want to send
-      for (j = i + 1; j < src_size - 2 && j - i < 0x7f; j++) {
-        // at the end  of the array
-        if (j == src_size - 2) {
-          j = src_size;
-          break;
-        }
-
-        // if we're found a repeat of 3 or more stop here
-        if (src.Get(j) == src.Get(j+1) && src.Get(j) == src.Get(j+2))
-          break;
-      }
-      if (j >= src_size - 2)
-        j = src_size;
+      unsigned int length = LiteralLength(src_data, src_size, i);
 
        // if we have enough room left for all the values
-      if (dst_index + j - i < dst_size) {
-        data[dst_index++] = j - i;
-        memcpy(&data[dst_index], src.GetRaw() + i, j-i);
-        dst_index += j - i;
-        i = j;
+      if (dst_index + length < dst_size) {
+        data[dst_index++] = length;
+        memcpy(&data[dst_index], src_data + i, length);
+        dst_index += length;
+        i += length;
 
       // see how much data we can get in
       } else if (dst_size - dst_index > 1) {
         unsigned int l = dst_size - dst_index -1;
         data[dst_index++] = l;
-        memcpy(&data[dst_index], src.GetRaw() + i, l);
+        memcpy(&data[dst_index], src_data + i, l);
         dst_index += l;
         return false;
       } else {
@@ -98,25 +111,94 @@ bool RunLengthEncoder::Encode(const DmxBuffer &src,
     return true;
 }
 
+
+/*
+ * The segments are decoded into a local frame and copied into the
+ * DmxBuffer in one go.
+ */
 bool RunLengthEncoder::Decode(unsigned int start_channel,
                               const uint8_t *src_data,
                               unsigned int length,
                               DmxBuffer *dst) {
-  int destination_index = start_channel;
+  if (start_channel >= DMX_UNIVERSE_SIZE)
+    return false;
+
+  uint8_t frame[DMX_UNIVERSE_SIZE];
+  const unsigned int frame_size = DMX_UNIVERSE_SIZE - start_channel;
+  unsigned int frame_index = 0;
+  bool ok = true;
 
-  for (unsigned int i = 0; i < length;) {
+  for (unsigned int i = 0; i < length && frame_index < frame_size;) {
     unsigned int segment_length = src_data[i] & (~REPEAT_FLAG);
-    if (src_data[i] & REPEAT_FLAG) {
-      i++;
-      dst->SetRangeToValue(destination_index, src_data[i++], segment_length);
-    } else {
-      i++;
-      dst->SetRange(destination_index, src_data + i, segment_length);
-      i += segment_length;
+    bool repeat = src_data[i++] & REPEAT_FLAG;
+    unsigned int data_length = repeat ? 1 : segment_length;
+    if (i + data_length > length) {
+      ok = false;
+      break;
     }
-    destination_index += segment_length;
+
+    unsigned int copy_length = min(segment_length, frame_size - frame_index);
+    if (repeat)
+      memset(frame + frame_index, src_data[i], copy_length);
+    else
+      memcpy(frame + frame_index, src_data + i, copy_length);
+    i += data_length;
+    frame_index += copy_length;
+  }
+
+  if (frame_index)
+    ok &= dst->SetRange(start_channel, frame, frame_index);
+  return ok;
+}
+
+
+/*
+ * Return the number of times the value at offset repeats, up to
+ * MAX_SEGMENT_LENGTH.
+ */
+unsigned int RunLengthEncoder::RepeatLength(const uint8_t *data,
+                                            unsigned int size,
+                                            unsigned int offset) {
+  const unsigned int limit = min(size, offset + MAX_SEGMENT_LENGTH);
+  const uint64_t pattern = LOW_BITS * data[offset];
+  unsigned int i = offset + 1;
+  while (i + WORD_SIZE <= limit && LoadWord(data + i) == pattern)
+    i += WORD_SIZE;
+  while (i < limit && data[i] == data[offset])
+    i++;
+  return i - offset;
+}
+
+
+/*
+ * Return the number of values, starting at offset, that should be sent
+ * without compression. This stops at the next run of 3 or more, or after
+ * MAX_SEGMENT_LENGTH values, whichever comes first.
+ */
+unsigned int RunLengthEncoder::LiteralLength(const uint8_t *data,
+                                             unsigned int size,
+                                             unsigned int offset) {
+  const unsigned int limit = min(size, offset + MAX_SEGMENT_LENGTH);
+  unsigned int i = offset + 1;
+
+  // Check WORD_SIZE positions at a time, x has a zero byte for each position
+  // that starts a run of three.
+  while (i + WORD_SIZE + 2 <= size && i + WORD_SIZE <= limit) {
+    uint64_t a = LoadWord(data + i);
+    uint64_t b = LoadWord(data + i + 1);
+    uint64_t c = LoadWord(data + i + 2);
+    uint64_t x = (a ^ b) | (b ^ c);
+    if (HasZeroByte(x))
+      break;
+    i += WORD_SIZE;
+  }
+
+  while (i + 2 < size && i < limit) {
+    if (data[i] == data[i + 1] && data[i] == data[i + 2])
+      return i - offset;
+    i++;
   }
-  return true;
+  return limit - offset;
 }
 }  // namespace dmx
 }  // namespace ola
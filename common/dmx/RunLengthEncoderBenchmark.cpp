@@ -0,0 +1,304 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RunLengthEncoderBenchmark.cpp
+ * Compares the RunLengthEncoder against the original byte-at-a-time codec.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * This isn't run as part of make check, run ./RunLengthEncoderBenchmark
+ * by hand.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "ola/BaseTypes.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/RunLengthEncoder.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::dmx::RunLengthEncoder;
+using ola::testing::ASSERT_DATA_EQUALS;
+using std::string;
+
+/*
+ * The original byte-at-a-time codec, kept as a baseline.
+ */
+class ReferenceEncoder {
+  public:
+    bool Encode(const DmxBuffer &src, uint8_t *data, unsigned int &data_size);
+    bool Decode(unsigned int start_channel, const uint8_t *src_data,
+                unsigned int length, DmxBuffer *dst);
+
+  private:
+    static const uint8_t REPEAT_FLAG = 0x80;
+};
+
+
+bool ReferenceEncoder::Encode(const DmxBuffer &src,
+                              uint8_t *data,
+                              unsigned int &data_size) {
+  unsigned int src_size = src.Size();
+  unsigned int dst_size = data_size;
+  unsigned int &dst_index = data_size;
+  dst_index = 0;
+
+  unsigned int i;
+  for (i = 0; i < src_size && dst_index < dst_size;) {
+    unsigned int j = i + 1;
+    while (j < src_size && src.Get(i) == src.Get(j) && j - i < 0x7f) {
+      j++;
+    }
+
+    if (j - i > 2) {
+      if (dst_size - dst_index > 1) {
+        data[dst_index++] = (REPEAT_FLAG | (j - i));
+        data[dst_index++] = src.Get(i);
+      } else {
+        return false;
+      }
+      i = j;
+    } else {
+      for (j = i + 1; j < src_size - 2 && j - i < 0x7f; j++) {
+        if (j == src_size - 2) {
+          j = src_size;
+          break;
+        }
+        if (src.Get(j) == src.Get(j+1) && src.Get(j) == src.Get(j+2))
+          break;
+      }
+      if (j >= src_size - 2)
+        j = src_size;
+
+      if (dst_index + j - i < dst_size) {
+        data[dst_index++] = j - i;
+        memcpy(&data[dst_index], src.GetRaw() + i, j-i);
+        dst_index += j - i;
+        i = j;
+      } else if (dst_size - dst_index > 1) {
+        unsigned int l = dst_size - dst_index -1;
+        data[dst_index++] = l;
+        memcpy(&data[dst_index], src.GetRaw() + i, l);
+        dst_index += l;
+        return false;
+      } else {
+        return false;
+      }
+    }
+  }
+  return i >= src_size;
+}
+
+
+bool ReferenceEncoder::Decode(unsigned int start_channel,
+                              const uint8_t *src_data,
+                              unsigned int length,
+                              DmxBuffer *dst) {
+  int destination_index = start_channel;
+
+  for (unsigned int i = 0; i < length;) {
+    unsigned int segment_length = src_data[i] & (~REPEAT_FLAG);
+    if (src_data[i] & REPEAT_FLAG) {
+      i++;
+      dst->SetRangeToValue(destination_index, src_data[i++], segment_length);
+    } else {
+      i++;
+      dst->SetRange(destination_index, src_data + i, segment_length);
+      i += segment_length;
+    }
+    destination_index += segment_length;
+  }
+  return true;
+}
+
+
+class RunLengthEncoderBenchmark: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RunLengthEncoderBenchmark);
+  CPPUNIT_TEST(testBlackout);
+  CPPUNIT_TEST(testStaticPixels);
+  CPPUNIT_TEST(testChase);
+  CPPUNIT_TEST(testRamp);
+  CPPUNIT_TEST(testNoise);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void testBlackout();
+    void testStaticPixels();
+    void testChase();
+    void testRamp();
+    void testNoise();
+
+  private:
+    // Enough to get stable numbers, a couple of seconds on a Raspberry Pi.
+    static const unsigned int ITERATIONS = 20000;
+    static const unsigned int PIXEL_COUNT = DMX_UNIVERSE_SIZE / 3;
+
+    RunLengthEncoder m_encoder;
+    ReferenceEncoder m_reference;
+    Clock m_clock;
+
+    void Benchmark(const string &description, const DmxBuffer &frame);
+    void SetPixel(DmxBuffer *buffer, unsigned int pixel,
+                  uint8_t r, uint8_t g, uint8_t b);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RunLengthEncoderBenchmark);
+
+
+/*
+ * Encode and decode a frame with both codecs and print the times.
+ */
+void RunLengthEncoderBenchmark::Benchmark(const string &description,
+                                          const DmxBuffer &frame) {
+  uint8_t encoded[DMX_UNIVERSE_SIZE * 2];
+  uint8_t reference_encoded[DMX_UNIVERSE_SIZE * 2];
+  unsigned int encoded_size = sizeof(encoded);
+  unsigned int reference_size = sizeof(reference_encoded);
+
+  // first check that both codecs agree
+  OLA_ASSERT_TRUE(m_encoder.Encode(frame, encoded, encoded_size));
+  OLA_ASSERT_TRUE(m_reference.Encode(frame, reference_encoded,
+                                     reference_size));
+  DmxBuffer output, reference_output;
+  OLA_ASSERT_TRUE(m_encoder.Decode(0, encoded, encoded_size, &output));
+  m_reference.Decode(0, encoded, encoded_size, &reference_output);
+  ASSERT_DATA_EQUALS(__LINE__, frame.GetRaw(), frame.Size(),
+                     output.GetRaw(), output.Size());
+  ASSERT_DATA_EQUALS(__LINE__, frame.GetRaw(), frame.Size(),
+                     reference_output.GetRaw(), reference_output.Size());
+
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    reference_size = sizeof(reference_encoded);
+    m_reference.Encode(frame, reference_encoded, reference_size);
+  }
+  m_clock.CurrentTime(&end);
+  TimeInterval reference_encode = end - start;
+
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    encoded_size = sizeof(encoded);
+    m_encoder.Encode(frame, encoded, encoded_size);
+  }
+  m_clock.CurrentTime(&end);
+  TimeInterval encode = end - start;
+
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+    m_reference.Decode(0, encoded, encoded_size, &reference_output);
+  m_clock.CurrentTime(&end);
+  TimeInterval reference_decode = end - start;
+
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++)
+    m_encoder.Decode(0, encoded, encoded_size, &output);
+  m_clock.CurrentTime(&end);
+  TimeInterval decode = end - start;
+
+  std::cout << std::endl << description << " (" << encoded_size
+            << " bytes encoded), " << ITERATIONS << " iterations" << std::endl
+            << "  encode: " << reference_encode << "s -> " << encode << "s"
+            << std::endl
+            << "  decode: " << reference_decode << "s -> " << decode << "s"
+            << std::endl;
+}
+
+
+void RunLengthEncoderBenchmark::SetPixel(DmxBuffer *buffer,
+                                         unsigned int pixel,
+                                         uint8_t r, uint8_t g, uint8_t b) {
+  buffer->SetChannel(pixel * 3, r);
+  buffer->SetChannel(pixel * 3 + 1, g);
+  buffer->SetChannel(pixel * 3 + 2, b);
+}
+
+
+/*
+ * A universe with every channel at 0.
+ */
+void RunLengthEncoderBenchmark::testBlackout() {
+  DmxBuffer frame;
+  frame.Blackout();
+  Benchmark("Blackout", frame);
+}
+
+
+/*
+ * RGB pixels in blocks of static colour, the common case for pixel mapping.
+ */
+void RunLengthEncoderBenchmark::testStaticPixels() {
+  DmxBuffer frame;
+  frame.Blackout();
+  for (unsigned int i = 0; i < PIXEL_COUNT; i++) {
+    if (i < 60)
+      SetPixel(&frame, i, 255, 0, 0);
+    else if (i < 120)
+      SetPixel(&frame, i, 0, 0, 255);
+    else
+      SetPixel(&frame, i, 255, 255, 255);
+  }
+  Benchmark("Static pixels", frame);
+}
+
+
+/*
+ * A single colour with a few pixels lit, e.g. a chase.
+ */
+void RunLengthEncoderBenchmark::testChase() {
+  DmxBuffer frame;
+  frame.Blackout();
+  for (unsigned int i = 0; i < PIXEL_COUNT; i += 17)
+    SetPixel(&frame, i, 255, 128, 0);
+  Benchmark("Chase", frame);
+}
+
+
+/*
+ * A ramp, which has no repeats at all.
+ */
+void RunLengthEncoderBenchmark::testRamp() {
+  DmxBuffer frame;
+  frame.Blackout();
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++)
+    frame.SetChannel(i, i);
+  Benchmark("Ramp", frame);
+}
+
+
+/*
+ * Pseudo random data.
+ */
+void RunLengthEncoderBenchmark::testNoise() {
+  DmxBuffer frame;
+  frame.Blackout();
+  uint32_t seed = 1;
+  for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+    seed = seed * 1103515245 + 12345;
+    frame.SetChannel(i, seed >> 16);
+  }
+  Benchmark("Noise", frame);
+}
@@ -35,11 +35,15 @@ class RunLengthEncoderTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RunLengthEncoderTest);
   CPPUNIT_TEST(testEncode);
   CPPUNIT_TEST(testEncode2);
+  CPPUNIT_TEST(testEncodeLongSegments);
+  CPPUNIT_TEST(testDecode);
   CPPUNIT_TEST_SUITE_END();
 
   public:
     void testEncode();
     void testEncode2();
+    void testEncodeLongSegments();
+    void testDecode();
     void testEncodeDecode();
     void setUp();
     void tearDown();
@@ -136,6 +140,78 @@ void RunLengthEncoderTest::testEncode2() {
 }
 
 
+/*
+ * Check that repeats and literals longer than a segment are split up.
+ */
+void RunLengthEncoderTest::testEncodeLongSegments() {
+  uint8_t data[DMX_UNIVERSE_SIZE];
+  for (unsigned int i = 0; i < 200; i++)
+    data[i] = i;
+  memset(data + 200, 7, 140);
+  for (unsigned int i = 340; i < DMX_UNIVERSE_SIZE; i++)
+    data[i] = i;
+  DmxBuffer buffer(data, sizeof(data));
+
+  unsigned int size = DMX_UNIVERSE_SIZE;
+  OLA_ASSERT_TRUE(m_encoder.Encode(buffer, m_dst, size));
+
+  // 127 & 73 literal values, 127 & 13 repeats, 127 & 45 literal values
+  OLA_ASSERT_EQ(127u + 73 + 127 + 45 + 4 + 4, size);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(127), m_dst[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(73), m_dst[128]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x80 | 127), m_dst[202]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(7), m_dst[203]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0x80 | 13), m_dst[204]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(127), m_dst[206]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(45), m_dst[334]);
+
+  DmxBuffer output;
+  OLA_ASSERT_TRUE(m_encoder.Decode(0, m_dst, size, &output));
+  OLA_ASSERT_EQ(buffer, output);
+
+  // a single slot
+  DmxBuffer single(data, 1);
+  const uint8_t EXPECTED_DATA[] = {1, 0};
+  checkEncode(single, DMX_UNIVERSE_SIZE, true, EXPECTED_DATA,
+              sizeof(EXPECTED_DATA));
+}
+
+
+/*
+ * Check that decoding works.
+ */
+void RunLengthEncoderTest::testDecode() {
+  const uint8_t ENCODED_DATA[] = {0x83, 5, 2, 1, 2};
+  const uint8_t EXPECTED_DATA[] = {0, 0, 5, 5, 5, 1, 2};
+  DmxBuffer expected(EXPECTED_DATA, sizeof(EXPECTED_DATA));
+
+  DmxBuffer output(EXPECTED_DATA, 2);
+  OLA_ASSERT_TRUE(m_encoder.Decode(2, ENCODED_DATA, sizeof(ENCODED_DATA),
+                                   &output));
+  OLA_ASSERT_EQ(expected, output);
+
+  // the start channel is past the end of the buffer
+  output.Set(EXPECTED_DATA, 1);
+  OLA_ASSERT_FALSE(m_encoder.Decode(2, ENCODED_DATA, sizeof(ENCODED_DATA),
+                                    &output));
+  OLA_ASSERT_EQ(1u, output.Size());
+
+  // truncated data is decoded up to the last complete segment
+  output.Set(EXPECTED_DATA, 2);
+  OLA_ASSERT_FALSE(m_encoder.Decode(2, ENCODED_DATA, 4, &output));
+  OLA_ASSERT_EQ(DmxBuffer(EXPECTED_DATA, 5), output);
+  OLA_ASSERT_FALSE(m_encoder.Decode(2, ENCODED_DATA, 1, &output));
+
+  // data past the end of the universe is dropped
+  output.Blackout();
+  OLA_ASSERT_TRUE(m_encoder.Decode(DMX_UNIVERSE_SIZE - 1, ENCODED_DATA,
+                                   sizeof(ENCODED_DATA), &output));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(5),
+                output.Get(DMX_UNIVERSE_SIZE - 1));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(DMX_UNIVERSE_SIZE), output.Size());
+}
+
+
 /*
  * Call Encode then Decode and check the results
  */
@@ -0,0 +1,170 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * UniverseDispatchTable.cpp
+ * Maps universe indices to receive buffers & callbacks.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <string.h>
+#include <vector>
+#include "ola/dmx/RunLengthEncoder.h"
+#include "ola/dmx/UniverseDispatchTable.h"
+
+namespace ola {
+namespace dmx {
+
+using std::vector;
+
+const TimeInterval UniverseDispatchTable::KEEPALIVE_INTERVAL(1, 0);
+
+UniverseDispatchTable::UniverseDispatchTable(const Clock *clock)
+    : m_clock(clock ? clock : &m_default_clock) {
+}
+
+
+UniverseDispatchTable::~UniverseDispatchTable() {
+  Clear();
+}
+
+
+/*
+ * Register a handler, replacing any existing closure.
+ */
+void UniverseDispatchTable::SetHandler(unsigned int index,
+                                       DmxBuffer *buffer,
+                                       Callback0<void> *closure) {
+  if (index >= m_handlers.size())
+    m_handlers.resize(index + 1, NULL);
+
+  universe_handler *handler = m_handlers[index];
+  if (handler) {
+    delete handler->closure;
+    handler->closure = closure;
+  } else {
+    handler = new universe_handler;
+    handler->buffer = buffer;
+    handler->closure = closure;
+    m_handlers[index] = handler;
+  }
+}
+
+
+bool UniverseDispatchTable::RemoveHandler(unsigned int index) {
+  universe_handler *handler = Lookup(index);
+  if (!handler)
+    return false;
+
+  delete handler->closure;
+  delete handler;
+  m_handlers[index] = NULL;
+
+  // shrink the table if we removed the last entry
+  while (!m_handlers.empty() && !m_handlers.back())
+    m_handlers.pop_back();
+  return true;
+}
+
+
+void UniverseDispatchTable::Clear() {
+  vector<universe_handler*>::iterator iter = m_handlers.begin();
+  for (; iter != m_handlers.end(); ++iter) {
+    if (*iter) {
+      delete (*iter)->closure;
+      delete *iter;
+    }
+  }
+  m_handlers.clear();
+}
+
+
+/*
+ * Copy a slot range into the buffer, only writing if the data differs.
+ */
+bool UniverseDispatchTable::SetRange(unsigned int index,
+                                     unsigned int offset,
+                                     const uint8_t *data,
+                                     unsigned int length) {
+  universe_handler *handler = Lookup(index);
+  if (!handler)
+    return false;
+
+  DmxBuffer *buffer = handler->buffer;
+  bool changed = (offset + length > buffer->Size() ||
+                  (length && memcmp(buffer->GetRaw() + offset, data, length)));
+  if (changed)
+    buffer->SetRange(offset, data, length);
+  SignalIfRequired(handler, changed);
+  return true;
+}
+
+
+bool UniverseDispatchTable::Set(unsigned int index,
+                                const uint8_t *data,
+                                unsigned int length) {
+  universe_handler *handler = Lookup(index);
+  if (!handler)
+    return false;
+
+  DmxBuffer *buffer = handler->buffer;
+  bool changed = (length != buffer->Size() ||
+                  (length && memcmp(buffer->GetRaw(), data, length)));
+  if (changed)
+    buffer->Set(data, length);
+  SignalIfRequired(handler, changed);
+  return true;
+}
+
+
+/*
+ * The encoded length doesn't tell us which slots are touched, so decode into
+ * a scratch copy and compare it against the current frame.
+ */
+bool UniverseDispatchTable::DecodeRunLength(unsigned int index,
+                                            unsigned int offset,
+                                            const uint8_t *data,
+                                            unsigned int length,
+                                            RunLengthEncoder *encoder) {
+  universe_handler *handler = Lookup(index);
+  if (!handler)
+    return false;
+
+  // DmxBuffer is copy-on-write so this only copies the slots once
+  m_scratch = *handler->buffer;
+  if (!encoder->Decode(offset, data, length, &m_scratch))
+    return false;
+  bool changed = !(m_scratch == *handler->buffer);
+  if (changed)
+    *handler->buffer = m_scratch;
+  SignalIfRequired(handler, changed);
+  return true;
+}
+
+
+/*
+ * Run the closure if the data changed or the keepalive has expired.
+ */
+void UniverseDispatchTable::SignalIfRequired(universe_handler *handler,
+                                             bool changed) {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (!changed && now < handler->last_signalled + KEEPALIVE_INTERVAL)
+    return;
+
+  handler->last_signalled = now;
+  handler->closure->Run();
+}
+}  // namespace dmx
+}  // namespace ola
@@ -0,0 +1,227 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * UniverseDispatchTableTest.cpp
+ * Test fixture for the UniverseDispatchTable class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/dmx/RunLengthEncoder.h"
+#include "ola/dmx/UniverseDispatchTable.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DmxBuffer;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::dmx::RunLengthEncoder;
+using ola::dmx::UniverseDispatchTable;
+
+class UniverseDispatchTableTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(UniverseDispatchTableTest);
+  CPPUNIT_TEST(testHandlers);
+  CPPUNIT_TEST(testSetRange);
+  CPPUNIT_TEST(testSet);
+  CPPUNIT_TEST(testDecodeRunLength);
+  CPPUNIT_TEST(testKeepalive);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp() { m_count = 0; }
+    void testHandlers();
+    void testSetRange();
+    void testSet();
+    void testDecodeRunLength();
+    void testKeepalive();
+
+    void Changed() { m_count++; }
+
+  private:
+    unsigned int m_count;
+    MockClock m_clock;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(UniverseDispatchTableTest);
+
+
+/*
+ * Check adding and removing handlers.
+ */
+void UniverseDispatchTableTest::testHandlers() {
+  UniverseDispatchTable table(&m_clock);
+  DmxBuffer buffer;
+  const uint8_t data[] = {1, 2, 3};
+
+  OLA_ASSERT_FALSE(table.HasHandler(0));
+  OLA_ASSERT_FALSE(table.SetRange(0, 0, data, sizeof(data)));
+  OLA_ASSERT_FALSE(table.RemoveHandler(0));
+
+  table.SetHandler(
+      300, &buffer,
+      NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.HasHandler(300));
+  OLA_ASSERT_FALSE(table.HasHandler(0));
+  OLA_ASSERT_FALSE(table.HasHandler(301));
+  OLA_ASSERT_FALSE(table.SetRange(0, 0, data, sizeof(data)));
+  OLA_ASSERT_TRUE(table.SetRange(300, 0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  // replacing the handler keeps the buffer
+  table.SetHandler(
+      300, &buffer,
+      NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.HasHandler(300));
+
+  OLA_ASSERT_TRUE(table.RemoveHandler(300));
+  OLA_ASSERT_FALSE(table.HasHandler(300));
+  OLA_ASSERT_FALSE(table.RemoveHandler(300));
+  OLA_ASSERT_FALSE(table.SetRange(300, 0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+}
+
+
+/*
+ * Check that SetRange only signals on changes.
+ */
+void UniverseDispatchTableTest::testSetRange() {
+  UniverseDispatchTable table(&m_clock);
+  DmxBuffer buffer;
+  const uint8_t data[] = {1, 2, 3, 4};
+  const uint8_t data2[] = {1, 2, 5, 4};
+
+  const uint8_t zeros[] = {0, 0, 0, 0};
+  DmxBuffer expected;
+  expected.Blackout();
+  expected.SetRange(0, data, sizeof(data));
+
+  table.SetHandler(1, &buffer,
+                   NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.SetRange(1, 0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_EQ(expected, buffer);
+
+  // same data, no callback
+  OLA_ASSERT_TRUE(table.SetRange(1, 0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_TRUE(table.SetRange(1, 1, data + 1, 2));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  // the unset slots were zeroed
+  OLA_ASSERT_TRUE(table.SetRange(1, 4, zeros, sizeof(zeros)));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  OLA_ASSERT_TRUE(table.SetRange(1, 0, data2, sizeof(data2)));
+  OLA_ASSERT_EQ(2u, m_count);
+  expected.SetRange(0, data2, sizeof(data2));
+  OLA_ASSERT_EQ(expected, buffer);
+}
+
+
+/*
+ * Check that Set only signals on changes.
+ */
+void UniverseDispatchTableTest::testSet() {
+  UniverseDispatchTable table(&m_clock);
+  DmxBuffer buffer;
+  const uint8_t data[] = {1, 2, 3, 4};
+
+  table.SetHandler(0, &buffer,
+                   NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  // a shorter frame is a change
+  OLA_ASSERT_TRUE(table.Set(0, data, 2));
+  OLA_ASSERT_EQ(2u, m_count);
+  OLA_ASSERT_EQ(DmxBuffer(data, 2), buffer);
+}
+
+
+/*
+ * Check that decoding RLE data only signals on changes.
+ */
+void UniverseDispatchTableTest::testDecodeRunLength() {
+  UniverseDispatchTable table(&m_clock);
+  RunLengthEncoder encoder;
+  DmxBuffer buffer;
+  const uint8_t encoded[] = {0x84, 7, 2, 1, 2};
+  const uint8_t expected[] = {7, 7, 7, 7, 1, 2};
+  const uint8_t encoded2[] = {0x84, 8};
+  DmxBuffer expected_buffer;
+  expected_buffer.Blackout();
+  expected_buffer.SetRange(0, expected, sizeof(expected));
+
+  table.SetHandler(2, &buffer,
+                   NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.DecodeRunLength(2, 0, encoded, sizeof(encoded),
+                                        &encoder));
+  OLA_ASSERT_EQ(1u, m_count);
+  OLA_ASSERT_EQ(expected_buffer, buffer);
+
+  OLA_ASSERT_TRUE(table.DecodeRunLength(2, 0, encoded, sizeof(encoded),
+                                        &encoder));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  OLA_ASSERT_TRUE(table.DecodeRunLength(2, 0, encoded2, sizeof(encoded2),
+                                        &encoder));
+  OLA_ASSERT_EQ(2u, m_count);
+  expected_buffer.SetRangeToValue(0, 8, 4);
+  OLA_ASSERT_EQ(expected_buffer, buffer);
+
+  // a truncated run doesn't touch the buffer or run the callback, even once
+  // the keepalive has expired.
+  const uint8_t truncated[] = {0x84};
+  m_clock.AdvanceTime(UniverseDispatchTable::KEEPALIVE_INTERVAL);
+  OLA_ASSERT_FALSE(table.DecodeRunLength(2, 0, truncated, sizeof(truncated),
+                                         &encoder));
+  OLA_ASSERT_EQ(2u, m_count);
+  OLA_ASSERT_EQ(expected_buffer, buffer);
+}
+
+
+/*
+ * Check that unchanged data is still signalled once per keepalive interval.
+ */
+void UniverseDispatchTableTest::testKeepalive() {
+  UniverseDispatchTable table(&m_clock);
+  DmxBuffer buffer;
+  const uint8_t data[] = {1, 2, 3, 4};
+
+  table.SetHandler(0, &buffer,
+                   NewCallback(this, &UniverseDispatchTableTest::Changed));
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  m_clock.AdvanceTime(0, 500000);
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(1u, m_count);
+
+  m_clock.AdvanceTime(0, 500000);
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(2u, m_count);
+
+  m_clock.AdvanceTime(0, 100000);
+  OLA_ASSERT_TRUE(table.Set(0, data, sizeof(data)));
+  OLA_ASSERT_EQ(2u, m_count);
+}
@@ -269,11 +269,12 @@ int ConnectedDescriptor::Receive(uint8_t *buffer,
         OLA_WARN << "read failed, " << strerror(errno);
         return -1;
       }
+      continue;
     } else if (ret == 0) {
       return 0;
     }
     data_read += ret;
-    data += data_read;
+    data += ret;
   }
   return 0;
 }
@@ -0,0 +1,566 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * CompiledPidFile.cpp
+ * A binary, memory mapped form of the PID definitions.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "common/rdm/CompiledPidFile.h"
+#include "common/rdm/PidIndex.h"
+#include "common/rdm/PidStoreLoader.h"
+#include "common/rdm/Pids.pb.h"
+#include "ola/Logging.h"
+#include "ola/rdm/PidStore.h"
+
+namespace ola {
+namespace rdm {
+
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+const char CompiledPidFile::MAGIC[] = "OLAPIDS";
+
+// The 32 bit FNV-1a parameters
+static const uint32_t FNV_OFFSET_BASIS = 2166136261u;
+static const uint32_t FNV_PRIME = 16777619;
+
+
+static uint16_t ReadUInt16(const uint8_t *data) {
+  return static_cast<uint16_t>((data[0] << 8) | data[1]);
+}
+
+
+static uint32_t ReadUInt32(const uint8_t *data) {
+  return (static_cast<uint32_t>(data[0]) << 24) |
+         (static_cast<uint32_t>(data[1]) << 16) |
+         (static_cast<uint32_t>(data[2]) << 8) |
+         data[3];
+}
+
+
+static void AppendUInt16(uint16_t value, string *output) {
+  output->push_back(static_cast<char>(value >> 8));
+  output->push_back(static_cast<char>(value));
+}
+
+
+static void AppendUInt32(uint32_t value, string *output) {
+  AppendUInt16(static_cast<uint16_t>(value >> 16), output);
+  AppendUInt16(static_cast<uint16_t>(value), output);
+}
+
+
+/*
+ * Used to sort the source files by name.
+ */
+static bool SourceNameLessThan(const CompiledPidFile::SourceFile &a,
+                               const CompiledPidFile::SourceFile &b) {
+  return a.name < b.name;
+}
+
+
+/*
+ * Used to sort the PIDs within a section by name, ignoring case.
+ */
+static bool PidNameLessThan(const pair<string, unsigned int> &a,
+                            const pair<string, unsigned int> &b) {
+  return PidIndex::CompareNames(a.first.data(), a.first.size(),
+                                b.first.data(), b.first.size()) < 0;
+}
+
+
+CompiledPidFile::CompiledPidFile(const uint8_t *data,
+                                 unsigned int size,
+                                 bool validate)
+    : m_data(data),
+      m_size(size),
+      m_validate(validate),
+      m_version(0),
+      m_section_count(0),
+      m_pid_count(0),
+      m_sections(NULL),
+      m_pids(NULL),
+      m_name_index(NULL) {
+}
+
+
+/**
+ * Unmap the file. Any PidDescriptors that were built remain valid.
+ */
+CompiledPidFile::~CompiledPidFile() {
+  munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+
+/**
+ * Return the manufacturer id for a section. Section 0 holds the ESTA PIDs.
+ */
+uint16_t CompiledPidFile::ManufacturerId(unsigned int section) const {
+  return ReadUInt16(Section(section));
+}
+
+
+/**
+ * Check if the file was compiled from a set of text format files.
+ * @param files the paths of the text format files.
+ * @returns true if the names, sizes and checksums of the files match those
+ *   recorded when the file was compiled.
+ */
+bool CompiledPidFile::SourcesMatch(const vector<string> &files) const {
+  vector<SourceFile> sources;
+  if (!ReadSourceFiles(files, &sources) || sources.size() != m_sources.size())
+    return false;
+
+  for (unsigned int i = 0; i < sources.size(); i++) {
+    if (sources[i].name != m_sources[i].name ||
+        sources[i].size != m_sources[i].size ||
+        sources[i].checksum != m_sources[i].checksum)
+      return false;
+  }
+  return true;
+}
+
+
+/**
+ * Return the number of PIDs in a section.
+ */
+unsigned int CompiledPidFile::PidCount(unsigned int section) const {
+  return ReadUInt32(Section(section) + 4);
+}
+
+
+/**
+ * Return the value of a PID.
+ * @param section the section the PID belongs to
+ * @param index the index of the PID within the section
+ */
+uint16_t CompiledPidFile::PidValue(unsigned int section,
+                                   unsigned int index) const {
+  return ReadUInt16(Entry(section, index));
+}
+
+
+/**
+ * Find a PID by value.
+ * @param section the section to search
+ * @param pid_value the PID to find
+ * @param index set to the index of the PID within the section
+ * @returns true if the PID was found, false otherwise.
+ */
+bool CompiledPidFile::FindPid(unsigned int section,
+                              uint16_t pid_value,
+                              unsigned int *index) const {
+  unsigned int low = 0;
+  unsigned int high = PidCount(section);
+  while (low < high) {
+    unsigned int middle = low + (high - low) / 2;
+    uint16_t value = PidValue(section, middle);
+    if (value == pid_value) {
+      *index = middle;
+      return true;
+    } else if (value < pid_value) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Find a PID by name. The name is case insensitive.
+ * @param section the section to search
+ * @param pid_name the name of the PID to find
+ * @param index set to the index of the PID within the section
+ * @returns true if the PID was found, false otherwise.
+ */
+bool CompiledPidFile::FindPid(unsigned int section,
+                              const string &pid_name,
+                              unsigned int *index) const {
+  const uint8_t *name_index = (
+      m_name_index + ReadUInt32(Section(section) + 8) * NAME_INDEX_ENTRY_SIZE);
+  unsigned int low = 0;
+  unsigned int high = PidCount(section);
+  while (low < high) {
+    unsigned int middle = low + (high - low) / 2;
+    unsigned int entry_index = ReadUInt32(
+        name_index + middle * NAME_INDEX_ENTRY_SIZE);
+    int result = CompareName(Entry(section, entry_index), pid_name);
+    if (result == 0) {
+      *index = entry_index;
+      return true;
+    } else if (result < 0) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return false;
+}
+
+
+/**
+ * Build the PidDescriptor for a PID.
+ * @param section the section the PID belongs to
+ * @param index the index of the PID within the section
+ * @returns a new PidDescriptor, ownership is transferred to the caller, or
+ *   NULL if the PID data was invalid.
+ */
+const PidDescriptor *CompiledPidFile::BuildDescriptor(
+    unsigned int section,
+    unsigned int index) const {
+  const uint8_t *entry = Entry(section, index);
+  ola::rdm::pid::Pid pid_pb;
+  if (!pid_pb.ParseFromArray(m_data + ReadUInt32(entry + 8),
+                             ReadUInt32(entry + 12))) {
+    OLA_WARN << "Corrupt compiled data for PID " << ReadUInt16(entry);
+    return NULL;
+  }
+
+  return PidStoreLoader::BuildPidDescriptor(pid_pb, m_validate);
+}
+
+
+/**
+ * Map a compiled PID file into memory.
+ * @param file the path to the compiled file.
+ * @param validate set to true if the PidDescriptors should be validated as
+ *   they're built.
+ * @returns a new CompiledPidFile or NULL if the file couldn't be loaded.
+ */
+CompiledPidFile *CompiledPidFile::Open(const string &file, bool validate) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    OLA_INFO << "Failed to open " << file << ": " << strerror(errno);
+    return NULL;
+  }
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat)) {
+    OLA_WARN << "Failed to stat " << file << ": " << strerror(errno);
+    close(fd);
+    return NULL;
+  }
+
+  if (file_stat.st_size < static_cast<off_t>(HEADER_SIZE)) {
+    OLA_WARN << file << " is too small to be a compiled PID file";
+    close(fd);
+    return NULL;
+  }
+
+  unsigned int size = static_cast<unsigned int>(file_stat.st_size);
+  void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    OLA_WARN << "Failed to mmap " << file << ": " << strerror(errno);
+    return NULL;
+  }
+
+  CompiledPidFile *compiled_file = new CompiledPidFile(
+      reinterpret_cast<const uint8_t*>(data), size, validate);
+  if (!compiled_file->Init()) {
+    OLA_WARN << file << " isn't a valid compiled PID file";
+    delete compiled_file;
+    return NULL;
+  }
+  return compiled_file;
+}
+
+
+/**
+ * Compile a PidStore protobuf.
+ * @param store_pb the PidStore to compile. This should have already been
+ *   checked by the PidStoreLoader.
+ * @param files the paths of the text format files the store was loaded from.
+ * @param output the string to write the compiled data to.
+ * @returns true if the store was compiled, false otherwise.
+ */
+bool CompiledPidFile::Compile(const ola::rdm::pid::PidStore &store_pb,
+                              const vector<string> &files,
+                              string *output) {
+  vector<SourceFile> sources;
+  if (!ReadSourceFiles(files, &sources))
+    return false;
+
+  // Section 0 is the ESTA PIDs, followed by the manufacturers in order.
+  typedef vector<const ola::rdm::pid::Pid*> PidList;
+  vector<pair<uint16_t, PidList> > sections;
+  sections.push_back(pair<uint16_t, PidList>(0, PidList()));
+  for (int i = 0; i < store_pb.pid_size(); ++i)
+    sections[0].second.push_back(&store_pb.pid(i));
+
+  map<uint16_t, PidList> manufacturers;
+  for (int i = 0; i < store_pb.manufacturer_size(); ++i) {
+    const ola::rdm::pid::Manufacturer &manufacturer = store_pb.manufacturer(i);
+    PidList &pids = manufacturers[manufacturer.manufacturer_id()];
+    for (int j = 0; j < manufacturer.pid_size(); ++j)
+      pids.push_back(&manufacturer.pid(j));
+  }
+  sections.insert(sections.end(), manufacturers.begin(), manufacturers.end());
+
+  unsigned int pid_count = 0;
+  for (unsigned int i = 0; i < sections.size(); i++)
+    pid_count += sections[i].second.size();
+
+  const unsigned int data_offset = (
+      HEADER_SIZE + sources.size() * SOURCE_SIZE +
+      sections.size() * SECTION_SIZE +
+      pid_count * (PID_ENTRY_SIZE + NAME_INDEX_ENTRY_SIZE));
+
+  string source_table, section_table, pid_table, name_index, data;
+  vector<SourceFile>::const_iterator source_iter = sources.begin();
+  for (; source_iter != sources.end(); ++source_iter) {
+    AppendUInt32(data_offset + data.size(), &source_table);
+    AppendUInt32(source_iter->name.size(), &source_table);
+    AppendUInt32(source_iter->size, &source_table);
+    AppendUInt32(source_iter->checksum, &source_table);
+    data.append(source_iter->name);
+  }
+
+  unsigned int first_entry = 0;
+  for (unsigned int i = 0; i < sections.size(); i++) {
+    // PidList is a vector of pointers, so sort by value via a map.
+    map<uint16_t, const ola::rdm::pid::Pid*> pids_by_value;
+    PidList::const_iterator iter = sections[i].second.begin();
+    for (; iter != sections[i].second.end(); ++iter) {
+      if (!pids_by_value.insert(
+            pair<uint16_t, const ola::rdm::pid::Pid*>(
+              (*iter)->value(), *iter)).second) {
+        OLA_WARN << "Duplicate PID " << (*iter)->value();
+        return false;
+      }
+    }
+
+    AppendUInt16(sections[i].first, &section_table);
+    AppendUInt16(0, &section_table);
+    AppendUInt32(pids_by_value.size(), &section_table);
+    AppendUInt32(first_entry, &section_table);
+    first_entry += pids_by_value.size();
+
+    vector<pair<string, unsigned int> > names;
+    map<uint16_t, const ola::rdm::pid::Pid*>::const_iterator pid_iter =
+        pids_by_value.begin();
+    for (; pid_iter != pids_by_value.end(); ++pid_iter) {
+      const ola::rdm::pid::Pid *pid = pid_iter->second;
+      if (pid->name().size() > 0xffff) {
+        OLA_WARN << "PID name too long: " << pid->name();
+        return false;
+      }
+      names.push_back(pair<string, unsigned int>(pid->name(), names.size()));
+
+      string pid_data;
+      if (!pid->SerializeToString(&pid_data)) {
+        OLA_WARN << "Failed to serialize PID " << pid->name();
+        return false;
+      }
+
+      AppendUInt16(pid->value(), &pid_table);
+      AppendUInt16(pid->name().size(), &pid_table);
+      AppendUInt32(data_offset + data.size(), &pid_table);
+      data.append(pid->name());
+      AppendUInt32(data_offset + data.size(), &pid_table);
+      AppendUInt32(pid_data.size(), &pid_table);
+      data.append(pid_data);
+    }
+
+    std::sort(names.begin(), names.end(), PidNameLessThan);
+    for (unsigned int j = 0; j < names.size(); j++)
+      AppendUInt32(names[j].second, &name_index);
+  }
+
+  output->clear();
+  output->reserve(data_offset + data.size());
+  output->append(MAGIC, MAGIC_SIZE);
+  AppendUInt32(FORMAT_VERSION, output);
+  AppendUInt32(sections.size(), output);
+  AppendUInt32(static_cast<uint32_t>(store_pb.version() >> 32), output);
+  AppendUInt32(static_cast<uint32_t>(store_pb.version()), output);
+  AppendUInt32(sources.size(), output);
+  AppendUInt32(0, output);
+  output->append(source_table);
+  output->append(section_table);
+  output->append(pid_table);
+  output->append(name_index);
+  output->append(data);
+  return true;
+}
+
+
+/**
+ * Read the name, size and checksum of each text format file.
+ * @param files the paths of the files.
+ * @param sources the vector to populate, this is sorted by name.
+ * @returns true if all the files could be read, false otherwise.
+ */
+bool CompiledPidFile::ReadSourceFiles(const vector<string> &files,
+                                      vector<SourceFile> *sources) {
+  sources->clear();
+  vector<string>::const_iterator iter = files.begin();
+  for (; iter != files.end(); ++iter) {
+    std::ifstream file(iter->c_str(), std::ios::in | std::ios::binary);
+    if (!file.is_open()) {
+      OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
+      return false;
+    }
+
+    SourceFile source;
+    string::size_type slash = iter->rfind('/');
+    source.name = slash == string::npos ? *iter : iter->substr(slash + 1);
+    source.size = 0;
+    source.checksum = FNV_OFFSET_BASIS;
+
+    char buffer[4096];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount()) {
+      for (std::streamsize i = 0; i < file.gcount(); i++) {
+        source.checksum ^= static_cast<uint8_t>(buffer[i]);
+        source.checksum *= FNV_PRIME;
+      }
+      source.size += file.gcount();
+    }
+    if (file.bad()) {
+      OLA_WARN << "Failed to read " << *iter;
+      return false;
+    }
+    sources->push_back(source);
+  }
+  std::sort(sources->begin(), sources->end(), SourceNameLessThan);
+  return true;
+}
+
+
+/**
+ * Check the file is well formed. After this all offsets in the file are
+ * known to be within bounds.
+ */
+bool CompiledPidFile::Init() {
+  if (m_size < HEADER_SIZE || memcmp(m_data, MAGIC, MAGIC_SIZE))
+    return false;
+
+  if (ReadUInt32(m_data + MAGIC_SIZE) != FORMAT_VERSION) {
+    OLA_WARN << "Unknown compiled PID format "
+             << ReadUInt32(m_data + MAGIC_SIZE);
+    return false;
+  }
+
+  m_section_count = ReadUInt32(m_data + MAGIC_SIZE + 4);
+  m_version = (static_cast<uint64_t>(ReadUInt32(m_data + MAGIC_SIZE + 8)) <<
+               32) | ReadUInt32(m_data + MAGIC_SIZE + 12);
+  const unsigned int source_count = ReadUInt32(m_data + MAGIC_SIZE + 16);
+  uint64_t offset = HEADER_SIZE;
+  if (offset + static_cast<uint64_t>(source_count) * SOURCE_SIZE > m_size)
+    return false;
+
+  m_sources.clear();
+  for (unsigned int i = 0; i < source_count; i++) {
+    const uint8_t *entry = m_data + offset + i * SOURCE_SIZE;
+    uint64_t name_end = (static_cast<uint64_t>(ReadUInt32(entry)) +
+                         ReadUInt32(entry + 4));
+    if (name_end > m_size)
+      return false;
+    SourceFile source;
+    source.name.assign(reinterpret_cast<const char*>(
+                           m_data + ReadUInt32(entry)),
+                       ReadUInt32(entry + 4));
+    source.size = ReadUInt32(entry + 8);
+    source.checksum = ReadUInt32(entry + 12);
+    m_sources.push_back(source);
+  }
+  offset += source_count * SOURCE_SIZE;
+
+  if (!m_section_count ||
+      offset + static_cast<uint64_t>(m_section_count) * SECTION_SIZE >
+      m_size)
+    return false;
+  m_sections = m_data + offset;
+  offset += m_section_count * SECTION_SIZE;
+
+  // the sections must cover the PID table in order
+  uint64_t pid_count = 0;
+  for (unsigned int i = 0; i < m_section_count; i++) {
+    if (ReadUInt32(Section(i) + 8) != pid_count)
+      return false;
+    pid_count += PidCount(i);
+  }
+
+  if (offset + pid_count * (PID_ENTRY_SIZE + NAME_INDEX_ENTRY_SIZE) >
+      m_size)
+    return false;
+  m_pid_count = static_cast<unsigned int>(pid_count);
+  m_pids = m_data + offset;
+  offset += m_pid_count * PID_ENTRY_SIZE;
+  m_name_index = m_data + offset;
+
+  for (unsigned int i = 0; i < m_section_count; i++) {
+    unsigned int count = PidCount(i);
+    const uint8_t *name_index = (
+        m_name_index + ReadUInt32(Section(i) + 8) * NAME_INDEX_ENTRY_SIZE);
+    for (unsigned int j = 0; j < count; j++) {
+      const uint8_t *entry = Entry(i, j);
+      uint64_t name_end = (static_cast<uint64_t>(ReadUInt32(entry + 4)) +
+                           ReadUInt16(entry + 2));
+      uint64_t data_end = (static_cast<uint64_t>(ReadUInt32(entry + 8)) +
+                           ReadUInt32(entry + 12));
+      if (name_end > m_size || data_end > m_size)
+        return false;
+      if (ReadUInt32(name_index + j * NAME_INDEX_ENTRY_SIZE) >= count)
+        return false;
+    }
+  }
+  return true;
+}
+
+
+const uint8_t *CompiledPidFile::Section(unsigned int section) const {
+  return m_sections + section * SECTION_SIZE;
+}
+
+
+const uint8_t *CompiledPidFile::Entry(unsigned int section,
+                                      unsigned int index) const {
+  return m_pids + (ReadUInt32(Section(section) + 8) + index) * PID_ENTRY_SIZE;
+}
+
+
+/**
+ * Compare the name of a PID table entry with a string, ignoring case.
+ * @returns less than, equal to or greater than 0 if the entry's name is less
+ *   than, equal to or greater than name.
+ */
+int CompiledPidFile::CompareName(const uint8_t *entry,
+                                 const string &name) const {
+  const char *entry_name = reinterpret_cast<const char*>(
+      m_data + ReadUInt32(entry + 4));
+  return PidIndex::CompareNames(entry_name, ReadUInt16(entry + 2),
+                                name.data(), name.size());
+}
+}  // namespace rdm
+}  // namespace ola
@@ -0,0 +1,149 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * CompiledPidFile.h
+ * A binary, memory mapped form of the PID definitions.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * Parsing the text format PID files takes a noticeable amount of time, which
+ * is paid by every tool that loads the PID store. The compiled form is
+ * produced at build time by ola_pid_compiler, and can be mapped and used in
+ * place. The PidDescriptors are only built when a PID is first looked up.
+ *
+ * All integers are stored in network byte order so the file can be shared
+ * between architectures. The layout is:
+ *
+ *   Header
+ *     char[8]  magic, "OLAPIDS\0"
+ *     uint32   format version
+ *     uint32   section count, the first section holds the ESTA PIDs
+ *     uint64   store version
+ *     uint32   source file count
+ *     uint32   reserved
+ *   Source table, one entry per text format file, sorted by name
+ *     uint32   name offset
+ *     uint32   name length
+ *     uint32   file size
+ *     uint32   FNV-1a checksum of the file
+ *   Section table, one entry per section
+ *     uint16   manufacturer id
+ *     uint16   reserved
+ *     uint32   PID count
+ *     uint32   index of the section's first entry in the PID table
+ *   PID table, the entries for each section are sorted by value
+ *     uint16   PID value
+ *     uint16   name length
+ *     uint32   name offset
+ *     uint32   offset of the serialized ola.rdm.pid.Pid message
+ *     uint32   length of the serialized message
+ *   Name index, one entry per PID
+ *     uint32   index of the entry within its section, sorted by name
+ *   Data
+ *     Source file names, PID names and serialized Pid messages.
+ *
+ * The source table lets the loader check that the compiled file was built
+ * from the text files it sits beside. Modification times aren't used since
+ * they're reset when the files are installed.
+ */
+
+#ifndef COMMON_RDM_COMPILEDPIDFILE_H_
+#define COMMON_RDM_COMPILEDPIDFILE_H_
+
+#include <stdint.h>
+#include <ola/rdm/PidStore.h>
+#include <string>
+#include <vector>
+#include "common/rdm/Pids.pb.h"
+
+namespace ola {
+namespace rdm {
+
+/**
+ * A compiled PID file.
+ */
+class CompiledPidFile {
+  public:
+    /**
+     * A text format file that the store was compiled from.
+     */
+    typedef struct {
+      std::string name;  // the file name, without the directory
+      uint32_t size;
+      uint32_t checksum;
+    } SourceFile;
+
+    ~CompiledPidFile();
+
+    uint64_t Version() const { return m_version; }
+    unsigned int SectionCount() const { return m_section_count; }
+    uint16_t ManufacturerId(unsigned int section) const;
+
+    const std::vector<SourceFile> &SourceFiles() const { return m_sources; }
+    bool SourcesMatch(const std::vector<std::string> &files) const;
+
+    unsigned int PidCount(unsigned int section) const;
+    uint16_t PidValue(unsigned int section, unsigned int index) const;
+
+    bool FindPid(unsigned int section,
+                 uint16_t pid_value,
+                 unsigned int *index) const;
+    bool FindPid(unsigned int section,
+                 const std::string &pid_name,
+                 unsigned int *index) const;
+
+    const PidDescriptor *BuildDescriptor(unsigned int section,
+                                         unsigned int index) const;
+
+    static CompiledPidFile *Open(const std::string &file, bool validate);
+    static bool Compile(const ola::rdm::pid::PidStore &store_pb,
+                        const std::vector<std::string> &files,
+                        std::string *output);
+    static bool ReadSourceFiles(const std::vector<std::string> &files,
+                                std::vector<SourceFile> *sources);
+
+    static const unsigned int FORMAT_VERSION = 2;
+
+  private:
+    const uint8_t *m_data;
+    unsigned int m_size;
+    bool m_validate;
+    uint64_t m_version;
+    unsigned int m_section_count;
+    unsigned int m_pid_count;
+    const uint8_t *m_sections;
+    const uint8_t *m_pids;
+    const uint8_t *m_name_index;
+    std::vector<SourceFile> m_sources;
+
+    CompiledPidFile(const uint8_t *data, unsigned int size, bool validate);
+    CompiledPidFile(const CompiledPidFile&);
+    CompiledPidFile& operator=(const CompiledPidFile&);
+
+    bool Init();
+    const uint8_t *Section(unsigned int section) const;
+    const uint8_t *Entry(unsigned int section, unsigned int index) const;
+    int CompareName(const uint8_t *entry, const std::string &name) const;
+
+    static const char MAGIC[];
+    static const unsigned int MAGIC_SIZE = 8;
+    static const unsigned int HEADER_SIZE = 32;
+    static const unsigned int SOURCE_SIZE = 16;
+    static const unsigned int SECTION_SIZE = 12;
+    static const unsigned int PID_ENTRY_SIZE = 16;
+    static const unsigned int NAME_INDEX_ENTRY_SIZE = 4;
+};
+}  // namespace rdm
+}  // namespace ola
+#endif  // COMMON_RDM_COMPILEDPIDFILE_H_
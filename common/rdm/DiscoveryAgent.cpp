@@ -19,7 +19,9 @@
  *
  * The discovery process goes something like this:
  *   - if incremental, copy all previously discovered UIDs to the mute list
- *   - push (0, 0xffffffffffff) onto the resolution stack
+ *   - push (0, 0xffffffffffff) onto the resolution stack. For full discovery
+ *     where we've found devices before, split it into a branch per known
+ *     manufacturer and branches for the gaps between them.
  *   - unmute all
  *   - mute all previously discovered UIDs, for any that fail to mute remove
  *     them from the UIDSet.
@@ -40,6 +42,7 @@
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
 #include "string"
+#include "vector"
 
 namespace ola {
 namespace rdm {
@@ -61,7 +64,8 @@ DiscoveryAgent::DiscoveryAgent(DiscoveryTargetInterface *target)
       m_branch_callback(
         ola::NewCallback(this, &DiscoveryAgent::BranchComplete)),
       m_muting_uid(0, 0),
-      m_mute_attempts(0) {
+      m_mute_attempts(0),
+      m_mute_count(0) {
 }
 
 
@@ -141,20 +145,20 @@ void DiscoveryAgent::InitDiscovery(
     FreeCurrentRange();
 
   if (incremental) {
+    // the known devices are muted before the branch phase, so there's no
+    // point splitting the tree by manufacturer.
+    PushInitialRanges(UIDSet());
     UIDSet::Iterator iter = m_uids.Begin();
     for (; iter != m_uids.End(); ++iter)
       m_uids_to_mute.push(*iter);
   } else {
+    PushInitialRanges(m_uids);
     m_uids.Clear();
   }
 
   m_bad_uids.Clear();
   m_tree_corrupt = false;
 
-  // push the first range on to the branch stack
-  UID lower(0, 0);
-  m_uid_ranges.push(new UIDRange(lower, UID::AllDevices(), NULL));
-
   m_target->UnMuteAll(m_unmute_callback);
 }
 
@@ -213,6 +217,21 @@ void DiscoveryAgent::SendDiscovery() {
     return;
   }
   UIDRange *range = m_uid_ranges.top();
+  if (range->branches && range->empty_branches == range->branches &&
+      range->first_empty_mute_count == m_mute_count &&
+      range->uids_discovered) {
+    // Every child branch is silent, and no devices were muted since the first
+    // one went silent (muting a proxy can reveal the devices behind it). So
+    // all devices in this branch have been muted and there's no need to DUB
+    // it again.
+    OLA_DEBUG << "Skipping DUB of (" << range->lower << ", " << range->upper
+              << "), " << range->uids_discovered << " uids found";
+    BranchEmpty(range);
+    FreeCurrentRange();
+    SendDiscovery();
+    return;
+  }
+
   if (range->uids_discovered == 0) {
     range->attempt++;
   }
@@ -227,6 +246,11 @@ void DiscoveryAgent::SendDiscovery() {
       range->parent->branch_corrupt = true;
     FreeCurrentRange();
     SendDiscovery();
+  } else if (range->expect_collision) {
+    // The parent collided and the sibling branch is empty, so there are at
+    // least two devices in this branch. Skip the DUB and split it.
+    range->expect_collision = false;
+    HandleCollision();
   } else {
     OLA_DEBUG << "DUB " << range->lower << " - " << range->upper <<
       ", attempt " << range->attempt << ", uids found: " <<
@@ -245,6 +269,7 @@ void DiscoveryAgent::SendDiscovery() {
 void DiscoveryAgent::BranchComplete(const uint8_t *data, unsigned int length) {
   if (length == 0) {
     // timeout
+    BranchEmpty(m_uid_ranges.top());
     FreeCurrentRange();
     SendDiscovery();
     return;
@@ -352,6 +377,7 @@ void DiscoveryAgent::BranchMuteComplete(bool status) {
   if (status) {
     m_uids.AddUID(m_muting_uid);
     m_uid_ranges.top()->uids_discovered++;
+    m_mute_count++;
   } else {
     // failed to mute, if we haven't reached the limit try it again
     if (m_mute_attempts < MAX_MUTE_ATTEMPTS) {
@@ -397,6 +423,9 @@ void DiscoveryAgent::HandleCollision() {
     " , " << mid_plus_one_uid << " - " << upper_uid;
 
   range->uids_discovered = 0;
+  range->collided = true;
+  range->branches = 2;
+  range->empty_branches = 0;
   // add both ranges to the stack
   m_uid_ranges.push(new UIDRange(lower_uid, mid_uid, range));
   m_uid_ranges.push(new UIDRange(mid_plus_one_uid, upper_uid, range));
@@ -421,5 +450,82 @@ void DiscoveryAgent::FreeCurrentRange() {
   delete range;
   m_uid_ranges.pop();
 }
+
+
+/**
+ * Record that a branch returned no response to a DUB, which means it's now
+ * empty.
+ */
+void DiscoveryAgent::BranchEmpty(UIDRange *range) {
+  UIDRange *parent = range->parent;
+  if (!parent)
+    return;
+
+  if (!parent->empty_branches) {
+    parent->first_empty_mute_count = m_mute_count;
+    // If this was the first DUB of the half of a collided branch searched
+    // first, all the responders that collided must be in the other half.
+    if (parent->collided && range->attempt == 1 && !range->uids_discovered &&
+        m_uid_ranges.size() > 1) {
+      m_uid_ranges.pop();
+      UIDRange *sibling = m_uid_ranges.top();
+      if (sibling->parent == parent && sibling->attempt == 0)
+        sibling->expect_collision = true;
+      m_uid_ranges.push(range);
+    }
+  }
+  parent->empty_branches++;
+}
+
+
+/**
+ * Push the ranges to start discovery with on to the stack.
+ *
+ * Devices from the same manufacturer share the upper 16 bits of their UID, so
+ * a search from (0, 0xffffffffffff) has to collide its way down to each
+ * manufacturer. Since most rigs don't change much between runs, the top
+ * level range is split up front into a branch for each manufacturer we've
+ * seen before, and a branch for each gap between them.
+ * @param known_uids the UIDs found by the last discovery run.
+ */
+void DiscoveryAgent::PushInitialRanges(const UIDSet &known_uids) {
+  UIDRange *root = new UIDRange(UID(0, 0), UID::AllDevices(), NULL);
+  m_uid_ranges.push(root);
+  if (known_uids.Size() == 0)
+    return;
+
+  std::vector<UIDRange*> ranges;
+  // the first manufacturer id not yet covered by a range
+  uint32_t next_manufacturer = 0;
+  UIDSet::Iterator iter = known_uids.Begin();
+  for (; iter != known_uids.End(); ++iter) {
+    uint32_t manufacturer_id = iter->ManufacturerId();
+    if (manufacturer_id < next_manufacturer)
+      continue;
+
+    if (manufacturer_id > next_manufacturer) {
+      ranges.push_back(new UIDRange(
+            UID(next_manufacturer, 0),
+            UID(manufacturer_id - 1, UID::ALL_DEVICES),
+            root));
+    }
+    ranges.push_back(new UIDRange(
+          UID(manufacturer_id, 0),
+          UID(manufacturer_id, UID::ALL_DEVICES),
+          root));
+    next_manufacturer = manufacturer_id + 1;
+  }
+
+  if (next_manufacturer <= UID::ALL_MANUFACTURERS) {
+    ranges.push_back(
+        new UIDRange(UID(next_manufacturer, 0), UID::AllDevices(), root));
+  }
+
+  // push in reverse order so we search from the lowest UID up
+  root->branches = ranges.size();
+  std::vector<UIDRange*>::reverse_iterator range_iter = ranges.rbegin();
+  for (; range_iter != ranges.rend(); ++range_iter)
+    m_uid_ranges.push(*range_iter);
+}
 }  // namespace rdm
 }  // namespace ola
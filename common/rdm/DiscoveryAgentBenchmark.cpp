@@ -0,0 +1,158 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * DiscoveryAgentBenchmark.cpp
+ * Counts the messages the DiscoveryAgent sends to discover a large rig.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * This isn't run as part of make check, run ./DiscoveryAgentBenchmark by
+ * hand.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <iostream>
+#include <string>
+
+#include "common/rdm/DiscoveryAgentTestHelper.h"
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/rdm/DiscoveryAgent.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::TimeStamp;
+using ola::rdm::DiscoveryAgent;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::string;
+
+
+class DiscoveryAgentBenchmark: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DiscoveryAgentBenchmark);
+  CPPUNIT_TEST(testLargeRig);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    DiscoveryAgentBenchmark()
+        : CppUnit::TestFixture(),
+          m_callback_run(false) {
+    }
+
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+    }
+
+    void testLargeRig();
+
+  private:
+    static const unsigned int RESPONDER_COUNT = 1024;
+    static const unsigned int NEW_RESPONDER_COUNT = 16;
+
+    bool m_callback_run;
+    Clock m_clock;
+
+    void RunDiscovery(const string &description,
+                      MockDiscoveryTarget *target,
+                      DiscoveryAgent *agent,
+                      const UIDSet &expected_uids,
+                      bool full);
+    void DiscoveryComplete(const UIDSet *expected,
+                           bool successful,
+                           const UIDSet &received);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DiscoveryAgentBenchmark);
+
+
+/*
+ * Discover 1024 responders spread over 4 manufacturers.
+ */
+void DiscoveryAgentBenchmark::testLargeRig() {
+  const uint16_t manufacturers[] = {0x00a1, 0x4a54, 0x4a55, 0x7a70};
+  const unsigned int manufacturer_count =
+    sizeof(manufacturers) / sizeof(manufacturers[0]);
+  UIDSet uids;
+  uint32_t seed = 1;
+  while (uids.Size() < RESPONDER_COUNT) {
+    seed = seed * 1103515245 + 12345;
+    uids.AddUID(UID(manufacturers[uids.Size() % manufacturer_count], seed));
+  }
+
+  ResponderList responders;
+  UIDSet::Iterator iter = uids.Begin();
+  for (; iter != uids.End(); ++iter)
+    responders.push_back(new MockResponder(*iter));
+  MockDiscoveryTarget target(responders);
+  target.SetDeferCallbacks(true);
+  DiscoveryAgent agent(&target);
+
+  std::cout << std::endl;
+  RunDiscovery("Full, cold", &target, &agent, uids, true);
+  RunDiscovery("Full, warm", &target, &agent, uids, true);
+  RunDiscovery("Incremental, no changes", &target, &agent, uids, false);
+
+  for (unsigned int i = 0; i < NEW_RESPONDER_COUNT; i++) {
+    seed = seed * 1103515245 + 12345;
+    UID uid(manufacturers[i % manufacturer_count], seed);
+    uids.AddUID(uid);
+    target.AddResponder(new MockResponder(uid));
+  }
+  RunDiscovery("Incremental, 16 new", &target, &agent, uids, false);
+}
+
+
+/*
+ * Run discovery and print the number of messages sent.
+ */
+void DiscoveryAgentBenchmark::RunDiscovery(const string &description,
+                                           MockDiscoveryTarget *target,
+                                           DiscoveryAgent *agent,
+                                           const UIDSet &expected_uids,
+                                           bool full) {
+  DiscoveryAgent::DiscoveryCompleteCallback *callback =
+    ola::NewSingleCallback(this,
+                           &DiscoveryAgentBenchmark::DiscoveryComplete,
+                           &expected_uids);
+  m_callback_run = false;
+  target->ResetCounters();
+
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  if (full)
+    agent->StartFullDiscovery(callback);
+  else
+    agent->StartIncrementalDiscovery(callback);
+  target->RunPendingCallbacks();
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_TRUE(m_callback_run);
+
+  std::cout << description << ", " << expected_uids.Size() << " responders: "
+            << target->BranchCount() << " DUBs, " << target->MuteCount()
+            << " mutes, " << (end - start) << "s" << std::endl;
+}
+
+
+void DiscoveryAgentBenchmark::DiscoveryComplete(const UIDSet *expected,
+                                                bool successful,
+                                                const UIDSet &received) {
+  OLA_ASSERT_TRUE(successful);
+  OLA_ASSERT_EQ(*expected, received);
+  m_callback_run = true;
+}
@@ -50,6 +50,7 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testNonMutingResponder);
   CPPUNIT_TEST(testFlakeyResponder);
   CPPUNIT_TEST(testProxy);
+  CPPUNIT_TEST(testLargeRig);
   CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -67,6 +68,7 @@ class DiscoveryAgentTest: public CppUnit::TestFixture {
     void testNonMutingResponder();
     void testFlakeyResponder();
     void testProxy();
+    void testLargeRig();
 
     void setUp() {
       ola::InitLogging(ola::OLA_LOG_DEBUG, ola::OLA_LOG_STDERR);
@@ -450,4 +452,56 @@ void DiscoveryAgentTest::testProxy() {
                              static_cast<const UIDSet*>(&uids)));
   OLA_ASSERT_TRUE(m_callback_run);
   m_callback_run = false;
+
+  // run it again, this time the tree is split by manufacturer
+  OLA_INFO << "starting second discovery with Proxy responder";
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+}
+
+
+/**
+ * Test a large number of responders, and check that the second run of full
+ * discovery, which starts with the manufacturers from the first run, sends
+ * fewer DUBs.
+ */
+void DiscoveryAgentTest::testLargeRig() {
+  ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+  const uint16_t manufacturers[] = {0x00a1, 0x4a54, 0x7a70};
+  UIDSet uids;
+  ResponderList responders;
+  uint32_t seed = 1;
+  for (unsigned int i = 0; i < 1200; i++) {
+    seed = seed * 1103515245 + 12345;
+    uids.AddUID(UID(manufacturers[i % 3], seed));
+  }
+  PopulateResponderListFromUIDs(uids, &responders);
+  MockDiscoveryTarget target(responders);
+  target.SetDeferCallbacks(true);
+
+  DiscoveryAgent agent(&target);
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  target.RunPendingCallbacks();
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+  unsigned int first_branch_count = target.BranchCount();
+  OLA_ASSERT_EQ(uids.Size(), target.MuteCount());
+
+  target.ResetCounters();
+  agent.StartFullDiscovery(
+      ola::NewSingleCallback(this,
+                             &DiscoveryAgentTest::DiscoverySuccessful,
+                             static_cast<const UIDSet*>(&uids)));
+  target.RunPendingCallbacks();
+  OLA_ASSERT_TRUE(m_callback_run);
+  m_callback_run = false;
+  OLA_ASSERT_LT(target.BranchCount(), first_branch_count);
+  OLA_ASSERT_EQ(uids.Size(), target.MuteCount());
 }
@@ -24,8 +24,10 @@
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
 #include <algorithm>
+#include <queue>
 #include <vector>
 
+#include "ola/Callback.h"
 #include "ola/Logging.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
@@ -341,26 +343,37 @@ class ProxyResponder: public MockResponder {
 class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
   public:
     explicit MockDiscoveryTarget(const ResponderList &responders)
-        : m_responders(responders) {
+        : m_responders(responders),
+          m_defer_callbacks(false),
+          m_branch_count(0),
+          m_mute_count(0) {
     }
 
     ~MockDiscoveryTarget() {
       ResponderList::const_iterator iter = m_responders.begin();
       for (; iter != m_responders.end(); ++iter)
         delete *iter;
+      while (!m_pending_callbacks.empty()) {
+        delete m_pending_callbacks.front();
+        m_pending_callbacks.pop();
+      }
     }
 
     // Mute a device
     void MuteDevice(const UID &target, MuteDeviceCallback *mute_complete) {
+      m_mute_count++;
+      bool muted = false;
       ResponderList::const_iterator iter = m_responders.begin();
       for (; iter != m_responders.end(); ++iter) {
         if ((*iter)->Mute(target)) {
-          mute_complete->Run(true);
-          return;
+          muted = true;
+          break;
         }
       }
-      // if we made it this far the responder has gone
-      mute_complete->Run(false);
+      // if muted is false the responder has gone
+      RunCallback(ola::NewSingleCallback(mute_complete,
+                                         &MuteDeviceCallback::Run,
+                                         muted));
     }
 
     // Un Mute all devices
@@ -368,30 +381,45 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
       ResponderList::const_iterator iter = m_responders.begin();
       for (; iter != m_responders.end(); ++iter)
         (*iter)->UnMute();
-      unmute_complete->Run();
+      RunCallback(ola::NewSingleCallback(unmute_complete,
+                                         &UnMuteDeviceCallback::Run));
     }
 
     // Send a branch request
     void Branch(const UID &lower, const UID &upper, BranchCallback *callback) {
-      // alloc twice the amount we need
-      unsigned int data_size = 2 * MockResponder::DISCOVERY_RESPONSE_SIZE;
-      uint8_t data[data_size];
-      memset(data, 0, data_size);
+      m_branch_count++;
+      memset(m_branch_data, 0, sizeof(m_branch_data));
       bool valid = false;
       unsigned int actual_size = 0;
       ResponderList::const_iterator iter = m_responders.begin();
       for (; iter != m_responders.end(); ++iter) {
-        unsigned int data_used = data_size;
-        if ((*iter)->FormResponse(lower, upper, data, &data_used)) {
+        unsigned int data_used = sizeof(m_branch_data);
+        if ((*iter)->FormResponse(lower, upper, m_branch_data, &data_used)) {
           actual_size = std::max(data_used, actual_size);
           valid = true;
         }
       }
 
-      if (valid)
-        callback->Run(data, actual_size);
-      else
-        callback->Run(NULL, 0);
+      const uint8_t *data = valid ? m_branch_data : NULL;
+      RunCallback(ola::NewSingleCallback(callback,
+                                         &BranchCallback::Run,
+                                         data,
+                                         valid ? actual_size : 0));
+    }
+
+    /*
+     * If defer is true, callbacks aren't run until RunPendingCallbacks() is
+     * called. Otherwise the agent recurses once for each message which can
+     * overflow the stack when there are lots of responders.
+     */
+    void SetDeferCallbacks(bool defer) { m_defer_callbacks = defer; }
+
+    void RunPendingCallbacks() {
+      while (!m_pending_callbacks.empty()) {
+        ola::SingleUseCallback0<void> *callback = m_pending_callbacks.front();
+        m_pending_callbacks.pop();
+        callback->Run();
+      }
     }
 
     // Add a responder to the list of responders
@@ -411,7 +439,29 @@ class MockDiscoveryTarget: public ola::rdm::DiscoveryTargetInterface {
       }
     }
 
+    // The number of DUB & mute messages sent since the last ResetCounters()
+    unsigned int BranchCount() const { return m_branch_count; }
+    unsigned int MuteCount() const { return m_mute_count; }
+
+    void ResetCounters() {
+      m_branch_count = 0;
+      m_mute_count = 0;
+    }
+
   private:
     ResponderList m_responders;
+    bool m_defer_callbacks;
+    std::queue<ola::SingleUseCallback0<void>*> m_pending_callbacks;
+    // alloc twice the amount we need
+    uint8_t m_branch_data[2 * MockResponder::DISCOVERY_RESPONSE_SIZE];
+    unsigned int m_branch_count;
+    unsigned int m_mute_count;
+
+    void RunCallback(ola::SingleUseCallback0<void> *callback) {
+      if (m_defer_callbacks)
+        m_pending_callbacks.push(callback);
+      else
+        callback->Run();
+    }
 };
 #endif  // COMMON_RDM_DISCOVERYAGENTTESTHELPER_H_
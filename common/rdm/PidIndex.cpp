@@ -0,0 +1,169 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * PidIndex.cpp
+ * Hash indexes of PidDescriptors by value and name.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <string>
+#include <vector>
+#include "common/rdm/PidIndex.h"
+#include "ola/rdm/PidStore.h"
+
+namespace ola {
+namespace rdm {
+
+using std::string;
+using std::vector;
+
+/*
+ * Convert an ASCII character to upper case. PID names are always ASCII, and
+ * this avoids the locale lookups in toupper().
+ */
+static inline char ToUpperASCII(char c) {
+  return (c >= 'a' && c <= 'z') ? c - ('a' - 'A') : c;
+}
+
+
+/**
+ * Create a new, empty index.
+ */
+PidIndex::PidIndex()
+    : m_size(0),
+      m_shift(32 - INITIAL_TABLE_BITS) {
+  ValueSlot empty_value = {0, NULL};
+  NameSlot empty_name = {0, NULL};
+  m_values.resize(1 << INITIAL_TABLE_BITS, empty_value);
+  m_names.resize(1 << INITIAL_TABLE_BITS, empty_name);
+}
+
+
+/**
+ * Add a descriptor to the index. This replaces any existing descriptor with
+ * the same value or name.
+ */
+void PidIndex::Add(const PidDescriptor *descriptor) {
+  // keep the load factor at or below 0.5 so the probe sequences stay short
+  if ((m_size + 1) * 2 > m_values.size())
+    Grow();
+  Insert(descriptor);
+}
+
+
+/**
+ * Lookup a descriptor by name, ignoring case.
+ * @returns the descriptor, or NULL if the name isn't in the index.
+ */
+const PidDescriptor *PidIndex::Lookup(const string &pid_name) const {
+  const uint32_t hash = NameHash(pid_name.data(), pid_name.size());
+  const unsigned int mask = m_names.size() - 1;
+  for (unsigned int i = Slot(hash); m_names[i].descriptor;
+       i = (i + 1) & mask) {
+    if (m_names[i].hash != hash)
+      continue;
+    const string &name = m_names[i].descriptor->Name();
+    if (!CompareNames(name.data(), name.size(), pid_name.data(),
+                      pid_name.size()))
+      return m_names[i].descriptor;
+  }
+  return NULL;
+}
+
+
+/**
+ * Compare two PID names, ignoring case.
+ * @returns less than, equal to or greater than 0 if name1 is less than, equal
+ *   to or greater than name2.
+ */
+int PidIndex::CompareNames(const char *name1, unsigned int length1,
+                           const char *name2, unsigned int length2) {
+  const unsigned int length = length1 < length2 ? length1 : length2;
+  for (unsigned int i = 0; i < length; i++) {
+    const char c1 = ToUpperASCII(name1[i]);
+    const char c2 = ToUpperASCII(name2[i]);
+    if (c1 != c2)
+      return static_cast<unsigned char>(c1) < static_cast<unsigned char>(c2) ?
+        -1 : 1;
+  }
+  if (length1 == length2)
+    return 0;
+  return length1 < length2 ? -1 : 1;
+}
+
+
+void PidIndex::Insert(const PidDescriptor *descriptor) {
+  unsigned int mask = m_values.size() - 1;
+  unsigned int i = Slot(descriptor->Value());
+  while (m_values[i].descriptor &&
+         m_values[i].value != descriptor->Value())
+    i = (i + 1) & mask;
+  if (!m_values[i].descriptor)
+    m_size++;
+  m_values[i].value = descriptor->Value();
+  m_values[i].descriptor = descriptor;
+
+  const string &name = descriptor->Name();
+  const uint32_t hash = NameHash(name.data(), name.size());
+  mask = m_names.size() - 1;
+  i = Slot(hash);
+  while (m_names[i].descriptor) {
+    const string &other_name = m_names[i].descriptor->Name();
+    if (m_names[i].hash == hash &&
+        !CompareNames(other_name.data(), other_name.size(), name.data(),
+                      name.size()))
+      break;
+    i = (i + 1) & mask;
+  }
+  m_names[i].hash = hash;
+  m_names[i].descriptor = descriptor;
+}
+
+
+/**
+ * Double the size of the tables.
+ */
+void PidIndex::Grow() {
+  vector<ValueSlot> old_values;
+  old_values.swap(m_values);
+
+  ValueSlot empty_value = {0, NULL};
+  NameSlot empty_name = {0, NULL};
+  m_values.resize(old_values.size() * 2, empty_value);
+  m_names.assign(old_values.size() * 2, empty_name);
+  m_shift--;
+  m_size = 0;
+
+  vector<ValueSlot>::const_iterator iter = old_values.begin();
+  for (; iter != old_values.end(); ++iter) {
+    if (iter->descriptor)
+      Insert(iter->descriptor);
+  }
+}
+
+
+/**
+ * A case insensitive FNV-1a hash of a name.
+ */
+uint32_t PidIndex::NameHash(const char *name, unsigned int length) {
+  uint32_t hash = 2166136261u;
+  for (unsigned int i = 0; i < length; i++) {
+    hash ^= static_cast<unsigned char>(ToUpperASCII(name[i]));
+    hash *= 16777619u;
+  }
+  return hash;
+}
+}  // namespace rdm
+}  // namespace ola
@@ -0,0 +1,101 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * PidIndex.h
+ * Hash indexes of PidDescriptors by value and name.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * The RDM sniffers and the CommandPrinter look up a PID for every packet, so
+ * the indexes are flat, open addressed tables rather than std::maps. Name
+ * lookups are case insensitive, which saves the caller from converting the
+ * name to upper case first.
+ */
+
+#ifndef COMMON_RDM_PIDINDEX_H_
+#define COMMON_RDM_PIDINDEX_H_
+
+#include <stdint.h>
+#include <ola/rdm/PidStore.h>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * Indexes a set of PidDescriptors. The descriptors aren't owned by the
+ * index.
+ */
+class PidIndex {
+  public:
+    PidIndex();
+
+    unsigned int Size() const { return m_size; }
+
+    void Add(const PidDescriptor *descriptor);
+    const PidDescriptor *Lookup(const std::string &pid_name) const;
+
+    /**
+     * Lookup a descriptor by value. This is on the per-packet path so it's
+     * inline.
+     * @returns the descriptor, or NULL if the value isn't in the index.
+     */
+    const PidDescriptor *Lookup(uint16_t pid_value) const {
+      const unsigned int mask = m_values.size() - 1;
+      for (unsigned int i = Slot(pid_value); m_values[i].descriptor;
+           i = (i + 1) & mask) {
+        if (m_values[i].value == pid_value)
+          return m_values[i].descriptor;
+      }
+      return NULL;
+    }
+
+    static int CompareNames(const char *name1, unsigned int length1,
+                            const char *name2, unsigned int length2);
+
+  private:
+    struct ValueSlot {
+      uint16_t value;
+      const PidDescriptor *descriptor;
+    };
+
+    struct NameSlot {
+      uint32_t hash;
+      const PidDescriptor *descriptor;
+    };
+
+    std::vector<ValueSlot> m_values;
+    std::vector<NameSlot> m_names;
+    unsigned int m_size;
+    unsigned int m_shift;
+
+    void Insert(const PidDescriptor *descriptor);
+    void Grow();
+
+    /*
+     * Map a hash to a slot, using Fibonacci hashing to spread the PID
+     * values, which tend to be clustered, across the table.
+     */
+    unsigned int Slot(uint32_t hash) const {
+      return (hash * 2654435769u) >> m_shift;
+    }
+
+    static uint32_t NameHash(const char *name, unsigned int length);
+
+    static const unsigned int INITIAL_TABLE_BITS = 4;
+};
+}  // namespace rdm
+}  // namespace ola
+#endif  // COMMON_RDM_PIDINDEX_H_
@@ -18,19 +18,56 @@
  * Copyright (C) 2011 Simon Newton
  */
 
+#include <algorithm>
 #include <string>
+#include <utility>
 #include <vector>
+#include "common/rdm/CompiledPidFile.h"
+#include "common/rdm/PidIndex.h"
 #include "common/rdm/PidStoreLoader.h"
-#include "ola/StringUtils.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMEnums.h"
+#include "ola/thread/Mutex.h"
 
 namespace ola {
 namespace rdm {
 
+using ola::thread::MutexLocker;
+using std::pair;
 using std::vector;
 
 
+/*
+ * Used to search the manufacturer index.
+ */
+static bool ManufacturerLessThan(const pair<uint16_t, const PidStore*> &entry,
+                                 uint16_t esta_id) {
+  return entry.first < esta_id;
+}
+
+
+/**
+ * Create a new RootPidStore
+ * @param esta_store the store holding the ESTA PIDs, ownership is transferred.
+ * @param manufacturer_stores the manufacturer specific stores, ownership of
+ *   the stores is transferred.
+ * @param version the version of the store.
+ * @param compiled_file the compiled PID file backing the stores, or NULL.
+ *   Ownership is transferred.
+ */
+RootPidStore::RootPidStore(const PidStore *esta_store,
+                           const ManufacturerMap &manufacturer_stores,
+                           uint64_t version,
+                           const CompiledPidFile *compiled_file)
+    : m_esta_store(esta_store),
+      m_manufacturer_store(manufacturer_stores),
+      m_manufacturer_index(manufacturer_stores.begin(),
+                           manufacturer_stores.end()),
+      m_version(version),
+      m_compiled_file(compiled_file) {
+}
+
+
 /**
  * Clean up
  */
@@ -45,8 +82,10 @@ RootPidStore::~RootPidStore() {
  * @returns A pointer to a PidStore or NULL if not found
  */
 const PidStore *RootPidStore::ManufacturerStore(uint16_t esta_id) const {
-  ManufacturerMap::const_iterator iter = m_manufacturer_store.find(esta_id);
-  if (iter == m_manufacturer_store.end())
+  ManufacturerIndex::const_iterator iter = std::lower_bound(
+      m_manufacturer_index.begin(), m_manufacturer_index.end(), esta_id,
+      ManufacturerLessThan);
+  if (iter == m_manufacturer_index.end() || iter->first != esta_id)
     return NULL;
   return iter->second;
 }
@@ -59,9 +98,7 @@ const PidStore *RootPidStore::ManufacturerStore(uint16_t esta_id) const {
  */
 const PidDescriptor *RootPidStore::GetDescriptor(
     const string &pid_name) const {
-  string canonical_pid_name = pid_name;
-  ola::ToUpper(&canonical_pid_name);
-  return InternalESTANameLookup(canonical_pid_name);
+  return InternalESTANameLookup(pid_name);
 }
 
 
@@ -75,17 +112,14 @@ const PidDescriptor *RootPidStore::GetDescriptor(
 const PidDescriptor *RootPidStore::GetDescriptor(
     const string &pid_name,
     uint16_t manufacturer_id) const {
-  string canonical_pid_name = pid_name;
-  ola::ToUpper(&canonical_pid_name);
-
-  const PidDescriptor *descriptor = InternalESTANameLookup(canonical_pid_name);
+  const PidDescriptor *descriptor = InternalESTANameLookup(pid_name);
   if (descriptor)
     return descriptor;
 
   // now try the specific manufacturer store
   const PidStore *store = ManufacturerStore(manufacturer_id);
   if (store)
-    return store->LookupPID(canonical_pid_name);
+    return store->LookupPID(pid_name);
   return NULL;
 }
 
@@ -134,13 +168,13 @@ const PidDescriptor *RootPidStore::GetDescriptor(
 
 
 /**
- * Lookup an ESTA Pid by canonical name.
+ * Lookup an ESTA Pid by name, ignoring case.
  */
 const PidDescriptor *RootPidStore::InternalESTANameLookup(
-    const string &canonical_pid_name) const {
+    const string &pid_name) const {
   if (m_esta_store) {
     const ola::rdm::PidDescriptor *descriptor =
-      m_esta_store->LookupPID(canonical_pid_name);
+      m_esta_store->LookupPID(pid_name);
     if (descriptor)
       return descriptor;
   }
@@ -163,6 +197,10 @@ void RootPidStore::CleanStore() {
     delete iter->second;
   }
   m_manufacturer_store.clear();
+  m_manufacturer_index.clear();
+  // the stores may refer to the compiled file, so this goes last
+  delete m_compiled_file;
+  m_compiled_file = NULL;
 }
 
 
@@ -192,15 +230,30 @@ const RootPidStore *RootPidStore::LoadFromDirectory(
  * @param a list of PidDescriptors for this store.
  * @pre the names and values for the pids in the vector are unique.
  */
-PidStore::PidStore(const vector<const PidDescriptor*> &pids) {
+PidStore::PidStore(const vector<const PidDescriptor*> &pids)
+    : m_compiled_file(NULL),
+      m_section(0),
+      m_index(new PidIndex()) {
   vector<const PidDescriptor*>::const_iterator iter = pids.begin();
   for (; iter != pids.end(); ++iter) {
     m_pid_by_value[(*iter)->Value()] = *iter;
-    m_pid_by_name[(*iter)->Name()] = *iter;
+    m_index->Add(*iter);
   }
 }
 
 
+/**
+ * Create a new PidStore from a section of a compiled PID file.
+ * @param compiled_file the compiled PID file, ownership is not transferred.
+ * @param section the section of the file that holds the PIDs for this store.
+ */
+PidStore::PidStore(const CompiledPidFile *compiled_file, unsigned int section)
+    : m_compiled_file(compiled_file),
+      m_section(section),
+      m_index(new PidIndex()) {
+}
+
+
 /**
  * Clean up.
  */
@@ -210,7 +263,17 @@ PidStore::~PidStore() {
     delete iter->second;
   }
   m_pid_by_value.clear();
-  m_pid_by_name.clear();
+  delete m_index;
+}
+
+
+/**
+ * Return the number of pids in the store.
+ */
+unsigned int PidStore::PidCount() const {
+  if (m_compiled_file)
+    return m_compiled_file->PidCount(m_section);
+  return m_pid_by_value.size();
 }
 
 
@@ -219,6 +282,14 @@ PidStore::~PidStore() {
  * @param a pointer to a vector in which to put the PidDescriptors.
  */
 void PidStore::AllPids(vector<const PidDescriptor*> *pids) const {
+  MutexLocker lock(&m_mutex);
+  if (m_compiled_file) {
+    for (unsigned int i = 0; i < m_compiled_file->PidCount(m_section); i++) {
+      if (!m_index->Lookup(m_compiled_file->PidValue(m_section, i)))
+        BuildDescriptor(i);
+    }
+  }
+
   pids->reserve(pids->size() + m_pid_by_value.size());
 
   PidMap::const_iterator iter = m_pid_by_value.begin();
@@ -244,24 +315,54 @@ PidDescriptor::~PidDescriptor() {
  * @param pid_value the 16 bit pid value.
  */
 const PidDescriptor *PidStore::LookupPID(uint16_t pid_value) const {
-  PidMap::const_iterator iter = m_pid_by_value.find(pid_value);
-  if (iter == m_pid_by_value.end())
-    return NULL;
-  else
-    return iter->second;
+  if (!m_compiled_file)
+    return m_index->Lookup(pid_value);
+
+  MutexLocker lock(&m_mutex);
+  const PidDescriptor *descriptor = m_index->Lookup(pid_value);
+  if (descriptor)
+    return descriptor;
+
+  unsigned int index;
+  if (m_compiled_file->FindPid(m_section, pid_value, &index))
+    return BuildDescriptor(index);
+  return NULL;
 }
 
 
 /**
  * Lookup a PID by name
- * @param pid_name the name of the pid.
+ * @param pid_name the name of the pid, this is case insensitive.
  */
 const PidDescriptor *PidStore::LookupPID(const string &pid_name) const {
-  PidNameMap::const_iterator iter = m_pid_by_name.find(pid_name);
-  if (iter == m_pid_by_name.end())
-    return NULL;
-  else
-    return iter->second;
+  if (!m_compiled_file)
+    return m_index->Lookup(pid_name);
+
+  MutexLocker lock(&m_mutex);
+  const PidDescriptor *descriptor = m_index->Lookup(pid_name);
+  if (descriptor)
+    return descriptor;
+
+  unsigned int index;
+  if (m_compiled_file->FindPid(m_section, pid_name, &index))
+    return BuildDescriptor(index);
+  return NULL;
+}
+
+
+/**
+ * Build the descriptor for a PID in the compiled file, and add it to the
+ * maps. m_mutex must be held.
+ * @param index the index of the PID within our section of the file.
+ */
+const PidDescriptor *PidStore::BuildDescriptor(unsigned int index) const {
+  const PidDescriptor *descriptor = m_compiled_file->BuildDescriptor(
+      m_section, index);
+  if (descriptor) {
+    m_pid_by_value[descriptor->Value()] = descriptor;
+    m_index->Add(descriptor);
+  }
+  return descriptor;
 }
 
 
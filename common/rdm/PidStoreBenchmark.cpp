@@ -0,0 +1,237 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * PidStoreBenchmark.cpp
+ * Compares the PID store lookups with the std::map lookups they replaced.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * This isn't run as part of make check, run ./PidStoreBenchmark by hand.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/rdm/PidStoreLoader.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/rdm/PidStore.h"
+#include "ola/testing/TestUtils.h"
+
+using ola::Clock;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::rdm::PidDescriptor;
+using ola::rdm::PidStore;
+using ola::rdm::PidStoreLoader;
+using ola::rdm::RootPidStore;
+using std::auto_ptr;
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+
+class PidStoreBenchmark: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(PidStoreBenchmark);
+  CPPUNIT_TEST(testLookups);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_WARN, ola::OLA_LOG_STDERR);
+    }
+
+    void testLookups();
+
+  private:
+    typedef vector<pair<uint16_t, const PidDescriptor*> > PidList;
+
+    // The lookup structures used before the PidIndex was added.
+    typedef map<uint16_t, const PidDescriptor*> ValueMap;
+    typedef map<string, const PidDescriptor*> NameMap;
+    struct MapStore {
+      ValueMap by_value;
+      NameMap by_name;
+    };
+    typedef map<uint16_t, MapStore> MapStores;
+
+    static const unsigned int ROUNDS = 20000;
+
+    Clock m_clock;
+
+    void AddStore(uint16_t manufacturer_id, const PidStore *store,
+                  PidList *pids, MapStores *map_stores);
+    const PidDescriptor *MapLookup(const MapStores &map_stores,
+                                   uint16_t manufacturer_id,
+                                   uint16_t pid_value);
+    const PidDescriptor *MapLookup(const MapStores &map_stores,
+                                   uint16_t manufacturer_id,
+                                   const string &pid_name);
+    void PrintRate(const string &description, unsigned int lookups,
+                   const TimeStamp &start);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PidStoreBenchmark);
+
+
+/*
+ * Look up every PID in the shipped definitions by value and by name.
+ */
+void PidStoreBenchmark::testLookups() {
+  PidStoreLoader loader;
+  auto_ptr<const RootPidStore> root_store(loader.LoadFromDirectory(
+      PID_DEFINITIONS_DIR));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+
+  PidList pids;
+  MapStores map_stores;
+  AddStore(0, root_store->EstaStore(), &pids, &map_stores);
+  for (unsigned int i = 1; i <= 0xffff; i++) {
+    const PidStore *store = root_store->ManufacturerStore(i);
+    if (store)
+      AddStore(i, store, &pids, &map_stores);
+  }
+
+  // the sniffers see the names in whatever case the user typed
+  vector<string> names;
+  PidList::const_iterator iter = pids.begin();
+  for (; iter != pids.end(); ++iter) {
+    string name = iter->second->Name();
+    ola::ToLower(&name);
+    names.push_back(name);
+  }
+
+  const unsigned int lookups = ROUNDS * pids.size();
+  std::cout << std::endl << pids.size() << " PIDs, " << lookups
+            << " lookups per test" << std::endl;
+
+  unsigned int found = 0;
+  TimeStamp start;
+  m_clock.CurrentTime(&start);
+  for (unsigned int round = 0; round < ROUNDS; round++) {
+    for (iter = pids.begin(); iter != pids.end(); ++iter)
+      found += MapLookup(map_stores, iter->first, iter->second->Value()) !=
+               NULL;
+  }
+  PrintRate("std::map, by value", lookups, start);
+  OLA_ASSERT_EQ(lookups, found);
+
+  found = 0;
+  m_clock.CurrentTime(&start);
+  for (unsigned int round = 0; round < ROUNDS; round++) {
+    for (iter = pids.begin(); iter != pids.end(); ++iter)
+      found += root_store->GetDescriptor(iter->second->Value(),
+                                         iter->first) != NULL;
+  }
+  PrintRate("RootPidStore, by value", lookups, start);
+  OLA_ASSERT_EQ(lookups, found);
+
+  found = 0;
+  m_clock.CurrentTime(&start);
+  for (unsigned int round = 0; round < ROUNDS; round++) {
+    for (unsigned int i = 0; i < pids.size(); i++)
+      found += MapLookup(map_stores, pids[i].first, names[i]) != NULL;
+  }
+  PrintRate("std::map, by name", lookups, start);
+  OLA_ASSERT_EQ(lookups, found);
+
+  found = 0;
+  m_clock.CurrentTime(&start);
+  for (unsigned int round = 0; round < ROUNDS; round++) {
+    for (unsigned int i = 0; i < pids.size(); i++)
+      found += root_store->GetDescriptor(names[i], pids[i].first) != NULL;
+  }
+  PrintRate("RootPidStore, by name", lookups, start);
+  OLA_ASSERT_EQ(lookups, found);
+}
+
+
+void PidStoreBenchmark::AddStore(uint16_t manufacturer_id,
+                                 const PidStore *store,
+                                 PidList *pids,
+                                 MapStores *map_stores) {
+  vector<const PidDescriptor*> descriptors;
+  store->AllPids(&descriptors);
+  MapStore &map_store = (*map_stores)[manufacturer_id];
+  vector<const PidDescriptor*>::const_iterator iter = descriptors.begin();
+  for (; iter != descriptors.end(); ++iter) {
+    pids->push_back(pair<uint16_t, const PidDescriptor*>(manufacturer_id,
+                                                         *iter));
+    map_store.by_value[(*iter)->Value()] = *iter;
+    map_store.by_name[(*iter)->Name()] = *iter;
+  }
+}
+
+
+/*
+ * The ESTA PIDs are held under manufacturer 0.
+ */
+const PidDescriptor *PidStoreBenchmark::MapLookup(
+    const MapStores &map_stores,
+    uint16_t manufacturer_id,
+    uint16_t pid_value) {
+  MapStores::const_iterator store_iter = map_stores.find(0);
+  ValueMap::const_iterator iter = store_iter->second.by_value.find(pid_value);
+  if (iter != store_iter->second.by_value.end())
+    return iter->second;
+
+  store_iter = map_stores.find(manufacturer_id);
+  if (store_iter == map_stores.end())
+    return NULL;
+  iter = store_iter->second.by_value.find(pid_value);
+  return iter == store_iter->second.by_value.end() ? NULL : iter->second;
+}
+
+
+const PidDescriptor *PidStoreBenchmark::MapLookup(
+    const MapStores &map_stores,
+    uint16_t manufacturer_id,
+    const string &pid_name) {
+  string canonical_pid_name = pid_name;
+  ola::ToUpper(&canonical_pid_name);
+
+  MapStores::const_iterator store_iter = map_stores.find(0);
+  NameMap::const_iterator iter = store_iter->second.by_name.find(
+      canonical_pid_name);
+  if (iter != store_iter->second.by_name.end())
+    return iter->second;
+
+  store_iter = map_stores.find(manufacturer_id);
+  if (store_iter == map_stores.end())
+    return NULL;
+  iter = store_iter->second.by_name.find(canonical_pid_name);
+  return iter == store_iter->second.by_name.end() ? NULL : iter->second;
+}
+
+
+void PidStoreBenchmark::PrintRate(const string &description,
+                                  unsigned int lookups,
+                                  const TimeStamp &start) {
+  TimeStamp end;
+  m_clock.CurrentTime(&end);
+  TimeInterval duration = end - start;
+  double seconds = duration.Seconds() + duration.MicroSeconds() / 1000000.0;
+  std::cout << description << ": " << duration << "s, "
+            << static_cast<uint64_t>(lookups / seconds) << " lookups/s"
+            << std::endl;
+}
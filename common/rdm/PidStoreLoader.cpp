@@ -27,6 +27,7 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include "common/rdm/CompiledPidFile.h"
 #include "common/rdm/DescriptorConsistencyChecker.h"
 #include "common/rdm/PidStoreLoader.h"
 #include "common/rdm/Pids.pb.h"
@@ -44,6 +45,8 @@ using std::set;
 using std::stringstream;
 using std::vector;
 
+const char PidStoreLoader::COMPILED_FILE_NAME[] = "pids.compiled";
+
 
 /**
  * Load Pid information from a file.
@@ -69,6 +72,9 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 /**
  * Load Pid information from a directory. This is an all-or-nothing load. Any
  *   error with cause us to abort the load.
+ *
+ * If the directory contains a compiled PID file that was built from the
+ * .proto files in it, it's used instead.
  * @param directory the directory to load files from.
  * @param validate set to true if we should perform validation of the contents.
  * @returns A pointer to a new RootPidStore or NULL if loading failed.
@@ -76,68 +82,179 @@ const RootPidStore *PidStoreLoader::LoadFromFile(const string &file,
 const RootPidStore *PidStoreLoader::LoadFromDirectory(
     const std::string &directory,
     bool validate) {
-  DIR *dir;
-  struct dirent dir_ent;
-  struct dirent *entry;
-  if ((dir  = opendir(directory.data())) == NULL) {
-    OLA_WARN << "Could not open " << directory << ":" << strerror(errno);
+  vector<string> files;
+  if (!ListProtoFiles(directory, &files))
     return NULL;
+
+  const string compiled_file = directory + "/" + COMPILED_FILE_NAME;
+  const CompiledPidFile *compiled_pids = CompiledPidFile::Open(compiled_file,
+                                                               validate);
+  if (compiled_pids) {
+    if (compiled_pids->SourcesMatch(files)) {
+      OLA_DEBUG << "Loaded " << compiled_file;
+      return BuildCompiledStore(compiled_pids);
+    }
+    OLA_INFO << compiled_file << " wasn't built from the files in "
+             << directory << ", not using the compiled PIDs";
+    delete compiled_pids;
   }
 
-  vector<string> files;
-  readdir_r(dir, &dir_ent, &entry);
-  while (entry != NULL) {
-    string file_name(entry->d_name);
-    readdir_r(dir, &dir_ent, &entry);
+  ola::rdm::pid::PidStore pid_store_pb;
+  if (!ParseFiles(files, &pid_store_pb))
+    return NULL;
+  return BuildStore(pid_store_pb, validate);
+}
 
-    if (!StringEndsWith(file_name, ".proto"))
-      continue;
 
-    stringstream str;
-    str << directory << "/" << file_name;
-    files.push_back(str.str());
+/**
+ * Load Pid information from a stream
+ * @param data the input stream.
+ * @param validate set to true if we should perform validation of the contents.
+ * @returns A pointer to a new RootPidStore or NULL if loading failed.
+ */
+const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
+                                                   bool validate) {
+  ola::rdm::pid::PidStore pid_store_pb;
+  google::protobuf::io::IstreamInputStream input_stream(data);
+  bool ok = google::protobuf::TextFormat::Parse(&input_stream, &pid_store_pb);
+
+  if (!ok)
+    return NULL;
+
+  return BuildStore(pid_store_pb, validate);
+}
+
+
+/**
+ * Load a compiled PID file. The PidDescriptors are built as they're looked
+ * up.
+ * @param file the path to the compiled file.
+ * @param validate set to true if we should perform validation of the
+ *   descriptors as they're built.
+ * @returns A pointer to a new RootPidStore or NULL if loading failed.
+ */
+const RootPidStore *PidStoreLoader::LoadFromCompiledFile(const string &file,
+                                                         bool validate) {
+  const CompiledPidFile *compiled_file = CompiledPidFile::Open(file,
+                                                               validate);
+  if (!compiled_file)
+    return NULL;
+
+  OLA_DEBUG << "Loaded " << file;
+  return BuildCompiledStore(compiled_file);
+}
+
+
+/**
+ * Build the root store for a compiled PID file.
+ * @param compiled_file the compiled file, ownership is transferred.
+ */
+const RootPidStore *PidStoreLoader::BuildCompiledStore(
+    const CompiledPidFile *compiled_file) {
+  RootPidStore::ManufacturerMap manufacturer_map;
+  for (unsigned int i = 1; i < compiled_file->SectionCount(); i++) {
+    manufacturer_map[compiled_file->ManufacturerId(i)] = new PidStore(
+        compiled_file, i);
   }
-  closedir(dir);
 
+  return new RootPidStore(new PidStore(compiled_file, 0),
+                          manufacturer_map,
+                          compiled_file->Version(),
+                          compiled_file);
+}
+
+
+/**
+ * Compile the PID definitions in a directory. The definitions are fully
+ * validated first.
+ * @param directory the directory to load the .proto files from.
+ * @param output the string to write the compiled form to.
+ * @returns true if the definitions were compiled, false otherwise.
+ */
+bool PidStoreLoader::CompileDirectory(const string &directory,
+                                      string *output) {
+  vector<string> files;
   ola::rdm::pid::PidStore pid_store_pb;
+  if (!ListProtoFiles(directory, &files) ||
+      !ParseFiles(files, &pid_store_pb))
+    return false;
+
+  const RootPidStore *store = BuildStore(pid_store_pb, true);
+  if (!store)
+    return false;
+  delete store;
+  return CompiledPidFile::Compile(pid_store_pb, files, output);
+}
+
+
+/**
+ * Build the PidDescriptor for a single Pid message. This is used by the
+ * compiled PID store, which builds the descriptors as they're looked up.
+ * @param pid the Pid message.
+ * @param validate set to true if the descriptor should be validated.
+ * @returns a new PidDescriptor or NULL if the message was invalid.
+ */
+PidDescriptor *PidStoreLoader::BuildPidDescriptor(
+    const ola::rdm::pid::Pid &pid,
+    bool validate) {
+  PidStoreLoader loader;
+  return loader.PidToDescriptor(pid, validate);
+}
+
+
+/**
+ * Merge a list of text format PID files into a protobuf.
+ */
+bool PidStoreLoader::ParseFiles(const vector<string> &files,
+                                ola::rdm::pid::PidStore *store_pb) {
   vector<string>::const_iterator iter = files.begin();
   for (; iter != files.end(); ++iter) {
     std::ifstream proto_file(iter->data());
     if (!proto_file.is_open()) {
       OLA_WARN << "Failed to open " << *iter << ": " << strerror(errno);
-      return NULL;
+      return false;
     }
 
     google::protobuf::io::IstreamInputStream input_stream(&proto_file);
-    bool ok = google::protobuf::TextFormat::Merge(&input_stream,
-                                                  &pid_store_pb);
+    bool ok = google::protobuf::TextFormat::Merge(&input_stream, store_pb);
     proto_file.close();
 
     if (!ok) {
       OLA_WARN << "Failed to load " << *iter;
-      return NULL;
+      return false;
     }
   }
-  return BuildStore(pid_store_pb, validate);
+  return true;
 }
 
 
 /**
- * Load Pid information from a stream
- * @param data the input stream.
- * @param validate set to true if we should perform validation of the contents.
- * @returns A pointer to a new RootPidStore or NULL if loading failed.
+ * Get the paths of the .proto files in a directory.
  */
-const RootPidStore *PidStoreLoader::LoadFromStream(std::istream *data,
-                                                   bool validate) {
-  ola::rdm::pid::PidStore pid_store_pb;
-  google::protobuf::io::IstreamInputStream input_stream(data);
-  bool ok = google::protobuf::TextFormat::Parse(&input_stream, &pid_store_pb);
+bool PidStoreLoader::ListProtoFiles(const string &directory,
+                                    vector<string> *files) {
+  DIR *dir;
+  struct dirent dir_ent;
+  struct dirent *entry;
+  if ((dir  = opendir(directory.data())) == NULL) {
+    OLA_WARN << "Could not open " << directory << ":" << strerror(errno);
+    return false;
+  }
 
-  if (!ok)
-    return NULL;
+  readdir_r(dir, &dir_ent, &entry);
+  while (entry != NULL) {
+    string file_name(entry->d_name);
+    readdir_r(dir, &dir_ent, &entry);
 
-  return BuildStore(pid_store_pb, validate);
+    if (!StringEndsWith(file_name, ".proto"))
+      continue;
+
+    stringstream str;
+    str << directory << "/" << file_name;
+    files->push_back(str.str());
+  }
+  closedir(dir);
+  return true;
 }
 
 
@@ -54,11 +54,30 @@ class PidStoreLoader {
     const RootPidStore *LoadFromStream(std::istream *data,
                                        bool validate = true);
 
+    // Load a store produced by CompileDirectory
+    const RootPidStore *LoadFromCompiledFile(const std::string &file,
+                                             bool validate = true);
+
+    // Compile the files in a directory into the binary form
+    bool CompileDirectory(const std::string &directory, std::string *output);
+
+    // Build a PidDescriptor from a single Pid message
+    static PidDescriptor *BuildPidDescriptor(const ola::rdm::pid::Pid &pid,
+                                             bool validate);
+
+    static const char COMPILED_FILE_NAME[];
+
   private:
     PidStoreLoader(const PidStoreLoader&);
     PidStoreLoader& operator=(const PidStoreLoader&);
     DescriptorConsistencyChecker m_checker;
 
+    bool ParseFiles(const vector<string> &files,
+                    ola::rdm::pid::PidStore *store_pb);
+    bool ListProtoFiles(const std::string &directory,
+                        vector<string> *files);
+    const RootPidStore *BuildCompiledStore(
+        const class CompiledPidFile *compiled_file);
     const RootPidStore *BuildStore(const ola::rdm::pid::PidStore &store_pb,
                                    bool validate);
     template <typename pb_object>
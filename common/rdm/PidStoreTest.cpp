@@ -20,26 +20,37 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
 
+#include "common/rdm/CompiledPidFile.h"
+#include "common/rdm/PidIndex.h"
 #include "common/rdm/PidStoreLoader.h"
 #include "ola/BaseTypes.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/messaging/Descriptor.h"
 #include "ola/messaging/SchemaPrinter.h"
 #include "ola/rdm/PidStore.h"
 #include "ola/rdm/RDMEnums.h"
 #include "ola/testing/TestUtils.h"
+#include "ola/thread/Thread.h"
 
 
 
 using ola::messaging::Descriptor;
 using ola::messaging::FieldDescriptor;
 using ola::messaging::FieldDescriptorGroup;
+using ola::rdm::CompiledPidFile;
 using ola::rdm::PidDescriptor;
+using ola::rdm::PidIndex;
 using ola::rdm::PidStore;
 using ola::rdm::PidStoreLoader;
 using ola::rdm::RootPidStore;
@@ -53,9 +64,13 @@ class PidStoreTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(PidStoreTest);
   CPPUNIT_TEST(testPidDescriptor);
   CPPUNIT_TEST(testPidStore);
+  CPPUNIT_TEST(testPidIndex);
   CPPUNIT_TEST(testPidStoreLoad);
   CPPUNIT_TEST(testPidStoreFileLoad);
   CPPUNIT_TEST(testPidStoreDirectoryLoad);
+  CPPUNIT_TEST(testCompiledPidStore);
+  CPPUNIT_TEST(testCompiledPidStoreThreads);
+  CPPUNIT_TEST(testCompiledPidSources);
   CPPUNIT_TEST(testPidStoreLoadMissingFile);
   CPPUNIT_TEST(testPidStoreLoadDuplicateManufacturer);
   CPPUNIT_TEST(testPidStoreLoadDuplicateValue);
@@ -67,9 +82,13 @@ class PidStoreTest: public CppUnit::TestFixture {
   public:
     void testPidDescriptor();
     void testPidStore();
+    void testPidIndex();
     void testPidStoreLoad();
     void testPidStoreFileLoad();
     void testPidStoreDirectoryLoad();
+    void testCompiledPidStore();
+    void testCompiledPidStoreThreads();
+    void testCompiledPidSources();
     void testPidStoreLoadMissingFile();
     void testPidStoreLoadDuplicateManufacturer();
     void testPidStoreLoadDuplicateValue();
@@ -83,12 +102,46 @@ class PidStoreTest: public CppUnit::TestFixture {
     void tearDown() {}
 
   private:
+    void WriteFile(const string &file, const string &data);
+    string ReadFile(const string &file);
+    string DescriptorAsString(const Descriptor *descriptor);
+    void CheckStoresMatch(const PidStore *expected, const PidStore *actual);
 };
 
 
 CPPUNIT_TEST_SUITE_REGISTRATION(PidStoreTest);
 
 
+/*
+ * Looks up a list of PIDs, used to check that a compiled store can be shared
+ * between threads.
+ */
+class PidLookupThread: public ola::thread::Thread {
+  public:
+    PidLookupThread(const PidStore *store, const vector<uint16_t> &pids)
+        : m_store(store),
+          m_pids(pids) {
+    }
+
+    const vector<const PidDescriptor*> &Descriptors() const {
+      return m_descriptors;
+    }
+
+  protected:
+    void *Run() {
+      vector<uint16_t>::const_iterator iter = m_pids.begin();
+      for (; iter != m_pids.end(); ++iter)
+        m_descriptors.push_back(m_store->LookupPID(*iter));
+      return NULL;
+    }
+
+  private:
+    const PidStore *m_store;
+    const vector<uint16_t> m_pids;
+    vector<const PidDescriptor*> m_descriptors;
+};
+
+
 /*
  * Test that the PidDescriptor works.
  */
@@ -169,6 +222,12 @@ void PidStoreTest::testPidStore() {
   OLA_ASSERT_EQ(bar_pid, store.LookupPID("bar"));
   OLA_ASSERT_EQ(static_cast<const PidDescriptor*>(NULL),
                        store.LookupPID("baz"));
+  OLA_ASSERT_EQ(foo_pid, store.LookupPID("FOO"));
+  OLA_ASSERT_EQ(bar_pid, store.LookupPID("bAr"));
+  OLA_ASSERT_EQ(static_cast<const PidDescriptor*>(NULL),
+                       store.LookupPID("fo"));
+  OLA_ASSERT_EQ(static_cast<const PidDescriptor*>(NULL),
+                       store.LookupPID("fooo"));
 
   // check all pids;
   vector<const PidDescriptor*> all_pids;
@@ -179,6 +238,53 @@ void PidStoreTest::testPidStore() {
 }
 
 
+/**
+ * Check the PidIndex works once it's grown past the initial table size.
+ */
+void PidStoreTest::testPidIndex() {
+  vector<const PidDescriptor*> pids;
+  PidIndex index;
+  for (unsigned int i = 0; i < 500; i++) {
+    std::ostringstream str;
+    str << "PID_" << i;
+    // spread the values out like the manufacturer PIDs
+    uint16_t value = static_cast<uint16_t>(i < 250 ? i : 0x8000 + i * 3);
+    const PidDescriptor *pid = new PidDescriptor(
+      str.str(), value, NULL, NULL, NULL, NULL,
+      PidDescriptor::ROOT_DEVICE, PidDescriptor::ROOT_DEVICE);
+    pids.push_back(pid);
+    index.Add(pid);
+  }
+  OLA_ASSERT_EQ(500u, index.Size());
+
+  vector<const PidDescriptor*>::const_iterator iter = pids.begin();
+  for (; iter != pids.end(); ++iter) {
+    OLA_ASSERT_EQ(*iter, index.Lookup((*iter)->Value()));
+    OLA_ASSERT_EQ(*iter, index.Lookup((*iter)->Name()));
+    string lower_name = (*iter)->Name();
+    ola::ToLower(&lower_name);
+    OLA_ASSERT_EQ(*iter, index.Lookup(lower_name));
+  }
+  OLA_ASSERT_NULL(index.Lookup(static_cast<uint16_t>(250)));
+  OLA_ASSERT_NULL(index.Lookup(static_cast<uint16_t>(0xffff)));
+  OLA_ASSERT_NULL(index.Lookup("PID_500"));
+  OLA_ASSERT_NULL(index.Lookup(""));
+
+  // adding a PID with the same value replaces the existing one
+  const PidDescriptor *replacement = new PidDescriptor(
+      "PID_0", 0, NULL, NULL, NULL, NULL,
+      PidDescriptor::ROOT_DEVICE, PidDescriptor::ROOT_DEVICE);
+  index.Add(replacement);
+  OLA_ASSERT_EQ(500u, index.Size());
+  OLA_ASSERT_EQ(replacement, index.Lookup(static_cast<uint16_t>(0)));
+  OLA_ASSERT_EQ(replacement, index.Lookup("pid_0"));
+  delete replacement;
+
+  for (iter = pids.begin(); iter != pids.end(); ++iter)
+    delete *iter;
+}
+
+
 /**
  * Check we can load a PidStore from a string
  */
@@ -437,6 +543,166 @@ void PidStoreTest::testPidStoreDirectoryLoad() {
 }
 
 
+/**
+ * Check that a compiled store matches the one loaded from the text files.
+ */
+void PidStoreTest::testCompiledPidStore() {
+  const string compiled_file = "./PidStoreTest.compiled";
+  PidStoreLoader loader;
+
+  string compiled_data;
+  OLA_ASSERT_FALSE(loader.CompileDirectory("./testdata/missing_dir",
+                                           &compiled_data));
+  OLA_ASSERT_TRUE(loader.CompileDirectory("./testdata/pids",
+                                          &compiled_data));
+  WriteFile(compiled_file, compiled_data);
+
+  auto_ptr<const RootPidStore> expected_store(loader.LoadFromDirectory(
+      "./testdata/pids"));
+  auto_ptr<const RootPidStore> root_store(loader.LoadFromCompiledFile(
+      compiled_file));
+  OLA_ASSERT_NOT_NULL(expected_store.get());
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_EQ(expected_store->Version(), root_store->Version());
+
+  // lookups go through the RootPidStore, before any descriptors are built
+  const PidDescriptor *serial_number = root_store->GetDescriptor(
+      "serial_number", OPEN_LIGHTING_ESTA_CODE);
+  OLA_ASSERT_NOT_NULL(serial_number);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(32768), serial_number->Value());
+  OLA_ASSERT_EQ(serial_number,
+                root_store->GetDescriptor(32768, OPEN_LIGHTING_ESTA_CODE));
+  OLA_ASSERT_NULL(root_store->GetDescriptor("SERIAL_NUMBER"));
+  OLA_ASSERT_NULL(root_store->GetDescriptor("FOO_BAR"));
+  OLA_ASSERT_NULL(root_store->GetDescriptor(0x1234));
+  OLA_ASSERT_NULL(root_store->ManufacturerStore(0x1234));
+
+  CheckStoresMatch(expected_store->EstaStore(), root_store->EstaStore());
+  CheckStoresMatch(
+      expected_store->ManufacturerStore(OPEN_LIGHTING_ESTA_CODE),
+      root_store->ManufacturerStore(OPEN_LIGHTING_ESTA_CODE));
+
+  // a truncated file is rejected
+  WriteFile(compiled_file,
+            compiled_data.substr(0, compiled_data.size() - 1));
+  OLA_ASSERT_NULL(loader.LoadFromCompiledFile(compiled_file));
+  WriteFile(compiled_file, compiled_data.substr(0, 30));
+  OLA_ASSERT_NULL(loader.LoadFromCompiledFile(compiled_file));
+  unlink(compiled_file.c_str());
+  OLA_ASSERT_NULL(loader.LoadFromCompiledFile(compiled_file));
+}
+
+
+/**
+ * Check that concurrent lookups on a compiled store each build the descriptor
+ * once.
+ */
+void PidStoreTest::testCompiledPidStoreThreads() {
+  const string compiled_file = "./PidStoreThreadTest.compiled";
+  const unsigned int thread_count = 4;
+  PidStoreLoader loader;
+
+  string compiled_data;
+  OLA_ASSERT_TRUE(loader.CompileDirectory("./testdata/pids",
+                                          &compiled_data));
+  WriteFile(compiled_file, compiled_data);
+  auto_ptr<const RootPidStore> root_store(loader.LoadFromCompiledFile(
+      compiled_file));
+  unlink(compiled_file.c_str());
+  OLA_ASSERT_NOT_NULL(root_store.get());
+
+  auto_ptr<const RootPidStore> expected_store(loader.LoadFromDirectory(
+      "./testdata/pids"));
+  OLA_ASSERT_NOT_NULL(expected_store.get());
+  vector<const PidDescriptor*> expected_pids;
+  expected_store->EstaStore()->AllPids(&expected_pids);
+  vector<uint16_t> pids;
+  vector<const PidDescriptor*>::const_iterator pid_iter =
+      expected_pids.begin();
+  for (; pid_iter != expected_pids.end(); ++pid_iter)
+    pids.push_back((*pid_iter)->Value());
+
+  vector<PidLookupThread*> threads;
+  for (unsigned int i = 0; i < thread_count; i++) {
+    threads.push_back(new PidLookupThread(root_store->EstaStore(), pids));
+  }
+  vector<PidLookupThread*>::iterator iter = threads.begin();
+  for (; iter != threads.end(); ++iter)
+    OLA_ASSERT_TRUE((*iter)->Start());
+
+  for (iter = threads.begin(); iter != threads.end(); ++iter) {
+    OLA_ASSERT_TRUE((*iter)->Join());
+    const vector<const PidDescriptor*> &descriptors = (*iter)->Descriptors();
+    OLA_ASSERT_EQ(pids.size(), descriptors.size());
+    for (unsigned int i = 0; i < pids.size(); i++) {
+      OLA_ASSERT_NOT_NULL(descriptors[i]);
+      OLA_ASSERT_EQ(root_store->EstaStore()->LookupPID(pids[i]),
+                    descriptors[i]);
+    }
+    delete *iter;
+  }
+}
+
+
+/**
+ * Check that a compiled file is only used with the text files it was built
+ * from.
+ */
+void PidStoreTest::testCompiledPidSources() {
+  const string directory = "./PidStoreSourcesTest";
+  const string compiled_file = (
+      directory + "/" + PidStoreLoader::COMPILED_FILE_NAME);
+  vector<string> files;
+  files.push_back(directory + "/pids2.proto");
+  files.push_back(directory + "/pids1.proto");
+  mkdir(directory.c_str(), 0755);
+  WriteFile(files[0], ReadFile("./testdata/pids/pids2.proto"));
+  WriteFile(files[1], ReadFile("./testdata/pids/pids1.proto"));
+
+  PidStoreLoader loader;
+  string compiled_data;
+  OLA_ASSERT_TRUE(loader.CompileDirectory(directory, &compiled_data));
+  WriteFile(compiled_file, compiled_data);
+
+  auto_ptr<const CompiledPidFile> compiled_pids(
+      CompiledPidFile::Open(compiled_file, true));
+  OLA_ASSERT_NOT_NULL(compiled_pids.get());
+  const vector<CompiledPidFile::SourceFile> &sources =
+      compiled_pids->SourceFiles();
+  OLA_ASSERT_EQ(static_cast<size_t>(2), sources.size());
+  OLA_ASSERT_EQ(string("pids1.proto"), sources[0].name);
+  OLA_ASSERT_EQ(string("pids2.proto"), sources[1].name);
+  OLA_ASSERT_EQ(static_cast<uint32_t>(ReadFile(files[1]).size()),
+                sources[0].size);
+  OLA_ASSERT_TRUE(compiled_pids->SourcesMatch(files));
+
+  // the order of the files doesn't matter, but they must all be there
+  std::reverse(files.begin(), files.end());
+  OLA_ASSERT_TRUE(compiled_pids->SourcesMatch(files));
+  vector<string> missing_file(files.begin(), files.begin() + 1);
+  OLA_ASSERT_FALSE(compiled_pids->SourcesMatch(missing_file));
+
+  // an edit that doesn't change the size is still caught
+  string data = ReadFile(files[0]);
+  OLA_ASSERT_EQ('\n', data[data.size() - 1]);
+  data[data.size() - 1] = ' ';
+  WriteFile(files[0], data);
+  OLA_ASSERT_FALSE(compiled_pids->SourcesMatch(files));
+
+  // and the directory is loaded from the text files
+  auto_ptr<const RootPidStore> root_store(loader.LoadFromDirectory(
+      directory));
+  OLA_ASSERT_NOT_NULL(root_store.get());
+  OLA_ASSERT_NOT_NULL(root_store->GetDescriptor("proxied_devices"));
+
+  compiled_pids.reset();
+  unlink(compiled_file.c_str());
+  unlink(files[0].c_str());
+  unlink(files[1].c_str());
+  rmdir(directory.c_str());
+}
+
+
 /**
  * Check that loading a missing file fails.
  */
@@ -501,3 +767,68 @@ void PidStoreTest::testInconsistentData() {
       "./testdata/inconsistent_pid.proto");
   OLA_ASSERT_NULL(root_store);
 }
+
+
+void PidStoreTest::WriteFile(const string &file, const string &data) {
+  std::ofstream output(file.c_str(), std::ios::out | std::ios::binary);
+  output.write(data.data(), data.size());
+  output.close();
+  OLA_ASSERT_FALSE(output.fail());
+}
+
+
+string PidStoreTest::ReadFile(const string &file) {
+  std::ifstream input(file.c_str(), std::ios::in | std::ios::binary);
+  OLA_ASSERT_TRUE(input.is_open());
+  std::stringstream str;
+  str << input.rdbuf();
+  return str.str();
+}
+
+
+string PidStoreTest::DescriptorAsString(const Descriptor *descriptor) {
+  if (!descriptor)
+    return "<none>";
+  ola::messaging::SchemaPrinter printer(true, true);
+  descriptor->Accept(&printer);
+  return printer.AsString();
+}
+
+
+/**
+ * Check that two PidStores hold the same PIDs.
+ */
+void PidStoreTest::CheckStoresMatch(const PidStore *expected,
+                                    const PidStore *actual) {
+  OLA_ASSERT_NOT_NULL(expected);
+  OLA_ASSERT_NOT_NULL(actual);
+  OLA_ASSERT_EQ(expected->PidCount(), actual->PidCount());
+
+  vector<const PidDescriptor*> expected_pids;
+  expected->AllPids(&expected_pids);
+  vector<const PidDescriptor*>::const_iterator iter = expected_pids.begin();
+  for (; iter != expected_pids.end(); ++iter) {
+    const PidDescriptor *pid = actual->LookupPID((*iter)->Value());
+    OLA_ASSERT_NOT_NULL(pid);
+    OLA_ASSERT_EQ(pid, actual->LookupPID((*iter)->Name()));
+    OLA_ASSERT_EQ((*iter)->Name(), pid->Name());
+    OLA_ASSERT_EQ(DescriptorAsString((*iter)->GetRequest()),
+                  DescriptorAsString(pid->GetRequest()));
+    OLA_ASSERT_EQ(DescriptorAsString((*iter)->GetResponse()),
+                  DescriptorAsString(pid->GetResponse()));
+    OLA_ASSERT_EQ(DescriptorAsString((*iter)->SetRequest()),
+                  DescriptorAsString(pid->SetRequest()));
+    OLA_ASSERT_EQ(DescriptorAsString((*iter)->SetResponse()),
+                  DescriptorAsString(pid->SetResponse()));
+    for (uint16_t sub_device = 0; sub_device < 3; sub_device++) {
+      OLA_ASSERT_EQ((*iter)->IsGetValid(sub_device),
+                    pid->IsGetValid(sub_device));
+      OLA_ASSERT_EQ((*iter)->IsSetValid(sub_device),
+                    pid->IsSetValid(sub_device));
+    }
+  }
+
+  vector<const PidDescriptor*> actual_pids;
+  actual->AllPids(&actual_pids);
+  OLA_ASSERT_EQ(expected_pids.size(), actual_pids.size());
+}
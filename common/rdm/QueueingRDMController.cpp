@@ -19,6 +19,8 @@
  */
 
 #include <string.h>
+#include <algorithm>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -49,6 +51,9 @@ QueueingRDMController::QueueingRDMController(
     unsigned int max_queue_size)
   : m_controller(controller),
     m_max_queue_size(max_queue_size),
+    m_queue_size(0),
+    m_interactive_burst(0),
+    m_current_request(NULL),
     m_rdm_request_pending(false),
     m_active(true),
     m_response(NULL) {
@@ -63,12 +68,21 @@ QueueingRDMController::QueueingRDMController(
 QueueingRDMController::~QueueingRDMController() {
   // delete all outstanding requests
   std::vector<string> packets;
-  while (!m_pending_requests.empty()) {
-    outstanding_rdm_request outstanding_request = m_pending_requests.front();
-    if (outstanding_request.on_complete)
-      outstanding_request.on_complete->Run(RDM_FAILED_TO_SEND, NULL, packets);
-    delete outstanding_request.request;
-    m_pending_requests.pop();
+  if (m_current_request) {
+    RunCallbacks(m_current_request, RDM_FAILED_TO_SEND, NULL, packets);
+    delete m_current_request->request;
+    delete m_current_request;
+    m_current_request = NULL;
+  }
+
+  for (unsigned int i = 0; i <= BACKGROUND_PRIORITY; i++) {
+    RequestPriority priority = static_cast<RequestPriority>(i);
+    while (!m_priority_classes[i].uids.empty()) {
+      outstanding_rdm_request *outstanding_request = Dequeue(priority);
+      RunCallbacks(outstanding_request, RDM_FAILED_TO_SEND, NULL, packets);
+      delete outstanding_request->request;
+      delete outstanding_request;
+    }
   }
 
   if (m_response)
@@ -101,7 +115,25 @@ void QueueingRDMController::Resume() {
  */
 void QueueingRDMController::SendRDMRequest(const RDMRequest *request,
                                            RDMCallback *on_complete) {
-  if (m_pending_requests.size() >= m_max_queue_size) {
+  SendRDMRequest(request, on_complete, INTERACTIVE_PRIORITY);
+}
+
+
+/**
+ * Queue an RDM request for sending with the given priority. If an identical
+ * GET is already queued or in flight, the callback is attached to that
+ * request instead.
+ */
+void QueueingRDMController::SendRDMRequest(const RDMRequest *request,
+                                           RDMCallback *on_complete,
+                                           RequestPriority priority) {
+  if (request->CommandClass() == RDMCommand::GET_COMMAND &&
+      CoalesceRequest(request, on_complete, priority)) {
+    delete request;
+    return;
+  }
+
+  if (m_queue_size >= m_max_queue_size) {
     OLA_WARN << "RDM Queue is full, dropping request";
     if (on_complete) {
       std::vector<string> packets;
@@ -111,10 +143,10 @@ void QueueingRDMController::SendRDMRequest(const RDMRequest *request,
     return;
   }
 
-  outstanding_rdm_request outstanding_request;
-  outstanding_request.request = request;
-  outstanding_request.on_complete = on_complete;
-  m_pending_requests.push(outstanding_request);
+  outstanding_rdm_request *outstanding_request = new outstanding_rdm_request;
+  outstanding_request->request = request;
+  outstanding_request->callbacks.push_back(on_complete);
+  Enqueue(outstanding_request, priority);
   TakeNextAction();
 }
 
@@ -145,9 +177,10 @@ bool QueueingRDMController::CheckForBlockingCondition() {
  * If we're not paused, send the next request.
  */
 void QueueingRDMController::MaybeSendRDMRequest() {
-  if (m_pending_requests.empty())
+  if (!m_queue_size)
     return;
 
+  m_current_request = Dequeue(NextPriority());
   m_rdm_request_pending = true;
   DispatchNextRequest();
 }
@@ -157,12 +190,11 @@ void QueueingRDMController::MaybeSendRDMRequest() {
  * Send the next RDM request.
  */
 void QueueingRDMController::DispatchNextRequest() {
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
   // We have to make a copy here because we pass ownership of the request to
   // the underlying controller.
   // We need to have the original request because we use it if we receive an
   // ACK_OVERFLOW.
-  m_controller->SendRDMRequest(outstanding_request.request->Duplicate(),
+  m_controller->SendRDMRequest(m_current_request->request->Duplicate(),
                                m_callback);
 }
 
@@ -176,8 +208,8 @@ void QueueingRDMController::HandleRDMResponse(
     const std::vector<std::string> &packets) {
   m_rdm_request_pending = false;
 
-  if (m_pending_requests.empty()) {
-    OLA_FATAL << "Recieved a response but the queue was empty!";
+  if (!m_current_request) {
+    OLA_FATAL << "Recieved a response but no request was pending!";
     return;
   }
 
@@ -205,6 +237,7 @@ void QueueingRDMController::HandleRDMResponse(
     if (m_response) {
       if (original_type == ACK_OVERFLOW) {
         // send the same command again;
+        m_rdm_request_pending = true;
         DispatchNextRequest();
         return;
       }
@@ -217,17 +250,210 @@ void QueueingRDMController::HandleRDMResponse(
       delete m_response;
     m_response = NULL;
   }
-  outstanding_rdm_request outstanding_request = m_pending_requests.front();
-  if (outstanding_request.on_complete)
-    outstanding_request.on_complete->Run(status, m_response, m_packets);
-  m_packets.clear();
+  outstanding_rdm_request *outstanding_request = m_current_request;
+  m_current_request = NULL;
+  const RDMResponse *response_to_return = m_response;
   m_response = NULL;
-  delete outstanding_request.request;
-  m_pending_requests.pop();
+  vector<string> packets_to_return;
+  packets_to_return.swap(m_packets);
+
+  RunCallbacks(outstanding_request, status, response_to_return,
+               packets_to_return);
+  delete outstanding_request->request;
+  delete outstanding_request;
   TakeNextAction();
 }
 
 
+/**
+ * Attach a GET to an identical one that's already queued or in flight. If the
+ * matching request has a lower priority it's promoted. We don't coalesce if
+ * a SET to the same device is queued, since the caller expects the GET to
+ * see the result of the SET.
+ * @returns true if the request was coalesced, false otherwise.
+ */
+bool QueueingRDMController::CoalesceRequest(const RDMRequest *request,
+                                            RDMCallback *on_complete,
+                                            RequestPriority priority) {
+  outstanding_rdm_request *match = NULL;
+  RequestPriority match_priority = priority;
+
+  for (unsigned int i = 0; i <= BACKGROUND_PRIORITY; i++) {
+    std::map<UID, RequestQueue>::const_iterator iter =
+      m_priority_classes[i].queues.find(request->DestinationUID());
+    if (iter == m_priority_classes[i].queues.end())
+      continue;
+
+    RequestQueue::const_iterator request_iter = iter->second.begin();
+    for (; request_iter != iter->second.end(); ++request_iter) {
+      if ((*request_iter)->request->CommandClass() != RDMCommand::GET_COMMAND)
+        return false;
+      if (!match && IsSameGet((*request_iter)->request, request)) {
+        match = *request_iter;
+        match_priority = static_cast<RequestPriority>(i);
+      }
+    }
+  }
+
+  if (match) {
+    if (priority < match_priority) {
+      RemoveFromQueue(match, match_priority);
+      Enqueue(match, priority);
+    }
+  } else if (m_current_request &&
+             IsSameGet(m_current_request->request, request)) {
+    match = m_current_request;
+  } else {
+    return false;
+  }
+
+  OLA_DEBUG << "Coalescing GET for PID 0x" << std::hex << request->ParamId()
+            << " to " << request->DestinationUID();
+  match->callbacks.push_back(on_complete);
+  return true;
+}
+
+
+/**
+ * Add a request to the end of the queue for its destination.
+ */
+void QueueingRDMController::Enqueue(
+    outstanding_rdm_request *outstanding_request,
+    RequestPriority priority) {
+  PriorityClass &priority_class = m_priority_classes[priority];
+  const UID &uid = outstanding_request->request->DestinationUID();
+  RequestQueue &queue = priority_class.queues[uid];
+  if (queue.empty())
+    priority_class.uids.push_back(uid);
+  queue.push_back(outstanding_request);
+  m_queue_size++;
+}
+
+
+/**
+ * Remove the next request for the next UID in the round robin.
+ * @pre there is at least one request queued with this priority.
+ */
+QueueingRDMController::outstanding_rdm_request *QueueingRDMController::Dequeue(
+    RequestPriority priority) {
+  PriorityClass &priority_class = m_priority_classes[priority];
+  const UID uid = priority_class.uids.front();
+  priority_class.uids.pop_front();
+
+  std::map<UID, RequestQueue>::iterator iter = priority_class.queues.find(uid);
+  outstanding_rdm_request *outstanding_request = iter->second.front();
+  iter->second.pop_front();
+  if (iter->second.empty())
+    priority_class.queues.erase(iter);
+  else
+    priority_class.uids.push_back(uid);
+  m_queue_size--;
+  return outstanding_request;
+}
+
+
+/**
+ * Remove a particular request from the queue.
+ */
+void QueueingRDMController::RemoveFromQueue(
+    outstanding_rdm_request *outstanding_request,
+    RequestPriority priority) {
+  PriorityClass &priority_class = m_priority_classes[priority];
+  const UID uid = outstanding_request->request->DestinationUID();
+  std::map<UID, RequestQueue>::iterator iter = priority_class.queues.find(uid);
+  if (iter == priority_class.queues.end())
+    return;
+
+  RequestQueue::iterator request_iter = std::find(
+      iter->second.begin(), iter->second.end(), outstanding_request);
+  if (request_iter == iter->second.end())
+    return;
+
+  iter->second.erase(request_iter);
+  if (iter->second.empty()) {
+    priority_class.queues.erase(iter);
+    priority_class.uids.erase(std::find(priority_class.uids.begin(),
+                                        priority_class.uids.end(),
+                                        uid));
+  }
+  m_queue_size--;
+}
+
+
+/**
+ * Pick the priority of the next request to send. Interactive requests go
+ * first, but every MAX_INTERACTIVE_BURST requests we let a background request
+ * through so polling isn't starved.
+ * @pre at least one request is queued.
+ */
+QueueingRDMController::RequestPriority QueueingRDMController::NextPriority() {
+  bool have_interactive =
+    !m_priority_classes[INTERACTIVE_PRIORITY].uids.empty();
+  bool have_background =
+    !m_priority_classes[BACKGROUND_PRIORITY].uids.empty();
+
+  if (!have_background) {
+    m_interactive_burst = 0;
+    return INTERACTIVE_PRIORITY;
+  }
+
+  if (have_interactive && m_interactive_burst < MAX_INTERACTIVE_BURST) {
+    m_interactive_burst++;
+    return INTERACTIVE_PRIORITY;
+  }
+  m_interactive_burst = 0;
+  return BACKGROUND_PRIORITY;
+}
+
+
+/**
+ * Run all the callbacks for a request. Each callback takes ownership of the
+ * response, so all but the last caller get a copy.
+ */
+void QueueingRDMController::RunCallbacks(
+    outstanding_rdm_request *outstanding_request,
+    rdm_response_code status,
+    const RDMResponse *response,
+    const vector<string> &packets) {
+  vector<RDMCallback*> callbacks;
+  callbacks.swap(outstanding_request->callbacks);
+  callbacks.erase(std::remove(callbacks.begin(), callbacks.end(),
+                              static_cast<RDMCallback*>(NULL)),
+                  callbacks.end());
+
+  if (callbacks.empty()) {
+    delete response;
+    return;
+  }
+
+  vector<RDMCallback*>::iterator iter = callbacks.begin();
+  for (; iter != callbacks.end() - 1; ++iter)
+    (*iter)->Run(status, response ? response->Duplicate() : NULL, packets);
+  callbacks.back()->Run(status, response, packets);
+}
+
+
+/**
+ * Check if two requests are GETs for the same data from the same requester.
+ * The response is addressed to the source UID and carries the transaction
+ * number of the request, so GETs which differ in either can't share one.
+ */
+bool QueueingRDMController::IsSameGet(const RDMRequest *request1,
+                                      const RDMRequest *request2) {
+  return (request1->CommandClass() == RDMCommand::GET_COMMAND &&
+          request2->CommandClass() == RDMCommand::GET_COMMAND &&
+          request1->SourceUID() == request2->SourceUID() &&
+          request1->TransactionNumber() == request2->TransactionNumber() &&
+          request1->DestinationUID() == request2->DestinationUID() &&
+          request1->SubDevice() == request2->SubDevice() &&
+          request1->ParamId() == request2->ParamId() &&
+          request1->ParamDataSize() == request2->ParamDataSize() &&
+          (request1->ParamDataSize() == 0 ||
+           0 == memcmp(request1->ParamData(), request2->ParamData(),
+                       request1->ParamDataSize())));
+}
+
+
 
 /**
  * Constructor for the DiscoverableQueueingRDMController
@@ -54,6 +54,10 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testAckOverflows);
   CPPUNIT_TEST(testPauseAndResume);
   CPPUNIT_TEST(testQueueOverflow);
+  CPPUNIT_TEST(testPriority);
+  CPPUNIT_TEST(testFairness);
+  CPPUNIT_TEST(testCoalescing);
+  CPPUNIT_TEST(testCoalescingSources);
   CPPUNIT_TEST(testDiscovery);
   CPPUNIT_TEST(testMultipleDiscovery);
   CPPUNIT_TEST(testReentrantDiscovery);
@@ -68,6 +72,10 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
     void testAckOverflows();
     void testPauseAndResume();
     void testQueueOverflow();
+    void testPriority();
+    void testFairness();
+    void testCoalescing();
+    void testCoalescingSources();
     void testDiscovery();
     void testMultipleDiscovery();
     void testReentrantDiscovery();
@@ -91,9 +99,11 @@ class QueueingRDMControllerTest: public CppUnit::TestFixture {
 
   private:
     int m_discovery_complete_count;
+    unsigned int m_response_count;
 
     RDMRequest *NewGetRequest(const UID &source,
-                              const UID &destination);
+                              const UID &destination,
+                              uint16_t param_id = 296);
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(QueueingRDMControllerTest);
@@ -265,6 +275,7 @@ void MockRDMController::Verify() {
 void QueueingRDMControllerTest::setUp() {
   ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
   m_discovery_complete_count = 0;
+  m_response_count = 0;
 }
 
 
@@ -291,6 +302,7 @@ void QueueingRDMControllerTest::VerifyResponse(
 
   if (delete_response)
     delete response;
+  m_response_count++;
 }
 
 
@@ -324,7 +336,8 @@ void QueueingRDMControllerTest::ReentrantDiscovery(
  *
  */
 RDMRequest *QueueingRDMControllerTest::NewGetRequest(const UID &source,
-                                                     const UID &destination) {
+                                                     const UID &destination,
+                                                     uint16_t param_id) {
   return  new ola::rdm::RDMGetRequest(
       source,
       destination,
@@ -332,7 +345,7 @@ RDMRequest *QueueingRDMControllerTest::NewGetRequest(const UID &source,
       1,  // port id
       0,  // message count
       10,  // sub device
-      296,  // param id
+      param_id,  // param id
       NULL,  // data
       0);  // data length
 }
@@ -653,10 +666,11 @@ void QueueingRDMControllerTest::testPauseAndResume() {
           packets,
           false));
 
+  // use a different PID so the requests aren't coalesced
   packets[0] = "bar";
-  get_request = NewGetRequest(source, destination);
+  RDMRequest *get_request2 = NewGetRequest(source, destination, 297);
   controller.SendRDMRequest(
-      get_request,
+      get_request2,
       ola::NewSingleCallback(
           this,
           &QueueingRDMControllerTest::VerifyResponse,
@@ -670,7 +684,7 @@ void QueueingRDMControllerTest::testPauseAndResume() {
                                   ola::rdm::RDM_COMPLETED_OK,
                                   &expected_command,
                                   "foo");
-  mock_controller.AddExpectedCall(get_request,
+  mock_controller.AddExpectedCall(get_request2,
                                   ola::rdm::RDM_COMPLETED_OK,
                                   &expected_command,
                                   "bar");
@@ -719,6 +733,347 @@ void QueueingRDMControllerTest::testQueueOverflow() {
 }
 
 
+/*
+ * Check that interactive requests are sent before background ones.
+ */
+void QueueingRDMControllerTest::testPriority() {
+  UID source(1, 2);
+  UID destination1(3, 4);
+  UID destination2(5, 6);
+
+  MockRDMController mock_controller;
+  ola::rdm::QueueingRDMController controller(&mock_controller, 10);
+  controller.Pause();
+
+  vector<string> packets;
+  RDMRequest *background_request = NewGetRequest(source, destination1);
+  controller.SendRDMRequest(
+      background_request,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          packets,
+          false),
+      ola::rdm::QueueingRDMController::BACKGROUND_PRIORITY);
+
+  RDMRequest *interactive_request = NewGetRequest(source, destination2);
+  controller.SendRDMRequest(
+      interactive_request,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          packets,
+          false));
+  OLA_ASSERT_EQ(2u, controller.QueueSize());
+
+  mock_controller.AddExpectedCall(interactive_request,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  mock_controller.AddExpectedCall(background_request,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  controller.Resume();
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(2u, m_response_count);
+  OLA_ASSERT_EQ(0u, controller.QueueSize());
+
+  // an interactive GET that matches a background one promotes it
+  controller.Pause();
+  background_request = NewGetRequest(source, destination1);
+  controller.SendRDMRequest(
+      background_request,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          packets,
+          false),
+      ola::rdm::QueueingRDMController::BACKGROUND_PRIORITY);
+
+  RDMRequest *background_request2 = NewGetRequest(source, destination2);
+  controller.SendRDMRequest(
+      background_request2,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          packets,
+          false),
+      ola::rdm::QueueingRDMController::BACKGROUND_PRIORITY);
+
+  controller.SendRDMRequest(
+      NewGetRequest(source, destination2),
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          packets,
+          false));
+  OLA_ASSERT_EQ(2u, controller.QueueSize());
+
+  mock_controller.AddExpectedCall(background_request2,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  mock_controller.AddExpectedCall(background_request,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  controller.Resume();
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(5u, m_response_count);
+}
+
+
+/*
+ * Check that requests are sent round robin between responders.
+ */
+void QueueingRDMControllerTest::testFairness() {
+  UID source(1, 2);
+  UID destination1(3, 4);
+  UID destination2(5, 6);
+
+  MockRDMController mock_controller;
+  ola::rdm::QueueingRDMController controller(&mock_controller, 10);
+  controller.Pause();
+
+  vector<string> packets;
+  RDMRequest *requests[4];
+  requests[0] = NewGetRequest(source, destination1, 296);
+  requests[1] = NewGetRequest(source, destination1, 297);
+  requests[2] = NewGetRequest(source, destination1, 298);
+  requests[3] = NewGetRequest(source, destination2, 296);
+
+  for (unsigned int i = 0; i < 4; i++) {
+    controller.SendRDMRequest(
+        requests[i],
+        ola::NewSingleCallback(
+            this,
+            &QueueingRDMControllerTest::VerifyResponse,
+            ola::rdm::RDM_TIMEOUT,
+            static_cast<const RDMResponse*>(NULL),
+            packets,
+            false));
+  }
+
+  // destination2 shouldn't have to wait for all of destination1's requests
+  const unsigned int expected_order[] = {0, 3, 1, 2};
+  for (unsigned int i = 0; i < 4; i++) {
+    mock_controller.AddExpectedCall(requests[expected_order[i]],
+                                    ola::rdm::RDM_TIMEOUT,
+                                    NULL,
+                                    "");
+  }
+  controller.Resume();
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(4u, m_response_count);
+}
+
+
+/*
+ * Check that identical GETs are coalesced.
+ */
+void QueueingRDMControllerTest::testCoalescing() {
+  UID source(1, 2);
+  UID destination(3, 4);
+  uint8_t data[] = {0xaa, 0xbb};
+
+  MockRDMController mock_controller;
+  ola::rdm::QueueingRDMController controller(&mock_controller, 10);
+  controller.Pause();
+
+  RDMGetResponse expected_response(destination,
+                                   source,
+                                   0,  // transaction #
+                                   RDM_ACK,
+                                   0,  // message count
+                                   10,  // sub device
+                                   296,  // param id
+                                   data,  // data
+                                   sizeof(data));  // data length
+
+  vector<string> packets;
+  packets.push_back("foo");
+  RDMRequest *get_request = NewGetRequest(source, destination);
+  controller.SendRDMRequest(
+      get_request,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_COMPLETED_OK,
+          static_cast<const RDMResponse*>(&expected_response),
+          packets,
+          true));
+  controller.SendRDMRequest(
+      NewGetRequest(source, destination),
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_COMPLETED_OK,
+          static_cast<const RDMResponse*>(&expected_response),
+          packets,
+          true));
+  OLA_ASSERT_EQ(1u, controller.QueueSize());
+
+  // a GET after a SET to the same device isn't coalesced
+  vector<string> empty_packets;
+  RDMRequest *set_request = new ola::rdm::RDMSetRequest(
+      source,
+      destination,
+      0,  // transaction #
+      1,  // port id
+      0,  // message count
+      10,  // sub device
+      296,  // param id
+      NULL,  // data
+      0);  // data length
+  controller.SendRDMRequest(
+      set_request,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          empty_packets,
+          false));
+  RDMRequest *get_request2 = NewGetRequest(source, destination);
+  controller.SendRDMRequest(
+      get_request2,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_TIMEOUT,
+          static_cast<const RDMResponse*>(NULL),
+          empty_packets,
+          false));
+  OLA_ASSERT_EQ(3u, controller.QueueSize());
+
+  mock_controller.AddExpectedCall(get_request,
+                                  ola::rdm::RDM_COMPLETED_OK,
+                                  expected_response.Duplicate(),
+                                  "foo");
+  mock_controller.AddExpectedCall(set_request,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  mock_controller.AddExpectedCall(get_request2,
+                                  ola::rdm::RDM_TIMEOUT,
+                                  NULL,
+                                  "");
+  controller.Resume();
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(4u, m_response_count);
+
+  // a GET that matches the one in flight gets the same response
+  m_response_count = 0;
+  get_request = NewGetRequest(source, destination);
+  mock_controller.AddExpectedCall(get_request,
+                                  ola::rdm::RDM_COMPLETED_OK,
+                                  NULL,
+                                  "",
+                                  false);
+  for (unsigned int i = 0; i < 2; i++) {
+    controller.SendRDMRequest(
+        i ? NewGetRequest(source, destination) : get_request,
+        ola::NewSingleCallback(
+            this,
+            &QueueingRDMControllerTest::VerifyResponse,
+            ola::rdm::RDM_COMPLETED_OK,
+            static_cast<const RDMResponse*>(&expected_response),
+            packets,
+            true));
+  }
+  OLA_ASSERT_EQ(0u, controller.QueueSize());
+  OLA_ASSERT_EQ(0u, m_response_count);
+
+  mock_controller.RunRDMCallback(ola::rdm::RDM_COMPLETED_OK,
+                                 expected_response.Duplicate(),
+                                 "foo");
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(2u, m_response_count);
+}
+
+
+/**
+ * Check that GETs from different sources aren't coalesced, and that each
+ * requester gets the response addressed to it.
+ */
+void QueueingRDMControllerTest::testCoalescingSources() {
+  UID source1(1, 2);
+  UID source2(1, 3);
+  UID destination(3, 4);
+  uint8_t data[] = {0xaa, 0xbb};
+
+  MockRDMController mock_controller;
+  ola::rdm::QueueingRDMController controller(&mock_controller, 10);
+  controller.Pause();
+
+  RDMGetResponse expected_response1(destination,
+                                    source1,
+                                    0,  // transaction #
+                                    RDM_ACK,
+                                    0,  // message count
+                                    10,  // sub device
+                                    296,  // param id
+                                    data,  // data
+                                    sizeof(data));  // data length
+  RDMGetResponse expected_response2(destination,
+                                    source2,
+                                    0,  // transaction #
+                                    RDM_ACK,
+                                    0,  // message count
+                                    10,  // sub device
+                                    296,  // param id
+                                    data,  // data
+                                    sizeof(data));  // data length
+
+  vector<string> packets;
+  packets.push_back("foo");
+  RDMRequest *get_request1 = NewGetRequest(source1, destination);
+  RDMRequest *get_request2 = NewGetRequest(source2, destination);
+  controller.SendRDMRequest(
+      get_request1,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_COMPLETED_OK,
+          static_cast<const RDMResponse*>(&expected_response1),
+          packets,
+          true));
+  controller.SendRDMRequest(
+      get_request2,
+      ola::NewSingleCallback(
+          this,
+          &QueueingRDMControllerTest::VerifyResponse,
+          ola::rdm::RDM_COMPLETED_OK,
+          static_cast<const RDMResponse*>(&expected_response2),
+          packets,
+          true));
+  OLA_ASSERT_EQ(2u, controller.QueueSize());
+
+  mock_controller.AddExpectedCall(get_request1,
+                                  ola::rdm::RDM_COMPLETED_OK,
+                                  expected_response1.Duplicate(),
+                                  "foo");
+  mock_controller.AddExpectedCall(get_request2,
+                                  ola::rdm::RDM_COMPLETED_OK,
+                                  expected_response2.Duplicate(),
+                                  "foo");
+  controller.Resume();
+  mock_controller.Verify();
+  OLA_ASSERT_EQ(2u, m_response_count);
+}
+
+
 /**
  * Verify discovery works
  */
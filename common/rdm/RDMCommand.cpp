@@ -30,6 +30,7 @@
 #include "ola/Logging.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMCommandView.h"
 #include "ola/rdm/UID.h"
 
 namespace ola {
@@ -120,21 +121,15 @@ void RDMCommand::Write(ola::io::OutputStream *stream) const {
   message.param_id[1] = m_param_id & 0xff;
   message.param_data_length = m_data_length;
 
-  unsigned int checksum_value = START_CODE;
-
   // checksum & write out the header
-  const uint8_t *ptr = reinterpret_cast<uint8_t*>(&message);
-  for (unsigned int i = 0; i != sizeof(message); i++)
-    checksum_value += ptr[i];
-
+  uint16_t checksum = RDMChecksum(reinterpret_cast<uint8_t*>(&message),
+                                  sizeof(message));
   stream->Write(reinterpret_cast<uint8_t*>(&message), sizeof(message));
 
   // checksum & write out the data
-  for (unsigned int i = 0; i != m_data_length; i++)
-    checksum_value += m_data[i];
+  checksum = RDMChecksum(m_data, m_data_length, checksum);
   stream->Write(m_data, m_data_length);
 
-  uint16_t checksum = static_cast<uint16_t>(checksum_value);
   *stream << ola::network::HostToNetwork(checksum);
 }
 
@@ -256,10 +251,7 @@ rdm_response_code RDMCommand::VerifyData(
  */
 uint16_t RDMCommand::CalculateChecksum(const uint8_t *data,
                                        unsigned int packet_length) {
-  unsigned int checksum_value = START_CODE;
-  for (unsigned int i = 0; i < packet_length; i++)
-    checksum_value += data[i];
-  return static_cast<uint16_t>(checksum_value);
+  return RDMChecksum(data, packet_length);
 }
 
 
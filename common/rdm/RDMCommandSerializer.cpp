@@ -23,6 +23,7 @@
 #include "ola/io/BigEndianStream.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMCommandSerializer.h"
+#include "ola/rdm/RDMCommandView.h"
 #include "ola/rdm/RDMPacket.h"
 
 namespace ola {
@@ -134,9 +135,7 @@ bool RDMCommandSerializer::PackWithParams(const RDMCommand &command,
   memcpy(buffer + sizeof(RDMCommandHeader), command.ParamData(),
          command.ParamDataSize());
 
-  uint16_t checksum = START_CODE;
-  for (unsigned int i = 0; i < packet_length - CHECKSUM_LENGTH; i++)
-    checksum += buffer[i];
+  uint16_t checksum = RDMChecksum(buffer, packet_length - CHECKSUM_LENGTH);
   buffer[packet_length - CHECKSUM_LENGTH] = checksum >> 8;
   buffer[packet_length - CHECKSUM_LENGTH + 1] = checksum & 0xff;
 
@@ -168,13 +167,10 @@ bool RDMCommandSerializer::WriteToStack(const RDMCommand &command,
   PopulateHeader(&header, command, packet_length, source, transaction_number,
                  port_id);
 
-  uint16_t checksum = START_CODE;
-  const uint8_t *ptr = reinterpret_cast<uint8_t*>(&header);
-  for (unsigned int i = 0; i < sizeof(header); i++)
-    checksum += ptr[i];
-  ptr = command.ParamData();
-  for (unsigned int i = 0; i < command.ParamDataSize(); i++)
-    checksum += ptr[i];
+  uint16_t checksum = RDMChecksum(reinterpret_cast<uint8_t*>(&header),
+                                  sizeof(header));
+  checksum = RDMChecksum(command.ParamData(), command.ParamDataSize(),
+                         checksum);
 
   // now perform the write in reverse order (since it's a stack).
   ola::io::BigEndianOutputStream output(stack);
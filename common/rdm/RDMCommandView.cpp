@@ -0,0 +1,248 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMCommandView.cpp
+ * A read only view of an RDM message held in a buffer.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ * @file RDMCommandView.cpp
+ * @}
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMCommandView.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ */
+
+/*
+ * This sums four bytes at a time, using two 16 bit lanes in a 32 bit word.
+ * Each lane gains at most 2 * 0xff per word so it can't overflow until
+ * WORDS_PER_BLOCK words have been added, at which point the lanes are folded
+ * into the result.
+ */
+uint16_t RDMChecksum(const uint8_t *data, unsigned int length,
+                     uint16_t checksum) {
+  static const uint32_t LOW_BYTES = 0x00ff00ff;
+  static const unsigned int WORDS_PER_BLOCK = 128;
+
+  unsigned int sum = checksum;
+  while (length >= sizeof(uint32_t)) {
+    unsigned int words = length / sizeof(uint32_t);
+    if (words > WORDS_PER_BLOCK)
+      words = WORDS_PER_BLOCK;
+
+    uint32_t lanes = 0;
+    for (unsigned int i = 0; i < words; i++) {
+      // the data may not be aligned, memcpy compiles to a single load
+      uint32_t word;
+      memcpy(&word, data, sizeof(word));
+      lanes += (word & LOW_BYTES) + ((word >> 8) & LOW_BYTES);
+      data += sizeof(word);
+    }
+    sum += (lanes & 0xffff) + (lanes >> 16);
+    length -= words * sizeof(uint32_t);
+  }
+
+  for (; length; length--)
+    sum += *data++;
+  return static_cast<uint16_t>(sum);
+}
+
+
+/**
+ * @brief Point the view at a new RDM message and validate it.
+ * @param data the raw RDM data, starting from the sub-start-code
+ * @param length the length of the data
+ * @returns RDM_COMPLETED_OK if the data contains a valid RDM message,
+ *   otherwise the reason the message is invalid. The view is only usable if
+ *   RDM_COMPLETED_OK is returned.
+ *
+ * Unlike RDMCommand::Inflate(), invalid messages aren't logged. On a sniffer
+ * or a busy network, corrupt messages are expected and it's up to the caller
+ * to decide if they should be reported.
+ */
+rdm_response_code RDMCommandView::Init(const uint8_t *data,
+                                       unsigned int length) {
+  m_data = data;
+  m_length = length;
+  m_header = reinterpret_cast<const RDMCommandHeader*>(data);
+  rdm_response_code code = Verify();
+  if (code != RDM_COMPLETED_OK)
+    m_header = NULL;
+  return code;
+}
+
+
+/**
+ * @brief Returns the type of message this is.
+ */
+rdm_message_type RDMCommandView::MessageType() const {
+  switch (CommandClass()) {
+    case RDMCommand::GET_COMMAND:
+    case RDMCommand::SET_COMMAND:
+    case RDMCommand::DISCOVER_COMMAND:
+      return RDM_REQUEST;
+    case RDMCommand::GET_COMMAND_RESPONSE:
+    case RDMCommand::SET_COMMAND_RESPONSE:
+    case RDMCommand::DISCOVER_COMMAND_RESPONSE:
+      return RDM_RESPONSE;
+    default:
+      return RDM_INVALID;
+  }
+}
+
+
+/**
+ * @brief Create a new RDMCommand from the message.
+ * @returns a new RDMRequest or RDMResponse, ownership is transferred to the
+ *   caller. NULL is returned if the view isn't valid.
+ */
+RDMCommand *RDMCommandView::ToCommand() const {
+  if (!IsValid())
+    return NULL;
+
+  if (MessageType() == RDM_REQUEST)
+    return ToRequest();
+  return ToResponse();
+}
+
+
+/**
+ * @brief Create a new RDMRequest from the message.
+ * @returns a new RDMRequest, ownership is transferred to the caller. NULL is
+ *   returned if the view isn't valid or the message isn't a request.
+ */
+RDMRequest *RDMCommandView::ToRequest() const {
+  if (!IsValid())
+    return NULL;
+
+  switch (CommandClass()) {
+    case RDMCommand::GET_COMMAND:
+      return new RDMGetRequest(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    case RDMCommand::SET_COMMAND:
+      return new RDMSetRequest(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    case RDMCommand::DISCOVER_COMMAND:
+      return new RDMDiscoveryRequest(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    default:
+      return NULL;
+  }
+}
+
+
+/**
+ * @brief Create a new RDMResponse from the message.
+ * @returns a new RDMResponse, ownership is transferred to the caller. NULL is
+ *   returned if the view isn't valid, the message isn't a response or the
+ *   response type is invalid.
+ */
+RDMResponse *RDMCommandView::ToResponse() const {
+  if (!IsValid())
+    return NULL;
+
+  if (PortIdResponseType() > ACK_OVERFLOW)
+    return NULL;
+
+  switch (CommandClass()) {
+    case RDMCommand::GET_COMMAND_RESPONSE:
+      return new RDMGetResponse(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    case RDMCommand::SET_COMMAND_RESPONSE:
+      return new RDMSetResponse(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    case RDMCommand::DISCOVER_COMMAND_RESPONSE:
+      return new RDMDiscoveryResponse(
+          SourceUID(), DestinationUID(), TransactionNumber(),
+          PortIdResponseType(), MessageCount(), SubDevice(), ParamId(),
+          ParamData(), ParamDataSize());
+    default:
+      return NULL;
+  }
+}
+
+
+/*
+ * Check the message is valid. This is the same set of checks that
+ * RDMCommand::VerifyData() performs, with the addition of checking the
+ * command class and that the message length covers the header and the
+ * parameter data.
+ */
+rdm_response_code RDMCommandView::Verify() const {
+  if (!m_data)
+    return RDM_INVALID_RESPONSE;
+
+  if (m_length < sizeof(RDMCommandHeader) + CHECKSUM_LENGTH)
+    return RDM_PACKET_TOO_SHORT;
+
+  if (m_header->sub_start_code != SUB_START_CODE)
+    return RDM_WRONG_SUB_START_CODE;
+
+  // the message length includes the start code but not the checksum
+  const unsigned int message_length = m_header->message_length;
+  if (message_length < sizeof(RDMCommandHeader) + 1 ||
+      m_length < message_length + 1)
+    return RDM_PACKET_LENGTH_MISMATCH;
+
+  uint16_t checksum = RDMChecksum(m_data, message_length - 1);
+  uint16_t actual_checksum = (m_data[message_length - 1] << 8) +
+    m_data[message_length];
+  if (actual_checksum != checksum)
+    return RDM_CHECKSUM_INCORRECT;
+
+  if (m_header->param_data_length >
+      message_length - 1 - sizeof(RDMCommandHeader))
+    return RDM_PARAM_LENGTH_MISMATCH;
+
+  switch (m_header->command_class) {
+    case RDMCommand::GET_COMMAND:
+    case RDMCommand::GET_COMMAND_RESPONSE:
+    case RDMCommand::SET_COMMAND:
+    case RDMCommand::SET_COMMAND_RESPONSE:
+    case RDMCommand::DISCOVER_COMMAND:
+    case RDMCommand::DISCOVER_COMMAND_RESPONSE:
+      return RDM_COMPLETED_OK;
+    default:
+      return RDM_INVALID_COMMAND_CLASS;
+  }
+}
+/**@}*/
+}  // namespace rdm
+}  // namespace ola
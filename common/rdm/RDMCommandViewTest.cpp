@@ -0,0 +1,276 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMCommandViewTest.cpp
+ * Test fixture for the RDMCommandView class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <string.h>
+#include <memory>
+
+#include "ola/Logging.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMCommandSerializer.h"
+#include "ola/rdm/RDMCommandView.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::rdm::RDMChecksum;
+using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandSerializer;
+using ola::rdm::RDMCommandView;
+using ola::rdm::RDMDiscoveryRequest;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMGetResponse;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using ola::testing::ASSERT_DATA_EQUALS;
+using std::auto_ptr;
+
+class RDMCommandViewTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMCommandViewTest);
+  CPPUNIT_TEST(testChecksum);
+  CPPUNIT_TEST(testRequest);
+  CPPUNIT_TEST(testResponse);
+  CPPUNIT_TEST(testInvalidMessages);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp() {
+      ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+    }
+
+    void testChecksum();
+    void testRequest();
+    void testResponse();
+    void testInvalidMessages();
+
+  private:
+    static const uint8_t PARAM_DATA[];
+
+    void UpdateChecksum(uint8_t *data, unsigned int length);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMCommandViewTest);
+
+const uint8_t RDMCommandViewTest::PARAM_DATA[] = {0xa5, 0xa5, 0x5a, 0x5a, 1};
+
+
+/*
+ * Check RDMChecksum matches a simple byte by byte sum.
+ */
+void RDMCommandViewTest::testChecksum() {
+  uint8_t data[1200];
+  for (unsigned int i = 0; i < sizeof(data); i++)
+    data[i] = i % 3 ? 0xff : i & 0xff;
+
+  OLA_ASSERT_EQ(static_cast<uint16_t>(RDMCommand::START_CODE),
+                RDMChecksum(NULL, 0));
+
+  // Cover the unaligned starts, the trailing bytes and the block boundaries.
+  for (unsigned int offset = 0; offset < 4; offset++) {
+    for (unsigned int length = 0; length < sizeof(data) - offset; length++) {
+      uint16_t expected = 0x1234;
+      for (unsigned int i = 0; i < length; i++)
+        expected += data[offset + i];
+      OLA_ASSERT_EQ(expected, RDMChecksum(data + offset, length, 0x1234));
+    }
+  }
+}
+
+
+/*
+ * Check a view of a request.
+ */
+void RDMCommandViewTest::testRequest() {
+  UID source(1, 2);
+  UID destination(3, 4);
+  RDMSetRequest request(source, destination,
+                        5,  // transaction #
+                        1,  // port id
+                        0,  // message count
+                        10,  // sub device
+                        0x8001,  // param id
+                        PARAM_DATA, sizeof(PARAM_DATA));
+
+  // offset the message by one byte to check unaligned access
+  uint8_t buffer[64];
+  unsigned int size = sizeof(buffer) - 1;
+  OLA_ASSERT(RDMCommandSerializer::Pack(request, buffer + 1, &size));
+
+  RDMCommandView view;
+  OLA_ASSERT_FALSE(view.IsValid());
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Init(buffer + 1, size));
+  OLA_ASSERT(view.IsValid());
+  OLA_ASSERT_EQ(static_cast<const uint8_t*>(buffer + 1), view.Data());
+  OLA_ASSERT_EQ(size, view.Size());
+  OLA_ASSERT_EQ(source, view.SourceUID());
+  OLA_ASSERT_EQ(destination, view.DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(5), view.TransactionNumber());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), view.PortIdResponseType());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), view.MessageCount());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(10), view.SubDevice());
+  OLA_ASSERT_EQ(RDMCommand::SET_COMMAND, view.CommandClass());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8001), view.ParamId());
+  OLA_ASSERT_EQ(ola::rdm::RDM_REQUEST, view.MessageType());
+  ASSERT_DATA_EQUALS(__LINE__, PARAM_DATA, sizeof(PARAM_DATA),
+                     view.ParamData(), view.ParamDataSize());
+
+  // the param data isn't copied
+  const uint8_t *param_data = buffer + 1 + sizeof(ola::rdm::RDMCommandHeader);
+  OLA_ASSERT_EQ(param_data, view.ParamData());
+
+  auto_ptr<RDMRequest> new_request(view.ToRequest());
+  OLA_ASSERT_NOT_NULL(new_request.get());
+  OLA_ASSERT(request == *new_request);
+
+  auto_ptr<RDMCommand> command(view.ToCommand());
+  OLA_ASSERT_NOT_NULL(command.get());
+  OLA_ASSERT(request == *command);
+
+  OLA_ASSERT_NULL(view.ToResponse());
+
+  // discovery requests
+  RDMDiscoveryRequest discovery_request(source, destination, 5, 1, 0, 0,
+                                        ola::rdm::PID_DISC_MUTE, NULL, 0);
+  size = sizeof(buffer);
+  OLA_ASSERT(RDMCommandSerializer::Pack(discovery_request, buffer, &size));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Init(buffer, size));
+  OLA_ASSERT_EQ(RDMCommand::DISCOVER_COMMAND, view.CommandClass());
+  OLA_ASSERT_EQ(0u, view.ParamDataSize());
+  new_request.reset(view.ToRequest());
+  OLA_ASSERT_NOT_NULL(new_request.get());
+  OLA_ASSERT(discovery_request == *new_request);
+}
+
+
+/*
+ * Check a view of a response.
+ */
+void RDMCommandViewTest::testResponse() {
+  UID source(3, 4);
+  UID destination(1, 2);
+  RDMGetResponse response(source, destination,
+                          5,  // transaction #
+                          ola::rdm::RDM_ACK,
+                          2,  // message count
+                          0,  // sub device
+                          ola::rdm::PID_DEVICE_LABEL,
+                          PARAM_DATA, sizeof(PARAM_DATA));
+
+  uint8_t buffer[64];
+  unsigned int size = sizeof(buffer);
+  OLA_ASSERT(RDMCommandSerializer::Pack(response, buffer, &size));
+
+  // trailing data after the checksum is ignored
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Init(buffer, size + 4));
+  OLA_ASSERT_EQ(source, view.SourceUID());
+  OLA_ASSERT_EQ(destination, view.DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), view.MessageCount());
+  OLA_ASSERT_EQ(RDMCommand::GET_COMMAND_RESPONSE, view.CommandClass());
+  OLA_ASSERT_EQ(ola::rdm::RDM_RESPONSE, view.MessageType());
+
+  auto_ptr<RDMResponse> new_response(view.ToResponse());
+  OLA_ASSERT_NOT_NULL(new_response.get());
+  OLA_ASSERT(response == *new_response);
+  OLA_ASSERT_NULL(view.ToRequest());
+
+  // an invalid response type can't be converted
+  buffer[15] = ola::rdm::ACK_OVERFLOW + 1;
+  UpdateChecksum(buffer, size);
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Init(buffer, size));
+  OLA_ASSERT_NULL(view.ToResponse());
+  OLA_ASSERT_NULL(view.ToCommand());
+}
+
+
+/*
+ * Check that invalid messages are rejected.
+ */
+void RDMCommandViewTest::testInvalidMessages() {
+  RDMGetRequest request(UID(1, 2), UID(3, 4), 0, 1, 0, 0,
+                        ola::rdm::PID_DEVICE_INFO, NULL, 0);
+  uint8_t buffer[64];
+  unsigned int size = sizeof(buffer);
+  OLA_ASSERT(RDMCommandSerializer::Pack(request, buffer, &size));
+
+  RDMCommandView view;
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_RESPONSE, view.Init(NULL, 0));
+  OLA_ASSERT_FALSE(view.IsValid());
+  OLA_ASSERT_NULL(view.ToCommand());
+
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_TOO_SHORT, view.Init(buffer, size - 1));
+  OLA_ASSERT_FALSE(view.IsValid());
+
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, view.Init(buffer, size));
+  OLA_ASSERT(view.IsValid());
+
+  uint8_t bad_buffer[64];
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[0] = 2;
+  OLA_ASSERT_EQ(ola::rdm::RDM_WRONG_SUB_START_CODE,
+                view.Init(bad_buffer, size));
+  OLA_ASSERT_FALSE(view.IsValid());
+
+  // a message length that doesn't cover the header
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[1] = 0;
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_LENGTH_MISMATCH,
+                view.Init(bad_buffer, size));
+
+  // a message length longer than the data
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[1]++;
+  OLA_ASSERT_EQ(ola::rdm::RDM_PACKET_LENGTH_MISMATCH,
+                view.Init(bad_buffer, size));
+
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[size - 1]++;
+  OLA_ASSERT_EQ(ola::rdm::RDM_CHECKSUM_INCORRECT,
+                view.Init(bad_buffer, size));
+
+  // param data length larger than the message
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[22] = 1;
+  UpdateChecksum(bad_buffer, size);
+  OLA_ASSERT_EQ(ola::rdm::RDM_PARAM_LENGTH_MISMATCH,
+                view.Init(bad_buffer, size));
+
+  memcpy(bad_buffer, buffer, size);
+  bad_buffer[19] = 0x40;
+  UpdateChecksum(bad_buffer, size);
+  OLA_ASSERT_EQ(ola::rdm::RDM_INVALID_COMMAND_CLASS,
+                view.Init(bad_buffer, size));
+  OLA_ASSERT_FALSE(view.IsValid());
+}
+
+
+void RDMCommandViewTest::UpdateChecksum(uint8_t *data, unsigned int length) {
+  unsigned int checksum = RDMCommand::START_CODE;
+  for (unsigned int i = 0 ; i < length - 2; i++)
+    checksum += data[i];
+
+  data[length - 2] = checksum >> 8;
+  data[length - 1] = checksum & 0xff;
+}
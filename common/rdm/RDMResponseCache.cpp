@@ -0,0 +1,273 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMResponseCache.cpp
+ * Caches the responses to GETs for PIDs that rarely change.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ola/Logging.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMResponseCache.h"
+
+namespace ola {
+namespace rdm {
+
+using std::string;
+using std::vector;
+
+
+/**
+ * Build a key from a request.
+ */
+RDMResponseCache::Key::Key(const RDMRequest &request)
+    : m_uid(request.DestinationUID()),
+      m_sub_device(request.SubDevice()),
+      m_param_id(request.ParamId()),
+      m_param_data(reinterpret_cast<const char*>(request.ParamData()),
+                   request.ParamDataSize()) {
+}
+
+
+/**
+ * Keys are ordered by UID first, so all the entries for a UID are adjacent.
+ */
+bool RDMResponseCache::Key::operator<(const Key &other) const {
+  if (m_uid != other.m_uid)
+    return m_uid < other.m_uid;
+  if (m_sub_device != other.m_sub_device)
+    return m_sub_device < other.m_sub_device;
+  if (m_param_id != other.m_param_id)
+    return m_param_id < other.m_param_id;
+  return m_param_data < other.m_param_data;
+}
+
+
+RDMResponseCache::RDMResponseCache(const Clock *clock,
+                                   unsigned int max_entries)
+    : m_clock(clock),
+      m_max_entries(max_entries),
+      m_global_generation(0),
+      m_last_generation(0),
+      m_hits(0),
+      m_misses(0) {
+}
+
+
+RDMResponseCache::~RDMResponseCache() {
+  InvalidateAll();
+}
+
+
+/**
+ * Check if the response to a request can be cached.
+ * @returns true if this is a GET for a cacheable PID to a single device.
+ */
+bool RDMResponseCache::IsCacheable(const RDMRequest &request) const {
+  return (request.CommandClass() == RDMCommand::GET_COMMAND &&
+          !request.DestinationUID().IsBroadcast() &&
+          TimeToLive(request.ParamId()) != 0);
+}
+
+
+/**
+ * Lookup a response.
+ * @param request the request to answer.
+ * @param packets a vector which is populated with the raw packets that made
+ *   up the response. These are as received, so they still carry the
+ *   destination and transaction number of the original request.
+ * @returns a copy of the cached response, addressed to the source of the
+ *   request, which the caller owns, or NULL if there was no valid entry.
+ */
+const RDMResponse *RDMResponseCache::Lookup(const RDMRequest &request,
+                                            vector<string> *packets) {
+  EntryMap::iterator iter = m_entries.find(Key(request));
+  if (iter == m_entries.end()) {
+    m_misses++;
+    return NULL;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  if (iter->second.expiry < now) {
+    delete iter->second.response;
+    m_entries.erase(iter);
+    m_misses++;
+    return NULL;
+  }
+
+  m_hits++;
+  packets->insert(packets->end(), iter->second.packets.begin(),
+                  iter->second.packets.end());
+  const RDMResponse *response = iter->second.response;
+  return new RDMResponse(response->SourceUID(),
+                         request.SourceUID(),
+                         request.TransactionNumber(),
+                         response->ResponseType(),
+                         response->MessageCount(),
+                         response->SubDevice(),
+                         response->CommandClass(),
+                         response->ParamId(),
+                         response->ParamData(),
+                         response->ParamDataSize());
+}
+
+
+/**
+ * Get the current generation for a UID. This changes each time the entries
+ * for the UID are invalidated.
+ */
+unsigned int RDMResponseCache::Generation(const UID &uid) const {
+  std::map<UID, unsigned int>::const_iterator iter = m_generations.find(uid);
+  return iter == m_generations.end() ? m_global_generation : iter->second;
+}
+
+
+/**
+ * Add a response to the cache. Only ACKs are stored.
+ * @param key the key for the request
+ * @param generation the generation of the UID when the request was sent.
+ * @param response the response to store, this is copied.
+ * @param packets the raw packets that made up the response.
+ */
+void RDMResponseCache::Add(const Key &key,
+                           unsigned int generation,
+                           const RDMResponse &response,
+                           const vector<string> &packets) {
+  if (response.CommandClass() != RDMCommand::GET_COMMAND_RESPONSE ||
+      response.ResponseType() != RDM_ACK)
+    return;
+
+  // the device may have changed since the request was sent
+  if (generation != Generation(key.m_uid))
+    return;
+
+  EntryMap::iterator iter = m_entries.find(key);
+  if (iter == m_entries.end()) {
+    if (m_entries.size() >= m_max_entries)
+      RemoveExpiredEntries();
+    if (m_entries.size() >= m_max_entries) {
+      OLA_DEBUG << "RDM response cache is full";
+      return;
+    }
+    CacheEntry entry;
+    entry.response = NULL;
+    iter = m_entries.insert(std::make_pair(key, entry)).first;
+  }
+
+  CacheEntry &entry = iter->second;
+  delete entry.response;
+  entry.response = response.Duplicate();
+  entry.packets = packets;
+  m_clock->CurrentTime(&entry.expiry);
+  entry.expiry += TimeInterval(TimeToLive(key.m_param_id), 0);
+}
+
+
+/**
+ * Remove all entries for a UID.
+ */
+void RDMResponseCache::Invalidate(const UID &uid) {
+  // Generations are never reused, so a UID can fall back to the global
+  // generation once the map is cleared. That drops the in-flight GETs to
+  // every UID, but stops the map growing as devices come and go.
+  if (m_generations.size() >= m_max_entries) {
+    m_global_generation = ++m_last_generation;
+    m_generations.clear();
+  }
+  m_generations[uid] = ++m_last_generation;
+
+  EntryMap::iterator iter = m_entries.begin();
+  while (iter != m_entries.end()) {
+    if (iter->first.m_uid == uid) {
+      delete iter->second.response;
+      m_entries.erase(iter++);
+    } else if (uid < iter->first.m_uid) {
+      break;
+    } else {
+      ++iter;
+    }
+  }
+}
+
+
+/**
+ * Remove all entries.
+ */
+void RDMResponseCache::InvalidateAll() {
+  m_global_generation = ++m_last_generation;
+  m_generations.clear();
+
+  EntryMap::iterator iter = m_entries.begin();
+  for (; iter != m_entries.end(); ++iter)
+    delete iter->second.response;
+  m_entries.clear();
+}
+
+
+/**
+ * Remove the entries that have expired.
+ */
+void RDMResponseCache::RemoveExpiredEntries() {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+
+  EntryMap::iterator iter = m_entries.begin();
+  while (iter != m_entries.end()) {
+    if (iter->second.expiry < now) {
+      delete iter->second.response;
+      m_entries.erase(iter++);
+    } else {
+      ++iter;
+    }
+  }
+}
+
+
+/**
+ * Return the number of seconds to cache the response for a PID, or 0 if it
+ * shouldn't be cached.
+ */
+unsigned int RDMResponseCache::TimeToLive(uint16_t param_id) {
+  switch (param_id) {
+    case PID_BOOT_SOFTWARE_VERSION_LABEL:
+    case PID_DEVICE_MODEL_DESCRIPTION:
+    case PID_DMX_PERSONALITY_DESCRIPTION:
+    case PID_LANGUAGE_CAPABILITIES:
+    case PID_MANUFACTURER_LABEL:
+    case PID_PARAMETER_DESCRIPTION:
+    case PID_PRODUCT_DETAIL_ID_LIST:
+    case PID_SELF_TEST_DESCRIPTION:
+    case PID_SENSOR_DEFINITION:
+    case PID_SOFTWARE_VERSION_LABEL:
+    case PID_STATUS_ID_DESCRIPTION:
+    case PID_SUPPORTED_PARAMETERS:
+      return STATIC_TTL;
+    case PID_DEFAULT_SLOT_VALUE:
+    case PID_SLOT_DESCRIPTION:
+    case PID_SLOT_INFO:
+      return PERSONALITY_TTL;
+    case PID_DEVICE_INFO:
+    case PID_DEVICE_LABEL:
+      return DYNAMIC_TTL;
+    default:
+      return 0;
+  }
+}
+}  // namespace rdm
+}  // namespace ola
@@ -0,0 +1,308 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMResponseCacheTest.cpp
+ * Test fixture for the RDMResponseCache
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ola/Clock.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMResponseCache.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::MockClock;
+using ola::rdm::RDMGetRequest;
+using ola::rdm::RDMGetResponse;
+using ola::rdm::RDMResponse;
+using ola::rdm::RDMResponseCache;
+using ola::rdm::RDMSetRequest;
+using ola::rdm::UID;
+using std::auto_ptr;
+using std::string;
+using std::vector;
+
+class RDMResponseCacheTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMResponseCacheTest);
+  CPPUNIT_TEST(testIsCacheable);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testExpiry);
+  CPPUNIT_TEST(testInvalidation);
+  CPPUNIT_TEST(testMaxEntries);
+  CPPUNIT_TEST(testReaddressing);
+  CPPUNIT_TEST(testGenerationLimit);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    RDMResponseCacheTest()
+        : m_source(1, 2),
+          m_destination(3, 4) {
+    }
+
+    void testIsCacheable();
+    void testLookup();
+    void testExpiry();
+    void testInvalidation();
+    void testMaxEntries();
+    void testReaddressing();
+    void testGenerationLimit();
+
+  private:
+    UID m_source;
+    UID m_destination;
+    MockClock m_clock;
+
+    RDMGetRequest *NewGetRequest(const UID &destination,
+                                 uint16_t param_id,
+                                 const uint8_t *data = NULL,
+                                 unsigned int length = 0) {
+      return new RDMGetRequest(m_source, destination, 0, 1, 0, 0, param_id,
+                               data, length);
+    }
+
+    RDMGetResponse *NewGetResponse(const UID &source,
+                                   uint16_t param_id,
+                                   uint8_t response_type = ola::rdm::RDM_ACK) {
+      const uint8_t data[] = "foo";
+      return new RDMGetResponse(source, m_source, 0, response_type, 0, 0,
+                                param_id, data, sizeof(data));
+    }
+
+    void AddResponse(RDMResponseCache *cache,
+                     const UID &uid,
+                     uint16_t param_id,
+                     unsigned int generation) {
+      auto_ptr<RDMGetRequest> request(NewGetRequest(uid, param_id));
+      auto_ptr<RDMGetResponse> response(NewGetResponse(uid, param_id));
+      vector<string> packets;
+      cache->Add(RDMResponseCache::Key(*request), generation, *response,
+                 packets);
+    }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMResponseCacheTest);
+
+
+/*
+ * Check which requests are cacheable.
+ */
+void RDMResponseCacheTest::testIsCacheable() {
+  RDMResponseCache cache(&m_clock);
+
+  auto_ptr<RDMGetRequest> request(
+      NewGetRequest(m_destination, ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_TRUE(cache.IsCacheable(*request));
+  request.reset(
+      NewGetRequest(m_destination, ola::rdm::PID_SUPPORTED_PARAMETERS));
+  OLA_ASSERT_TRUE(cache.IsCacheable(*request));
+  request.reset(NewGetRequest(m_destination, ola::rdm::PID_SENSOR_VALUE));
+  OLA_ASSERT_FALSE(cache.IsCacheable(*request));
+  request.reset(NewGetRequest(UID::AllDevices(), ola::rdm::PID_DEVICE_INFO));
+  OLA_ASSERT_FALSE(cache.IsCacheable(*request));
+
+  RDMSetRequest set_request(m_source, m_destination, 0, 1, 0, 0,
+                            ola::rdm::PID_DEVICE_LABEL, NULL, 0);
+  OLA_ASSERT_FALSE(cache.IsCacheable(set_request));
+}
+
+
+/*
+ * Check that lookups return the stored response.
+ */
+void RDMResponseCacheTest::testLookup() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMGetRequest> request(
+      NewGetRequest(m_destination, ola::rdm::PID_MANUFACTURER_LABEL));
+  RDMResponseCache::Key key(*request);
+
+  vector<string> packets;
+  OLA_ASSERT_NULL(cache.Lookup(*request, &packets));
+  OLA_ASSERT_EQ(0u, cache.Hits());
+  OLA_ASSERT_EQ(1u, cache.Misses());
+
+  auto_ptr<RDMGetResponse> response(
+      NewGetResponse(m_destination, ola::rdm::PID_MANUFACTURER_LABEL));
+  vector<string> response_packets;
+  response_packets.push_back("foo");
+  cache.Add(key, cache.Generation(m_destination), *response,
+            response_packets);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  auto_ptr<const RDMResponse> cached_response(cache.Lookup(*request, &packets));
+  OLA_ASSERT_NOT_NULL(cached_response.get());
+  OLA_ASSERT_TRUE(*response == *cached_response);
+  OLA_ASSERT_VECTOR_EQ(response_packets, packets);
+  OLA_ASSERT_EQ(1u, cache.Hits());
+  OLA_ASSERT_EQ(1u, cache.Misses());
+
+  // different param data is a different key
+  const uint8_t data[] = {1};
+  request.reset(NewGetRequest(m_destination, ola::rdm::PID_MANUFACTURER_LABEL,
+                              data, sizeof(data)));
+  packets.clear();
+  OLA_ASSERT_NULL(cache.Lookup(*request, &packets));
+
+  // NACKs aren't stored
+  request.reset(
+      NewGetRequest(m_destination, ola::rdm::PID_DEVICE_MODEL_DESCRIPTION));
+  response.reset(NewGetResponse(m_destination,
+                                ola::rdm::PID_DEVICE_MODEL_DESCRIPTION,
+                                ola::rdm::RDM_NACK_REASON));
+  cache.Add(RDMResponseCache::Key(*request), cache.Generation(m_destination),
+            *response, response_packets);
+  OLA_ASSERT_EQ(1u, cache.Size());
+}
+
+
+/*
+ * Check that entries expire.
+ */
+void RDMResponseCacheTest::testExpiry() {
+  RDMResponseCache cache(&m_clock);
+  auto_ptr<RDMGetRequest> request(
+      NewGetRequest(m_destination, ola::rdm::PID_DEVICE_INFO));
+  AddResponse(&cache, m_destination, ola::rdm::PID_DEVICE_INFO,
+              cache.Generation(m_destination));
+
+  vector<string> packets;
+  m_clock.AdvanceTime(4, 0);
+  auto_ptr<const RDMResponse> response(cache.Lookup(*request, &packets));
+  OLA_ASSERT_NOT_NULL(response.get());
+
+  m_clock.AdvanceTime(2, 0);
+  OLA_ASSERT_NULL(cache.Lookup(*request, &packets));
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check that invalidation removes entries and drops in-flight responses.
+ */
+void RDMResponseCacheTest::testInvalidation() {
+  RDMResponseCache cache(&m_clock);
+  UID other_uid(3, 5);
+  auto_ptr<RDMGetRequest> request(
+      NewGetRequest(m_destination, ola::rdm::PID_DEVICE_LABEL));
+  auto_ptr<RDMGetRequest> other_request(
+      NewGetRequest(other_uid, ola::rdm::PID_DEVICE_LABEL));
+
+  AddResponse(&cache, m_destination, ola::rdm::PID_DEVICE_LABEL,
+              cache.Generation(m_destination));
+  AddResponse(&cache, other_uid, ola::rdm::PID_DEVICE_LABEL,
+              cache.Generation(other_uid));
+  OLA_ASSERT_EQ(2u, cache.Size());
+
+  vector<string> packets;
+  cache.Invalidate(m_destination);
+  OLA_ASSERT_EQ(1u, cache.Size());
+  OLA_ASSERT_NULL(cache.Lookup(*request, &packets));
+  auto_ptr<const RDMResponse> response(cache.Lookup(*other_request, &packets));
+  OLA_ASSERT_NOT_NULL(response.get());
+
+  // a response to a GET sent before the invalidation is dropped
+  unsigned int generation = cache.Generation(m_destination);
+  cache.Invalidate(m_destination);
+  AddResponse(&cache, m_destination, ola::rdm::PID_DEVICE_LABEL, generation);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  generation = cache.Generation(other_uid);
+  cache.InvalidateAll();
+  OLA_ASSERT_EQ(0u, cache.Size());
+  AddResponse(&cache, other_uid, ola::rdm::PID_DEVICE_LABEL, generation);
+  OLA_ASSERT_EQ(0u, cache.Size());
+}
+
+
+/*
+ * Check the cache doesn't grow past the limit.
+ */
+void RDMResponseCacheTest::testMaxEntries() {
+  RDMResponseCache cache(&m_clock, 2);
+
+  for (uint32_t i = 0; i < 3; i++) {
+    UID uid(1, i);
+    AddResponse(&cache, uid, ola::rdm::PID_DEVICE_INFO, cache.Generation(uid));
+  }
+  OLA_ASSERT_EQ(2u, cache.Size());
+
+  // once the entries expire there is room again
+  m_clock.AdvanceTime(10, 0);
+  UID uid(1, 4);
+  AddResponse(&cache, uid, ola::rdm::PID_DEVICE_INFO, cache.Generation(uid));
+  OLA_ASSERT_EQ(1u, cache.Size());
+}
+
+
+/*
+ * Check that a cached response is addressed to the requester.
+ */
+void RDMResponseCacheTest::testReaddressing() {
+  RDMResponseCache cache(&m_clock);
+  AddResponse(&cache, m_destination, ola::rdm::PID_DEVICE_INFO,
+              cache.Generation(m_destination));
+
+  UID other_source(5, 6);
+  RDMGetRequest request(other_source, m_destination, 42, 1, 0, 0,
+                        ola::rdm::PID_DEVICE_INFO, NULL, 0);
+  vector<string> packets;
+  auto_ptr<const RDMResponse> response(cache.Lookup(request, &packets));
+  OLA_ASSERT_NOT_NULL(response.get());
+  OLA_ASSERT_EQ(m_destination, response->SourceUID());
+  OLA_ASSERT_EQ(other_source, response->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(42), response->TransactionNumber());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DEVICE_INFO),
+                response->ParamId());
+  OLA_ASSERT_EQ(4u, response->ParamDataSize());
+}
+
+
+/*
+ * Check the per-UID generations don't grow without bound.
+ */
+void RDMResponseCacheTest::testGenerationLimit() {
+  RDMResponseCache cache(&m_clock, 2);
+
+  UID uid1(1, 1);
+  unsigned int generation = cache.Generation(uid1);
+  for (uint32_t i = 0; i < 10; i++)
+    cache.Invalidate(UID(2, i));
+  OLA_ASSERT_TRUE(cache.GenerationCount() <= 2);
+
+  // a GET sent before the generations were trimmed is still dropped
+  AddResponse(&cache, uid1, ola::rdm::PID_DEVICE_INFO, generation);
+  OLA_ASSERT_EQ(0u, cache.Size());
+
+  generation = cache.Generation(uid1);
+  AddResponse(&cache, uid1, ola::rdm::PID_DEVICE_INFO, generation);
+  OLA_ASSERT_EQ(1u, cache.Size());
+
+  // an invalidated UID doesn't match a generation taken before the trim
+  UID uid2(2, 9);
+  generation = cache.Generation(uid2);
+  cache.Invalidate(uid2);
+  cache.Invalidate(UID(3, 1));
+  cache.Invalidate(UID(3, 2));
+  OLA_ASSERT_TRUE(cache.GenerationCount() <= 2);
+  AddResponse(&cache, uid2, ola::rdm::PID_DEVICE_INFO, generation);
+  OLA_ASSERT_EQ(1u, cache.Size());
+}
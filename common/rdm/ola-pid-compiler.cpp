@@ -0,0 +1,76 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * ola-pid-compiler.cpp
+ * Compiles the PID definitions into the form used by CompiledPidFile.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ola/Logging.h>
+#include <ola/base/Flags.h>
+#include <ola/base/SysExits.h>
+
+#include <fstream>
+#include <string>
+
+#include "common/rdm/PidStoreLoader.h"
+
+using ola::rdm::PidStoreLoader;
+using std::string;
+
+DEFINE_s_string(pid_location, p, "",
+                "The directory to read PID definitions from.");
+DEFINE_s_string(output, o, "", "The file to write the compiled PIDs to.");
+
+
+int main(int argc, char *argv[]) {
+  ola::SetHelpString(
+      "[options]",
+      "Compile the PID definitions in a directory, for faster loading.");
+  ola::ParseFlags(&argc, argv);
+  ola::InitLoggingFromFlags();
+
+  if (FLAGS_pid_location.str().empty() || FLAGS_output.str().empty()) {
+    ola::DisplayUsage();
+    exit(ola::EXIT_USAGE);
+  }
+
+  PidStoreLoader loader;
+  string compiled_data;
+  if (!loader.CompileDirectory(FLAGS_pid_location.str(), &compiled_data)) {
+    OLA_FATAL << "Failed to compile " << FLAGS_pid_location.str();
+    exit(ola::EXIT_DATAERR);
+  }
+
+  // Write to a temporary file first so an interrupted build doesn't leave a
+  // truncated file behind.
+  const string output = FLAGS_output.str();
+  const string temp_output = output + ".tmp";
+  std::ofstream output_file(temp_output.c_str(),
+                            std::ios::out | std::ios::binary);
+  output_file.write(compiled_data.data(), compiled_data.size());
+  output_file.close();
+  if (output_file.fail() || rename(temp_output.c_str(), output.c_str())) {
+    OLA_FATAL << "Failed to write " << output << ": " << strerror(errno);
+    unlink(temp_output.c_str());
+    exit(ola::EXIT_CANTCREAT);
+  }
+  return ola::EXIT_OK;
+}
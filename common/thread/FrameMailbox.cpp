@@ -0,0 +1,137 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * FrameMailbox.cpp
+ * Hands the latest DMX frame from one thread to another.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <algorithm>
+#include "ola/thread/FrameMailbox.h"
+
+namespace ola {
+namespace thread {
+
+/**
+ * Create a new, empty mailbox.
+ */
+FrameMailbox::FrameMailbox()
+    : m_back(0),
+      m_middle(1),
+      m_front(2),
+      m_fresh(false),
+      m_closed(false) {
+}
+
+
+/**
+ * Publish a frame, replacing any frame the consumer hasn't picked up yet.
+ * @param buffer the frame to publish, this is deep copied.
+ */
+void FrameMailbox::Put(const DmxBuffer &buffer) {
+  // avoid the reference counting, the consumer is in another thread
+  m_frames[m_back].Set(buffer);
+  {
+    MutexLocker locker(&m_mutex);
+    std::swap(m_back, m_middle);
+    m_fresh = true;
+  }
+  m_condition.Signal();
+}
+
+
+/**
+ * Close the mailbox, this wakes up the consumer.
+ */
+void FrameMailbox::Close() {
+  {
+    MutexLocker locker(&m_mutex);
+    m_closed = true;
+  }
+  m_condition.Signal();
+}
+
+
+/**
+ * Block until a new frame arrives or the mailbox is closed.
+ * @returns NEW_FRAME if Frame() was updated, or CLOSED.
+ */
+FrameMailbox::WaitResult FrameMailbox::Wait() {
+  MutexLocker locker(&m_mutex);
+  while (!m_fresh && !m_closed)
+    m_condition.Wait(&m_mutex);
+
+  if (m_closed)
+    return CLOSED;
+  TakeFrame();
+  return NEW_FRAME;
+}
+
+
+/**
+ * Block until a new frame arrives, the mailbox is closed or the wake up time
+ * is reached.
+ * @param wake_up_time the time to give up waiting.
+ * @returns NEW_FRAME if Frame() was updated, TIMED_OUT or CLOSED.
+ */
+FrameMailbox::WaitResult FrameMailbox::TimedWait(
+    const TimeStamp &wake_up_time) {
+  MutexLocker locker(&m_mutex);
+  while (!m_fresh && !m_closed) {
+    if (!m_condition.TimedWait(&m_mutex, wake_up_time))
+      break;
+  }
+
+  if (m_closed)
+    return CLOSED;
+  if (!m_fresh)
+    return TIMED_OUT;
+  TakeFrame();
+  return NEW_FRAME;
+}
+
+
+/**
+ * Pick up a new frame if there is one, without blocking.
+ * @returns true if Frame() was updated.
+ */
+bool FrameMailbox::Poll() {
+  MutexLocker locker(&m_mutex);
+  if (!m_fresh)
+    return false;
+  TakeFrame();
+  return true;
+}
+
+
+/**
+ * Check if the mailbox has been closed.
+ */
+bool FrameMailbox::IsClosed() {
+  MutexLocker locker(&m_mutex);
+  return m_closed;
+}
+
+
+/**
+ * Swap the most recent frame into the consumer's slot. Must be called with
+ * the lock held.
+ */
+void FrameMailbox::TakeFrame() {
+  std::swap(m_front, m_middle);
+  m_fresh = false;
+}
+}  // namespace thread
+}  // namespace ola
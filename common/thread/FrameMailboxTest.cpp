@@ -0,0 +1,211 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * FrameMailboxTest.cpp
+ * Test fixture for the FrameMailbox class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <unistd.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/thread/FrameMailbox.h"
+#include "ola/thread/Thread.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::thread::FrameMailbox;
+using ola::thread::Mutex;
+using ola::thread::MutexLocker;
+using ola::thread::Thread;
+
+class FrameMailboxTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(FrameMailboxTest);
+  CPPUNIT_TEST(testPoll);
+  CPPUNIT_TEST(testLatestFrameWins);
+  CPPUNIT_TEST(testTimedWait);
+  CPPUNIT_TEST(testClose);
+  CPPUNIT_TEST(testCrossThread);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void testPoll();
+    void testLatestFrameWins();
+    void testTimedWait();
+    void testClose();
+    void testCrossThread();
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FrameMailboxTest);
+
+
+/*
+ * Check that Poll() picks up a frame exactly once.
+ */
+void FrameMailboxTest::testPoll() {
+  FrameMailbox mailbox;
+  OLA_ASSERT_FALSE(mailbox.Poll());
+  OLA_ASSERT_EQ(0u, mailbox.Frame().Size());
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  mailbox.Put(buffer);
+  OLA_ASSERT_TRUE(mailbox.Poll());
+  OLA_ASSERT_EQ(buffer, mailbox.Frame());
+  OLA_ASSERT_FALSE(mailbox.Poll());
+
+  // the consumer's frame remains valid until the next frame is taken
+  OLA_ASSERT_EQ(buffer, mailbox.Frame());
+}
+
+
+/*
+ * Check that frames the consumer didn't pick up are dropped.
+ */
+void FrameMailboxTest::testLatestFrameWins() {
+  FrameMailbox mailbox;
+  DmxBuffer buffer1, buffer2, buffer3;
+  buffer1.SetFromString("1");
+  buffer2.SetFromString("2,2");
+  buffer3.SetFromString("3,3,3");
+
+  mailbox.Put(buffer1);
+  mailbox.Put(buffer2);
+  OLA_ASSERT_EQ(FrameMailbox::NEW_FRAME, mailbox.Wait());
+  OLA_ASSERT_EQ(buffer2, mailbox.Frame());
+
+  // changing the producer's copy doesn't change the published frame
+  mailbox.Put(buffer3);
+  buffer3.SetFromString("4");
+  OLA_ASSERT_TRUE(mailbox.Poll());
+  DmxBuffer expected;
+  expected.SetFromString("3,3,3");
+  OLA_ASSERT_EQ(expected, mailbox.Frame());
+}
+
+
+/*
+ * Check that TimedWait() returns once the wake up time passes.
+ */
+void FrameMailboxTest::testTimedWait() {
+  FrameMailbox mailbox;
+  Clock clock;
+  TimeStamp now, wake_up;
+  clock.CurrentTime(&now);
+  wake_up = now + TimeInterval(0, 20000);
+
+  OLA_ASSERT_EQ(FrameMailbox::TIMED_OUT, mailbox.TimedWait(wake_up));
+  clock.CurrentTime(&now);
+  OLA_ASSERT_TRUE(now >= wake_up);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("255");
+  mailbox.Put(buffer);
+  OLA_ASSERT_EQ(FrameMailbox::NEW_FRAME, mailbox.TimedWait(wake_up));
+  OLA_ASSERT_EQ(buffer, mailbox.Frame());
+}
+
+
+/*
+ * Check that Close() ends any waits.
+ */
+void FrameMailboxTest::testClose() {
+  FrameMailbox mailbox;
+  OLA_ASSERT_FALSE(mailbox.IsClosed());
+  mailbox.Close();
+  OLA_ASSERT_TRUE(mailbox.IsClosed());
+  OLA_ASSERT_EQ(FrameMailbox::CLOSED, mailbox.Wait());
+
+  TimeStamp wake_up;
+  Clock clock;
+  clock.CurrentTime(&wake_up);
+  wake_up += TimeInterval(10, 0);
+  OLA_ASSERT_EQ(FrameMailbox::CLOSED, mailbox.TimedWait(wake_up));
+}
+
+
+class ConsumerThread: public Thread {
+  public:
+    explicit ConsumerThread(FrameMailbox *mailbox)
+        : m_mailbox(mailbox),
+          m_frames(0) {
+    }
+
+    void *Run() {
+      while (m_mailbox->Wait() == FrameMailbox::NEW_FRAME) {
+        MutexLocker locker(&m_mutex);
+        m_frames++;
+        m_last_frame.Set(m_mailbox->Frame());
+      }
+      return NULL;
+    }
+
+    bool HasSeen(const DmxBuffer &buffer) {
+      MutexLocker locker(&m_mutex);
+      return m_last_frame == buffer;
+    }
+
+    unsigned int Frames() {
+      MutexLocker locker(&m_mutex);
+      return m_frames;
+    }
+
+  private:
+    FrameMailbox *m_mailbox;
+    unsigned int m_frames;
+    DmxBuffer m_last_frame;
+    Mutex m_mutex;
+};
+
+
+/*
+ * Check that a consumer thread always ends up with the most recent frame.
+ */
+void FrameMailboxTest::testCrossThread() {
+  FrameMailbox mailbox;
+  ConsumerThread thread(&mailbox);
+  OLA_ASSERT_TRUE(thread.Start());
+
+  DmxBuffer buffer;
+  const unsigned int FRAME_COUNT = 1000;
+  for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+    buffer.SetChannel(0, i & 0xff);
+    buffer.SetChannel(511, i >> 8);
+    mailbox.Put(buffer);
+  }
+
+  // wait for the consumer to catch up
+  Clock clock;
+  TimeStamp now, give_up;
+  clock.CurrentTime(&now);
+  give_up = now + TimeInterval(5, 0);
+  while (!thread.HasSeen(buffer) && now < give_up) {
+    usleep(1000);
+    clock.CurrentTime(&now);
+  }
+  mailbox.Close();
+  OLA_ASSERT_TRUE(thread.Join());
+
+  OLA_ASSERT_TRUE(thread.HasSeen(buffer));
+  OLA_ASSERT_TRUE(thread.Frames() > 0);
+  OLA_ASSERT_TRUE(thread.Frames() <= FRAME_COUNT);
+}
@@ -153,6 +153,29 @@ typedef SingleUseCallback3<void, const Result&,
                            const RDMMetadata&,
                            const ola::rdm::RDMResponse*> RDMCallback;
 
+/**
+ * @brief Called as each GET sent with OlaClient::RDMBatchGet() completes.
+ * The responses may arrive in a different order to the GETs.
+ * @param index the index of the GET in the vector passed to RDMBatchGet().
+ * @param metadata the metadata for the response, including the
+ * rdm_response_code.
+ * @param response the RDM Response, or NULL if no response was received.
+ * The response is deleted once the callback returns.
+ */
+typedef Callback3<void, unsigned int, const RDMMetadata&,
+                  const ola::rdm::RDMResponse*> RDMBatchResponseCallback;
+
+/**
+ * @brief Called when a responder returns a queued message or status messages
+ * to the server's status polling.
+ * @param universe the universe the responder is on.
+ * @param response the queued message or STATUS_MESSAGES response. The
+ * response is deleted once the callback returns.
+ * @sa OlaClient::RegisterForRDMStatus()
+ */
+typedef Callback2<void, unsigned int, const ola::rdm::RDMResponse*>
+    RDMStatusCallback;
+
 
 }  // namespace client
 }  // namespace ola
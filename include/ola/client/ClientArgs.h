@@ -23,6 +23,9 @@
 
 #include <ola/client/CallbackTypes.h>
 #include <ola/dmx/SourcePriorities.h>
+#include <ola/rdm/UID.h>
+
+#include <string>
 
 /**
  * @file
@@ -108,6 +111,41 @@ struct SendRDMArgs {
 
   explicit SendRDMArgs(RDMCallback *callback) : callback(callback) {}
 };
+
+/**
+ * @brief A GET sent with OlaClient::RDMBatchGet().
+ */
+struct RDMGetParams {
+  /**
+   * @brief The UID to send the GET to.
+   */
+  ola::rdm::UID uid;
+  /**
+   * @brief The sub device index.
+   */
+  uint16_t sub_device;
+  /**
+   * @brief The PID to address.
+   */
+  uint16_t pid;
+  /**
+   * @brief The param data, defaults to empty.
+   */
+  std::string data;
+
+  /**
+   * @brief Create a new RDMGetParams object
+   */
+  RDMGetParams(const ola::rdm::UID &uid,
+               uint16_t sub_device,
+               uint16_t pid,
+               const std::string &data = "")
+      : uid(uid),
+        sub_device(sub_device),
+        pid(pid),
+        data(data) {
+  }
+};
 }  // namespace client
 }  // namespace ola
 #endif  // INCLUDE_OLA_CLIENT_CLIENTARGS_H_
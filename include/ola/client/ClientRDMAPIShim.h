@@ -66,6 +66,18 @@ class ClientRDMAPIShim : public ola::rdm::RDMAPIImplInterface {
                 const uint8_t *data = NULL,
                 unsigned int data_length = 0);
 
+    /*
+     * Convert the result of a RDM request into the ResponseStatus and param
+     * data that the RDMAPI handlers expect. This is used by callers that
+     * send requests with OlaClient::RDMBatchGet().
+     */
+    static void GetResponseStatusAndData(
+        const Result &result,
+        ola::rdm::rdm_response_code response_code,
+        const ola::rdm::RDMResponse *response,
+        rdm::ResponseStatus *response_status,
+        string *data);
+
   private:
     OlaClient *m_client;
 
@@ -81,16 +93,9 @@ class ClientRDMAPIShim : public ola::rdm::RDMAPIImplInterface {
         const RDMMetadata &metadata,
         const ola::rdm::RDMResponse *response);
 
-    void GetResponseStatusAndData(
-        const Result &result,
-        ola::rdm::rdm_response_code response_code,
-        const ola::rdm::RDMResponse *response,
-        rdm::ResponseStatus *response_status,
-        string *data);
-
-    void GetParamFromReply(const std::string &message_type,
-                           const ola::rdm::RDMResponse *reply,
-                           ola::rdm::ResponseStatus *new_status);
+    static void GetParamFromReply(const std::string &message_type,
+                                  const ola::rdm::RDMResponse *reply,
+                                  ola::rdm::ResponseStatus *new_status);
 };
 }  // namespace client
 }  // namespace ola
@@ -35,6 +35,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ola {
 namespace client {
@@ -73,6 +74,14 @@ class OlaClient {
      */
     void SetDMXCallback(RepeatableDMXCallback *callback);
 
+    /**
+     * @brief Set the callback to be run when RDM status updates arrive.
+     * The callback will be run for the universes that have been registered
+     * with RegisterForRDMStatus().
+     * @param callback the callback to run, ownership is transferred.
+     */
+    void SetRDMStatusCallback(RDMStatusCallback *callback);
+
     /**
      * @brief Fetch the list of plugins loaded.
      * @param callback the PluginListCallback to be invoked upon completion.
@@ -219,6 +228,28 @@ class OlaClient {
                           RegisterAction register_action,
                           SetCallback *callback);
 
+    /**
+     * @brief Register for the RDM status updates from all universes. The
+     * callback set by SetRDMStatusCallback() will be called when a responder
+     * returns a queued message or status messages.
+     * @param register_action the action (register or unregister)
+     * @param callback the SetCallback to invoke upon completion.
+     * @note The server only polls responders if it was started with a
+     * non-zero --rdm-status-budget.
+     */
+    void RegisterForRDMStatus(RegisterAction register_action,
+                              SetCallback *callback);
+
+    /**
+     * @brief Register for the RDM status updates from a single universe.
+     * @param universe the id of the universe to register for.
+     * @param register_action the action (register or unregister)
+     * @param callback the SetCallback to invoke upon completion.
+     */
+    void RegisterForRDMStatus(unsigned int universe,
+                              RegisterAction register_action,
+                              SetCallback *callback);
+
     /**
      * @brief Send DMX data.
      * @param universe the universe to send to.
@@ -271,6 +302,25 @@ class OlaClient {
                 unsigned int data_length,
                 const SendRDMArgs& args);
 
+    /**
+     * @brief Send a batch of RDM Get Commands to a universe.
+     * The server schedules the GETs across the responders and streams back
+     * each response as it arrives. Large batches are split into several
+     * requests to the server.
+     * @param universe the universe to send the commands on
+     * @param gets the GETs to send
+     * @param on_response the callback to run as each GET completes,
+     * ownership is transferred.
+     * @param on_complete the callback to run once all the GETs have completed.
+     * @param interactive true if a user is waiting on the results, in which
+     * case the GETs are sent ahead of background requests like status polls.
+     */
+    void RDMBatchGet(unsigned int universe,
+                     const std::vector<RDMGetParams> &gets,
+                     RDMBatchResponseCallback *on_response,
+                     SetCallback *on_complete,
+                     bool interactive = false);
+
     /**
      * @brief Send an RDM Set Command.
      * @param universe the universe to send the command on
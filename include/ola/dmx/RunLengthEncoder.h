@@ -68,6 +68,14 @@ class RunLengthEncoder {
 
   private:
     static const uint8_t REPEAT_FLAG = 0x80;
+    static const unsigned int MAX_SEGMENT_LENGTH = 0x7f;
+
+    static unsigned int RepeatLength(const uint8_t *data,
+                                     unsigned int size,
+                                     unsigned int offset);
+    static unsigned int LiteralLength(const uint8_t *data,
+                                      unsigned int size,
+                                      unsigned int offset);
 };
 }  // namespace dmx
 }  // namespace ola
@@ -0,0 +1,156 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * UniverseDispatchTable.h
+ * Maps universe indices to receive buffers & callbacks.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+/**
+ * @file UniverseDispatchTable.h
+ * @brief A flat table that maps a universe index to the DmxBuffer and
+ * callback used when receiving data.
+ */
+
+#ifndef INCLUDE_OLA_DMX_UNIVERSEDISPATCHTABLE_H_
+#define INCLUDE_OLA_DMX_UNIVERSEDISPATCHTABLE_H_
+
+#include <stdint.h>
+#include <ola/Callback.h>
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <vector>
+
+namespace ola {
+namespace dmx {
+
+class RunLengthEncoder;
+
+/**
+ * @brief Dispatches received DMX data to per-universe handlers.
+ *
+ * Receive-only protocol nodes (ShowNet, Pathport, SandNet) register a
+ * DmxBuffer and a callback for each universe index they're interested in.
+ * Data is written into the buffer and the callback is only run if the
+ * contents actually changed, or if KEEPALIVE_INTERVAL has passed since the
+ * callback was last run. The keepalive stops the input port's source from
+ * timing out while a controller sends the same frame over and over.
+ *
+ * Indices are kept in a flat vector so lookups are O(1). It's intended for
+ * small index spaces (up to 64k entries), the table only grows as large as
+ * the highest registered index.
+ */
+class UniverseDispatchTable {
+  public:
+    /**
+     * @brief Create a new table.
+     * @param clock the Clock to use for the keepalive, if NULL the system
+     *   clock is used. Ownership is not transferred.
+     */
+    explicit UniverseDispatchTable(const Clock *clock = NULL);
+    ~UniverseDispatchTable();
+
+    /**
+     * @brief Register a handler for an index.
+     * @param index the universe index.
+     * @param buffer the DmxBuffer to write received data into, ownership is
+     *   not transferred.
+     * @param closure the callback to run when the data changes, ownership is
+     *   transferred. If a handler already exists for this index its closure
+     *   is deleted and replaced.
+     */
+    void SetHandler(unsigned int index,
+                    DmxBuffer *buffer,
+                    Callback0<void> *closure);
+
+    /**
+     * @brief Remove the handler for an index.
+     * @return true if a handler was removed, false otherwise.
+     */
+    bool RemoveHandler(unsigned int index);
+
+    /**
+     * @brief Check if a handler is registered for an index.
+     */
+    bool HasHandler(unsigned int index) const {
+      return index < m_handlers.size() && m_handlers[index];
+    }
+
+    /**
+     * @brief Remove all handlers.
+     */
+    void Clear();
+
+    /**
+     * @brief Copy a range of slots into the buffer for an index.
+     * @param index the universe index.
+     * @param offset the first slot to write to.
+     * @param data the slot data.
+     * @param length the number of slots.
+     * @return true if a handler exists for the index, false otherwise.
+     */
+    bool SetRange(unsigned int index, unsigned int offset,
+                  const uint8_t *data, unsigned int length);
+
+    /**
+     * @brief Replace the entire frame in the buffer for an index.
+     * @return true if a handler exists for the index, false otherwise.
+     */
+    bool Set(unsigned int index, const uint8_t *data, unsigned int length);
+
+    /**
+     * @brief Decode run length encoded data into the buffer for an index.
+     * @param index the universe index.
+     * @param offset the slot the encoded data starts at.
+     * @param data the encoded data.
+     * @param length the length of the encoded data.
+     * @param encoder the RunLengthEncoder to use.
+     * @return true if a handler exists for the index and the data was
+     *   decoded, false otherwise. If the data can't be decoded the buffer
+     *   isn't updated and the callback isn't run.
+     */
+    bool DecodeRunLength(unsigned int index, unsigned int offset,
+                         const uint8_t *data, unsigned int length,
+                         RunLengthEncoder *encoder);
+
+    /**
+     * @brief The maximum time between callbacks while data is being
+     * received, even if the data doesn't change.
+     */
+    static const TimeInterval KEEPALIVE_INTERVAL;
+
+  private:
+    typedef struct {
+      DmxBuffer *buffer;
+      Callback0<void> *closure;
+      TimeStamp last_signalled;
+    } universe_handler;
+
+    std::vector<universe_handler*> m_handlers;
+    const Clock *m_clock;
+    Clock m_default_clock;
+    DmxBuffer m_scratch;
+
+    universe_handler *Lookup(unsigned int index) const {
+      return index < m_handlers.size() ? m_handlers[index] : NULL;
+    }
+
+    void SignalIfRequired(universe_handler *handler, bool changed);
+
+    DISALLOW_COPY_AND_ASSIGN(UniverseDispatchTable);
+};
+}  // namespace dmx
+}  // namespace ola
+#endif  // INCLUDE_OLA_DMX_UNIVERSEDISPATCHTABLE_H_
@@ -100,6 +100,11 @@ class DiscoveryAgent {
             attempt(0),
             failures(0),
             uids_discovered(0),
+            branches(0),
+            empty_branches(0),
+            first_empty_mute_count(0),
+            collided(false),
+            expect_collision(false),
             branch_corrupt(false) {
       }
       UID lower;
@@ -108,6 +113,14 @@ class DiscoveryAgent {
       unsigned int attempt;  // the # of attempts for this branch
       unsigned int failures;
       unsigned int uids_discovered;
+      unsigned int branches;  // the # of child branches
+      // the # of child branches that ended with no response
+      unsigned int empty_branches;
+      // the value of m_mute_count when the first child branch ended
+      unsigned int first_empty_mute_count;
+      bool collided;  // true if this branch was split after a collision
+      // true if the sibling branch was empty, so this one must collide
+      bool expect_collision;
       bool branch_corrupt;  // true if this branch contains a bad device
     };
 
@@ -129,6 +142,7 @@ class DiscoveryAgent {
     UIDRanges m_uid_ranges;
     UID m_muting_uid;  // the uid we're currently trying to mute
     unsigned int m_mute_attempts;
+    unsigned int m_mute_count;  // the # of devices muted in the branch phase
     bool m_tree_corrupt;  // true if there was a problem with discovery
 
     void InitDiscovery(DiscoveryCompleteCallback *on_complete,
@@ -143,6 +157,8 @@ class DiscoveryAgent {
     void BranchMuteComplete(bool status);
     void HandleCollision();
     void FreeCurrentRange();
+    void BranchEmpty(UIDRange *range);
+    void PushInitialRanges(const UIDSet &known_uids);
 
     static const unsigned int MAX_DUB_RESPONSE_SIZE = 24;
     static const unsigned int MIN_DUB_RESPONSE_SIZE = 17;
@@ -31,9 +31,11 @@
 
 #include <stdint.h>
 #include <ola/messaging/Descriptor.h>
+#include <ola/thread/Mutex.h>
 #include <istream>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace ola {
@@ -54,13 +56,11 @@ class RootPidStore {
   public:
     typedef map<uint16_t, const PidStore*> ManufacturerMap;
 
+    // compiled_file is the memory mapped file backing the stores, if any.
     RootPidStore(const PidStore *esta_store,
                  const ManufacturerMap &manufacturer_stores,
-                 uint64_t version = 0)
-        : m_esta_store(esta_store),
-          m_manufacturer_store(manufacturer_stores),
-          m_version(version) {
-    }
+                 uint64_t version = 0,
+                 const class CompiledPidFile *compiled_file = NULL);
     ~RootPidStore();
 
     // Seconds since epoch in UTC
@@ -92,9 +92,14 @@ class RootPidStore {
                                                  bool validate = true);
 
   private:
+    typedef vector<std::pair<uint16_t, const PidStore*> > ManufacturerIndex;
+
     const PidStore *m_esta_store;
     ManufacturerMap m_manufacturer_store;
+    // sorted by manufacturer id, this is faster to search than the map
+    ManufacturerIndex m_manufacturer_index;
     uint64_t m_version;
+    const class CompiledPidFile *m_compiled_file;
 
     RootPidStore(const RootPidStore&);
     RootPidStore& operator=(const RootPidStore&);
@@ -105,25 +110,35 @@ class RootPidStore {
 
 /**
  * Stores the PidDescriptors for a set of PIDs in a common namespace.
+ *
+ * A PidStore backed by a compiled PID file builds the PidDescriptors as
+ * they're looked up. The lookups are guarded by a mutex so the store can be
+ * shared between threads.
  */
 class PidStore {
   public:
     explicit PidStore(const vector<const PidDescriptor*> &pids);
+    PidStore(const class CompiledPidFile *compiled_file, unsigned int section);
     ~PidStore();
 
-    unsigned int PidCount() const { return m_pid_by_value.size(); }
+    unsigned int PidCount() const;
     void AllPids(vector<const PidDescriptor*> *pids) const;
     const PidDescriptor *LookupPID(uint16_t pid_value) const;
     const PidDescriptor *LookupPID(const string &pid_name) const;
 
   private:
     typedef map<uint16_t, const PidDescriptor*> PidMap;
-    typedef map<string, const PidDescriptor*> PidNameMap;
-    PidMap m_pid_by_value;
-    PidNameMap m_pid_by_name;
+    const class CompiledPidFile *m_compiled_file;
+    unsigned int m_section;
+    // m_pid_by_value owns the descriptors, m_index is used for lookups
+    mutable PidMap m_pid_by_value;
+    class PidIndex *m_index;
+    // guards m_pid_by_value & m_index for stores backed by a compiled file
+    mutable ola::thread::Mutex m_mutex;
 
     PidStore(const PidStore&);
     PidStore& operator=(const PidStore&);
+    const PidDescriptor *BuildDescriptor(unsigned int index) const;
 };
 
 
@@ -30,7 +30,9 @@
 #define INCLUDE_OLA_RDM_QUEUEINGRDMCONTROLLER_H_
 
 #include <ola/rdm/RDMControllerInterface.h>
-#include <queue>
+#include <ola/rdm/UID.h>
+#include <deque>
+#include <map>
 #include <string>
 #include <utility>
 #include <vector>
@@ -44,9 +46,19 @@ using std::vector;
 /*
  * A RDM controller that only sends a single request at a time. This also
  * handles timing out messages that we don't get a response for.
+ *
+ * Queued requests are scheduled by priority and then round robin between
+ * destination UIDs, so a slow responder or a bulk poll doesn't hold up
+ * everything else. A GET that matches one already queued or in flight is
+ * coalesced with it, and the response is passed to each caller.
  */
 class QueueingRDMController: public RDMControllerInterface {
   public:
+    typedef enum {
+      INTERACTIVE_PRIORITY,  // requests a user is waiting on
+      BACKGROUND_PRIORITY  // polling and other bulk requests
+    } RequestPriority;
+
     QueueingRDMController(RDMControllerInterface *controller,
                           unsigned int max_queue_size);
     ~QueueingRDMController();
@@ -56,16 +68,32 @@ class QueueingRDMController: public RDMControllerInterface {
 
     // This can be called multiple times and the requests will be queued.
     void SendRDMRequest(const RDMRequest *request, RDMCallback *on_complete);
+    void SendRDMRequest(const RDMRequest *request,
+                        RDMCallback *on_complete,
+                        RequestPriority priority);
+
+    // The number of requests waiting to be sent.
+    unsigned int QueueSize() const { return m_queue_size; }
 
   protected:
     typedef struct {
       const RDMRequest *request;
-      RDMCallback *on_complete;
+      vector<RDMCallback*> callbacks;
     } outstanding_rdm_request;
 
+    typedef std::deque<outstanding_rdm_request*> RequestQueue;
+
+    typedef struct {
+      std::map<UID, RequestQueue> queues;
+      std::deque<UID> uids;  // UIDs with queued requests, in round robin order
+    } PriorityClass;
+
     RDMControllerInterface *m_controller;
     unsigned int m_max_queue_size;
-    std::queue<outstanding_rdm_request> m_pending_requests;
+    unsigned int m_queue_size;
+    unsigned int m_interactive_burst;
+    PriorityClass m_priority_classes[BACKGROUND_PRIORITY + 1];
+    outstanding_rdm_request *m_current_request;  // the request on the wire
     bool m_rdm_request_pending;  // true if a request is in progress
     bool m_active;  // true if the controller is active
     RDMCallback *m_callback;
@@ -80,6 +108,28 @@ class QueueingRDMController: public RDMControllerInterface {
     void HandleRDMResponse(rdm_response_code status,
                            const ola::rdm::RDMResponse *response,
                            const vector<std::string> &packets);
+
+  private:
+    bool CoalesceRequest(const RDMRequest *request,
+                         RDMCallback *on_complete,
+                         RequestPriority priority);
+    void Enqueue(outstanding_rdm_request *outstanding_request,
+                 RequestPriority priority);
+    outstanding_rdm_request *Dequeue(RequestPriority priority);
+    void RemoveFromQueue(outstanding_rdm_request *outstanding_request,
+                         RequestPriority priority);
+    RequestPriority NextPriority();
+
+    static void RunCallbacks(outstanding_rdm_request *outstanding_request,
+                             rdm_response_code status,
+                             const RDMResponse *response,
+                             const vector<std::string> &packets);
+    static bool IsSameGet(const RDMRequest *request1,
+                          const RDMRequest *request2);
+
+    // the number of interactive requests to send before letting a
+    // background request through
+    static const unsigned int MAX_INTERACTIVE_BURST = 4;
 };
 
 
@@ -423,6 +423,13 @@ class RDMResponse: public RDMCommand {
 
     RDMCommandClass CommandClass() const { return m_command_class; }
 
+    RDMResponse *Duplicate() const {
+      return new RDMResponse(SourceUID(), DestinationUID(),
+                             TransactionNumber(), ResponseType(),
+                             MessageCount(), SubDevice(), CommandClass(),
+                             ParamId(), ParamData(), ParamDataSize());
+    }
+
     // The maximum size of an ACK_OVERFLOW session that we'll buffer
     // 4k should be big enough for everyone ;)
     static const unsigned int MAX_OVERFLOW_SIZE = 4 << 10;
@@ -0,0 +1,163 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMCommandView.h
+ * A read only view of an RDM message held in a buffer.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ * @file RDMCommandView.h
+ * @brief A non-owning, validated view of an RDM message.
+ * @}
+ */
+
+#ifndef INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
+#define INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
+
+#include <stdint.h>
+#include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMPacket.h>
+#include <ola/rdm/RDMResponseCodes.h>
+#include <ola/rdm/UID.h>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @addtogroup rdm_command
+ * @{
+ */
+
+/**
+ * @brief Calculate the RDM checksum of a block of data.
+ * @param data the data to checksum
+ * @param length the length of the data
+ * @param checksum the initial value of the checksum, this defaults to the RDM
+ *   start code since the data usually excludes it.
+ * @returns the 16 bit checksum
+ */
+uint16_t RDMChecksum(const uint8_t *data, unsigned int length,
+                     uint16_t checksum = START_CODE);
+
+/**
+ * @brief A read only view of an RDM message.
+ *
+ * Unlike RDMCommand::Inflate(), this doesn't allocate or copy anything, the
+ * fields are read directly from the buffer the view was initialized with.
+ * This makes it suitable for the receive paths, where most messages are
+ * either discarded or only need a couple of fields checked. Use ToCommand(),
+ * ToRequest() or ToResponse() once an owning RDMCommand is required.
+ *
+ * @note The buffer must outlive the view.
+ *
+ * @examplepara
+ * @code
+ *   RDMCommandView view;
+ *   if (view.Init(data, length) != RDM_COMPLETED_OK)
+ *     return;
+ *   if (view.DestinationUID() == our_uid)
+ *     HandleRequest(view.ToRequest());
+ * @endcode
+ */
+class RDMCommandView {
+  public:
+    RDMCommandView()
+        : m_header(NULL),
+          m_data(NULL),
+          m_length(0) {
+    }
+
+    rdm_response_code Init(const uint8_t *data, unsigned int length);
+
+    /** @brief Returns true if the last call to Init() succeeded */
+    bool IsValid() const { return m_header != NULL; }
+
+    /**
+     * @name Accessors
+     * These are only valid if IsValid() returns true.
+     * @{
+     */
+
+    /** @brief Returns the data the view was initialized with */
+    const uint8_t *Data() const { return m_data; }
+
+    /** @brief Returns the length of the data the view was initialized with */
+    unsigned int Size() const { return m_length; }
+
+    /** @brief Returns the Source UID of the message */
+    UID SourceUID() const { return UID(m_header->source_uid); }
+
+    /** @brief Returns the Destination UID of the message */
+    UID DestinationUID() const { return UID(m_header->destination_uid); }
+
+    /** @brief Returns the Transaction Number of the message */
+    uint8_t TransactionNumber() const {
+      return m_header->transaction_number;
+    }
+
+    /** @brief Returns the Port ID or Response Type of the message */
+    uint8_t PortIdResponseType() const { return m_header->port_id; }
+
+    /** @brief Returns the Message Count of the message */
+    uint8_t MessageCount() const { return m_header->message_count; }
+
+    /** @brief Returns the SubDevice of the message */
+    uint16_t SubDevice() const {
+      return (m_header->sub_device[0] << 8) + m_header->sub_device[1];
+    }
+
+    /** @brief Returns the Command Class of the message */
+    RDMCommand::RDMCommandClass CommandClass() const {
+      return static_cast<RDMCommand::RDMCommandClass>(
+          m_header->command_class);
+    }
+
+    /** @brief Returns the Parameter ID of the message */
+    uint16_t ParamId() const {
+      return (m_header->param_id[0] << 8) + m_header->param_id[1];
+    }
+
+    /** @brief Returns a pointer to the Parameter Data of the message */
+    const uint8_t *ParamData() const {
+      return m_data + sizeof(RDMCommandHeader);
+    }
+
+    /** @brief Returns the Size of the Parameter Data of the message */
+    unsigned int ParamDataSize() const {
+      return m_header->param_data_length;
+    }
+
+    /** @} */
+
+    rdm_message_type MessageType() const;
+
+    RDMCommand *ToCommand() const;
+    RDMRequest *ToRequest() const;
+    RDMResponse *ToResponse() const;
+
+  private:
+    const RDMCommandHeader *m_header;
+    const uint8_t *m_data;
+    unsigned int m_length;
+
+    rdm_response_code Verify() const;
+};
+/**@}*/
+}  // namespace rdm
+}  // namespace ola
+#endif  // INCLUDE_OLA_RDM_RDMCOMMANDVIEW_H_
@@ -0,0 +1,165 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * RDMResponseCache.h
+ * Caches the responses to GETs for PIDs that rarely change.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+/**
+ * @addtogroup rdm_controller
+ * @{
+ * @file RDMResponseCache.h
+ * @brief Caches the responses to GETs for PIDs that rarely change.
+ * @}
+ */
+#ifndef INCLUDE_OLA_RDM_RDMRESPONSECACHE_H_
+#define INCLUDE_OLA_RDM_RDMRESPONSECACHE_H_
+
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
+#include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/UID.h>
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ola {
+namespace rdm {
+
+/**
+ * @addtogroup rdm_controller
+ * @{
+ * @class RDMResponseCache
+ * @brief A cache of GET responses, keyed by UID, sub device, PID and param
+ * data.
+ *
+ * Only the PIDs that describe a device, like DEVICE_INFO or
+ * MANUFACTURER_LABEL, are cached, each with its own time to live. Entries
+ * for a UID are invalidated when a SET is sent to it or it's added or removed
+ * by discovery.
+ *
+ * Responses are shared between requesters; Lookup() readdresses the cached
+ * response to the source UID and transaction number of the request.
+ *
+ * Since the response to a GET may arrive after a SET to the same device,
+ * callers take the generation of the UID with Generation() when they send
+ * the GET, and pass it to Add(). Responses from an older generation are
+ * discarded.
+ * @}
+ */
+class RDMResponseCache {
+  public:
+    /**
+     * @brief The key for a cached response.
+     */
+    class Key {
+      public:
+        explicit Key(const RDMRequest &request);
+
+        bool operator<(const Key &other) const;
+
+        const UID &DestinationUID() const { return m_uid; }
+
+      private:
+        UID m_uid;
+        uint16_t m_sub_device;
+        uint16_t m_param_id;
+        std::string m_param_data;
+
+        friend class RDMResponseCache;
+    };
+
+    /**
+     * @brief Create a new cache.
+     * @param clock the clock to use for expiring entries.
+     * @param max_entries the maximum number of responses to hold.
+     */
+    explicit RDMResponseCache(const Clock *clock,
+                              unsigned int max_entries = DEFAULT_MAX_ENTRIES);
+    ~RDMResponseCache();
+
+    bool IsCacheable(const RDMRequest &request) const;
+
+    const RDMResponse *Lookup(const RDMRequest &request,
+                              std::vector<std::string> *packets);
+
+    unsigned int Generation(const UID &uid) const;
+
+    void Add(const Key &key,
+             unsigned int generation,
+             const RDMResponse &response,
+             const std::vector<std::string> &packets);
+
+    void Invalidate(const UID &uid);
+    void InvalidateAll();
+
+    /**
+     * @brief The number of responses in the cache.
+     */
+    unsigned int Size() const { return m_entries.size(); }
+
+    /**
+     * @brief The number of UIDs with their own generation.
+     */
+    unsigned int GenerationCount() const { return m_generations.size(); }
+
+    /**
+     * @brief The number of lookups that returned a response.
+     */
+    unsigned int Hits() const { return m_hits; }
+
+    /**
+     * @brief The number of lookups that didn't return a response.
+     */
+    unsigned int Misses() const { return m_misses; }
+
+    static const unsigned int DEFAULT_MAX_ENTRIES = 1024;
+
+  private:
+    typedef struct {
+      const RDMResponse *response;
+      std::vector<std::string> packets;
+      TimeStamp expiry;
+    } CacheEntry;
+
+    typedef std::map<Key, CacheEntry> EntryMap;
+
+    const Clock *m_clock;
+    const unsigned int m_max_entries;
+    EntryMap m_entries;
+    std::map<UID, unsigned int> m_generations;
+    unsigned int m_global_generation;
+    unsigned int m_last_generation;
+    unsigned int m_hits;
+    unsigned int m_misses;
+
+    void RemoveExpiredEntries();
+
+    static unsigned int TimeToLive(uint16_t param_id);
+
+    // device descriptions, these only change with new firmware
+    static const unsigned int STATIC_TTL = 600;
+    // slot data changes when the personality does
+    static const unsigned int PERSONALITY_TTL = 60;
+    // can be changed from the front panel of a device
+    static const unsigned int DYNAMIC_TTL = 5;
+
+    DISALLOW_COPY_AND_ASSIGN(RDMResponseCache);
+};
+}  // namespace rdm
+}  // namespace ola
+#endif  // INCLUDE_OLA_RDM_RDMRESPONSECACHE_H_
@@ -0,0 +1,85 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * FrameMailbox.h
+ * Hands the latest DMX frame from one thread to another.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#ifndef INCLUDE_OLA_THREAD_FRAMEMAILBOX_H_
+#define INCLUDE_OLA_THREAD_FRAMEMAILBOX_H_
+
+#include <ola/Clock.h>
+#include <ola/DmxBuffer.h>
+#include <ola/base/Macro.h>
+#include <ola/thread/Mutex.h>
+
+namespace ola {
+namespace thread {
+
+/**
+ * A latest-frame mailbox between a single producer and a single consumer.
+ *
+ * This is a triple buffer: the producer copies into a slot it owns and the
+ * consumer reads from a slot it owns, so neither copy happens with the lock
+ * held. The lock only guards swapping the slot indices and is used with a
+ * condition variable so the consumer can block until a new frame arrives,
+ * a deadline passes or the mailbox is closed. Frames that are overwritten
+ * before the consumer picks them up are dropped.
+ */
+class FrameMailbox {
+  public:
+    typedef enum {
+      NEW_FRAME,
+      TIMED_OUT,
+      CLOSED
+    } WaitResult;
+
+    FrameMailbox();
+    ~FrameMailbox() {}
+
+    // Producer side
+    void Put(const DmxBuffer &buffer);
+    void Close();
+
+    // Consumer side
+    WaitResult Wait();
+    WaitResult TimedWait(const TimeStamp &wake_up_time);
+    bool Poll();
+    bool IsClosed();
+
+    /**
+     * The consumer's current frame. This is only valid in the consumer thread
+     * and is replaced by the next call to Wait(), TimedWait() or Poll().
+     */
+    const DmxBuffer &Frame() const { return m_frames[m_front]; }
+
+  private:
+    DmxBuffer m_frames[3];
+    unsigned int m_back;  // owned by the producer
+    unsigned int m_middle;  // the most recently published frame
+    unsigned int m_front;  // owned by the consumer
+    bool m_fresh;
+    bool m_closed;
+    Mutex m_mutex;
+    ConditionVariable m_condition;
+
+    void TakeFrame();
+
+    DISALLOW_COPY_AND_ASSIGN(FrameMailbox);
+};
+}  // namespace thread
+}  // namespace ola
+#endif  // INCLUDE_OLA_THREAD_FRAMEMAILBOX_H_
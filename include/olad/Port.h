@@ -23,6 +23,7 @@
 
 #include <ola/DmxBuffer.h>
 #include <ola/base/Macro.h>
+#include <ola/rdm/QueueingRDMController.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/timecode/TimeCode.h>
@@ -115,6 +116,12 @@ class OutputPort: public Port, ola::rdm::DiscoverableRDMControllerInterface {
     // Ownership of the request object is transferred
     virtual void SendRDMRequest(const ola::rdm::RDMRequest *request,
                                 ola::rdm::RDMCallback *callback) = 0;
+    // Send a request with a queueing priority. Ports that don't queue
+    // requests ignore the priority.
+    virtual void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) = 0;
     virtual void RunFullDiscovery(
         ola::rdm::RDMDiscoveryCallback *on_complete) = 0;
     virtual void RunIncrementalDiscovery(
@@ -225,6 +232,10 @@ class BasicOutputPort: public OutputPort {
     // DiscoverableRDMControllerInterface methods
     virtual void SendRDMRequest(const ola::rdm::RDMRequest *request,
                                 ola::rdm::RDMCallback *callback);
+    virtual void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority);
     virtual void RunFullDiscovery(
         ola::rdm::RDMDiscoveryCallback *on_complete);
     virtual void RunIncrementalDiscovery(
@@ -25,8 +25,10 @@
 #include <ola/DmxBuffer.h>
 #include <ola/ExportMap.h>
 #include <ola/base/Macro.h>
+#include <ola/rdm/QueueingRDMController.h>
 #include <ola/rdm/RDMCommand.h>
 #include <ola/rdm/RDMControllerInterface.h>
+#include <ola/rdm/RDMResponseCache.h>
 #include <ola/rdm/UID.h>
 #include <ola/rdm/UIDSet.h>
 #include <olad/DmxSource.h>
@@ -132,11 +134,16 @@ class Universe: public ola::rdm::RDMControllerInterface {
     // RDM methods
     void SendRDMRequest(const ola::rdm::RDMRequest *request,
                         ola::rdm::RDMCallback *callback);
+    void SendRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority);
     void RunRDMDiscovery(RDMDiscoveryCallback *on_complete,
                          bool full = true);
     void NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids);
     void GetUIDs(ola::rdm::UIDSet *uids) const;
     unsigned int UIDCount() const;
+    const OutputPort *OutputPortForUID(const ola::rdm::UID &uid) const;
 
     bool operator==(const Universe &other) {
       return m_universe_id == other.UniverseId();
@@ -145,10 +152,13 @@ class Universe: public ola::rdm::RDMControllerInterface {
     static const char K_FPS_VAR[];
     static const char K_MERGE_HTP_STR[];
     static const char K_MERGE_LTP_STR[];
+    static const char K_PORT_RDM_DISCOVERY_TIME_VAR[];
     static const char K_UNIVERSE_INPUT_PORT_VAR[];
     static const char K_UNIVERSE_MODE_VAR[];
     static const char K_UNIVERSE_NAME_VAR[];
     static const char K_UNIVERSE_OUTPUT_PORT_VAR[];
+    static const char K_UNIVERSE_RDM_CACHE_HITS_VAR[];
+    static const char K_UNIVERSE_RDM_CACHE_MISSES_VAR[];
     static const char K_UNIVERSE_RDM_REQUESTS[];
     static const char K_UNIVERSE_SINK_CLIENTS_VAR[];
     static const char K_UNIVERSE_SOURCE_CLIENTS_VAR[];
@@ -163,6 +173,20 @@ class Universe: public ola::rdm::RDMControllerInterface {
       vector<string> packets;
     } broadcast_request_tracker;
 
+    struct cacheable_request_tracker {
+      ola::rdm::RDMResponseCache::Key key;
+      unsigned int generation;
+      ola::rdm::RDMCallback *callback;
+
+      cacheable_request_tracker(const ola::rdm::RDMRequest &request,
+                                unsigned int generation,
+                                ola::rdm::RDMCallback *callback)
+          : key(request),
+            generation(generation),
+            callback(callback) {
+      }
+    };
+
     typedef map<Client*, bool> SourceClientMap;
 
     string m_universe_name;
@@ -185,6 +209,7 @@ class Universe: public ola::rdm::RDMControllerInterface {
     Clock *m_clock;
     TimeInterval m_rdm_discovery_interval;
     TimeStamp m_last_discovery_time;
+    ola::rdm::RDMResponseCache m_rdm_cache;
 
     void HandleBroadcastAck(broadcast_request_tracker *tracker,
                             ola::rdm::rdm_response_code code,
@@ -194,6 +219,15 @@ class Universe: public ola::rdm::RDMControllerInterface {
                                   ola::rdm::rdm_response_code code,
                                   const ola::rdm::RDMResponse *response,
                                   const std::vector<std::string> &packets);
+    void SendCacheableRDMRequest(
+        OutputPort *port,
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority);
+    void HandleCacheableResponse(cacheable_request_tracker *tracker,
+                                 ola::rdm::rdm_response_code code,
+                                 const ola::rdm::RDMResponse *response,
+                                 const std::vector<std::string> &packets);
     bool UpdateDependants();
     void UpdateName();
     void UpdateMode();
@@ -201,6 +235,7 @@ class Universe: public ola::rdm::RDMControllerInterface {
     bool MergeAll(const InputPort *port, const Client *client);
     void PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                OutputPort *output_port,
+                               TimeStamp start_time,
                                const ola::rdm::UIDSet &uids);
     void DiscoveryComplete(RDMDiscoveryCallback *on_complete);
 
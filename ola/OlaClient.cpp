@@ -21,6 +21,7 @@
 #include "ola/client/OlaClient.h"
 
 #include <string>
+#include <vector>
 
 #include "ola/BaseTypes.h"
 #include "ola/Logging.h"
@@ -60,6 +61,10 @@ void OlaClient::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_core->SetDMXCallback(callback);
 }
 
+void OlaClient::SetRDMStatusCallback(RDMStatusCallback *callback) {
+  m_core->SetRDMStatusCallback(callback);
+}
+
 void OlaClient::FetchPluginList(PluginListCallback *callback) {
   m_core->FetchPluginList(callback);
 }
@@ -146,6 +151,17 @@ void OlaClient::RegisterUniverse(unsigned int universe,
   m_core->RegisterUniverse(universe, register_action, callback);
 }
 
+void OlaClient::RegisterForRDMStatus(RegisterAction register_action,
+                                     SetCallback *callback) {
+  m_core->RegisterForRDMStatus(register_action, callback);
+}
+
+void OlaClient::RegisterForRDMStatus(unsigned int universe,
+                                     RegisterAction register_action,
+                                     SetCallback *callback) {
+  m_core->RegisterForRDMStatus(universe, register_action, callback);
+}
+
 void OlaClient::SendDMX(unsigned int universe,
                         const DmxBuffer &data,
                         const SendDMXArgs &args) {
@@ -182,6 +198,14 @@ void OlaClient::RDMGet(unsigned int universe,
   m_core->RDMGet(universe, uid, sub_device, pid, data, data_length, args);
 }
 
+void OlaClient::RDMBatchGet(unsigned int universe,
+                            const std::vector<RDMGetParams> &gets,
+                            RDMBatchResponseCallback *on_response,
+                            SetCallback *on_complete,
+                            bool interactive) {
+  m_core->RDMBatchGet(universe, gets, on_response, on_complete, interactive);
+}
+
 void OlaClient::RDMSet(unsigned int universe,
                        const ola::rdm::UID &uid,
                        uint16_t sub_device,
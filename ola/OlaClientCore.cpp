@@ -37,6 +37,7 @@
 #include "ola/network/NetworkUtils.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMEnums.h"
+#include "ola/stl/STLUtils.h"
 
 namespace ola {
 namespace client {
@@ -52,13 +53,21 @@ const char OlaClientCore::NOT_CONNECTED_ERROR[] = "Not connected";
 
 OlaClientCore::OlaClientCore(ConnectedDescriptor *descriptor)
     : m_descriptor(descriptor),
-      m_connected(false) {
+      m_connected(false),
+      m_next_rdm_batch_id(0) {
 }
 
 
 OlaClientCore::~OlaClientCore() {
   if (m_connected)
     Stop();
+
+  RDMBatchMap::iterator iter = m_rdm_batches.begin();
+  for (; iter != m_rdm_batches.end(); ++iter) {
+    delete iter->second->on_response;
+    delete iter->second->on_complete;
+    delete iter->second;
+  }
 }
 
 
@@ -111,6 +120,10 @@ void OlaClientCore::SetDMXCallback(RepeatableDMXCallback *callback) {
   m_dmx_callback.reset(callback);
 }
 
+void OlaClientCore::SetRDMStatusCallback(RDMStatusCallback *callback) {
+  m_rdm_status_callback.reset(callback);
+}
+
 void OlaClientCore::FetchPluginList(PluginListCallback *callback) {
   RpcController *controller = new RpcController();
   ola::proto::PluginListRequest request;
@@ -415,6 +428,24 @@ void OlaClientCore::RegisterUniverse(unsigned int universe,
   }
 }
 
+void OlaClientCore::RegisterForRDMStatus(RegisterAction register_action,
+                                         SetCallback *callback) {
+  ola::proto::RegisterRDMStatusRequest request;
+  request.set_action(register_action == REGISTER ? ola::proto::REGISTER :
+                     ola::proto::UNREGISTER);
+  SendRegisterForRDMStatus(request, callback);
+}
+
+void OlaClientCore::RegisterForRDMStatus(unsigned int universe,
+                                         RegisterAction register_action,
+                                         SetCallback *callback) {
+  ola::proto::RegisterRDMStatusRequest request;
+  request.set_action(register_action == REGISTER ? ola::proto::REGISTER :
+                     ola::proto::UNREGISTER);
+  request.set_universe(universe);
+  SendRegisterForRDMStatus(request, callback);
+}
+
 void OlaClientCore::SendDMX(unsigned int universe,
                             const DmxBuffer &data,
                             const SendDMXArgs &args) {
@@ -526,6 +557,32 @@ void OlaClientCore::RDMGet(unsigned int universe,
                  args);
 }
 
+void OlaClientCore::RDMBatchGet(unsigned int universe,
+                                const vector<RDMGetParams> &gets,
+                                RDMBatchResponseCallback *on_response,
+                                SetCallback *on_complete,
+                                bool interactive) {
+  if (!m_connected) {
+    delete on_response;
+    if (on_complete)
+      on_complete->Run(Result(NOT_CONNECTED_ERROR));
+    return;
+  }
+
+  RDMBatch *batch = new RDMBatch;
+  batch->universe = universe;
+  batch->gets = gets;
+  batch->offset = 0;
+  batch->next = 0;
+  batch->on_response = on_response;
+  batch->on_complete = on_complete;
+  batch->interactive = interactive;
+
+  unsigned int batch_id = m_next_rdm_batch_id++;
+  m_rdm_batches[batch_id] = batch;
+  SendRDMBatch(batch_id, batch);
+}
+
 void OlaClientCore::RDMSet(unsigned int universe,
                            const ola::rdm::UID &uid,
                            uint16_t sub_device,
@@ -588,6 +645,48 @@ void OlaClientCore::UpdateDmxData(ola::rpc::RpcController*,
   done->Run();
 }
 
+void OlaClientCore::StreamRDMBatchResponse(
+    ola::rpc::RpcController*,
+    const ola::proto::RDMBatchResponse *request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    CompletionCallback*) {
+  RDMBatch *batch = STLFindOrNull(m_rdm_batches, request->batch_id());
+  if (!batch) {
+    OLA_WARN << "Response for unknown RDM batch " << request->batch_id();
+    return;
+  }
+
+  RDMMetadata metadata;
+  auto_ptr<ola::rdm::RDMResponse> response(
+      BuildRDMResponse(&request->response(), &metadata.response_code));
+  if (batch->on_response) {
+    batch->on_response->Run(batch->offset + request->index(), metadata,
+                            response.get());
+  }
+}
+
+void OlaClientCore::UpdateRDMStatus(
+    ola::rpc::RpcController*,
+    const ola::proto::RDMStatusUpdate *request,
+    ola::proto::STREAMING_NO_RESPONSE*,
+    CompletionCallback*) {
+  if (!m_rdm_status_callback.get())
+    return;
+
+  ola::rdm::UID uid(request->uid().esta_id(), request->uid().device_id());
+  ola::rdm::RDMGetResponse response(
+      uid,
+      ola::rdm::UID(0, 0),
+      0,  // transaction #
+      ola::rdm::RDM_ACK,
+      0,  // message count
+      request->sub_device(),
+      request->param_id(),
+      reinterpret_cast<const uint8_t*>(request->data().data()),
+      request->data().size());
+  m_rdm_status_callback->Run(request->universe(), &response);
+}
+
 
 // The following are RPC callbacks
 
@@ -931,6 +1030,33 @@ void OlaClientCore::HandleRDM(RpcController *controller_ptr,
   callback->Run(result, metadata, response);
 }
 
+void OlaClientCore::HandleRDMBatchAck(RpcController *controller_ptr,
+                                      ola::proto::Ack *reply_ptr,
+                                      unsigned int batch_id) {
+  auto_ptr<RpcController> controller(controller_ptr);
+  auto_ptr<ola::proto::Ack> reply(reply_ptr);
+
+  RDMBatch *batch = STLFindOrNull(m_rdm_batches, batch_id);
+  if (!batch) {
+    return;
+  }
+
+  if (!controller->Failed() && m_connected &&
+      batch->next < batch->gets.size()) {
+    SendRDMBatch(batch_id, batch);
+    return;
+  }
+
+  m_rdm_batches.erase(batch_id);
+  Result result(controller->Failed() ? controller->ErrorText() : "");
+  SetCallback *on_complete = batch->on_complete;
+  delete batch->on_response;
+  delete batch;
+  if (on_complete) {
+    on_complete->Run(result);
+  }
+}
+
 void OlaClientCore::GenericFetchCandidatePorts(
     unsigned int universe_id,
     bool include_universe,
@@ -998,12 +1124,64 @@ void OlaClientCore::SendRDMCommand(bool is_set,
   m_stub->RDMCommand(controller, &request, reply, cb);
 }
 
+void OlaClientCore::SendRegisterForRDMStatus(
+    const ola::proto::RegisterRDMStatusRequest &request,
+    SetCallback *callback) {
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+
+  if (m_connected) {
+    CompletionCallback *cb = ola::NewSingleCallback(
+        this,
+        &OlaClientCore::HandleAck,
+        controller, reply, callback);
+    m_stub->RegisterForRDMStatus(controller, &request, reply, cb);
+  } else {
+    controller->SetFailed(NOT_CONNECTED_ERROR);
+    HandleAck(controller, reply, callback);
+  }
+}
+
+/*
+ * Send the next chunk of a RDM batch. Each chunk reuses the batch id, the
+ * server has finished with it once the previous chunk is acked.
+ */
+void OlaClientCore::SendRDMBatch(unsigned int batch_id, RDMBatch *batch) {
+  ola::proto::RDMBatchRequest request;
+  request.set_universe(batch->universe);
+  request.set_batch_id(batch_id);
+  request.set_interactive(batch->interactive);
+
+  batch->offset = batch->next;
+  const unsigned int end = std::min(
+      static_cast<unsigned int>(batch->gets.size()),
+      batch->offset + MAX_RDM_BATCH_SIZE);
+  for (; batch->next < end; batch->next++) {
+    const RDMGetParams &get = batch->gets[batch->next];
+    ola::proto::RDMBatchItem *item = request.add_item();
+    ola::proto::UID *pb_uid = item->mutable_uid();
+    pb_uid->set_esta_id(get.uid.ManufacturerId());
+    pb_uid->set_device_id(get.uid.DeviceId());
+    item->set_sub_device(get.sub_device);
+    item->set_param_id(get.pid);
+    item->set_data(get.data);
+  }
+
+  RpcController *controller = new RpcController();
+  ola::proto::Ack *reply = new ola::proto::Ack();
+  CompletionCallback *cb = NewSingleCallback(
+      this,
+      &OlaClientCore::HandleRDMBatchAck,
+      controller, reply, batch_id);
+  m_stub->RDMBatchGet(controller, &request, reply, cb);
+}
+
 /**
  * This constructs a ola::rdm::RDMResponse object from the information in a
  * ola::proto::RDMResponse.
  */
 ola::rdm::RDMResponse *OlaClientCore::BuildRDMResponse(
-    ola::proto::RDMResponse *reply,
+    const ola::proto::RDMResponse *reply,
     ola::rdm::rdm_response_code *response_code) {
   // Get the response code, if it's not RDM_COMPLETED_OK don't bother with the
   // rest of the response data.
@@ -21,8 +21,10 @@
 #ifndef OLA_OLACLIENTCORE_H_
 #define OLA_OLACLIENTCORE_H_
 
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "common/protocol/Ola.pb.h"
 #include "common/protocol/OlaService.pb.h"
@@ -72,6 +74,14 @@ class OlaClientCore: public ola::proto::OlaClientService {
      */
     void SetDMXCallback(RepeatableDMXCallback *callback);
 
+    /**
+     * @brief Set the callback to be run when RDM status updates arrive.
+     * The callback will be run for the universes that have been registered
+     * with RegisterForRDMStatus().
+     * @param callback the callback to run, ownership is transferred.
+     */
+    void SetRDMStatusCallback(RDMStatusCallback *callback);
+
     /**
      * @brief Fetch the list of plugins loaded.
      * @param callback the PluginListCallback to be invoked upon completion.
@@ -218,6 +228,28 @@ class OlaClientCore: public ola::proto::OlaClientService {
                           RegisterAction register_action,
                           SetCallback *callback);
 
+    /**
+     * @brief Register for the RDM status updates from all universes. The
+     * callback set by SetRDMStatusCallback() will be called when a responder
+     * returns a queued message or status messages.
+     * @param register_action the action (register or unregister)
+     * @param callback the SetCallback to invoke upon completion.
+     * @note The server only polls responders if it was started with a
+     * non-zero --rdm-status-budget.
+     */
+    void RegisterForRDMStatus(RegisterAction register_action,
+                              SetCallback *callback);
+
+    /**
+     * @brief Register for the RDM status updates from a single universe.
+     * @param universe the id of the universe to register for.
+     * @param register_action the action (register or unregister)
+     * @param callback the SetCallback to invoke upon completion.
+     */
+    void RegisterForRDMStatus(unsigned int universe,
+                              RegisterAction register_action,
+                              SetCallback *callback);
+
     /**
      * @brief Send DMX data.
      * @param universe the universe to send to.
@@ -270,6 +302,25 @@ class OlaClientCore: public ola::proto::OlaClientService {
                 unsigned int data_length,
                 const SendRDMArgs& args);
 
+    /**
+     * @brief Send a batch of RDM Get Commands to a universe.
+     * The server schedules the GETs across the responders and streams back
+     * each response as it arrives. Large batches are split into several
+     * requests to the server.
+     * @param universe the universe to send the commands on
+     * @param gets the GETs to send
+     * @param on_response the callback to run as each GET completes,
+     * ownership is transferred.
+     * @param on_complete the callback to run once all the GETs have completed.
+     * @param interactive true if a user is waiting on the results, in which
+     * case the GETs are sent ahead of background requests like status polls.
+     */
+    void RDMBatchGet(unsigned int universe,
+                     const std::vector<RDMGetParams> &gets,
+                     RDMBatchResponseCallback *on_response,
+                     SetCallback *on_complete,
+                     bool interactive = false);
+
     /**
      * @brief Send an RDM Set Command.
      * @param universe the universe to send the command on
@@ -304,12 +355,46 @@ class OlaClientCore: public ola::proto::OlaClientService {
                        ola::proto::Ack* response,
                        CompletionCallback* done);
 
+    /**
+     * @brief This is called by the channel as each response to a
+     * RDMBatchGet() arrives.
+     */
+    void StreamRDMBatchResponse(
+        ola::rpc::RpcController* controller,
+        const ola::proto::RDMBatchResponse* request,
+        ola::proto::STREAMING_NO_RESPONSE* response,
+        CompletionCallback* done);
+
+    /**
+     * @brief This is called by the channel when a RDM status update arrives.
+     */
+    void UpdateRDMStatus(
+        ola::rpc::RpcController* controller,
+        const ola::proto::RDMStatusUpdate* request,
+        ola::proto::STREAMING_NO_RESPONSE* response,
+        CompletionCallback* done);
+
   private:
+    typedef struct {
+      unsigned int universe;
+      std::vector<RDMGetParams> gets;
+      unsigned int offset;  // the index of the first GET in the current request
+      unsigned int next;  // the index of the next GET to send
+      RDMBatchResponseCallback *on_response;
+      SetCallback *on_complete;
+      bool interactive;
+    } RDMBatch;
+
+    typedef std::map<unsigned int, RDMBatch*> RDMBatchMap;
+
     ConnectedDescriptor *m_descriptor;
     std::auto_ptr<RepeatableDMXCallback> m_dmx_callback;
+    std::auto_ptr<RDMStatusCallback> m_rdm_status_callback;
     std::auto_ptr<RpcChannel> m_channel;
     std::auto_ptr<ola::proto::OlaServerService_Stub> m_stub;
     int m_connected;
+    RDMBatchMap m_rdm_batches;
+    unsigned int m_next_rdm_batch_id;
 
     /**
      * @brief Called when GetPlugins() completes.
@@ -395,6 +480,13 @@ class OlaClientCore: public ola::proto::OlaClientService {
                    ola::proto::RDMResponse *reply,
                    RDMCallback *callback);
 
+    /**
+     * @brief Called when a RDMBatchGet() request completes.
+     */
+    void HandleRDMBatchAck(RpcController *controller,
+                           ola::proto::Ack *reply,
+                           unsigned int batch_id);
+
     /**
      * @brief Fetch a list of candidate ports, with or without a universe
      */
@@ -414,15 +506,31 @@ class OlaClientCore: public ola::proto::OlaClientService {
                         unsigned int data_length,
                         const SendRDMArgs &args);
 
+    /**
+     * @brief Register or unregister for RDM status updates.
+     */
+    void SendRegisterForRDMStatus(
+        const ola::proto::RegisterRDMStatusRequest &request,
+        SetCallback *callback);
+
+    /**
+     * @brief Sends the next request for a batch of RDM GETs to the server.
+     */
+    void SendRDMBatch(unsigned int batch_id, RDMBatch *batch);
+
     /**
      * @brief Builds a RDMResponse from the server's RDM reply message.
      */
     ola::rdm::RDMResponse *BuildRDMResponse(
-        ola::proto::RDMResponse *reply,
+        const ola::proto::RDMResponse *reply,
         ola::rdm::rdm_response_code *response_code);
 
     static const char NOT_CONNECTED_ERROR[];
 
+    // The maximum number of GETs in each request to the server, this keeps
+    // the request well below the RPC message size limit.
+    static const unsigned int MAX_RDM_BATCH_SIZE = 1000;
+
     DISALLOW_COPY_AND_ASSIGN(OlaClientCore);
 };
 
@@ -0,0 +1,282 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * OlaClientCoreTest.cpp
+ * Test fixture for the OlaClientCore class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <vector>
+
+#include "common/protocol/Ola.pb.h"
+#include "common/protocol/OlaService.pb.h"
+#include "common/rpc/RpcChannel.h"
+#include "common/rpc/RpcController.h"
+#include "ola/Callback.h"
+#include "ola/client/ClientArgs.h"
+#include "ola/client/ClientTypes.h"
+#include "ola/client/Result.h"
+#include "ola/io/Descriptor.h"
+#include "ola/io/SelectServer.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "ola/OlaClientCore.h"
+
+using ola::client::OlaClientCore;
+using ola::client::RDMGetParams;
+using ola::client::RDMMetadata;
+using ola::client::Result;
+using ola::io::SelectServer;
+using ola::io::UnixSocket;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rpc::RpcChannel;
+using ola::rpc::RpcController;
+using std::auto_ptr;
+using std::vector;
+
+
+/*
+ * A server which answers each GET in a RDMBatchRequest with an ACK, echoing
+ * the PID. The responses are streamed in reverse order, so the client can't
+ * rely on the order of arrival to match them up. Like olad, the responses are
+ * spread over several iterations of the SelectServer so the socket doesn't
+ * fill up.
+ */
+class MockOlaServer: public ola::proto::OlaServerService {
+  public:
+    explicit MockOlaServer(SelectServer *ss)
+        : m_ss(ss),
+          m_client_stub(NULL),
+          m_done(NULL),
+          m_timeout_id(ola::thread::INVALID_TIMEOUT) {
+    }
+
+    ~MockOlaServer() {
+      if (m_timeout_id != ola::thread::INVALID_TIMEOUT)
+        m_ss->RemoveTimeout(m_timeout_id);
+    }
+
+    void SetClientStub(ola::proto::OlaClientService_Stub *stub) {
+      m_client_stub = stub;
+    }
+
+    void RDMBatchGet(RpcController *controller,
+                     const ola::proto::RDMBatchRequest *request,
+                     ola::proto::Ack *response,
+                     CompletionCallback *done);
+
+    vector<unsigned int> batch_ids;
+    vector<unsigned int> batch_sizes;
+
+  private:
+    SelectServer *m_ss;
+    ola::proto::OlaClientService_Stub *m_client_stub;
+    vector<ola::proto::RDMBatchResponse> m_pending;
+    CompletionCallback *m_done;
+    ola::thread::timeout_id m_timeout_id;
+
+    bool SendResponses();
+
+    static const unsigned int RESPONSES_PER_TICK = 50;
+};
+
+
+void MockOlaServer::RDMBatchGet(RpcController *controller,
+                                const ola::proto::RDMBatchRequest *request,
+                                ola::proto::Ack *response,
+                                CompletionCallback *done) {
+  batch_ids.push_back(request->batch_id());
+  batch_sizes.push_back(request->item_size());
+
+  // m_pending is sent from the back, so this queues them in reverse order.
+  for (int i = 0; i < request->item_size(); i++) {
+    const ola::proto::RDMBatchItem &item = request->item(i);
+    ola::proto::RDMBatchResponse batch_response;
+    batch_response.set_batch_id(request->batch_id());
+    batch_response.set_index(i);
+
+    ola::proto::RDMResponse *rdm_response = batch_response.mutable_response();
+    rdm_response->set_response_code(ola::proto::RDM_COMPLETED_OK);
+    rdm_response->mutable_source_uid()->CopyFrom(item.uid());
+    ola::proto::UID *dest_uid = rdm_response->mutable_dest_uid();
+    dest_uid->set_esta_id(0x7a70);
+    dest_uid->set_device_id(0xfffffe00);
+    rdm_response->set_transaction_number(0);
+    rdm_response->set_response_type(ola::proto::RDM_ACK);
+    rdm_response->set_sub_device(item.sub_device());
+    rdm_response->set_command_class(ola::proto::RDM_GET_RESPONSE);
+    rdm_response->set_param_id(item.param_id());
+    m_pending.push_back(batch_response);
+  }
+  m_done = done;
+  m_timeout_id = m_ss->RegisterRepeatingTimeout(
+      1, ola::NewCallback(this, &MockOlaServer::SendResponses));
+  (void) controller;
+  (void) response;
+}
+
+
+/*
+ * Stream the next few responses, and ack the request once they've all been
+ * sent.
+ */
+bool MockOlaServer::SendResponses() {
+  for (unsigned int i = 0; i < RESPONSES_PER_TICK && !m_pending.empty();
+       i++) {
+    m_client_stub->StreamRDMBatchResponse(NULL, &m_pending.back(), NULL,
+                                          NULL);
+    m_pending.pop_back();
+  }
+
+  if (!m_pending.empty())
+    return true;
+
+  m_timeout_id = ola::thread::INVALID_TIMEOUT;
+  CompletionCallback *done = m_done;
+  m_done = NULL;
+  done->Run();
+  return false;
+}
+
+
+class OlaClientCoreTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(OlaClientCoreTest);
+  CPPUNIT_TEST(testRDMBatchGetChunking);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp();
+    void tearDown();
+    void testRDMBatchGetChunking();
+
+  private:
+    SelectServer m_ss;
+    auto_ptr<MockOlaServer> m_server;
+    auto_ptr<UnixSocket> m_socket;
+    auto_ptr<OlaClientCore> m_client;
+    auto_ptr<RpcChannel> m_server_channel;
+    auto_ptr<ola::proto::OlaClientService_Stub> m_client_stub;
+    vector<unsigned int> m_responses;
+    bool m_complete;
+    bool m_complete_ok;
+
+    void HandleResponse(unsigned int index,
+                        const RDMMetadata &metadata,
+                        const RDMResponse *response);
+    void BatchComplete(const Result &result);
+
+    static const unsigned int ABORT_TIMEOUT_IN_MS = 2000;
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(OlaClientCoreTest);
+
+
+void OlaClientCoreTest::setUp() {
+  m_complete = false;
+  m_complete_ok = false;
+  m_responses.clear();
+  m_server.reset(new MockOlaServer(&m_ss));
+
+  m_socket.reset(new UnixSocket());
+  OLA_ASSERT_TRUE(m_socket->Init());
+  m_client.reset(new OlaClientCore(m_socket.get()));
+  OLA_ASSERT_TRUE(m_client->Setup());
+  m_ss.AddReadDescriptor(m_socket.get());
+
+  UnixSocket *server_end = m_socket->OppositeEnd();
+  m_server_channel.reset(new RpcChannel(m_server.get(), server_end));
+  m_client_stub.reset(
+      new ola::proto::OlaClientService_Stub(m_server_channel.get()));
+  m_server->SetClientStub(m_client_stub.get());
+  m_ss.AddReadDescriptor(server_end);
+
+  m_ss.RegisterSingleTimeout(
+      ABORT_TIMEOUT_IN_MS,
+      ola::NewSingleCallback(&m_ss, &SelectServer::Terminate));
+}
+
+
+void OlaClientCoreTest::tearDown() {
+  m_ss.RemoveReadDescriptor(m_socket->OppositeEnd());
+  m_ss.RemoveReadDescriptor(m_socket.get());
+  m_client_stub.reset();
+  m_server_channel.reset();
+  m_client.reset();
+  m_socket.reset();
+  m_server.reset();
+}
+
+
+/*
+ * Check that a batch larger than the client's chunk size is split into
+ * multiple requests, and that each response is reported with its index in
+ * the original vector rather than the index within the chunk.
+ */
+void OlaClientCoreTest::testRDMBatchGetChunking() {
+  const unsigned int batch_size = 2500;
+  const UID uid(0x7a70, 1);
+
+  vector<RDMGetParams> gets;
+  for (unsigned int i = 0; i < batch_size; i++) {
+    gets.push_back(RDMGetParams(uid, 0, i));
+  }
+  m_responses.resize(batch_size, 0);
+
+  m_client->RDMBatchGet(
+      1, gets,
+      ola::NewCallback(this, &OlaClientCoreTest::HandleResponse),
+      ola::NewSingleCallback(this, &OlaClientCoreTest::BatchComplete));
+  m_ss.Run();
+
+  OLA_ASSERT_TRUE(m_complete);
+  OLA_ASSERT_TRUE(m_complete_ok);
+
+  // 1000 + 1000 + 500, all sharing the one batch id
+  OLA_ASSERT_EQ(static_cast<size_t>(3), m_server->batch_sizes.size());
+  OLA_ASSERT_EQ(1000u, m_server->batch_sizes[0]);
+  OLA_ASSERT_EQ(1000u, m_server->batch_sizes[1]);
+  OLA_ASSERT_EQ(500u, m_server->batch_sizes[2]);
+  OLA_ASSERT_EQ(m_server->batch_ids[0], m_server->batch_ids[1]);
+  OLA_ASSERT_EQ(m_server->batch_ids[0], m_server->batch_ids[2]);
+
+  for (unsigned int i = 0; i < batch_size; i++) {
+    OLA_ASSERT_EQ(1u, m_responses[i]);
+  }
+}
+
+
+void OlaClientCoreTest::HandleResponse(unsigned int index,
+                                       const RDMMetadata &metadata,
+                                       const RDMResponse *response) {
+  OLA_ASSERT_LT(index, static_cast<unsigned int>(m_responses.size()));
+  OLA_ASSERT_EQ(ola::rdm::RDM_COMPLETED_OK, metadata.response_code);
+  OLA_ASSERT_NOT_NULL(response);
+  // The PID was set to the index of the GET.
+  OLA_ASSERT_EQ(static_cast<uint16_t>(index), response->ParamId());
+  m_responses[index]++;
+}
+
+
+void OlaClientCoreTest::BatchComplete(const Result &result) {
+  m_complete = true;
+  m_complete_ok = result.Success();
+  m_ss.Terminate();
+}
@@ -94,6 +94,7 @@ bool OlaServerThread::Setup() {
   ola_options.http_enable_quit = false;
   ola_options.http_port = 0;
   ola_options.http_data_dir = "";
+  ola_options.rdm_status_budget = 0;
 
   // pick an unused port
   auto_ptr<OlaDaemon> olad(new OlaDaemon(ola_options, NULL));
@@ -51,18 +51,22 @@ void ClientBroker::RemoveClient(const Client *client) {
  * @param universe the universe to send the RDM request on
  * @param request the RDM request
  * @param callback the callback to run when the request completes
+ * @param priority the queueing priority of the request
  */
-void ClientBroker::SendRDMRequest(const Client *client,
-                                  Universe *universe,
-                                  const ola::rdm::RDMRequest *request,
-                                  ola::rdm::RDMCallback *callback) {
+void ClientBroker::SendRDMRequest(
+    const Client *client,
+    Universe *universe,
+    const ola::rdm::RDMRequest *request,
+    ola::rdm::RDMCallback *callback,
+    ola::rdm::QueueingRDMController::RequestPriority priority) {
   if (!STLContains(m_clients, client))
     OLA_WARN <<
       "Making an RDM call but the client doesn't exist in the broker!";
 
   universe->SendRDMRequest(request,
       NewSingleCallback(this, &ClientBroker::RequestComplete, client,
-                        callback));
+                        callback),
+      priority);
 }
 
 
@@ -28,6 +28,7 @@
 #include <string>
 #include <vector>
 #include "ola/base/Macro.h"
+#include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/Callback.h"
@@ -44,10 +45,13 @@ class ClientBroker {
     void AddClient(const Client *client);
     void RemoveClient(const Client *client);
 
-    void SendRDMRequest(const Client *client,
-                        Universe *universe,
-                        const ola::rdm::RDMRequest *request,
-                        ola::rdm::RDMCallback *callback);
+    void SendRDMRequest(
+        const Client *client,
+        Universe *universe,
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority =
+            ola::rdm::QueueingRDMController::INTERACTIVE_PRIORITY);
 
   private:
     void RequestComplete(const Client *key,
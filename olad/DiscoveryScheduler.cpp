@@ -0,0 +1,191 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * DiscoveryScheduler.cpp
+ * Schedules periodic RDM discovery across universes.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "olad/DiscoveryScheduler.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+
+namespace ola {
+
+/**
+ * Create a new DiscoveryScheduler
+ * @param universe_store the store to look universes up in
+ * @param scheduler the scheduler to use for the stagger timer
+ * @param max_concurrent the maximum number of universes to run discovery on
+ *   at once.
+ * @param stagger_ms the minimum time between starting discovery on two
+ *   universes, 0 starts them all at once.
+ * @param watchdog_ms how long to wait for a universe's discovery to complete
+ *   before releasing its slot.
+ */
+DiscoveryScheduler::DiscoveryScheduler(
+    UniverseStore *universe_store,
+    ola::thread::SchedulerInterface *scheduler,
+    unsigned int max_concurrent,
+    unsigned int stagger_ms,
+    unsigned int watchdog_ms)
+    : m_universe_store(universe_store),
+      m_scheduler(scheduler),
+      m_max_concurrent(max_concurrent ? max_concurrent : 1),
+      m_stagger_ms(stagger_ms),
+      m_watchdog_ms(watchdog_ms),
+      m_next_run_id(0),
+      m_stagger_timeout(ola::thread::INVALID_TIMEOUT) {
+}
+
+
+DiscoveryScheduler::~DiscoveryScheduler() {
+  if (m_stagger_timeout != ola::thread::INVALID_TIMEOUT)
+    m_scheduler->RemoveTimeout(m_stagger_timeout);
+
+  RunningMap::iterator iter = m_running.begin();
+  for (; iter != m_running.end(); ++iter)
+    m_scheduler->RemoveTimeout(iter->second.watchdog);
+}
+
+
+/**
+ * Queue discovery for a universe.
+ * If discovery is already queued for the universe the requests are merged,
+ * with full discovery taking precedence. Incremental discovery isn't queued
+ * for a universe that is already running discovery.
+ * @param universe_id the universe to run discovery on
+ * @param full true for full discovery, false for incremental.
+ */
+void DiscoveryScheduler::ScheduleDiscovery(unsigned int universe_id,
+                                           bool full) {
+  PendingQueue::iterator iter = m_pending.begin();
+  for (; iter != m_pending.end(); ++iter) {
+    if (iter->universe_id == universe_id) {
+      iter->full |= full;
+      return;
+    }
+  }
+
+  if (!full && m_running.find(universe_id) != m_running.end())
+    return;
+
+  PendingDiscovery discovery = {universe_id, full};
+  m_pending.push_back(discovery);
+  StartDiscovery();
+}
+
+
+/**
+ * Start discovery on as many queued universes as we can.
+ */
+void DiscoveryScheduler::StartDiscovery() {
+  while (m_stagger_timeout == ola::thread::INVALID_TIMEOUT &&
+         m_running.size() < m_max_concurrent) {
+    // find the first universe that isn't already running discovery
+    PendingQueue::iterator iter = m_pending.begin();
+    while (iter != m_pending.end() &&
+           m_running.find(iter->universe_id) != m_running.end())
+      ++iter;
+    if (iter == m_pending.end())
+      return;
+
+    PendingDiscovery discovery = *iter;
+    m_pending.erase(iter);
+
+    Universe *universe = m_universe_store->GetUniverse(discovery.universe_id);
+    if (!universe || !universe->IsActive())
+      continue;
+
+    // insert before starting discovery, the callback may run immediately.
+    RunningDiscovery running;
+    running.run_id = m_next_run_id++;
+    running.watchdog = m_scheduler->RegisterSingleTimeout(
+        m_watchdog_ms,
+        NewSingleCallback(this,
+                          &DiscoveryScheduler::WatchdogTimeout,
+                          discovery.universe_id,
+                          running.run_id));
+    m_running[discovery.universe_id] = running;
+    if (m_stagger_ms) {
+      m_stagger_timeout = m_scheduler->RegisterSingleTimeout(
+          m_stagger_ms,
+          NewSingleCallback(this, &DiscoveryScheduler::StaggerTimeout));
+    }
+
+    TimeStamp now;
+    m_clock.CurrentTime(&now);
+    universe->RunRDMDiscovery(
+        NewSingleCallback(this,
+                          &DiscoveryScheduler::DiscoveryComplete,
+                          discovery.universe_id,
+                          running.run_id,
+                          now),
+        discovery.full);
+  }
+}
+
+
+/**
+ * Called when the stagger timer expires.
+ */
+void DiscoveryScheduler::StaggerTimeout() {
+  m_stagger_timeout = ola::thread::INVALID_TIMEOUT;
+  StartDiscovery();
+}
+
+
+/**
+ * Called when discovery completes on a universe.
+ */
+void DiscoveryScheduler::DiscoveryComplete(unsigned int universe_id,
+                                           unsigned int run_id,
+                                           TimeStamp start_time,
+                                           const ola::rdm::UIDSet &uids) {
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  OLA_INFO << "RDM discovery for universe " << universe_id << " took "
+           << (now - start_time) << ", " << uids.Size() << " UIDs, "
+           << m_pending.size() << " universes waiting";
+
+  // The watchdog may have already released this run.
+  RunningMap::iterator iter = m_running.find(universe_id);
+  if (iter == m_running.end() || iter->second.run_id != run_id)
+    return;
+
+  m_scheduler->RemoveTimeout(iter->second.watchdog);
+  m_running.erase(iter);
+  StartDiscovery();
+}
+
+
+/**
+ * Called if discovery on a universe doesn't complete in time.
+ */
+void DiscoveryScheduler::WatchdogTimeout(unsigned int universe_id,
+                                         unsigned int run_id) {
+  RunningMap::iterator iter = m_running.find(universe_id);
+  if (iter == m_running.end() || iter->second.run_id != run_id)
+    return;
+
+  OLA_WARN << "RDM discovery for universe " << universe_id
+           << " didn't complete within " << m_watchdog_ms
+           << "ms, releasing its slot";
+  m_running.erase(iter);
+  StartDiscovery();
+}
+}  // namespace ola
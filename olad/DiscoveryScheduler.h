@@ -0,0 +1,98 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * DiscoveryScheduler.h
+ * Schedules periodic RDM discovery across universes.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * Each universe runs discovery on all its ports at once, so rather than
+ * starting discovery on every universe that's due in the same housekeeping
+ * pass, the scheduler runs up to max_concurrent universes at a time and
+ * staggers the starts. This spreads the DMX disruption caused by discovery
+ * over time while still sweeping large rigs in parallel.
+ *
+ * If a port or device is removed while discovery is running, the universe's
+ * discovery callback may never run. Each run has a watchdog, once it expires
+ * the universe's slot is released so other universes can proceed.
+ */
+
+#ifndef OLAD_DISCOVERYSCHEDULER_H_
+#define OLAD_DISCOVERYSCHEDULER_H_
+
+#include <deque>
+#include <map>
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+
+namespace ola {
+
+class DiscoveryScheduler {
+  public:
+    DiscoveryScheduler(class UniverseStore *universe_store,
+                       ola::thread::SchedulerInterface *scheduler,
+                       unsigned int max_concurrent = DEFAULT_MAX_CONCURRENT,
+                       unsigned int stagger_ms = DEFAULT_STAGGER_MS,
+                       unsigned int watchdog_ms = DEFAULT_WATCHDOG_MS);
+    ~DiscoveryScheduler();
+
+    void ScheduleDiscovery(unsigned int universe_id, bool full);
+
+    unsigned int PendingCount() const { return m_pending.size(); }
+    unsigned int RunningCount() const { return m_running.size(); }
+
+    static const unsigned int DEFAULT_MAX_CONCURRENT = 8;
+    static const unsigned int DEFAULT_STAGGER_MS = 500;
+    static const unsigned int DEFAULT_WATCHDOG_MS = 300000;
+
+  private:
+    typedef struct {
+      unsigned int universe_id;
+      bool full;
+    } PendingDiscovery;
+
+    typedef std::deque<PendingDiscovery> PendingQueue;
+
+    typedef struct {
+      unsigned int run_id;
+      ola::thread::timeout_id watchdog;
+    } RunningDiscovery;
+
+    typedef std::map<unsigned int, RunningDiscovery> RunningMap;
+
+    class UniverseStore *m_universe_store;
+    ola::thread::SchedulerInterface *m_scheduler;
+    const unsigned int m_max_concurrent;
+    const unsigned int m_stagger_ms;
+    const unsigned int m_watchdog_ms;
+    PendingQueue m_pending;
+    RunningMap m_running;
+    unsigned int m_next_run_id;
+    ola::thread::timeout_id m_stagger_timeout;
+    Clock m_clock;
+
+    void StartDiscovery();
+    void StaggerTimeout();
+    void DiscoveryComplete(unsigned int universe_id,
+                           unsigned int run_id,
+                           TimeStamp start_time,
+                           const ola::rdm::UIDSet &uids);
+    void WatchdogTimeout(unsigned int universe_id, unsigned int run_id);
+
+    DISALLOW_COPY_AND_ASSIGN(DiscoveryScheduler);
+};
+}  // namespace ola
+#endif  // OLAD_DISCOVERYSCHEDULER_H_
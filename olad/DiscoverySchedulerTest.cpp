@@ -0,0 +1,382 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * DiscoverySchedulerTest.cpp
+ * Test fixture for the DiscoveryScheduler class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/DiscoveryScheduler.h"
+#include "olad/Preferences.h"
+#include "olad/TestCommon.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::DiscoveryScheduler;
+using ola::Universe;
+using ola::rdm::RDMDiscoveryCallback;
+using ola::rdm::UIDSet;
+using ola::thread::timeout_id;
+using std::auto_ptr;
+using std::pair;
+using std::vector;
+
+static const unsigned int WATCHDOG_MS = 60000;
+
+
+/*
+ * A scheduler which only runs the single timeouts when asked to. Timeouts are
+ * grouped by their delay, so the stagger and watchdog timers can be run
+ * separately.
+ */
+class MockScheduler: public ola::thread::SchedulerInterface {
+  public:
+    MockScheduler() {}
+    ~MockScheduler() {
+      TimeoutVector::iterator iter = m_timeouts.begin();
+      for (; iter != m_timeouts.end(); ++iter)
+        delete iter->second;
+    }
+
+    timeout_id RegisterRepeatingTimeout(unsigned int,
+                                        ola::Callback0<bool>*) {
+      return ola::thread::INVALID_TIMEOUT;
+    }
+    timeout_id RegisterRepeatingTimeout(const ola::TimeInterval&,
+                                        ola::Callback0<bool>*) {
+      return ola::thread::INVALID_TIMEOUT;
+    }
+
+    timeout_id RegisterSingleTimeout(unsigned int ms,
+                                     ola::SingleUseCallback0<void> *closure) {
+      m_timeouts.push_back(TimeoutEntry(ms, closure));
+      return closure;
+    }
+    timeout_id RegisterSingleTimeout(const ola::TimeInterval &interval,
+                                     ola::SingleUseCallback0<void> *closure) {
+      return RegisterSingleTimeout(interval.InMilliSeconds(), closure);
+    }
+
+    void RemoveTimeout(timeout_id id) {
+      TimeoutVector::iterator iter = m_timeouts.begin();
+      for (; iter != m_timeouts.end(); ++iter) {
+        if (iter->second == id) {
+          delete iter->second;
+          m_timeouts.erase(iter);
+          return;
+        }
+      }
+    }
+
+    unsigned int TimeoutCount(unsigned int ms) const {
+      unsigned int count = 0;
+      TimeoutVector::const_iterator iter = m_timeouts.begin();
+      for (; iter != m_timeouts.end(); ++iter) {
+        if (iter->first == ms)
+          count++;
+      }
+      return count;
+    }
+
+    // Run the timeouts registered with a delay of ms.
+    void RunTimeouts(unsigned int ms) {
+      vector<ola::SingleUseCallback0<void>*> timeouts;
+      TimeoutVector::iterator iter = m_timeouts.begin();
+      while (iter != m_timeouts.end()) {
+        if (iter->first == ms) {
+          timeouts.push_back(iter->second);
+          iter = m_timeouts.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+      vector<ola::SingleUseCallback0<void>*>::iterator run_iter =
+          timeouts.begin();
+      for (; run_iter != timeouts.end(); ++run_iter)
+        (*run_iter)->Run();
+    }
+
+  private:
+    typedef pair<unsigned int, ola::SingleUseCallback0<void>*> TimeoutEntry;
+    typedef vector<TimeoutEntry> TimeoutVector;
+
+    TimeoutVector m_timeouts;
+};
+
+
+/*
+ * An RDM port which holds on to the discovery callback until Complete() is
+ * called.
+ */
+class AsyncDiscoveryPort: public TestMockRDMOutputPort {
+  public:
+    AsyncDiscoveryPort(unsigned int port_id, UIDSet *uids)
+        : TestMockRDMOutputPort(NULL, port_id, uids),
+          m_uids(uids),
+          m_full(false) {
+    }
+
+    void RunFullDiscovery(RDMDiscoveryCallback *on_complete) {
+      m_full = true;
+      m_callback.reset(on_complete);
+    }
+
+    void RunIncrementalDiscovery(RDMDiscoveryCallback *on_complete) {
+      m_full = false;
+      m_callback.reset(on_complete);
+    }
+
+    bool DiscoveryRunning() const { return m_callback.get(); }
+    bool FullDiscovery() const { return m_full; }
+
+    void Complete() {
+      RDMDiscoveryCallback *callback = m_callback.release();
+      callback->Run(*m_uids);
+    }
+
+  private:
+    UIDSet *m_uids;
+    bool m_full;
+    auto_ptr<RDMDiscoveryCallback> m_callback;
+};
+
+
+class DiscoverySchedulerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(DiscoverySchedulerTest);
+  CPPUNIT_TEST(testConcurrency);
+  CPPUNIT_TEST(testStagger);
+  CPPUNIT_TEST(testMerging);
+  CPPUNIT_TEST(testWatchdog);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    void setUp();
+    void tearDown();
+    void testConcurrency();
+    void testStagger();
+    void testMerging();
+    void testWatchdog();
+
+  private:
+    ola::MemoryPreferences *m_preferences;
+    ola::UniverseStore *m_store;
+    UIDSet m_uids;
+    vector<AsyncDiscoveryPort*> m_ports;
+
+    void AddPorts(unsigned int count);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(DiscoverySchedulerTest);
+
+
+void DiscoverySchedulerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+}
+
+
+void DiscoverySchedulerTest::tearDown() {
+  vector<AsyncDiscoveryPort*>::iterator iter = m_ports.begin();
+  for (; iter != m_ports.end(); ++iter) {
+    (*iter)->GetUniverse()->RemovePort(*iter);
+    delete *iter;
+  }
+  m_ports.clear();
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Create a universe with a single port for universes 1 to count.
+ */
+void DiscoverySchedulerTest::AddPorts(unsigned int count) {
+  for (unsigned int i = 1; i <= count; i++) {
+    Universe *universe = m_store->GetUniverseOrCreate(i);
+    OLA_ASSERT_NOT_NULL(universe);
+    AsyncDiscoveryPort *port = new AsyncDiscoveryPort(i, &m_uids);
+    universe->AddPort(port);
+    port->SetUniverse(universe);
+    m_ports.push_back(port);
+  }
+}
+
+
+/*
+ * Check that no more than max_concurrent universes run discovery at once.
+ */
+void DiscoverySchedulerTest::testConcurrency() {
+  AddPorts(3);
+  MockScheduler scheduler;
+  DiscoveryScheduler discovery_scheduler(m_store, &scheduler, 2, 0,
+                                         WATCHDOG_MS);
+
+  for (unsigned int i = 1; i <= 3; i++)
+    discovery_scheduler.ScheduleDiscovery(i, false);
+  OLA_ASSERT_EQ(2u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_TRUE(m_ports[0]->DiscoveryRunning());
+  OLA_ASSERT_TRUE(m_ports[1]->DiscoveryRunning());
+  OLA_ASSERT_FALSE(m_ports[2]->DiscoveryRunning());
+  OLA_ASSERT_FALSE(m_ports[0]->FullDiscovery());
+  OLA_ASSERT_EQ(0u, scheduler.TimeoutCount(0));
+  OLA_ASSERT_EQ(2u, scheduler.TimeoutCount(WATCHDOG_MS));
+
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(2u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_TRUE(m_ports[2]->DiscoveryRunning());
+
+  m_ports[0]->Complete();
+  m_ports[2]->Complete();
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, scheduler.TimeoutCount(WATCHDOG_MS));
+
+  // universes that don't exist are skipped
+  discovery_scheduler.ScheduleDiscovery(10, false);
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, discovery_scheduler.PendingCount());
+}
+
+
+/*
+ * Check that the starts are staggered.
+ */
+void DiscoverySchedulerTest::testStagger() {
+  AddPorts(3);
+  MockScheduler scheduler;
+  DiscoveryScheduler discovery_scheduler(m_store, &scheduler, 3, 100,
+                                         WATCHDOG_MS);
+
+  for (unsigned int i = 1; i <= 3; i++)
+    discovery_scheduler.ScheduleDiscovery(i, false);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(2u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(100));
+
+  // completing discovery doesn't skip the stagger
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_FALSE(m_ports[1]->DiscoveryRunning());
+
+  scheduler.RunTimeouts(100);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_TRUE(m_ports[1]->DiscoveryRunning());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(100));
+
+  scheduler.RunTimeouts(100);
+  OLA_ASSERT_EQ(2u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_TRUE(m_ports[2]->DiscoveryRunning());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(100));
+  scheduler.RunTimeouts(100);
+  OLA_ASSERT_EQ(0u, scheduler.TimeoutCount(100));
+
+  m_ports[1]->Complete();
+  m_ports[2]->Complete();
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, scheduler.TimeoutCount(WATCHDOG_MS));
+}
+
+
+/*
+ * Check that requests for the same universe are merged.
+ */
+void DiscoverySchedulerTest::testMerging() {
+  AddPorts(2);
+  MockScheduler scheduler;
+  DiscoveryScheduler discovery_scheduler(m_store, &scheduler, 1, 0,
+                                         WATCHDOG_MS);
+
+  discovery_scheduler.ScheduleDiscovery(1, false);
+  discovery_scheduler.ScheduleDiscovery(2, false);
+  discovery_scheduler.ScheduleDiscovery(2, true);
+  discovery_scheduler.ScheduleDiscovery(2, false);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+
+  // incremental discovery for a running universe is dropped
+  discovery_scheduler.ScheduleDiscovery(1, false);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+
+  m_ports[0]->Complete();
+  OLA_ASSERT_TRUE(m_ports[1]->DiscoveryRunning());
+  OLA_ASSERT_TRUE(m_ports[1]->FullDiscovery());
+
+  // but full discovery is queued until the current run completes
+  discovery_scheduler.ScheduleDiscovery(2, true);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_TRUE(m_ports[1]->DiscoveryRunning());
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+}
+
+
+/*
+ * Check that the watchdog releases the slot of a universe whose discovery
+ * never completes, e.g. because the port was removed.
+ */
+void DiscoverySchedulerTest::testWatchdog() {
+  AddPorts(2);
+  MockScheduler scheduler;
+  DiscoveryScheduler discovery_scheduler(m_store, &scheduler, 1, 0,
+                                         WATCHDOG_MS);
+
+  discovery_scheduler.ScheduleDiscovery(1, false);
+  discovery_scheduler.ScheduleDiscovery(2, false);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(WATCHDOG_MS));
+  OLA_ASSERT_FALSE(m_ports[1]->DiscoveryRunning());
+
+  // universe 1 never completes, the watchdog lets universe 2 run
+  scheduler.RunTimeouts(WATCHDOG_MS);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, discovery_scheduler.PendingCount());
+  OLA_ASSERT_TRUE(m_ports[1]->DiscoveryRunning());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(WATCHDOG_MS));
+
+  // a late result from universe 1 doesn't release universe 2's slot
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(1u, scheduler.TimeoutCount(WATCHDOG_MS));
+
+  // universe 1 can be scheduled again
+  discovery_scheduler.ScheduleDiscovery(1, false);
+  OLA_ASSERT_EQ(1u, discovery_scheduler.PendingCount());
+
+  m_ports[1]->Complete();
+  OLA_ASSERT_EQ(1u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_TRUE(m_ports[0]->DiscoveryRunning());
+  m_ports[0]->Complete();
+  OLA_ASSERT_EQ(0u, discovery_scheduler.RunningCount());
+  OLA_ASSERT_EQ(0u, scheduler.TimeoutCount(WATCHDOG_MS));
+}
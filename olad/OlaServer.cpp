@@ -44,6 +44,7 @@
 #include "olad/Client.h"
 #include "olad/ClientBroker.h"
 #include "olad/DeviceManager.h"
+#include "olad/DiscoveryScheduler.h"
 #include "olad/OlaServer.h"
 #include "olad/OlaServerServiceImpl.h"
 #include "olad/Plugin.h"
@@ -53,6 +54,7 @@
 #include "olad/PortBroker.h"
 #include "olad/PortManager.h"
 #include "olad/Preferences.h"
+#include "olad/RDMStatusCollector.h"
 #include "olad/Universe.h"
 #include "olad/UniverseStore.h"
 
@@ -128,12 +130,15 @@ OlaServer::~OlaServer() {
     CleanupConnection(iter->second);
   }
 
+  m_rdm_status_collector.reset();
   m_broker.reset();
   m_port_broker.reset();
 
   if (m_accepting_socket && m_accepting_socket->ValidReadDescriptor())
     m_ss->RemoveReadDescriptor(m_accepting_socket);
 
+  m_discovery_scheduler.reset();
+
   if (m_universe_store.get()) {
     m_universe_store->DeleteAll();
     m_universe_store.reset();
@@ -203,6 +208,8 @@ bool OlaServer::Init() {
   m_universe_preferences->Load();
   m_universe_store.reset(
       new UniverseStore(m_universe_preferences, m_export_map));
+  m_discovery_scheduler.reset(
+      new DiscoveryScheduler(m_universe_store.get(), m_ss));
 
   m_port_broker.reset(new PortBroker());
   m_port_manager.reset(
@@ -228,6 +235,19 @@ bool OlaServer::Init() {
       m_ss->WakeUpTime(),
       m_default_uid));
 
+  if (m_options.rdm_status_budget) {
+    m_rdm_status_collector.reset(new RDMStatusCollector(
+        m_universe_store.get(),
+        m_broker.get(),
+        m_ss,
+        &m_clock,
+        m_default_uid,
+        NewCallback(m_service_impl.get(),
+                    &OlaServerServiceImpl::HandleRDMStatus),
+        m_options.rdm_status_budget));
+    m_rdm_status_collector->Start();
+  }
+
   // The plugin load procedure can take a while so we run it in the main loop.
   m_ss->Execute(
       ola::NewSingleCallback(m_plugin_manager.get(), &PluginManager::LoadAll));
@@ -327,8 +347,8 @@ bool OlaServer::RunHousekeeping() {
     if ((*iter)->IsActive() &&
         (*iter)->RDMDiscoveryInterval().Seconds() &&
         *now - (*iter)->LastRDMDiscovery() > (*iter)->RDMDiscoveryInterval()) {
-      // run incremental discovery
-      (*iter)->RunRDMDiscovery(NULL, false);
+      // queue incremental discovery
+      m_discovery_scheduler->ScheduleDiscovery((*iter)->UniverseId(), false);
     }
   }
   return true;
@@ -431,6 +451,7 @@ void OlaServer::InternalNewConnection(
 void OlaServer::CleanupConnection(ClientEntry client_entry) {
   Client *client = client_entry.client_service->GetClient();
   m_broker->RemoveClient(client);
+  m_service_impl->RemoveRDMStatusClient(client);
 
   vector<Universe*> universe_list;
   m_universe_store->GetList(&universe_list);
@@ -65,6 +65,8 @@ class OlaServer {
       string http_data_dir;  // directory that contains the static content
       string interface;
       string pid_data_dir;  // directory with the pid definitions.
+      // the % of RDM bus time used to poll for status messages, 0 disables
+      unsigned int rdm_status_budget;
     };
 
 
@@ -114,6 +116,8 @@ class OlaServer {
     auto_ptr<class PluginManager> m_plugin_manager;
     auto_ptr<class PluginAdaptor> m_plugin_adaptor;
     auto_ptr<class UniverseStore> m_universe_store;
+    auto_ptr<class DiscoveryScheduler> m_discovery_scheduler;
+    auto_ptr<class RDMStatusCollector> m_rdm_status_collector;
     auto_ptr<class PortManager> m_port_manager;
     auto_ptr<class OlaServerServiceImpl> m_service_impl;
     auto_ptr<class ClientBroker> m_broker;
@@ -125,6 +129,7 @@ class OlaServer {
     auto_ptr<OladHTTPServer_t> m_httpd;
     const Options m_options;
     ola::rdm::UID m_default_uid;
+    Clock m_clock;
 
 #ifdef HAVE_LIBMICROHTTPD
     bool StartHttpServer(const ola::network::Interface &interface);
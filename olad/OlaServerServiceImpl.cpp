@@ -20,6 +20,7 @@
  */
 
 #include <algorithm>
+#include <map>
 #include <set>
 #include <string>
 #include <vector>
@@ -31,6 +32,8 @@
 #include "ola/Logging.h"
 #include "ola/rdm/UIDSet.h"
 #include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/stl/STLUtils.h"
 #include "ola/timecode/TimeCode.h"
 #include "ola/timecode/TimeCodeEnums.h"
 #include "olad/Client.h"
@@ -42,6 +45,7 @@
 #include "olad/PluginManager.h"
 #include "olad/Port.h"
 #include "olad/PortManager.h"
+#include "olad/RDMBatchRunner.h"
 #include "olad/Universe.h"
 #include "olad/UniverseStore.h"
 
@@ -749,6 +753,183 @@ void OlaServerServiceImpl::RDMDiscoveryCommand(
 }
 
 
+/*
+ * Create a RDMBatchRunner for a batch of RDM GETs. The caller starts the
+ * runner once it's stored it.
+ * @returns the new RDMBatchRunner, or NULL if the universe doesn't exist, in
+ *   which case on_complete has already been run.
+ */
+RDMBatchRunner *OlaServerServiceImpl::NewRDMBatchRunner(
+    RpcController* controller,
+    const ola::proto::RDMBatchRequest* request,
+    const UID *uid,
+    class Client *client,
+    SingleUseCallback0<void> *on_complete) {
+  Universe *universe = m_universe_store->GetUniverse(request->universe());
+  if (!universe) {
+    MissingUniverseError(controller);
+    on_complete->Run();
+    return NULL;
+  }
+
+  RDMBatchRunner *runner = new RDMBatchRunner(
+      m_broker,
+      client,
+      m_universe_store,
+      universe->UniverseId(),
+      RDMBatchRunner::MAX_IN_FLIGHT_PER_PORT,
+      request->interactive() ?
+        ola::rdm::QueueingRDMController::INTERACTIVE_PRIORITY :
+        ola::rdm::QueueingRDMController::BACKGROUND_PRIORITY,
+      NewCallback(this,
+                  &OlaServerServiceImpl::HandleRDMBatchResponse,
+                  client,
+                  static_cast<unsigned int>(request->batch_id()),
+                  request->include_raw_response()),
+      on_complete);
+
+  UID source_uid = uid ? *uid : m_uid;
+  for (int i = 0; i < request->item_size(); ++i) {
+    const ola::proto::RDMBatchItem &item = request->item(i);
+    UID destination(item.uid().esta_id(), item.uid().device_id());
+    runner->AddRequest(new ola::rdm::RDMGetRequest(
+        source_uid,
+        destination,
+        0,  // transaction #
+        1,  // port id
+        0,  // message count
+        item.sub_device(),
+        item.param_id(),
+        reinterpret_cast<const uint8_t*>(item.data().data()),
+        item.data().size()));
+  }
+  return runner;
+}
+
+
+/*
+ * Run a batch of RDM GETs.
+ */
+void OlaClientService::RDMBatchGet(
+    RpcController* controller,
+    const ola::proto::RDMBatchRequest* request,
+    ola::proto::Ack*,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  if (STLContains(m_rdm_batches, request->batch_id())) {
+    controller->SetFailed("RDM batch id already in use");
+    done->Run();
+    return;
+  }
+
+  RDMBatchRunner *runner = m_impl->NewRDMBatchRunner(
+      controller, request, m_uid, m_client,
+      NewSingleCallback(this,
+                        &OlaClientService::RDMBatchComplete,
+                        static_cast<unsigned int>(request->batch_id()),
+                        done));
+  if (runner) {
+    m_rdm_batches[request->batch_id()] = runner;
+    runner->Start();
+  }
+}
+
+
+/*
+ * Called when all the requests in a RDM batch have completed.
+ */
+void OlaClientService::RDMBatchComplete(
+    unsigned int batch_id,
+    ola::rpc::RpcService::CompletionCallback* done) {
+  delete STLLookupAndRemovePtr(&m_rdm_batches, batch_id);
+  done->Run();
+}
+
+
+/*
+ * Register or unregister a client for the RDM status updates.
+ */
+void OlaServerServiceImpl::RegisterForRDMStatus(
+    RpcController*,
+    const ola::proto::RegisterRDMStatusRequest* request,
+    Ack*,
+    ola::rpc::RpcService::CompletionCallback* done,
+    Client *client) {
+  ClosureRunner runner(done);
+  if (request->action() == ola::proto::REGISTER) {
+    if (request->has_universe())
+      m_rdm_status_universes[request->universe()].insert(client);
+    else
+      m_rdm_status_clients.insert(client);
+  } else if (request->has_universe()) {
+    set<Client*> *clients = STLFind(&m_rdm_status_universes,
+                                    static_cast<unsigned int>(
+                                        request->universe()));
+    if (clients)
+      clients->erase(client);
+  } else {
+    RemoveRDMStatusClient(client);
+  }
+}
+
+
+/*
+ * Called by the RDMStatusCollector when a responder returns a queued message
+ * or status messages. This sends the update to the registered clients.
+ */
+void OlaServerServiceImpl::HandleRDMStatus(unsigned int universe,
+                                           const RDMResponse *response) {
+  set<Client*> clients = m_rdm_status_clients;
+  set<Client*> *universe_clients = STLFind(&m_rdm_status_universes, universe);
+  if (universe_clients)
+    clients.insert(universe_clients->begin(), universe_clients->end());
+  if (clients.empty())
+    return;
+
+  ola::proto::RDMStatusUpdate update;
+  update.set_universe(universe);
+  SetProtoUID(response->SourceUID(), update.mutable_uid());
+  update.set_sub_device(response->SubDevice());
+  update.set_param_id(response->ParamId());
+  update.set_data(response->ParamData(), response->ParamDataSize());
+
+  if (response->ParamId() == ola::rdm::PID_STATUS_MESSAGES) {
+    static const unsigned int STATUS_MESSAGE_SIZE = 9;
+    const uint8_t *data = response->ParamData();
+    for (unsigned int i = 0;
+         i + STATUS_MESSAGE_SIZE <= response->ParamDataSize();
+         i += STATUS_MESSAGE_SIZE) {
+      ola::proto::RDMStatusMessage *message = update.add_status_message();
+      message->set_sub_device((data[i] << 8) + data[i + 1]);
+      message->set_status_type(data[i + 2]);
+      message->set_status_message_id((data[i + 3] << 8) + data[i + 4]);
+      message->set_data_value1(
+          static_cast<int16_t>((data[i + 5] << 8) + data[i + 6]));
+      message->set_data_value2(
+          static_cast<int16_t>((data[i + 7] << 8) + data[i + 8]));
+    }
+  }
+
+  set<Client*>::iterator iter = clients.begin();
+  for (; iter != clients.end(); ++iter) {
+    if ((*iter)->Stub())
+      (*iter)->Stub()->UpdateRDMStatus(NULL, &update, NULL, NULL);
+  }
+}
+
+
+/*
+ * Remove a client from the RDM status updates, this is called when the client
+ * disconnects.
+ */
+void OlaServerServiceImpl::RemoveRDMStatusClient(Client *client) {
+  m_rdm_status_clients.erase(client);
+  std::map<unsigned int, set<Client*> >::iterator iter =
+      m_rdm_status_universes.begin();
+  for (; iter != m_rdm_status_universes.end(); ++iter)
+    iter->second.erase(client);
+}
+
+
 /*
  * Set this client's source UID
  */
@@ -801,6 +982,45 @@ void OlaServerServiceImpl::HandleRDMResponse(
     const RDMResponse *rdm_response,
     const vector<string> &packets) {
   ClosureRunner runner(done);
+  PopulateRDMResponse(response, include_raw_packets, code, rdm_response,
+                      packets);
+  delete rdm_response;
+}
+
+
+/*
+ * Called as each request in a RDM batch completes. This streams the response
+ * back to the client.
+ */
+void OlaServerServiceImpl::HandleRDMBatchResponse(
+    Client *client,
+    unsigned int batch_id,
+    bool include_raw_packets,
+    unsigned int index,
+    ola::rdm::rdm_response_code code,
+    const RDMResponse *rdm_response,
+    const vector<string> &packets) {
+  if (!client || !client->Stub())
+    return;
+
+  ola::proto::RDMBatchResponse batch_response;
+  batch_response.set_batch_id(batch_id);
+  batch_response.set_index(index);
+  PopulateRDMResponse(batch_response.mutable_response(), include_raw_packets,
+                      code, rdm_response, packets);
+  client->Stub()->StreamRDMBatchResponse(NULL, &batch_response, NULL, NULL);
+}
+
+
+/*
+ * Copy a RDM response into the protobuf.
+ */
+void OlaServerServiceImpl::PopulateRDMResponse(
+    ola::proto::RDMResponse* response,
+    bool include_raw_packets,
+    ola::rdm::rdm_response_code code,
+    const RDMResponse *rdm_response,
+    const vector<string> &packets) {
   response->set_response_code(
       static_cast<ola::proto::RDMResponseCode>(code));
 
@@ -856,8 +1076,6 @@ void OlaServerServiceImpl::HandleRDMResponse(
     }
   }
 
-  delete rdm_response;
-
   if (include_raw_packets) {
     vector<string>::const_iterator iter = packets.begin();
     for (; iter != packets.end(); ++iter) {
@@ -983,6 +1201,7 @@ void OlaServerServiceImpl::SetProtoUID(const ola::rdm::UID &uid,
 // OlaClientService
 // ----------------------------------------------------------------------------
 OlaClientService::~OlaClientService() {
+  STLDeleteValues(&m_rdm_batches);
   if (m_uid)
     delete m_uid;
 }
@@ -18,6 +18,8 @@
  * Copyright (C) 2005 - 2008 Simon Newton
  */
 
+#include <map>
+#include <set>
 #include <vector>
 #include <string>
 #include "common/protocol/Ola.pb.h"
@@ -148,6 +150,18 @@ class OlaServerServiceImpl {
                              ola::rpc::RpcService::CompletionCallback* done,
                              const UID *uid,
                              class Client *client);
+    class RDMBatchRunner *NewRDMBatchRunner(
+        RpcController* controller,
+        const ::ola::proto::RDMBatchRequest* request,
+        const UID *uid,
+        class Client *client,
+        SingleUseCallback0<void> *on_complete);
+    void RegisterForRDMStatus(
+        RpcController* controller,
+        const ::ola::proto::RegisterRDMStatusRequest* request,
+        Ack* response,
+        ola::rpc::RpcService::CompletionCallback* done,
+        class Client *client);
     void SetSourceUID(RpcController* controller,
                       const ::ola::proto::UID* request,
                       ola::proto::Ack* response,
@@ -158,6 +172,10 @@ class OlaServerServiceImpl {
                       ::ola::proto::Ack* response,
                       ola::rpc::RpcService::CompletionCallback* done);
 
+    void HandleRDMStatus(unsigned int universe,
+                         const ola::rdm::RDMResponse *response);
+    void RemoveRDMStatusClient(class Client *client);
+
   private:
     void HandleRDMResponse(ola::proto::RDMResponse* response,
                            ola::rpc::RpcService::CompletionCallback* done,
@@ -165,6 +183,18 @@ class OlaServerServiceImpl {
                            ola::rdm::rdm_response_code code,
                            const ola::rdm::RDMResponse *rdm_response,
                            const std::vector<std::string> &packets);
+    void HandleRDMBatchResponse(class Client *client,
+                                unsigned int batch_id,
+                                bool include_raw_packets,
+                                unsigned int index,
+                                ola::rdm::rdm_response_code code,
+                                const ola::rdm::RDMResponse *rdm_response,
+                                const std::vector<std::string> &packets);
+    void PopulateRDMResponse(ola::proto::RDMResponse* response,
+                             bool include_raw_packets,
+                             ola::rdm::rdm_response_code code,
+                             const ola::rdm::RDMResponse *rdm_response,
+                             const std::vector<std::string> &packets);
     void RDMDiscoveryComplete(unsigned int universe,
                               ola::rpc::RpcService::CompletionCallback* done,
                               ola::proto::UIDListReply *response,
@@ -195,6 +225,10 @@ class OlaServerServiceImpl {
     class ClientBroker *m_broker;
     const class TimeStamp *m_wake_up_time;
     ola::rdm::UID m_uid;
+    // the clients registered for RDM status updates from all universes
+    std::set<class Client*> m_rdm_status_clients;
+    // the clients registered for RDM status updates, by universe
+    std::map<unsigned int, std::set<class Client*> > m_rdm_status_universes;
 };
 
 
@@ -350,6 +384,20 @@ class OlaClientService: public ola::proto::OlaServerService {
                                   m_client);
     }
 
+    void RDMBatchGet(RpcController* controller,
+                     const ::ola::proto::RDMBatchRequest* request,
+                     ola::proto::Ack* response,
+                     ola::rpc::RpcService::CompletionCallback* done);
+
+    void RegisterForRDMStatus(
+        RpcController* controller,
+        const ::ola::proto::RegisterRDMStatusRequest* request,
+        Ack* response,
+        ola::rpc::RpcService::CompletionCallback* done) {
+      m_impl->RegisterForRDMStatus(controller, request, response, done,
+                                   m_client);
+    }
+
     void SetSourceUID(RpcController* controller,
                       const ::ola::proto::UID* request,
                       ola::proto::Ack* response,
@@ -368,6 +416,11 @@ class OlaClientService: public ola::proto::OlaServerService {
     class Client *m_client;
     OlaServerServiceImpl *m_impl;
     ola::rdm::UID *m_uid;
+    // the RDM batches in progress, keyed by batch id
+    std::map<unsigned int, class RDMBatchRunner*> m_rdm_batches;
+
+    void RDMBatchComplete(unsigned int batch_id,
+                          ola::rpc::RpcService::CompletionCallback* done);
 };
 
 
@@ -57,6 +57,9 @@ DEFINE_string(pid_location, PID_DATA_DIR,
               "The directory containing the PID definitions");
 DEFINE_s_uint16(http_port, p, ola::OlaServer::DEFAULT_HTTP_PORT,
                 "Port to run the http server on");
+DEFINE_uint8(rdm_status_budget, 0,
+             "The percentage of RDM bus time to use for polling responders "
+             "for status messages, 0 disables polling");
 
 
 /**
@@ -116,6 +119,7 @@ int main(int argc, char *argv[]) {
   options.http_data_dir = FLAGS_http_data_dir.str();
   options.interface = FLAGS_interface.str();
   options.pid_data_dir = FLAGS_pid_location.str();
+  options.rdm_status_budget = FLAGS_rdm_status_budget;
 
   std::auto_ptr<OlaDaemon> olad(new OlaDaemon(options, &export_map));
   if (!olad.get()) {
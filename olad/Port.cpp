@@ -208,6 +208,17 @@ void BasicOutputPort::SendRDMRequest(const ola::rdm::RDMRequest *request,
 }
 
 
+/*
+ * Ports that don't queue RDM requests ignore the priority.
+ */
+void BasicOutputPort::SendPrioritizedRDMRequest(
+    const ola::rdm::RDMRequest *request,
+    ola::rdm::RDMCallback *callback,
+    ola::rdm::QueueingRDMController::RequestPriority) {
+  SendRDMRequest(request, callback);
+}
+
+
 /*
  * This is a noop for ports that don't support RDM
  */
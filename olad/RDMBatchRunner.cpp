@@ -0,0 +1,194 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMBatchRunner.cpp
+ * Sends a batch of RDM requests to a universe.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <map>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/QueueingRDMController.h"
+#include "olad/ClientBroker.h"
+#include "olad/RDMBatchRunner.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+
+namespace ola {
+
+using ola::rdm::QueueingRDMController;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using std::string;
+using std::vector;
+
+/**
+ * Create a new RDMBatchRunner
+ * @param broker the ClientBroker to send the requests through
+ * @param client the client the batch belongs to
+ * @param universe_store the store to look the universe up in
+ * @param universe_id the universe to send the requests on
+ * @param max_in_flight_per_port the maximum number of requests to have
+ *   outstanding on each output port.
+ * @param priority the priority to send the requests at.
+ * @param on_response the callback to run as each request completes, ownership
+ *   is transferred.
+ * @param on_complete the callback to run once all the requests have
+ *   completed, ownership is transferred. This may delete the runner.
+ */
+RDMBatchRunner::RDMBatchRunner(ClientBroker *broker,
+                               const Client *client,
+                               UniverseStore *universe_store,
+                               unsigned int universe_id,
+                               unsigned int max_in_flight_per_port,
+                               QueueingRDMController::RequestPriority priority,
+                               ResponseCallback *on_response,
+                               SingleUseCallback0<void> *on_complete)
+    : m_broker(broker),
+      m_client(client),
+      m_universe_store(universe_store),
+      m_universe_id(universe_id),
+      m_max_in_flight_per_port(
+          max_in_flight_per_port ? max_in_flight_per_port : 1),
+      m_priority(priority),
+      m_on_response(on_response),
+      m_on_complete(on_complete),
+      m_request_count(0),
+      m_pending_count(0),
+      m_in_flight(0),
+      m_started(false),
+      m_sending(false) {
+}
+
+
+/**
+ * Clean up. Any requests in flight are left to the ClientBroker, which drops
+ * the responses once the client has been removed.
+ */
+RDMBatchRunner::~RDMBatchRunner() {
+  std::map<UID, RequestQueue>::iterator iter = m_queues.begin();
+  for (; iter != m_queues.end(); ++iter) {
+    RequestQueue::iterator request_iter = iter->second.begin();
+    for (; request_iter != iter->second.end(); ++request_iter)
+      delete request_iter->second;
+  }
+  delete m_on_response;
+  delete m_on_complete;
+}
+
+
+/**
+ * Add a request to the batch. This must be called before Start().
+ * @param request the request to send, ownership is transferred.
+ */
+void RDMBatchRunner::AddRequest(const RDMRequest *request) {
+  RequestQueue &queue = m_queues[request->DestinationUID()];
+  if (queue.empty())
+    m_uid_order.push_back(&queue);
+  queue.push_back(PendingRequest(m_request_count++, request));
+  m_pending_count++;
+}
+
+
+/**
+ * Start sending the requests.
+ */
+void RDMBatchRunner::Start() {
+  m_started = true;
+  SendRequests();
+}
+
+
+/**
+ * Send requests until every port with requests waiting has reached the in
+ * flight limit. Requests may complete synchronously, so this is guarded
+ * against re-entry.
+ */
+void RDMBatchRunner::SendRequests() {
+  if (m_sending || !m_started)
+    return;
+
+  m_sending = true;
+  while (true) {
+    // Find the first UID in the round robin order whose port isn't busy. UIDs
+    // that are skipped keep their place.
+    Universe *universe = m_universe_store->GetUniverse(m_universe_id);
+    const OutputPort *port = NULL;
+    std::deque<RequestQueue*>::iterator iter = m_uid_order.begin();
+    for (; iter != m_uid_order.end(); ++iter) {
+      port = universe ?
+          universe->OutputPortForUID((*iter)->front().second->DestinationUID())
+          : NULL;
+      if (m_port_in_flight[port] < m_max_in_flight_per_port)
+        break;
+    }
+    if (iter == m_uid_order.end())
+      break;
+
+    RequestQueue *queue = *iter;
+    m_uid_order.erase(iter);
+    PendingRequest request = queue->front();
+    queue->pop_front();
+    if (!queue->empty())
+      m_uid_order.push_back(queue);
+    m_pending_count--;
+    m_in_flight++;
+    m_port_in_flight[port]++;
+
+    if (universe) {
+      m_broker->SendRDMRequest(
+          m_client,
+          universe,
+          request.second,
+          NewSingleCallback(this,
+                            &RDMBatchRunner::RequestComplete,
+                            port,
+                            request.first),
+          m_priority);
+    } else {
+      delete request.second;
+      vector<string> packets;
+      RequestComplete(port, request.first, ola::rdm::RDM_FAILED_TO_SEND, NULL,
+                      packets);
+    }
+  }
+  m_sending = false;
+
+  if (m_uid_order.empty() && !m_in_flight && m_on_complete) {
+    SingleUseCallback0<void> *on_complete = m_on_complete;
+    m_on_complete = NULL;
+    on_complete->Run();
+  }
+}
+
+
+/**
+ * Called when a request completes.
+ */
+void RDMBatchRunner::RequestComplete(const OutputPort *port,
+                                     unsigned int index,
+                                     ola::rdm::rdm_response_code code,
+                                     const ola::rdm::RDMResponse *response,
+                                     const vector<string> &packets) {
+  m_in_flight--;
+  m_port_in_flight[port]--;
+  m_on_response->Run(index, code, response, packets);
+  delete response;
+  SendRequests();
+}
+}  // namespace ola
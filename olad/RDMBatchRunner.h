@@ -0,0 +1,109 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMBatchRunner.h
+ * Sends a batch of RDM requests to a universe.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * Rather than handing every request in the batch to the universe at once,
+ * which would overflow the port queues and hold up requests from other
+ * clients, the runner keeps a limited number in flight on each output port.
+ * The requests are sent round robin between the destination UIDs, so a
+ * single slow responder doesn't stall the rest of the batch, and UIDs on a
+ * busy port are skipped in favour of those on idle ones.
+ */
+
+#ifndef OLAD_RDMBATCHRUNNER_H_
+#define OLAD_RDMBATCHRUNNER_H_
+
+#include <deque>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/QueueingRDMController.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+
+namespace ola {
+
+class RDMBatchRunner {
+  public:
+    /*
+     * Run as each request completes, with the index of the request within
+     * the batch. The response is deleted once the callback returns.
+     */
+    typedef Callback4<void,
+                      unsigned int,
+                      ola::rdm::rdm_response_code,
+                      const ola::rdm::RDMResponse*,
+                      const std::vector<std::string>&> ResponseCallback;
+
+    RDMBatchRunner(class ClientBroker *broker,
+                   const class Client *client,
+                   class UniverseStore *universe_store,
+                   unsigned int universe_id,
+                   unsigned int max_in_flight_per_port,
+                   ola::rdm::QueueingRDMController::RequestPriority priority,
+                   ResponseCallback *on_response,
+                   SingleUseCallback0<void> *on_complete);
+    ~RDMBatchRunner();
+
+    void AddRequest(const ola::rdm::RDMRequest *request);
+    void Start();
+
+    unsigned int PendingCount() const { return m_pending_count; }
+    unsigned int InFlightCount() const { return m_in_flight; }
+
+    static const unsigned int MAX_IN_FLIGHT_PER_PORT = 4;
+
+  private:
+    typedef std::pair<unsigned int, const ola::rdm::RDMRequest*>
+      PendingRequest;
+    typedef std::deque<PendingRequest> RequestQueue;
+
+    class ClientBroker *m_broker;
+    const class Client *m_client;
+    class UniverseStore *m_universe_store;
+    const unsigned int m_universe_id;
+    const unsigned int m_max_in_flight_per_port;
+    const ola::rdm::QueueingRDMController::RequestPriority m_priority;
+    ResponseCallback *m_on_response;
+    SingleUseCallback0<void> *m_on_complete;
+    std::map<ola::rdm::UID, RequestQueue> m_queues;
+    // the queues with requests left to send, in round robin order
+    std::deque<RequestQueue*> m_uid_order;
+    unsigned int m_request_count;
+    unsigned int m_pending_count;
+    unsigned int m_in_flight;
+    // requests in flight per port, UIDs not in the universe use NULL.
+    std::map<const class OutputPort*, unsigned int> m_port_in_flight;
+    bool m_started;
+    bool m_sending;
+
+    void SendRequests();
+    void RequestComplete(const class OutputPort *port,
+                         unsigned int index,
+                         ola::rdm::rdm_response_code code,
+                         const ola::rdm::RDMResponse *response,
+                         const std::vector<std::string> &packets);
+
+    DISALLOW_COPY_AND_ASSIGN(RDMBatchRunner);
+};
+}  // namespace ola
+#endif  // OLAD_RDMBATCHRUNNER_H_
@@ -0,0 +1,435 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMBatchRunnerTest.cpp
+ * Test fixture for the RDMBatchRunner class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/rdm/QueueingRDMController.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "olad/Client.h"
+#include "olad/ClientBroker.h"
+#include "olad/Preferences.h"
+#include "olad/RDMBatchRunner.h"
+#include "olad/TestCommon.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::Client;
+using ola::ClientBroker;
+using ola::NewCallback;
+using ola::NewSingleCallback;
+using ola::RDMBatchRunner;
+using ola::Universe;
+using ola::rdm::QueueingRDMController;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMRequest;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::pair;
+using std::string;
+using std::vector;
+
+
+/*
+ * A RDM port which records the priority of each request.
+ */
+class PriorityRecordingRDMOutputPort: public TestMockRDMOutputPort {
+  public:
+    PriorityRecordingRDMOutputPort(unsigned int port_id, UIDSet *uids)
+        : TestMockRDMOutputPort(NULL, port_id, uids, true) {
+    }
+
+    void SendPrioritizedRDMRequest(
+        const RDMRequest *request,
+        RDMCallback *callback,
+        QueueingRDMController::RequestPriority priority) {
+      priorities.push_back(priority);
+      SendRDMRequest(request, callback);
+    }
+
+    vector<QueueingRDMController::RequestPriority> priorities;
+};
+
+
+class RDMBatchRunnerTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMBatchRunnerTest);
+  CPPUNIT_TEST(testScheduling);
+  CPPUNIT_TEST(testPerPortLimit);
+  CPPUNIT_TEST(testSynchronousResponses);
+  CPPUNIT_TEST(testMissingUniverse);
+  CPPUNIT_TEST(testPriority);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    RDMBatchRunnerTest()
+        : m_source_uid(0x7a70, 100),
+          m_uid1(0x7a70, 1),
+          m_uid2(0x7a70, 2),
+          m_uid3(0x7a70, 3),
+          m_client(NULL),
+          m_complete_count(0) {
+    }
+
+    void setUp();
+    void tearDown();
+    void testScheduling();
+    void testPerPortLimit();
+    void testSynchronousResponses();
+    void testMissingUniverse();
+    void testPriority();
+
+  private:
+    typedef vector<pair<const RDMRequest*, RDMCallback*> > HeldRequests;
+
+    UID m_source_uid, m_uid1, m_uid2, m_uid3;
+    UIDSet m_uids;
+    ola::MemoryPreferences *m_preferences;
+    ola::UniverseStore *m_store;
+    Client m_client;
+    ClientBroker m_broker;
+    HeldRequests m_held_requests;
+    vector<pair<unsigned int, ola::rdm::rdm_response_code> > m_responses;
+    unsigned int m_complete_count;
+
+    RDMBatchRunner *NewRunner(
+        unsigned int universe_id,
+        unsigned int max_in_flight_per_port,
+        QueueingRDMController::RequestPriority priority =
+          QueueingRDMController::BACKGROUND_PRIORITY);
+    void AddRequest(RDMBatchRunner *runner, const UID &uid, uint16_t pid);
+    void CompleteRequest(unsigned int i);
+    void HoldRequest(const RDMRequest *request, RDMCallback *callback);
+    void ReturnTimeout(const RDMRequest *request, RDMCallback *callback);
+    void HandleResponse(unsigned int index,
+                        ola::rdm::rdm_response_code code,
+                        const ola::rdm::RDMResponse *response,
+                        const vector<string> &packets);
+    void BatchComplete() { m_complete_count++; }
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMBatchRunnerTest);
+
+static const unsigned int TEST_UNIVERSE = 1;
+
+
+void RDMBatchRunnerTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_broker.AddClient(&m_client);
+  m_uids.AddUID(m_uid1);
+  m_uids.AddUID(m_uid2);
+  m_uids.AddUID(m_uid3);
+}
+
+
+void RDMBatchRunnerTest::tearDown() {
+  m_broker.RemoveClient(&m_client);
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Check that requests are sent round robin between the UIDs, and that no more
+ * than max_in_flight_per_port are outstanding.
+ */
+void RDMBatchRunnerTest::testScheduling() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMBatchRunnerTest::HoldRequest));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  RDMBatchRunner *runner = NewRunner(TEST_UNIVERSE, 2);
+  AddRequest(runner, m_uid1, 0x8001);
+  AddRequest(runner, m_uid1, 0x8002);
+  AddRequest(runner, m_uid1, 0x8003);
+  AddRequest(runner, m_uid2, 0x8001);
+  AddRequest(runner, m_uid2, 0x8002);
+  AddRequest(runner, m_uid3, 0x8001);
+  OLA_ASSERT_EQ(6u, runner->PendingCount());
+
+  runner->Start();
+  OLA_ASSERT_EQ(2u, runner->InFlightCount());
+  OLA_ASSERT_EQ(4u, runner->PendingCount());
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(m_held_requests.size()));
+  OLA_ASSERT_EQ(m_uid1, m_held_requests[0].first->DestinationUID());
+  OLA_ASSERT_EQ(m_uid2, m_held_requests[1].first->DestinationUID());
+
+  // completing a request sends the next one
+  CompleteRequest(1);
+  OLA_ASSERT_EQ(1u, static_cast<unsigned int>(m_responses.size()));
+  OLA_ASSERT_EQ(3u, m_responses[0].first);
+  OLA_ASSERT_EQ(2u, runner->InFlightCount());
+  OLA_ASSERT_EQ(m_uid3, m_held_requests[2].first->DestinationUID());
+
+  CompleteRequest(0);
+  CompleteRequest(2);
+  OLA_ASSERT_EQ(m_uid1, m_held_requests[3].first->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8002),
+                m_held_requests[3].first->ParamId());
+  OLA_ASSERT_EQ(m_uid2, m_held_requests[4].first->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8002),
+                m_held_requests[4].first->ParamId());
+
+  CompleteRequest(3);
+  CompleteRequest(4);
+  OLA_ASSERT_EQ(m_uid1, m_held_requests[5].first->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8003),
+                m_held_requests[5].first->ParamId());
+  OLA_ASSERT_EQ(0u, m_complete_count);
+
+  CompleteRequest(5);
+  OLA_ASSERT_EQ(1u, m_complete_count);
+  OLA_ASSERT_EQ(6u, static_cast<unsigned int>(m_responses.size()));
+  OLA_ASSERT_EQ(2u, m_responses[5].first);
+  OLA_ASSERT_EQ(ola::rdm::RDM_TIMEOUT, m_responses[5].second);
+  delete runner;
+
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that the in flight limit applies to each port, and that UIDs on a
+ * busy port don't hold up those on an idle one.
+ */
+void RDMBatchRunnerTest::testPerPortLimit() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  UIDSet port1_uids, port2_uids;
+  port1_uids.AddUID(m_uid1);
+  port1_uids.AddUID(m_uid2);
+  port2_uids.AddUID(m_uid3);
+  TestMockRDMOutputPort port1(NULL, 1, &port1_uids, true);
+  TestMockRDMOutputPort port2(NULL, 2, &port2_uids, true);
+  port1.SetRDMHandler(NewCallback(this, &RDMBatchRunnerTest::HoldRequest));
+  port2.SetRDMHandler(NewCallback(this, &RDMBatchRunnerTest::HoldRequest));
+  universe->AddPort(&port1);
+  port1.SetUniverse(universe);
+  universe->AddPort(&port2);
+  port2.SetUniverse(universe);
+
+  RDMBatchRunner *runner = NewRunner(TEST_UNIVERSE, 1);
+  AddRequest(runner, m_uid1, 0x8001);
+  AddRequest(runner, m_uid1, 0x8002);
+  AddRequest(runner, m_uid2, 0x8001);
+  AddRequest(runner, m_uid3, 0x8001);
+  AddRequest(runner, m_uid3, 0x8002);
+
+  // one request on each port, uid2 waits for port 1
+  runner->Start();
+  OLA_ASSERT_EQ(2u, runner->InFlightCount());
+  OLA_ASSERT_EQ(3u, runner->PendingCount());
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(m_held_requests.size()));
+  OLA_ASSERT_EQ(m_uid1, m_held_requests[0].first->DestinationUID());
+  OLA_ASSERT_EQ(m_uid3, m_held_requests[1].first->DestinationUID());
+
+  // port 1 frees up and uid2 goes next
+  CompleteRequest(0);
+  OLA_ASSERT_EQ(2u, runner->InFlightCount());
+  OLA_ASSERT_EQ(m_uid2, m_held_requests[2].first->DestinationUID());
+
+  // port 2 frees up, the port 1 requests are still limited to one
+  CompleteRequest(1);
+  OLA_ASSERT_EQ(2u, runner->InFlightCount());
+  OLA_ASSERT_EQ(m_uid3, m_held_requests[3].first->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8002),
+                m_held_requests[3].first->ParamId());
+
+  CompleteRequest(2);
+  OLA_ASSERT_EQ(m_uid1, m_held_requests[4].first->DestinationUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8002),
+                m_held_requests[4].first->ParamId());
+  CompleteRequest(3);
+  CompleteRequest(4);
+  OLA_ASSERT_EQ(0u, runner->InFlightCount());
+  OLA_ASSERT_EQ(1u, m_complete_count);
+  OLA_ASSERT_EQ(5u, static_cast<unsigned int>(m_responses.size()));
+  delete runner;
+
+  universe->RemovePort(&port1);
+  universe->RemovePort(&port2);
+}
+
+
+/*
+ * Check that a large batch of requests that complete synchronously works.
+ */
+void RDMBatchRunnerTest::testSynchronousResponses() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMBatchRunnerTest::ReturnTimeout));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  RDMBatchRunner *runner = NewRunner(TEST_UNIVERSE, 4);
+  for (uint16_t i = 0; i < 1000; i++)
+    AddRequest(runner, i % 2 ? m_uid1 : m_uid2, 0x8000 + i);
+
+  runner->Start();
+  OLA_ASSERT_EQ(1u, m_complete_count);
+  OLA_ASSERT_EQ(1000u, static_cast<unsigned int>(m_responses.size()));
+  OLA_ASSERT_EQ(0u, runner->InFlightCount());
+  OLA_ASSERT_EQ(0u, runner->PendingCount());
+  delete runner;
+
+  // an empty batch completes straight away
+  runner = NewRunner(TEST_UNIVERSE, 4);
+  runner->Start();
+  OLA_ASSERT_EQ(2u, m_complete_count);
+  delete runner;
+
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that requests fail if the universe has gone away.
+ */
+void RDMBatchRunnerTest::testMissingUniverse() {
+  RDMBatchRunner *runner = NewRunner(TEST_UNIVERSE, 4);
+  AddRequest(runner, m_uid1, 0x8001);
+  AddRequest(runner, m_uid2, 0x8001);
+  runner->Start();
+
+  OLA_ASSERT_EQ(1u, m_complete_count);
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(m_responses.size()));
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_responses[0].second);
+  OLA_ASSERT_EQ(ola::rdm::RDM_FAILED_TO_SEND, m_responses[1].second);
+  delete runner;
+
+  // deleting a runner that hasn't completed cleans up the requests
+  runner = NewRunner(TEST_UNIVERSE, 4);
+  AddRequest(runner, m_uid1, 0x8001);
+  delete runner;
+  OLA_ASSERT_EQ(1u, m_complete_count);
+}
+
+
+/*
+ * Check that requests are sent at the priority of the batch.
+ */
+void RDMBatchRunnerTest::testPriority() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  PriorityRecordingRDMOutputPort port(1, &m_uids);
+  port.SetRDMHandler(NewCallback(this, &RDMBatchRunnerTest::ReturnTimeout));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  RDMBatchRunner *runner = NewRunner(TEST_UNIVERSE, 4);
+  AddRequest(runner, m_uid1, 0x8001);
+  runner->Start();
+  delete runner;
+
+  runner = NewRunner(TEST_UNIVERSE, 4,
+                     QueueingRDMController::INTERACTIVE_PRIORITY);
+  AddRequest(runner, m_uid1, 0x8001);
+  AddRequest(runner, m_uid2, 0x8001);
+  runner->Start();
+  delete runner;
+
+  OLA_ASSERT_EQ(2u, m_complete_count);
+  OLA_ASSERT_EQ(3u, static_cast<unsigned int>(port.priorities.size()));
+  OLA_ASSERT_EQ(QueueingRDMController::BACKGROUND_PRIORITY,
+                port.priorities[0]);
+  OLA_ASSERT_EQ(QueueingRDMController::INTERACTIVE_PRIORITY,
+                port.priorities[1]);
+  OLA_ASSERT_EQ(QueueingRDMController::INTERACTIVE_PRIORITY,
+                port.priorities[2]);
+
+  universe->RemovePort(&port);
+}
+
+
+RDMBatchRunner *RDMBatchRunnerTest::NewRunner(
+    unsigned int universe_id,
+    unsigned int max_in_flight_per_port,
+    QueueingRDMController::RequestPriority priority) {
+  return new RDMBatchRunner(
+      &m_broker, &m_client, m_store, universe_id, max_in_flight_per_port,
+      priority,
+      NewCallback(this, &RDMBatchRunnerTest::HandleResponse),
+      NewSingleCallback(this, &RDMBatchRunnerTest::BatchComplete));
+}
+
+
+void RDMBatchRunnerTest::AddRequest(RDMBatchRunner *runner,
+                                    const UID &uid,
+                                    uint16_t pid) {
+  runner->AddRequest(new ola::rdm::RDMGetRequest(
+      m_source_uid,
+      uid,
+      0,  // transaction #
+      1,  // port id
+      0,  // message count
+      0,  // sub device
+      pid,
+      NULL,
+      0));
+}
+
+
+/*
+ * Time out a request that was held by the port.
+ */
+void RDMBatchRunnerTest::CompleteRequest(unsigned int i) {
+  OLA_ASSERT_LT(i, static_cast<unsigned int>(m_held_requests.size()));
+  delete m_held_requests[i].first;
+  vector<string> packets;
+  m_held_requests[i].second->Run(ola::rdm::RDM_TIMEOUT, NULL, packets);
+}
+
+
+void RDMBatchRunnerTest::HoldRequest(const RDMRequest *request,
+                                     RDMCallback *callback) {
+  m_held_requests.push_back(
+      pair<const RDMRequest*, RDMCallback*>(request, callback));
+}
+
+
+void RDMBatchRunnerTest::ReturnTimeout(const RDMRequest *request,
+                                       RDMCallback *callback) {
+  delete request;
+  vector<string> packets;
+  callback->Run(ola::rdm::RDM_TIMEOUT, NULL, packets);
+}
+
+
+void RDMBatchRunnerTest::HandleResponse(unsigned int index,
+                                        ola::rdm::rdm_response_code code,
+                                        const ola::rdm::RDMResponse*,
+                                        const vector<string>&) {
+  m_responses.push_back(
+      pair<unsigned int, ola::rdm::rdm_response_code>(index, code));
+}
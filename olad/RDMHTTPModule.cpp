@@ -396,7 +396,8 @@ int RDMHTTPModule::JsonSupportedPIDs(const HTTPRequest *request,
 /**
  * Return a list of sections to display in the RDM control panel.
  * We use the response from SUPPORTED_PARAMS and DEVICE_INFO to decide which
- * pids exist.
+ * pids exist. The list is cached for SUPPORTED_SECTIONS_TTL seconds, so
+ * repeated requests for a UID don't all go to the device.
  * @param request the HTTPRequest
  * @param response the HTTPResponse
  * @returns MHD_NO or MHD_YES
@@ -413,21 +414,49 @@ int RDMHTTPModule::JsonSupportedSections(const HTTPRequest *request,
   if (!CheckForInvalidUid(request, &uid))
     return OladHTTPServer::ServeHelpRedirect(response);
 
-  string error;
-  bool ok = m_rdm_api.GetSupportedParameters(
-      universe_id,
-      *uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SupportedSectionsHandler,
-                        response,
-                        universe_id,
-                        *uid),
-      &error);
-  delete uid;
+  uid_resolution_state *uid_state = GetUniverseUids(universe_id);
+  if (uid_state) {
+    map<UID, cached_sections>::iterator iter =
+      uid_state->supported_sections.find(*uid);
+    if (iter != uid_state->supported_sections.end()) {
+      TimeStamp now;
+      m_clock.CurrentTime(&now);
+      if (now < iter->second.expiry) {
+        delete uid;
+        SendSupportedSections(response, iter->second.sections);
+        return MHD_YES;
+      }
+      uid_state->supported_sections.erase(iter);
+    }
+  }
 
-  if (!ok)
-    return m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR);
+  // SUPPORTED_PARAMS & DEVICE_INFO don't depend on each other, so they're
+  // sent together.
+  supported_sections_info info_init = {universe_id, *uid};
+  supported_sections_info *info = new supported_sections_info(info_init);
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = universe_id;
+  AddBatchGet(
+      batch, *uid, ola::rdm::PID_SUPPORTED_PARAMETERS,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetSupportedParameters,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::SupportedSectionsParamsHandler,
+                            info)));
+  AddBatchGet(
+      batch, *uid, ola::rdm::PID_DEVICE_INFO,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetDeviceDescriptor,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::SupportedSectionsDeviceInfoHandler,
+                            info)));
+  SendBatch(batch, NewSingleCallback(this,
+                                     &RDMHTTPModule::SupportedSectionsHandler,
+                                     response,
+                                     info));
+  delete uid;
   return MHD_YES;
 }
 
@@ -592,6 +621,12 @@ int RDMHTTPModule::JsonSaveSectionInfo(const HTTPRequest *request,
     return OladHTTPServer::ServeHelpRedirect(response);
   }
 
+  // Changing the personality or resetting the device can change the
+  // footprint and hence the sections, so fetch them again next time.
+  uid_resolution_state *uid_state = GetUniverseUids(universe_id);
+  if (uid_state)
+    uid_state->supported_sections.erase(*uid);
+
   delete uid;
   if (!error.empty())
     return RespondWithError(response, error);
@@ -700,6 +735,16 @@ void RDMHTTPModule::HandleUIDList(HTTPResponse *response,
     }
   }
 
+  // and the sections for devices that have gone away
+  map<UID, cached_sections>::iterator section_iter =
+    uid_state->supported_sections.begin();
+  while (section_iter != uid_state->supported_sections.end()) {
+    if (uids.Contains(section_iter->first))
+      ++section_iter;
+    else
+      uid_state->supported_sections.erase(section_iter++);
+  }
+
   if (!uid_state->uid_resolution_running)
     ResolveNextUID(universe_id);
 }
@@ -932,46 +977,68 @@ void RDMHTTPModule::SupportedParamsHandler(
 
 
 /**
- * Takes the supported pids for a device and come up with the list of sections
- * to display in the RDM panel
+ * Handle the supported params part of the supported sections request.
  */
-void RDMHTTPModule::SupportedSectionsHandler(
-    HTTPResponse *response,
-    unsigned int universe_id,
-    UID uid,
+void RDMHTTPModule::SupportedSectionsParamsHandler(
+    supported_sections_info *info,
     const ola::rdm::ResponseStatus &status,
-    const vector<uint16_t> &pid_list) {
-  string error;
+    const vector<uint16_t> &pids) {
+  info->pid_status = status;
+  info->pids = pids;
+}
 
+
+/**
+ * Handle the device info part of the supported sections request.
+ */
+void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
+    supported_sections_info *info,
+    const ola::rdm::ResponseStatus &status,
+    const ola::rdm::DeviceDescriptor &device) {
+  info->device_status = status;
+  info->device = device;
+}
+
+
+/**
+ * Called once both parts of the supported sections request have completed.
+ * This builds the list of sections and caches it if the device responded to
+ * both requests.
+ */
+void RDMHTTPModule::SupportedSectionsHandler(HTTPResponse *response,
+                                             supported_sections_info *info) {
   // nacks here are ok if the device doesn't support SUPPORTED_PARAMS
-  if (!CheckForRDMSuccess(status) && !status.WasNacked()) {
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  if (!CheckForRDMSuccess(info->pid_status) && !info->pid_status.WasNacked()) {
+    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR);
+    delete info;
     return;
   }
 
-  m_rdm_api.GetDeviceInfo(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SupportedSectionsDeviceInfoHandler,
-                        response,
-                        pid_list),
-      &error);
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  vector<section_info> sections;
+  BuildSupportedSections(info->pids, info->device_status, info->device,
+                         &sections);
+  if (info->device_status.WasAcked()) {
+    uid_resolution_state *uid_state =
+      GetUniverseUidsOrCreate(info->universe_id);
+    cached_sections &entry = uid_state->supported_sections[info->uid];
+    entry.sections = sections;
+    m_clock.CurrentTime(&entry.expiry);
+    entry.expiry += TimeInterval(SUPPORTED_SECTIONS_TTL, 0);
+  }
+  SendSupportedSections(response, sections);
+  delete info;
 }
 
 
 /**
- * Handle the second part of the supported sections request.
+ * Takes the supported pids and device info for a device and come up with the
+ * list of sections to display in the RDM panel
  */
-void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
-    HTTPResponse *response,
-    const vector<uint16_t> pid_list,
+void RDMHTTPModule::BuildSupportedSections(
+    const vector<uint16_t> &pid_list,
     const ola::rdm::ResponseStatus &status,
-    const ola::rdm::DeviceDescriptor &device) {
-  vector<section_info> sections;
+    const ola::rdm::DeviceDescriptor &device,
+    vector<section_info> *sections) {
   std::set<uint16_t> pids;
   copy(pid_list.begin(), pid_list.end(), inserter(pids, pids.end()));
 
@@ -979,9 +1046,9 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
   string hint;
   if (pids.find(ola::rdm::PID_DEVICE_MODEL_DESCRIPTION) != pids.end())
       hint.push_back('m');  // m is for device model
-  AddSection(&sections, DEVICE_INFO_SECTION, DEVICE_INFO_SECTION_NAME, hint);
+  AddSection(sections, DEVICE_INFO_SECTION, DEVICE_INFO_SECTION_NAME, hint);
 
-  AddSection(&sections, IDENTIFY_SECTION, IDENTIFY_SECTION_NAME);
+  AddSection(sections, IDENTIFY_SECTION, IDENTIFY_SECTION_NAME);
 
   bool dmx_address_added = false;
   bool include_software_version = false;
@@ -989,29 +1056,29 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
   for (; iter != pids.end(); ++iter) {
     switch (*iter) {
       case ola::rdm::PID_PROXIED_DEVICES:
-        AddSection(&sections, PROXIED_DEVICES_SECTION,
+        AddSection(sections, PROXIED_DEVICES_SECTION,
                    PROXIED_DEVICES_SECTION_NAME);
         break;
       case ola::rdm::PID_COMMS_STATUS:
-        AddSection(&sections, COMMS_STATUS_SECTION, COMMS_STATUS_SECTION_NAME);
+        AddSection(sections, COMMS_STATUS_SECTION, COMMS_STATUS_SECTION_NAME);
         break;
       case ola::rdm::PID_PRODUCT_DETAIL_ID_LIST:
-        AddSection(&sections, PRODUCT_DETAIL_SECTION,
+        AddSection(sections, PRODUCT_DETAIL_SECTION,
                    PRODUCT_DETAIL_SECTION_NAME);
         break;
       case ola::rdm::PID_MANUFACTURER_LABEL:
-        AddSection(&sections, MANUFACTURER_LABEL_SECTION,
+        AddSection(sections, MANUFACTURER_LABEL_SECTION,
                    MANUFACTURER_LABEL_SECTION_NAME);
         break;
       case ola::rdm::PID_DEVICE_LABEL:
-        AddSection(&sections, DEVICE_LABEL_SECTION, DEVICE_LABEL_SECTION_NAME);
+        AddSection(sections, DEVICE_LABEL_SECTION, DEVICE_LABEL_SECTION_NAME);
         break;
       case ola::rdm::PID_FACTORY_DEFAULTS:
-        AddSection(&sections, FACTORY_DEFAULTS_SECTION,
+        AddSection(sections, FACTORY_DEFAULTS_SECTION,
                    FACTORY_DEFAULTS_SECTION_NAME);
         break;
       case ola::rdm::PID_LANGUAGE:
-        AddSection(&sections, LANGUAGE_SECTION, LANGUAGE_SECTION_NAME);
+        AddSection(sections, LANGUAGE_SECTION, LANGUAGE_SECTION_NAME);
         break;
       case ola::rdm::PID_BOOT_SOFTWARE_VERSION_ID:
       case ola::rdm::PID_BOOT_SOFTWARE_VERSION_LABEL:
@@ -1019,69 +1086,69 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
         break;
       case ola::rdm::PID_DMX_PERSONALITY:
         if (pids.find(ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION) == pids.end())
-          AddSection(&sections, PERSONALITY_SECTION, PERSONALITY_SECTION_NAME);
+          AddSection(sections, PERSONALITY_SECTION, PERSONALITY_SECTION_NAME);
         else
-          AddSection(&sections, PERSONALITY_SECTION, PERSONALITY_SECTION_NAME,
+          AddSection(sections, PERSONALITY_SECTION, PERSONALITY_SECTION_NAME,
                      "l");
         break;
       case ola::rdm::PID_DMX_START_ADDRESS:
-        AddSection(&sections, DMX_ADDRESS_SECTION, DMX_ADDRESS_SECTION_NAME);
+        AddSection(sections, DMX_ADDRESS_SECTION, DMX_ADDRESS_SECTION_NAME);
         dmx_address_added = true;
         break;
       case ola::rdm::PID_DEVICE_HOURS:
-        AddSection(&sections, DEVICE_HOURS_SECTION, DEVICE_HOURS_SECTION_NAME);
+        AddSection(sections, DEVICE_HOURS_SECTION, DEVICE_HOURS_SECTION_NAME);
         break;
       case ola::rdm::PID_LAMP_HOURS:
-        AddSection(&sections, LAMP_HOURS_SECTION, LAMP_HOURS_SECTION_NAME);
+        AddSection(sections, LAMP_HOURS_SECTION, LAMP_HOURS_SECTION_NAME);
         break;
       case ola::rdm::PID_LAMP_STRIKES:
-        AddSection(&sections, LAMP_STRIKES_SECTION, LAMP_STRIKES_SECTION_NAME);
+        AddSection(sections, LAMP_STRIKES_SECTION, LAMP_STRIKES_SECTION_NAME);
         break;
       case ola::rdm::PID_LAMP_STATE:
-        AddSection(&sections, LAMP_STATE_SECTION, LAMP_STATE_SECTION_NAME);
+        AddSection(sections, LAMP_STATE_SECTION, LAMP_STATE_SECTION_NAME);
         break;
       case ola::rdm::PID_LAMP_ON_MODE:
-        AddSection(&sections, LAMP_MODE_SECTION, LAMP_MODE_SECTION_NAME);
+        AddSection(sections, LAMP_MODE_SECTION, LAMP_MODE_SECTION_NAME);
         break;
       case ola::rdm::PID_DEVICE_POWER_CYCLES:
-        AddSection(&sections, POWER_CYCLES_SECTION, POWER_CYCLES_SECTION_NAME);
+        AddSection(sections, POWER_CYCLES_SECTION, POWER_CYCLES_SECTION_NAME);
         break;
       case ola::rdm::PID_DISPLAY_INVERT:
-        AddSection(&sections, DISPLAY_INVERT_SECTION,
+        AddSection(sections, DISPLAY_INVERT_SECTION,
                    DISPLAY_INVERT_SECTION_NAME);
         break;
       case ola::rdm::PID_DISPLAY_LEVEL:
-        AddSection(&sections, DISPLAY_LEVEL_SECTION,
+        AddSection(sections, DISPLAY_LEVEL_SECTION,
                    DISPLAY_LEVEL_SECTION_NAME);
         break;
       case ola::rdm::PID_PAN_INVERT:
-        AddSection(&sections, PAN_INVERT_SECTION, PAN_INVERT_SECTION_NAME);
+        AddSection(sections, PAN_INVERT_SECTION, PAN_INVERT_SECTION_NAME);
         break;
       case ola::rdm::PID_TILT_INVERT:
-        AddSection(&sections, TILT_INVERT_SECTION, TILT_INVERT_SECTION_NAME);
+        AddSection(sections, TILT_INVERT_SECTION, TILT_INVERT_SECTION_NAME);
         break;
       case ola::rdm::PID_PAN_TILT_SWAP:
-        AddSection(&sections, PAN_TILT_SWAP_SECTION,
+        AddSection(sections, PAN_TILT_SWAP_SECTION,
                    PAN_TILT_SWAP_SECTION_NAME);
         break;
       case ola::rdm::PID_REAL_TIME_CLOCK:
-        AddSection(&sections, CLOCK_SECTION, CLOCK_SECTION_NAME);
+        AddSection(sections, CLOCK_SECTION, CLOCK_SECTION_NAME);
         break;
       case ola::rdm::PID_POWER_STATE:
-        AddSection(&sections, POWER_STATE_SECTION, POWER_STATE_SECTION_NAME);
+        AddSection(sections, POWER_STATE_SECTION, POWER_STATE_SECTION_NAME);
         break;
       case ola::rdm::PID_RESET_DEVICE:
-        AddSection(&sections, RESET_DEVICE_SECTION, RESET_DEVICE_SECTION_NAME);
+        AddSection(sections, RESET_DEVICE_SECTION, RESET_DEVICE_SECTION_NAME);
         break;
     }
   }
 
   if (include_software_version)
-    AddSection(&sections, BOOT_SOFTWARE_SECTION, BOOT_SOFTWARE_SECTION_NAME);
+    AddSection(sections, BOOT_SOFTWARE_SECTION, BOOT_SOFTWARE_SECTION_NAME);
 
   if (CheckForRDMSuccess(status)) {
     if (device.dmx_footprint && !dmx_address_added)
-      AddSection(&sections, DMX_ADDRESS_SECTION, DMX_ADDRESS_SECTION_NAME);
+      AddSection(sections, DMX_ADDRESS_SECTION, DMX_ADDRESS_SECTION_NAME);
     if (device.sensor_count &&
         pids.find(ola::rdm::PID_SENSOR_DEFINITION) != pids.end() &&
         pids.find(ola::rdm::PID_SENSOR_VALUE) != pids.end()) {
@@ -1090,13 +1157,21 @@ void RDMHTTPModule::SupportedSectionsDeviceInfoHandler(
         stringstream heading, hint;
         hint << i;
         heading << "Sensor " << std::setfill(' ') << std::setw(3) << (i + 1);
-        AddSection(&sections, SENSOR_SECTION, heading.str(), hint.str());
+        AddSection(sections, SENSOR_SECTION, heading.str(), hint.str());
       }
     }
   }
 
-  sort(sections.begin(), sections.end(), lt_section_info());
+  sort(sections->begin(), sections->end(), lt_section_info());
+}
+
 
+/**
+ * Send the list of sections for a device.
+ */
+void RDMHTTPModule::SendSupportedSections(
+    HTTPResponse *response,
+    const vector<section_info> &sections) {
   JsonArray json;
   vector<section_info>::const_iterator section_iter = sections.begin();
   for (; section_iter != sections.end(); ++section_iter) {
@@ -1236,26 +1311,50 @@ void RDMHTTPModule::ProxiedDevicesHandler(
 
 
 /*
- * Handle the request for the device info section.
+ * Handle the request for the device info section. The software version label,
+ * device model description and device info are fetched in one batch.
  */
 string RDMHTTPModule::GetDeviceInfo(const HTTPRequest *request,
                                     HTTPResponse *response,
                                     unsigned int universe_id,
                                     const UID &uid) {
   string hint = request->GetParameter(HINT_KEY);
-  string error;
-  device_info dev_info = {universe_id, uid, hint, "", ""};
-
-  m_rdm_api.GetSoftwareVersionLabel(
-    universe_id,
-    uid,
-    ola::rdm::ROOT_RDM_DEVICE,
-    NewSingleCallback(this,
-                      &RDMHTTPModule::GetSoftwareVersionHandler,
-                      response,
-                      dev_info),
-    &error);
-  return error;
+  device_info dev_info_init = {universe_id, uid, hint, "", ""};
+  device_info *dev_info = new device_info(dev_info_init);
+
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = universe_id;
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_SOFTWARE_VERSION_LABEL,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleLabelResponse,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetSoftwareVersionHandler,
+                            dev_info)));
+  if (hint.find('m') != string::npos) {
+    AddBatchGet(
+        batch, uid, ola::rdm::PID_DEVICE_MODEL_DESCRIPTION,
+        NewSingleCallback(
+            &m_rdm_api,
+            &ola::rdm::RDMAPI::_HandleLabelResponse,
+            NewSingleCallback(this,
+                              &RDMHTTPModule::GetDeviceModelHandler,
+                              dev_info)));
+  }
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_DEVICE_INFO,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetDeviceDescriptor,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetDeviceInfoHandler,
+                            dev_info)));
+  SendBatch(batch, NewSingleCallback(this,
+                                     &RDMHTTPModule::SendDeviceInfoResponse,
+                                     response,
+                                     dev_info));
+  return "";
 }
 
 
@@ -1263,39 +1362,11 @@ string RDMHTTPModule::GetDeviceInfo(const HTTPRequest *request,
  * Handle the response to a software version call.
  */
 void RDMHTTPModule::GetSoftwareVersionHandler(
-    HTTPResponse *response,
-    device_info dev_info,
+    device_info *dev_info,
     const ola::rdm::ResponseStatus &status,
     const string &software_version) {
-  string error;
-
   if (CheckForRDMSuccess(status))
-    dev_info.software_version = software_version;
-
-  if (dev_info.hint.find('m') != string::npos) {
-    m_rdm_api.GetDeviceModelDescription(
-        dev_info.universe_id,
-        dev_info.uid,
-        ola::rdm::ROOT_RDM_DEVICE,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetDeviceModelHandler,
-                          response,
-                          dev_info),
-        &error);
-  } else {
-    m_rdm_api.GetDeviceInfo(
-        dev_info.universe_id,
-        dev_info.uid,
-        ola::rdm::ROOT_RDM_DEVICE,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetDeviceInfoHandler,
-                          response,
-                          dev_info),
-        &error);
-  }
-
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+    dev_info->software_version = software_version;
 }
 
 
@@ -1303,42 +1374,38 @@ void RDMHTTPModule::GetSoftwareVersionHandler(
  * Handle the response to a device model call.
  */
 void RDMHTTPModule::GetDeviceModelHandler(
-    HTTPResponse *response,
-    device_info dev_info,
+    device_info *dev_info,
     const ola::rdm::ResponseStatus &status,
     const string &device_model) {
-  string error;
-
   if (CheckForRDMSuccess(status))
-    dev_info.device_model = device_model;
-
-  m_rdm_api.GetDeviceInfo(
-      dev_info.universe_id,
-      dev_info.uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetDeviceInfoHandler,
-                        response,
-                        dev_info),
-      &error);
-
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+    dev_info->device_model = device_model;
 }
 
 
 /**
- * Handle the response to a device info call and build the response
+ * Handle the response to a device info call.
  */
 void RDMHTTPModule::GetDeviceInfoHandler(
-    HTTPResponse *response,
-    device_info dev_info,
+    device_info *dev_info,
     const ola::rdm::ResponseStatus &status,
     const ola::rdm::DeviceDescriptor &device) {
+  dev_info->status = status;
+  dev_info->device = device;
+}
+
+
+/**
+ * Build the device info response once all the requests have completed.
+ */
+void RDMHTTPModule::SendDeviceInfoResponse(HTTPResponse *response,
+                                           device_info *dev_info) {
   JsonSection section;
+  const ola::rdm::DeviceDescriptor &device = dev_info->device;
 
-  if (CheckForRDMError(response, status))
+  if (CheckForRDMError(response, dev_info->status)) {
+    delete dev_info;
     return;
+  }
 
   stringstream stream;
   stream << static_cast<int>(device.protocol_version_high) << "."
@@ -1346,20 +1413,20 @@ void RDMHTTPModule::GetDeviceInfoHandler(
   section.AddItem(new StringItem("Protocol Version", stream.str()));
 
   stream.str("");
-  if (dev_info.device_model.empty())
+  if (dev_info->device_model.empty())
     stream << device.device_model;
   else
-    stream << dev_info.device_model << " (" << device.device_model << ")";
+    stream << dev_info->device_model << " (" << device.device_model << ")";
   section.AddItem(new StringItem("Device Model", stream.str()));
 
   section.AddItem(new StringItem(
       "Product Category",
       ola::rdm::ProductCategoryToString(device.product_category)));
   stream.str("");
-  if (dev_info.software_version.empty())
+  if (dev_info->software_version.empty())
     stream << device.software_version;
   else
-    stream << dev_info.software_version << " (" << device.software_version
+    stream << dev_info->software_version << " (" << device.software_version
       << ")";
   section.AddItem(new StringItem("Software Version", stream.str()));
 
@@ -1377,8 +1444,9 @@ void RDMHTTPModule::GetDeviceInfoHandler(
 
   section.AddItem(new UIntItem("Sub Devices", device.sub_device_count));
   section.AddItem(new UIntItem("Sensors", device.sensor_count));
-  section.AddItem(new StringItem("UID", dev_info.uid.ToString()));
+  section.AddItem(new StringItem("UID", dev_info->uid.ToString()));
   RespondWithSection(response, section);
+  delete dev_info;
 }
 
 
@@ -1617,18 +1685,30 @@ string RDMHTTPModule::SetFactoryDefault(HTTPResponse *response,
 string RDMHTTPModule::GetLanguage(HTTPResponse *response,
                                   unsigned int universe_id,
                                   const UID &uid) {
-  string error;
-  m_rdm_api.GetLanguageCapabilities(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetSupportedLanguagesHandler,
-                        response,
-                        universe_id,
-                        uid),
-      &error);
-  return error;
+  language_info *info = new language_info;
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = universe_id;
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_LANGUAGE_CAPABILITIES,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetLanguageCapabilities,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetSupportedLanguagesHandler,
+                            info)));
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_LANGUAGE,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetLanguage,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetLanguageHandler,
+                            info)));
+  SendBatch(batch, NewSingleCallback(this,
+                                     &RDMHTTPModule::SendLanguageResponse,
+                                     response,
+                                     info));
+  return "";
 }
 
 
@@ -1636,38 +1716,35 @@ string RDMHTTPModule::GetLanguage(HTTPResponse *response,
  * Handle the response to language capability call.
  */
 void RDMHTTPModule::GetSupportedLanguagesHandler(
-    HTTPResponse *response,
-    unsigned int universe_id,
-    const UID uid,
+    language_info *info,
     const ola::rdm::ResponseStatus &status,
     const vector<string> &languages) {
-  string error;
-  m_rdm_api.GetLanguage(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetLanguageHandler,
-                        response,
-                        languages),
-      &error);
-
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  info->languages = languages;
   (void) status;
 }
 
 
 /**
- * Handle the response to language call and build the response
+ * Handle the response to language call.
  */
-void RDMHTTPModule::GetLanguageHandler(HTTPResponse *response,
-                                       vector<string> languages,
+void RDMHTTPModule::GetLanguageHandler(language_info *info,
                                        const ola::rdm::ResponseStatus &status,
                                        const string &language) {
+  info->status = status;
+  info->language = language;
+}
+
+
+/**
+ * Build the language response once both requests have completed.
+ */
+void RDMHTTPModule::SendLanguageResponse(HTTPResponse *response,
+                                         language_info *info) {
+  const vector<string> &languages = info->languages;
+  const string &language = info->language;
   JsonSection section;
   SelectItem *item = new SelectItem("Language", LANGUAGE_FIELD);
-  bool ok = CheckForRDMSuccess(status);
+  bool ok = CheckForRDMSuccess(info->status);
 
   vector<string>::const_iterator iter = languages.begin();
   unsigned int i = 0;
@@ -1683,6 +1760,7 @@ void RDMHTTPModule::GetLanguageHandler(HTTPResponse *response,
   }
   section.AddItem(item);
   RespondWithSection(response, section);
+  delete info;
 }
 
 
@@ -1714,18 +1792,31 @@ string RDMHTTPModule::SetLanguage(const HTTPRequest *request,
 string RDMHTTPModule::GetBootSoftware(HTTPResponse *response,
                                       unsigned int universe_id,
                                       const UID &uid) {
-  string error;
-  m_rdm_api.GetBootSoftwareVersionLabel(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetBootSoftwareLabelHandler,
-                        response,
-                        universe_id,
-                        uid),
-      &error);
-  return error;
+  boot_software_info *info = new boot_software_info;
+  info->version = 0;
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = universe_id;
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_BOOT_SOFTWARE_VERSION_LABEL,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleLabelResponse,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetBootSoftwareLabelHandler,
+                            info)));
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_BOOT_SOFTWARE_VERSION_ID,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetBootSoftwareVersion,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::GetBootSoftwareVersionHandler,
+                            info)));
+  SendBatch(batch, NewSingleCallback(this,
+                                     &RDMHTTPModule::SendBootSoftwareResponse,
+                                     response,
+                                     info));
+  return "";
 }
 
 
@@ -1733,23 +1824,10 @@ string RDMHTTPModule::GetBootSoftware(HTTPResponse *response,
  * Handle the response to a boot software label.
  */
 void RDMHTTPModule::GetBootSoftwareLabelHandler(
-    HTTPResponse *response,
-    unsigned int universe_id,
-    const UID uid,
+    boot_software_info *info,
     const ola::rdm::ResponseStatus &status,
     const string &label) {
-  string error;
-  m_rdm_api.GetBootSoftwareVersion(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::GetBootSoftwareVersionHandler,
-                        response,
-                        label),
-      &error);
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  info->label = label;
   (void) status;
 }
 
@@ -1758,23 +1836,33 @@ void RDMHTTPModule::GetBootSoftwareLabelHandler(
  * Handle the response to a boot software version.
  */
 void RDMHTTPModule::GetBootSoftwareVersionHandler(
-    HTTPResponse *response,
-    string label,
+    boot_software_info *info,
     const ola::rdm::ResponseStatus &status,
     uint32_t version) {
+  info->status = status;
+  info->version = version;
+}
+
+
+/**
+ * Build the boot software response once both requests have completed.
+ */
+void RDMHTTPModule::SendBootSoftwareResponse(HTTPResponse *response,
+                                             boot_software_info *info) {
   stringstream str;
-  str << label;
-  if (CheckForRDMSuccess(status)) {
-    if (!label.empty())
-      str << " (" << version << ")";
+  str << info->label;
+  if (CheckForRDMSuccess(info->status)) {
+    if (!info->label.empty())
+      str << " (" << info->version << ")";
     else
-      str << version;
+      str << info->version;
   }
 
   JsonSection section;
   StringItem *item = new StringItem("Boot Software", str.str());
   section.AddItem(item);
   RespondWithSection(response, section);
+  delete info;
 }
 
 
@@ -1796,7 +1884,6 @@ string RDMHTTPModule::GetPersonalities(const HTTPRequest *request,
   info->include_descriptions = include_descriptions || (hint == "l");
   info->return_as_section = return_as_section;
   info->active = 0;
-  info->next = 1;
   info->total = 0;
 
   m_rdm_api.GetDMXPersonality(
@@ -1832,72 +1919,73 @@ void RDMHTTPModule::GetPersonalityHandler(
   info->total = total;
 
   if (info->include_descriptions)
-    GetNextPersonalityDescription(response, info);
+    GetPersonalityDescriptions(response, info);
   else
     SendPersonalityResponse(response, info);
 }
 
 
 /**
- * Get the description of the next dmx personality
+ * Get the descriptions of all the dmx personalities. These are sent as a
+ * single batch, rather than waiting for each one before sending the next.
  */
-void RDMHTTPModule::GetNextPersonalityDescription(HTTPResponse *response,
-                                                  personality_info *info) {
-  string error;
-  while (info->next <= info->total) {
-    bool r = m_rdm_api.GetDMXPersonalityDescription(
-        info->universe_id,
-        *(info->uid),
-        ola::rdm::ROOT_RDM_DEVICE,
-        info->next,
-        NewSingleCallback(this,
-                          &RDMHTTPModule::GetPersonalityLabelHandler,
-                          response,
-                          info),
-        &error);
-    if (r)
-      return;
+void RDMHTTPModule::GetPersonalityDescriptions(HTTPResponse *response,
+                                               personality_info *info) {
+  info->personalities.assign(
+      info->total, pair<uint32_t, string>(INVALID_PERSONALITY, ""));
+  if (!info->total) {
+    PersonalityDescriptionsComplete(response, info);
+    return;
+  }
 
-    info->next++;
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = info->universe_id;
+  for (unsigned int i = 0; i < info->total; i++) {
+    const uint8_t personality = i + 1;
+    AddBatchGet(
+        batch, *(info->uid), ola::rdm::PID_DMX_PERSONALITY_DESCRIPTION,
+        NewSingleCallback(
+            &m_rdm_api,
+            &ola::rdm::RDMAPI::_HandleGetDMXPersonalityDescription,
+            NewSingleCallback(this,
+                              &RDMHTTPModule::GetPersonalityLabelHandler,
+                              info,
+                              i)),
+        string(1, static_cast<char>(personality)));
   }
-  if (info->return_as_section)
-    SendSectionPersonalityResponse(response, info);
-  else
-    SendPersonalityResponse(response, info);
+  SendBatch(batch,
+            NewSingleCallback(this,
+                              &RDMHTTPModule::PersonalityDescriptionsComplete,
+                              response,
+                              info));
 }
 
 
 /**
- * Handle the response to a Personality label call. This fetches the next
- * personality in the sequence, or sends the response if we have all the info.
+ * Handle the response to a Personality label call.
  */
 void RDMHTTPModule::GetPersonalityLabelHandler(
-        HTTPResponse *response,
         personality_info *info,
+        unsigned int index,
         const ola::rdm::ResponseStatus &status,
         uint8_t personality,
         uint16_t slot_count,
         const string &label) {
-  string description = "";
-  uint32_t slots = INVALID_PERSONALITY;
-
-  if (CheckForRDMSuccess(status)) {
-    slots = slot_count;
-    description = label;
-  }
+  if (CheckForRDMSuccess(status))
+    info->personalities[index] = pair<uint32_t, string>(slot_count, label);
+  (void) personality;
+}
 
-  info->personalities.push_back(pair<uint32_t, string>(slots, description));
 
-  if (info->next == info->total) {
-    if (info->return_as_section)
-      SendSectionPersonalityResponse(response, info);
-    else
-      SendPersonalityResponse(response, info);
-  } else {
-    info->next++;
-    GetNextPersonalityDescription(response, info);
-  }
-  (void) personality;
+/**
+ * Called once we have the descriptions of all the personalities.
+ */
+void RDMHTTPModule::PersonalityDescriptionsComplete(HTTPResponse *response,
+                                                    personality_info *info) {
+  if (info->return_as_section)
+    SendSectionPersonalityResponse(response, info);
+  else
+    SendPersonalityResponse(response, info);
 }
 
 
@@ -2047,20 +2135,33 @@ string RDMHTTPModule::GetSensor(const HTTPRequest *request,
     return "Invalid hint (sensor #)";
   }
 
-  string error;
-  m_rdm_api.GetSensorDefinition(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      sensor_id,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SensorDefinitionHandler,
-                        response,
-                        universe_id,
-                        uid,
-                        sensor_id),
-      &error);
-  return error;
+  sensor_info *info = new sensor_info;
+  const string sensor_data(1, static_cast<char>(sensor_id));
+  rdm_batch *batch = new rdm_batch;
+  batch->universe_id = universe_id;
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_SENSOR_DEFINITION,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleGetSensorDefinition,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::SensorDefinitionHandler,
+                            info)),
+      sensor_data);
+  AddBatchGet(
+      batch, uid, ola::rdm::PID_SENSOR_VALUE,
+      NewSingleCallback(
+          &m_rdm_api,
+          &ola::rdm::RDMAPI::_HandleSensorValue,
+          NewSingleCallback(this,
+                            &RDMHTTPModule::SensorValueHandler,
+                            info)),
+      sensor_data);
+  SendBatch(batch, NewSingleCallback(this,
+                                     &RDMHTTPModule::SendSensorResponse,
+                                     response,
+                                     info));
+  return "";
 }
 
 
@@ -2068,45 +2169,38 @@ string RDMHTTPModule::GetSensor(const HTTPRequest *request,
  * Handle the response to a sensor definition request.
  */
 void RDMHTTPModule::SensorDefinitionHandler(
-    HTTPResponse *response,
-    unsigned int universe_id,
-    const UID uid,
-    uint8_t sensor_id,
+    sensor_info *info,
     const ola::rdm::ResponseStatus &status,
     const ola::rdm::SensorDescriptor &definition) {
-  ola::rdm::SensorDescriptor *definition_arg = NULL;
-
-  if (CheckForRDMSuccess(status)) {
-    definition_arg = new ola::rdm::SensorDescriptor();
-    *definition_arg = definition;
-  }
-  string error;
-  m_rdm_api.GetSensorValue(
-      universe_id,
-      uid,
-      ola::rdm::ROOT_RDM_DEVICE,
-      sensor_id,
-      NewSingleCallback(this,
-                        &RDMHTTPModule::SensorValueHandler,
-                        response,
-                        definition_arg),
-      &error);
-  if (!error.empty())
-    m_server->ServeError(response, BACKEND_DISCONNECTED_ERROR + error);
+  info->definition_status = status;
+  info->definition = definition;
 }
 
 
 /**
- * Handle the response to a sensor value request & build the response.
+ * Handle the response to a sensor value request.
  */
 void RDMHTTPModule::SensorValueHandler(
-    HTTPResponse *response,
-    ola::rdm::SensorDescriptor *definition,
+    sensor_info *info,
     const ola::rdm::ResponseStatus &status,
     const ola::rdm::SensorValueDescriptor &value) {
-  if (CheckForRDMError(response, status)) {
-    if (definition)
-      delete definition;
+  info->value_status = status;
+  info->value = value;
+}
+
+
+/**
+ * Build the sensor response once both requests have completed.
+ */
+void RDMHTTPModule::SendSensorResponse(HTTPResponse *response,
+                                       sensor_info *info) {
+  const ola::rdm::SensorValueDescriptor &value = info->value;
+  const ola::rdm::SensorDescriptor *definition = NULL;
+  if (CheckForRDMSuccess(info->definition_status))
+    definition = &info->definition;
+
+  if (CheckForRDMError(response, info->value_status)) {
+    delete info;
     return;
   }
 
@@ -2162,7 +2256,7 @@ void RDMHTTPModule::SensorValueHandler(
   }
   section.SetSaveButton("Record Sensor");
   RespondWithSection(response, section);
-  delete definition;
+  delete info;
 }
 
 
@@ -3075,6 +3169,93 @@ string RDMHTTPModule::SetResetDevice(const HTTPRequest *request,
 }
 
 
+/**
+ * Add a GET to a batch.
+ * @param batch the batch to add the GET to
+ * @param uid the UID to send the GET to
+ * @param pid the PID to get
+ * @param handler the RDMAPI handler that parses the response, ownership is
+ *   transferred.
+ * @param data the param data for the GET
+ */
+void RDMHTTPModule::AddBatchGet(
+    rdm_batch *batch,
+    const UID &uid,
+    uint16_t pid,
+    ola::rdm::RDMAPIImplInterface::rdm_callback *handler,
+    const string &data) {
+  batch->gets.push_back(ola::client::RDMGetParams(
+      uid, ola::rdm::ROOT_RDM_DEVICE, pid, data));
+  batch->handlers.push_back(handler);
+}
+
+
+/**
+ * Send a batch of GETs.
+ * @param batch the batch to send, ownership is transferred.
+ * @param on_complete the callback to run once all the handlers have been run.
+ */
+void RDMHTTPModule::SendBatch(rdm_batch *batch,
+                              SingleUseCallback0<void> *on_complete) {
+  m_client->RDMBatchGet(
+      batch->universe_id,
+      batch->gets,
+      NewCallback(this, &RDMHTTPModule::HandleBatchResponse, batch),
+      NewSingleCallback(this,
+                        &RDMHTTPModule::HandleBatchComplete,
+                        batch,
+                        on_complete),
+      true);  // a user is waiting on the page
+}
+
+
+/*
+ * Pass a response from a batch to the matching handler.
+ */
+void RDMHTTPModule::HandleBatchResponse(
+    rdm_batch *batch,
+    unsigned int index,
+    const client::RDMMetadata &metadata,
+    const ola::rdm::RDMResponse *response) {
+  if (index >= batch->handlers.size() || !batch->handlers[index]) {
+    OLA_WARN << "Unexpected RDM batch response, index " << index;
+    return;
+  }
+
+  ola::rdm::ResponseStatus status;
+  string data;
+  client::ClientRDMAPIShim::GetResponseStatusAndData(
+      Result(""), metadata.response_code, response, &status, &data);
+  batch->handlers[index]->Run(status, data);
+  batch->handlers[index] = NULL;
+}
+
+
+/*
+ * Called once a batch completes. Any GETs that didn't get a response, because
+ * the batch failed, have their handlers run with the error.
+ */
+void RDMHTTPModule::HandleBatchComplete(
+    rdm_batch *batch,
+    SingleUseCallback0<void> *on_complete,
+    const Result &result) {
+  const string error = result.Success() ? "No response" : result.Error();
+  vector<ola::rdm::RDMAPIImplInterface::rdm_callback*>::iterator iter =
+    batch->handlers.begin();
+  for (; iter != batch->handlers.end(); ++iter) {
+    if (!*iter)
+      continue;
+    ola::rdm::ResponseStatus status;
+    string data;
+    client::ClientRDMAPIShim::GetResponseStatusAndData(
+        Result(error), ola::rdm::RDM_FAILED_TO_SEND, NULL, &status, &data);
+    (*iter)->Run(status, data);
+  }
+  delete batch;
+  on_complete->Run();
+}
+
+
 /**
  * Check if the id url param exists and is valid.
  */
@@ -26,6 +26,8 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/base/Macro.h"
 #include "ola/client/ClientRDMAPIShim.h"
 #include "ola/client/OlaClient.h"
@@ -90,15 +92,31 @@ class RDMHTTPModule {
       RESOLVE_DEVICE,
     } uid_resolve_action;
 
+    typedef struct {
+      string id;
+      string name;
+      string hint;
+    } section_info;
+
+    typedef struct {
+      vector<section_info> sections;
+      TimeStamp expiry;
+    } cached_sections;
+
     typedef struct {
       map<UID, resolved_uid> resolved_uids;
       std::queue<std::pair<UID, uid_resolve_action> > pending_uids;
+      // The supported sections for each UID. These only change if the
+      // personality does, which can happen from the front panel, so they're
+      // kept for SUPPORTED_SECTIONS_TTL.
+      map<UID, cached_sections> supported_sections;
       bool uid_resolution_running;
       bool active;
     } uid_resolution_state;
 
     HTTPServer *m_server;
     ola::client::OlaClient *m_client;
+    Clock m_clock;
     ola::client::ClientRDMAPIShim m_shim;
     ola::rdm::RDMAPI m_rdm_api;
     map<unsigned int, uid_resolution_state*> m_universe_uids;
@@ -106,12 +124,6 @@ class RDMHTTPModule {
     ola::thread::Mutex m_pid_store_mu;
     const ola::rdm::RootPidStore *m_pid_store;  // GUARDED_BY(m_pid_store_mu);
 
-    typedef struct {
-      string id;
-      string name;
-      string hint;
-    } section_info;
-
     struct lt_section_info {
       bool operator()(const section_info &left, const section_info &right) {
         return left.name < right.name;
@@ -124,6 +136,8 @@ class RDMHTTPModule {
       string hint;
       string device_model;
       string software_version;
+      ola::rdm::ResponseStatus status;
+      ola::rdm::DeviceDescriptor device;
     } device_info;
 
     typedef struct {
@@ -132,11 +146,50 @@ class RDMHTTPModule {
       bool include_descriptions;
       bool return_as_section;
       unsigned int active;
-      unsigned int next;
       unsigned int total;
       vector<std::pair<uint32_t, string> > personalities;
     } personality_info;
 
+    typedef struct {
+      unsigned int universe_id;
+      UID uid;
+      ola::rdm::ResponseStatus pid_status;
+      vector<uint16_t> pids;
+      ola::rdm::ResponseStatus device_status;
+      ola::rdm::DeviceDescriptor device;
+    } supported_sections_info;
+
+    typedef struct {
+      vector<string> languages;
+      ola::rdm::ResponseStatus status;
+      string language;
+    } language_info;
+
+    typedef struct {
+      string label;
+      ola::rdm::ResponseStatus status;
+      uint32_t version;
+    } boot_software_info;
+
+    typedef struct {
+      ola::rdm::ResponseStatus definition_status;
+      ola::rdm::SensorDescriptor definition;
+      ola::rdm::ResponseStatus value_status;
+      ola::rdm::SensorValueDescriptor value;
+    } sensor_info;
+
+    /*
+     * A set of GETs that are sent to olad with a single RDMBatchGet() call.
+     * olad queues them together, so a section that needs several PIDs takes
+     * one round trip rather than one per PID. Each response is passed to the
+     * matching RDMAPI handler.
+     */
+    typedef struct {
+      unsigned int universe_id;
+      vector<ola::client::RDMGetParams> gets;
+      vector<ola::rdm::RDMAPIImplInterface::rdm_callback*> handlers;
+    } rdm_batch;
+
     // uid resolution methods
     void HandleUIDList(HTTPResponse *response,
                        unsigned int universe_id,
@@ -177,16 +230,22 @@ class RDMHTTPModule {
     void SupportedParamsHandler(HTTPResponse *response,
                                 const ola::rdm::ResponseStatus &status,
                                 const vector<uint16_t> &pids);
-    void SupportedSectionsHandler(HTTPResponse *response,
-                                  unsigned int universe,
-                                  UID uid,
-                                  const ola::rdm::ResponseStatus &status,
-                                  const vector<uint16_t> &pids);
+    void SupportedSectionsParamsHandler(
+        supported_sections_info *info,
+        const ola::rdm::ResponseStatus &status,
+        const vector<uint16_t> &pids);
     void SupportedSectionsDeviceInfoHandler(
-        HTTPResponse *response,
-        const vector<uint16_t> pids,
+        supported_sections_info *info,
         const ola::rdm::ResponseStatus &status,
         const ola::rdm::DeviceDescriptor &device);
+    void SupportedSectionsHandler(HTTPResponse *response,
+                                  supported_sections_info *info);
+    void BuildSupportedSections(const vector<uint16_t> &pid_list,
+                                const ola::rdm::ResponseStatus &status,
+                                const ola::rdm::DeviceDescriptor &device,
+                                vector<section_info> *sections);
+    void SendSupportedSections(HTTPResponse *response,
+                               const vector<section_info> &sections);
 
     // section methods
     string GetCommStatus(HTTPResponse *response,
@@ -218,21 +277,21 @@ class RDMHTTPModule {
                          unsigned int universe_id,
                          const UID &uid);
 
-    void GetSoftwareVersionHandler(HTTPResponse *response,
-                                   device_info dev_info,
+    void GetSoftwareVersionHandler(device_info *dev_info,
                                    const ola::rdm::ResponseStatus &status,
                                    const string &software_version);
 
-    void GetDeviceModelHandler(HTTPResponse *response,
-                               device_info dev_info,
+    void GetDeviceModelHandler(device_info *dev_info,
                                const ola::rdm::ResponseStatus &status,
                                const string &device_model);
 
-    void GetDeviceInfoHandler(HTTPResponse *response,
-                              device_info dev_info,
+    void GetDeviceInfoHandler(device_info *dev_info,
                               const ola::rdm::ResponseStatus &status,
                               const ola::rdm::DeviceDescriptor &device);
 
+    void SendDeviceInfoResponse(HTTPResponse *response,
+                                device_info *dev_info);
+
     string GetProductIds(const HTTPRequest *request,
                          HTTPResponse *response,
                          unsigned int universe_id,
@@ -285,17 +344,16 @@ class RDMHTTPModule {
                        unsigned int universe_id,
                        const UID &uid);
 
-    void GetSupportedLanguagesHandler(HTTPResponse *response,
-                                      unsigned int universe_id,
-                                      const UID uid,
+    void GetSupportedLanguagesHandler(language_info *info,
                                       const ola::rdm::ResponseStatus &status,
                                       const vector<string> &languages);
 
-    void GetLanguageHandler(HTTPResponse *response,
-                            vector<string> languages,
+    void GetLanguageHandler(language_info *info,
                             const ola::rdm::ResponseStatus &status,
                             const string &language);
 
+    void SendLanguageResponse(HTTPResponse *response, language_info *info);
+
     string SetLanguage(const HTTPRequest *request,
                        HTTPResponse *response,
                        unsigned int universe_id,
@@ -305,18 +363,18 @@ class RDMHTTPModule {
                            unsigned int universe_id,
                            const UID &uid);
 
-    void GetBootSoftwareLabelHandler(HTTPResponse *response,
-                                     unsigned int universe_id,
-                                     const UID uid,
+    void GetBootSoftwareLabelHandler(boot_software_info *info,
                                      const ola::rdm::ResponseStatus &status,
                                      const string &label);
 
     void GetBootSoftwareVersionHandler(
-        HTTPResponse *response,
-        string label,
+        boot_software_info *info,
         const ola::rdm::ResponseStatus &status,
         uint32_t version);
 
+    void SendBootSoftwareResponse(HTTPResponse *response,
+                                  boot_software_info *info);
+
     string GetPersonalities(const HTTPRequest *request,
                             HTTPResponse *response,
                             unsigned int universe_id,
@@ -331,17 +389,20 @@ class RDMHTTPModule {
         uint8_t current,
         uint8_t total);
 
-    void GetNextPersonalityDescription(HTTPResponse *response,
-                                       personality_info *info);
+    void GetPersonalityDescriptions(HTTPResponse *response,
+                                    personality_info *info);
 
     void GetPersonalityLabelHandler(
-        HTTPResponse *response,
         personality_info *info,
+        unsigned int index,
         const ola::rdm::ResponseStatus &status,
         uint8_t personality,
         uint16_t slot_count,
         const string &label);
 
+    void PersonalityDescriptionsComplete(HTTPResponse *response,
+                                         personality_info *info);
+
     void SendSectionPersonalityResponse(HTTPResponse *response,
                                         personality_info *info);
 
@@ -369,18 +430,16 @@ class RDMHTTPModule {
                      unsigned int universe_id,
                      const UID &uid);
 
-    void SensorDefinitionHandler(HTTPResponse *response,
-                                 unsigned int universe_id,
-                                 const UID uid,
-                                 uint8_t sensor_id,
+    void SensorDefinitionHandler(sensor_info *info,
                                  const ola::rdm::ResponseStatus &status,
                                  const ola::rdm::SensorDescriptor &definition);
 
-    void SensorValueHandler(HTTPResponse *response,
-                            ola::rdm::SensorDescriptor *definition,
+    void SensorValueHandler(sensor_info *info,
                             const ola::rdm::ResponseStatus &status,
                             const ola::rdm::SensorValueDescriptor &value);
 
+    void SendSensorResponse(HTTPResponse *response, sensor_info *info);
+
     string RecordSensor(const HTTPRequest *request,
                         HTTPResponse *response,
                         unsigned int universe_id,
@@ -548,6 +607,21 @@ class RDMHTTPModule {
                          unsigned int universe_id,
                          const UID &uid);
 
+    // batch methods
+    void AddBatchGet(rdm_batch *batch,
+                     const UID &uid,
+                     uint16_t pid,
+                     ola::rdm::RDMAPIImplInterface::rdm_callback *handler,
+                     const string &data = "");
+    void SendBatch(rdm_batch *batch, SingleUseCallback0<void> *on_complete);
+    void HandleBatchResponse(rdm_batch *batch,
+                             unsigned int index,
+                             const client::RDMMetadata &metadata,
+                             const ola::rdm::RDMResponse *response);
+    void HandleBatchComplete(rdm_batch *batch,
+                             SingleUseCallback0<void> *on_complete,
+                             const client::Result &result);
+
     // util methods
     bool CheckForInvalidId(const HTTPRequest *request,
                            unsigned int *universe_id);
@@ -591,6 +665,8 @@ class RDMHTTPModule {
                     const string &hint="");
 
     static const uint32_t INVALID_PERSONALITY = 0xffff;
+    // in seconds, this matches how long olad caches DEVICE_INFO for
+    static const unsigned int SUPPORTED_SECTIONS_TTL = 5;
     static const char BACKEND_DISCONNECTED_ERROR[];
 
     static const char HINT_KEY[];
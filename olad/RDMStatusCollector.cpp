@@ -0,0 +1,432 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMStatusCollector.cpp
+ * Polls the RDM responders in each universe for queued & status messages.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Logging.h"
+#include "ola/network/NetworkUtils.h"
+#include "ola/rdm/QueueingRDMController.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMHelper.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/stl/STLUtils.h"
+#include "olad/ClientBroker.h"
+#include "olad/Port.h"
+#include "olad/RDMStatusCollector.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+
+namespace ola {
+
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using std::map;
+using std::set;
+using std::string;
+using std::vector;
+
+/*
+ * The shortest time a GET and its response can take on the wire. This is
+ * charged for polls that complete faster than this, which happens if the
+ * response was returned from a cache or the port didn't send the request.
+ */
+static const unsigned int MIN_POLL_COST_US = 2500;
+
+
+/**
+ * Create a new RDMStatusCollector
+ * @param universe_store the store to find the universes in
+ * @param broker the ClientBroker to send the requests through
+ * @param scheduler the scheduler to use for the poll timer
+ * @param clock the clock used to measure the round trip times
+ * @param source_uid the UID to send the requests from
+ * @param on_status the callback to run when a status message is collected,
+ *   ownership is transferred.
+ * @param budget_percent the percentage of the bus time to use for polling
+ */
+RDMStatusCollector::RDMStatusCollector(
+    UniverseStore *universe_store,
+    ClientBroker *broker,
+    ola::thread::SchedulerInterface *scheduler,
+    const Clock *clock,
+    const UID &source_uid,
+    StatusCallback *on_status,
+    unsigned int budget_percent)
+    : m_universe_store(universe_store),
+      m_broker(broker),
+      m_scheduler(scheduler),
+      m_clock(clock),
+      m_source_uid(source_uid),
+      m_on_status(on_status),
+      m_budget_percent(std::min(budget_percent, 100u)),
+      m_client(NULL),
+      m_poll_timeout(ola::thread::INVALID_TIMEOUT) {
+  m_broker->AddClient(&m_client);
+}
+
+
+/**
+ * Clean up. Removing our client from the broker means any responses to
+ * requests that are still in flight are dropped.
+ */
+RDMStatusCollector::~RDMStatusCollector() {
+  Stop();
+  m_broker->RemoveClient(&m_client);
+  STLDeleteValues(&m_universes);
+  delete m_on_status;
+}
+
+
+/**
+ * Start polling.
+ */
+void RDMStatusCollector::Start() {
+  if (m_poll_timeout != ola::thread::INVALID_TIMEOUT)
+    return;
+
+  m_clock->CurrentTime(&m_last_poll);
+  m_poll_timeout = m_scheduler->RegisterRepeatingTimeout(
+      POLL_INTERVAL_MS,
+      NewCallback(this, &RDMStatusCollector::Poll));
+}
+
+
+/**
+ * Stop polling. Requests in flight are allowed to complete.
+ */
+void RDMStatusCollector::Stop() {
+  if (m_poll_timeout == ola::thread::INVALID_TIMEOUT)
+    return;
+
+  m_scheduler->RemoveTimeout(m_poll_timeout);
+  m_poll_timeout = ola::thread::INVALID_TIMEOUT;
+}
+
+
+/**
+ * Return the number of polls in flight, across all universes.
+ */
+unsigned int RDMStatusCollector::InFlightCount() const {
+  unsigned int in_flight = 0;
+  UniverseStateMap::const_iterator iter = m_universes.begin();
+  for (; iter != m_universes.end(); ++iter)
+    in_flight += iter->second->in_flight;
+  return in_flight;
+}
+
+
+/*
+ * Called periodically. This adds to the budget for each port and sends polls
+ * until they're used up.
+ */
+bool RDMStatusCollector::Poll() {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  TimeInterval elapsed = now - m_last_poll;
+  m_last_poll = now;
+
+  int64_t elapsed_us = elapsed.Seconds() * 1000000 + elapsed.MicroSeconds();
+  elapsed_us = std::max(std::min(elapsed_us,
+                                 static_cast<int64_t>(MAX_BUDGET_US)),
+                        static_cast<int64_t>(0));
+
+  vector<Universe*> universes;
+  m_universe_store->GetList(&universes);
+  set<unsigned int> universe_ids;
+
+  vector<Universe*>::iterator iter = universes.begin();
+  for (; iter != universes.end(); ++iter) {
+    UniverseState *state = STLFindOrNull(m_universes, (*iter)->UniverseId());
+    if (!state) {
+      state = new UniverseState();
+      state->in_flight = 0;
+      state->sending = false;
+      m_universes[(*iter)->UniverseId()] = state;
+    }
+    universe_ids.insert((*iter)->UniverseId());
+
+    // Only the ports that are still patched carry their budget over.
+    vector<OutputPort*> ports;
+    (*iter)->OutputPorts(&ports);
+    map<const OutputPort*, int64_t> port_budget_us;
+    port_budget_us[NULL] = 0;
+    vector<OutputPort*>::const_iterator port_iter = ports.begin();
+    for (; port_iter != ports.end(); ++port_iter)
+      port_budget_us[*port_iter] = 0;
+
+    map<const OutputPort*, int64_t>::iterator budget_iter =
+        port_budget_us.begin();
+    for (; budget_iter != port_budget_us.end(); ++budget_iter) {
+      const int64_t *budget_us = STLFind(&state->port_budget_us,
+                                         budget_iter->first);
+      budget_iter->second = std::min(
+          (budget_us ? *budget_us : 0) + elapsed_us * m_budget_percent / 100,
+          static_cast<int64_t>(MAX_BUDGET_US));
+    }
+    state->port_budget_us.swap(port_budget_us);
+    SendPolls(*iter, state);
+  }
+
+  // Remove the universes that have gone away. If polls are still in flight
+  // we wait until they've completed.
+  UniverseStateMap::iterator state_iter = m_universes.begin();
+  while (state_iter != m_universes.end()) {
+    if (!STLContains(universe_ids, state_iter->first) &&
+        !state_iter->second->in_flight) {
+      delete state_iter->second;
+      m_universes.erase(state_iter++);
+    } else {
+      ++state_iter;
+    }
+  }
+  return true;
+}
+
+
+/*
+ * Send polls to a universe until every port with UIDs waiting has run out of
+ * budget or reached the in flight limit. Polls may complete synchronously, so
+ * this is guarded against re-entry.
+ */
+void RDMStatusCollector::SendPolls(Universe *universe, UniverseState *state) {
+  if (state->sending)
+    return;
+
+  state->sending = true;
+  bool refilled = false;
+  while (true) {
+    UID uid(0, 0);
+    uint16_t pid;
+    const OutputPort *port;
+    if (!NextUID(universe, state, &uid, &pid, &port)) {
+      // The UIDs left may all be on ports that are busy or out of budget, so
+      // start a new sweep to keep the other ports going. Each call starts at
+      // most one, so we don't spin if none of the responders can be polled.
+      if (refilled)
+        break;
+      StartSweep(universe, state);
+      refilled = true;
+      continue;
+    }
+
+    uint8_t status_type = ola::rdm::STATUS_ADVISORY;
+    TimeStamp now;
+    m_clock->CurrentTime(&now);
+    state->in_flight++;
+    state->in_flight_uids[uid] = port;
+    state->port_in_flight[port]++;
+    m_broker->SendRDMRequest(
+        &m_client,
+        universe,
+        new ola::rdm::RDMGetRequest(
+            m_source_uid,
+            uid,
+            0,  // transaction #
+            1,  // port id
+            0,  // message count
+            ola::rdm::ROOT_RDM_DEVICE,
+            pid,
+            &status_type,
+            sizeof(status_type)),
+        NewSingleCallback(this,
+                          &RDMStatusCollector::PollComplete,
+                          universe->UniverseId(),
+                          uid,
+                          pid,
+                          now),
+        ola::rdm::QueueingRDMController::BACKGROUND_PRIORITY);
+  }
+  state->sending = false;
+}
+
+
+/*
+ * Queue up the UIDs in the universe for polling, other than those still
+ * waiting from the last sweep. New UIDs are polled with QUEUED_MESSAGE, and
+ * UIDs that have gone away are forgotten.
+ */
+void RDMStatusCollector::StartSweep(Universe *universe,
+                                    UniverseState *state) {
+  UIDSet uids;
+  universe->GetUIDs(&uids);
+  set<UID> waiting(state->sweep.begin(), state->sweep.end());
+
+  map<UID, uint16_t> poll_pids;
+  UIDSet::Iterator iter = uids.Begin();
+  for (; iter != uids.End(); ++iter) {
+    map<UID, uint16_t>::const_iterator pid_iter = state->poll_pids.find(*iter);
+    if (pid_iter == state->poll_pids.end())
+      poll_pids[*iter] = ola::rdm::PID_QUEUED_MESSAGE;
+    else
+      poll_pids[*iter] = pid_iter->second;
+    if (!STLContains(waiting, *iter))
+      state->sweep.push_back(*iter);
+  }
+  state->poll_pids.swap(poll_pids);
+}
+
+
+/*
+ * Remove the next UID to poll from the queues, along with the PID to poll it
+ * with and the port it's on. UIDs with queued messages go first. UIDs whose
+ * port is out of budget or at the in flight limit, or which already have a
+ * poll in flight, are skipped and keep their place.
+ * @returns true if a UID was found, false otherwise.
+ */
+bool RDMStatusCollector::NextUID(Universe *universe,
+                                 UniverseState *state,
+                                 UID *uid,
+                                 uint16_t *pid,
+                                 const OutputPort **port) {
+  UIDQueue *queues[] = {&state->drain, &state->sweep};
+  for (unsigned int i = 0; i < sizeof(queues) / sizeof(queues[0]); i++) {
+    UIDQueue::iterator iter = queues[i]->begin();
+    while (iter != queues[i]->end()) {
+      map<UID, uint16_t>::const_iterator pid_iter =
+          state->poll_pids.find(*iter);
+      if (pid_iter == state->poll_pids.end() || !pid_iter->second) {
+        iter = queues[i]->erase(iter);
+        continue;
+      }
+
+      const OutputPort *uid_port = universe->OutputPortForUID(*iter);
+      const int64_t *budget_us = STLFind(&state->port_budget_us, uid_port);
+      if (STLContains(state->in_flight_uids, *iter) ||
+          !budget_us || *budget_us <= 0 ||
+          state->port_in_flight[uid_port] >= MAX_IN_FLIGHT_PER_PORT) {
+        ++iter;
+        continue;
+      }
+
+      *uid = *iter;
+      *pid = pid_iter->second;
+      *port = uid_port;
+      queues[i]->erase(iter);
+      return true;
+    }
+  }
+  return false;
+}
+
+
+/*
+ * Called when a poll completes. The round trip time is charged against the
+ * budget of the port the poll was sent on.
+ */
+void RDMStatusCollector::PollComplete(unsigned int universe_id,
+                                      UID uid,
+                                      uint16_t pid,
+                                      TimeStamp sent_time,
+                                      ola::rdm::rdm_response_code code,
+                                      const RDMResponse *response,
+                                      const vector<string>&) {
+  UniverseState *state = STLFindOrNull(m_universes, universe_id);
+  if (!state) {
+    delete response;
+    return;
+  }
+
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  TimeInterval round_trip = now - sent_time;
+  int64_t cost_us = round_trip.Seconds() * 1000000 +
+                    round_trip.MicroSeconds();
+  state->in_flight--;
+  map<UID, const OutputPort*>::iterator port_iter =
+      state->in_flight_uids.find(uid);
+  if (port_iter != state->in_flight_uids.end()) {
+    // the port may have been removed from the universe since
+    map<const OutputPort*, int64_t>::iterator budget_iter =
+        state->port_budget_us.find(port_iter->second);
+    if (budget_iter != state->port_budget_us.end()) {
+      budget_iter->second -= std::max(cost_us,
+                                      static_cast<int64_t>(MIN_POLL_COST_US));
+    }
+    state->port_in_flight[port_iter->second]--;
+    state->in_flight_uids.erase(port_iter);
+  }
+
+  if (code == ola::rdm::RDM_COMPLETED_OK && response)
+    HandleResponse(universe_id, state, uid, pid, response);
+  delete response;
+
+  Universe *universe = m_universe_store->GetUniverse(universe_id);
+  if (universe)
+    SendPolls(universe, state);
+}
+
+
+/*
+ * Handle a response to a poll.
+ */
+void RDMStatusCollector::HandleResponse(unsigned int universe_id,
+                                        UniverseState *state,
+                                        const UID &uid,
+                                        uint16_t pid,
+                                        const RDMResponse *response) {
+  if (response->MessageCount() &&
+      std::find(state->drain.begin(), state->drain.end(), uid) ==
+      state->drain.end())
+    state->drain.push_back(uid);
+
+  switch (response->ResponseType()) {
+    case ola::rdm::RDM_ACK:
+      // an empty STATUS_MESSAGES means there is nothing to report.
+      if (response->ParamId() == ola::rdm::PID_STATUS_MESSAGES &&
+          !response->ParamDataSize())
+        return;
+      m_on_status->Run(universe_id, response);
+      break;
+    case ola::rdm::RDM_NACK_REASON: {
+      uint16_t reason;
+      if (response->ParamId() != pid ||
+          response->ParamDataSize() != sizeof(reason))
+        break;
+      memcpy(reinterpret_cast<uint8_t*>(&reason), response->ParamData(),
+             sizeof(reason));
+      reason = ola::network::NetworkToHost(reason);
+      if (reason != ola::rdm::NR_UNKNOWN_PID) {
+        // the responder may be busy, try again on the next sweep.
+        OLA_INFO << uid << " NACKed PID 0x" << std::hex << pid << ": "
+                 << ola::rdm::NackReasonToString(reason);
+        break;
+      }
+
+      OLA_INFO << uid << " doesn't support PID 0x" << std::hex << pid;
+      // fall back to STATUS_MESSAGES, and if that isn't supported either,
+      // stop polling the responder.
+      if (pid == ola::rdm::PID_QUEUED_MESSAGE)
+        state->poll_pids[uid] = ola::rdm::PID_STATUS_MESSAGES;
+      else
+        state->poll_pids[uid] = 0;
+      break;
+    }
+    default:
+      // ACK_TIMER, the message will be collected by a later poll.
+      break;
+  }
+}
+}  // namespace ola
@@ -0,0 +1,140 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMStatusCollector.h
+ * Polls the RDM responders in each universe for queued & status messages.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * The collector sweeps round robin through the UIDs in each universe, sending
+ * a GET QUEUED_MESSAGE to each one. Responders that don't support
+ * QUEUED_MESSAGE are polled with GET STATUS_MESSAGES instead. A response with
+ * a non-zero message count moves the responder to the front of the line, so
+ * its queue is drained before the sweep continues.
+ *
+ * To limit the impact on other RDM traffic, each output port is given a share
+ * of the bus time, as a percentage of the time elapsed. The round trip time
+ * of each poll is charged against the budget of the port it was sent on, and
+ * no new polls are sent on a port once its budget has been used up, so a slow
+ * line doesn't hold up the others. Each port has at most
+ * MAX_IN_FLIGHT_PER_PORT polls in flight, and each responder at most one.
+ */
+
+#ifndef OLAD_RDMSTATUSCOLLECTOR_H_
+#define OLAD_RDMSTATUSCOLLECTOR_H_
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/base/Macro.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMControllerInterface.h"
+#include "ola/rdm/UID.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/Client.h"
+
+namespace ola {
+
+class RDMStatusCollector {
+  public:
+    /*
+     * Run with the universe id when a responder reports a queued message or
+     * a non-empty set of status messages. The response is deleted once the
+     * callback returns.
+     */
+    typedef Callback2<void, unsigned int, const ola::rdm::RDMResponse*>
+      StatusCallback;
+
+    RDMStatusCollector(class UniverseStore *universe_store,
+                       class ClientBroker *broker,
+                       ola::thread::SchedulerInterface *scheduler,
+                       const Clock *clock,
+                       const ola::rdm::UID &source_uid,
+                       StatusCallback *on_status,
+                       unsigned int budget_percent = DEFAULT_BUDGET_PERCENT);
+    ~RDMStatusCollector();
+
+    void Start();
+    void Stop();
+
+    unsigned int InFlightCount() const;
+
+    static const unsigned int DEFAULT_BUDGET_PERCENT = 20;
+    static const unsigned int POLL_INTERVAL_MS = 100;
+    static const unsigned int MAX_IN_FLIGHT_PER_PORT = 1;
+    // the most bus time that can be saved up, per port
+    static const unsigned int MAX_BUDGET_US = 500000;
+
+  private:
+    typedef std::deque<ola::rdm::UID> UIDQueue;
+
+    typedef struct {
+      UIDQueue sweep;  // the UIDs left to poll in this sweep
+      UIDQueue drain;  // the UIDs with messages queued
+      // the PID used to poll each responder, 0 if it doesn't support either
+      std::map<ola::rdm::UID, uint16_t> poll_pids;
+      // the port each poll in flight was sent on, keyed by UID
+      std::map<ola::rdm::UID, const class OutputPort*> in_flight_uids;
+      std::map<const class OutputPort*, unsigned int> port_in_flight;
+      // the bus time left on each port, UIDs not on a port use NULL.
+      std::map<const class OutputPort*, int64_t> port_budget_us;
+      unsigned int in_flight;
+      bool sending;
+    } UniverseState;
+
+    typedef std::map<unsigned int, UniverseState*> UniverseStateMap;
+
+    class UniverseStore *m_universe_store;
+    class ClientBroker *m_broker;
+    ola::thread::SchedulerInterface *m_scheduler;
+    const Clock *m_clock;
+    const ola::rdm::UID m_source_uid;
+    StatusCallback *m_on_status;
+    const unsigned int m_budget_percent;
+    // the collector makes requests as a client, so that the ClientBroker
+    // drops any responses that arrive once it's been deleted.
+    Client m_client;
+    UniverseStateMap m_universes;
+    ola::thread::timeout_id m_poll_timeout;
+    TimeStamp m_last_poll;
+
+    bool Poll();
+    void SendPolls(class Universe *universe, UniverseState *state);
+    void StartSweep(class Universe *universe, UniverseState *state);
+    bool NextUID(class Universe *universe,
+                 UniverseState *state,
+                 ola::rdm::UID *uid,
+                 uint16_t *pid,
+                 const class OutputPort **port);
+    void PollComplete(unsigned int universe_id,
+                      ola::rdm::UID uid,
+                      uint16_t pid,
+                      TimeStamp sent_time,
+                      ola::rdm::rdm_response_code code,
+                      const ola::rdm::RDMResponse *response,
+                      const std::vector<std::string> &packets);
+    void HandleResponse(unsigned int universe_id,
+                        UniverseState *state,
+                        const ola::rdm::UID &uid,
+                        uint16_t pid,
+                        const ola::rdm::RDMResponse *response);
+
+    DISALLOW_COPY_AND_ASSIGN(RDMStatusCollector);
+};
+}  // namespace ola
+#endif  // OLAD_RDMSTATUSCOLLECTOR_H_
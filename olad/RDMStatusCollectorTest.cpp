@@ -0,0 +1,577 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * RDMStatusCollectorTest.cpp
+ * Test fixture for the RDMStatusCollector class
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ola/Callback.h"
+#include "ola/Clock.h"
+#include "ola/Logging.h"
+#include "ola/StringUtils.h"
+#include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/UID.h"
+#include "ola/rdm/UIDSet.h"
+#include "ola/thread/SchedulerInterface.h"
+#include "olad/ClientBroker.h"
+#include "olad/Preferences.h"
+#include "olad/RDMStatusCollector.h"
+#include "olad/TestCommon.h"
+#include "olad/Universe.h"
+#include "olad/UniverseStore.h"
+#include "ola/testing/TestUtils.h"
+
+
+using ola::ClientBroker;
+using ola::MockClock;
+using ola::NewCallback;
+using ola::RDMStatusCollector;
+using ola::Universe;
+using ola::rdm::RDMCallback;
+using ola::rdm::RDMRequest;
+using ola::rdm::RDMResponse;
+using ola::rdm::UID;
+using ola::rdm::UIDSet;
+using ola::thread::timeout_id;
+using std::map;
+using std::pair;
+using std::string;
+using std::vector;
+
+
+/*
+ * A scheduler that holds on to the repeating timeout so it can be run by the
+ * test.
+ */
+class MockPollScheduler: public ola::thread::SchedulerInterface {
+  public:
+    MockPollScheduler() : m_timeout(NULL) {}
+    ~MockPollScheduler() { delete m_timeout; }
+
+    timeout_id RegisterRepeatingTimeout(unsigned int,
+                                        ola::Callback0<bool> *closure) {
+      delete m_timeout;
+      m_timeout = closure;
+      return closure;
+    }
+    timeout_id RegisterRepeatingTimeout(const ola::TimeInterval&,
+                                        ola::Callback0<bool> *closure) {
+      return RegisterRepeatingTimeout(0, closure);
+    }
+
+    timeout_id RegisterSingleTimeout(unsigned int,
+                                     ola::SingleUseCallback0<void> *closure) {
+      delete closure;
+      return ola::thread::INVALID_TIMEOUT;
+    }
+    timeout_id RegisterSingleTimeout(const ola::TimeInterval&,
+                                     ola::SingleUseCallback0<void> *closure) {
+      delete closure;
+      return ola::thread::INVALID_TIMEOUT;
+    }
+
+    void RemoveTimeout(timeout_id id) {
+      if (id == m_timeout) {
+        delete m_timeout;
+        m_timeout = NULL;
+      }
+    }
+
+    bool HasTimeout() const { return m_timeout != NULL; }
+    void RunTimeout() { m_timeout->Run(); }
+
+  private:
+    ola::Callback0<bool> *m_timeout;
+};
+
+
+class RDMStatusCollectorTest: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(RDMStatusCollectorTest);
+  CPPUNIT_TEST(testBudget);
+  CPPUNIT_TEST(testQueuedMessages);
+  CPPUNIT_TEST(testNackReason);
+  CPPUNIT_TEST(testPerPortLimit);
+  CPPUNIT_TEST(testPerPortBudget);
+  CPPUNIT_TEST(testDelete);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    RDMStatusCollectorTest()
+        : m_source_uid(0x7a70, 100),
+          m_uid1(0x7a70, 1),
+          m_uid2(0x7a70, 2),
+          m_uid3(0x7a70, 3),
+          m_nack_reason(ola::rdm::NR_UNKNOWN_PID) {
+    }
+
+    void setUp();
+    void tearDown();
+    void testBudget();
+    void testQueuedMessages();
+    void testNackReason();
+    void testPerPortLimit();
+    void testPerPortBudget();
+    void testDelete();
+
+  private:
+    typedef vector<pair<const RDMRequest*, RDMCallback*> > HeldRequests;
+    typedef vector<string> PollList;
+    typedef pair<UID, uint16_t> Status;
+
+    UID m_source_uid, m_uid1, m_uid2, m_uid3;
+    UIDSet m_uids;
+    ola::MemoryPreferences *m_preferences;
+    ola::UniverseStore *m_store;
+    ClientBroker m_broker;
+    MockPollScheduler m_scheduler;
+    MockClock m_clock;
+    HeldRequests m_held_requests;
+    PollList m_polls;
+    vector<Status> m_status;
+    map<UID, unsigned int> m_queued_messages;
+    ola::rdm::rdm_nack_reason m_nack_reason;
+
+    RDMStatusCollector *NewCollector();
+    void AdvanceAndPoll(unsigned int ms);
+    void CompleteRequest(unsigned int i);
+    void HoldRequest(const RDMRequest *request, RDMCallback *callback);
+    void Respond(const RDMRequest *request, RDMCallback *callback);
+    void StatusReceived(unsigned int universe, const RDMResponse *response);
+
+    static string PollName(const UID &uid, uint16_t pid);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RDMStatusCollectorTest);
+
+static const unsigned int TEST_UNIVERSE = 1;
+
+
+void RDMStatusCollectorTest::setUp() {
+  ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
+  m_preferences = new ola::MemoryPreferences("foo");
+  m_store = new ola::UniverseStore(m_preferences, NULL);
+  m_uids.AddUID(m_uid1);
+  m_uids.AddUID(m_uid2);
+  m_uids.AddUID(m_uid3);
+}
+
+
+void RDMStatusCollectorTest::tearDown() {
+  delete m_store;
+  delete m_preferences;
+}
+
+
+/*
+ * Check that the UIDs are polled round robin, and that polling stops once the
+ * bus time budget has been used.
+ */
+void RDMStatusCollectorTest::testBudget() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMStatusCollectorTest::HoldRequest));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+  OLA_ASSERT(m_scheduler.HasTimeout());
+
+  // 20% of 100ms is 20ms of bus time, with one request in flight per port
+  AdvanceAndPoll(100);
+  OLA_ASSERT_EQ(1u, collector->InFlightCount());
+  OLA_ASSERT_EQ(1u, static_cast<unsigned int>(m_held_requests.size()));
+  const RDMRequest *request = m_held_requests[0].first;
+  OLA_ASSERT_EQ(m_uid1, request->DestinationUID());
+  OLA_ASSERT_EQ(m_source_uid, request->SourceUID());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_QUEUED_MESSAGE),
+                request->ParamId());
+  OLA_ASSERT_EQ(1u, request->ParamDataSize());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(ola::rdm::STATUS_ADVISORY),
+                request->ParamData()[0]);
+
+  // each request takes 8ms, so the budget is used up after three polls
+  for (unsigned int i = 0; i < 3; i++) {
+    m_clock.AdvanceTime(0, 8000);
+    CompleteRequest(i);
+  }
+  PollList expected;
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  OLA_ASSERT_EQ(0u, collector->InFlightCount());
+
+  // the next period starts a new sweep, once the overspend is paid off
+  AdvanceAndPoll(100);
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  OLA_ASSERT_TRUE(m_status.empty());
+
+  // responses to polls in flight are dropped once the collector is deleted
+  delete collector;
+  OLA_ASSERT_FALSE(m_scheduler.HasTimeout());
+  CompleteRequest(3);
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that queues are drained, and that responders which don't support
+ * QUEUED_MESSAGE are polled with STATUS_MESSAGES.
+ */
+void RDMStatusCollectorTest::testQueuedMessages() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMStatusCollectorTest::Respond));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+  m_queued_messages[m_uid1] = 2;
+  m_queued_messages[m_uid2] = 1;
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+  AdvanceAndPoll(100);
+
+  // uid1 is drained before the sweep moves on.
+  PollList expected;
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  OLA_ASSERT_EQ(2u, static_cast<unsigned int>(m_status.size()));
+  OLA_ASSERT_EQ(m_uid1, m_status[0].first);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_DMX_START_ADDRESS),
+                m_status[0].second);
+
+  // the next sweep falls back to STATUS_MESSAGES for uid2 & uid3
+  m_polls.clear();
+  AdvanceAndPoll(100);
+  expected.clear();
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_STATUS_MESSAGES));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_STATUS_MESSAGES));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  OLA_ASSERT_EQ(3u, static_cast<unsigned int>(m_status.size()));
+  OLA_ASSERT_EQ(m_uid2, m_status[2].first);
+  OLA_ASSERT_EQ(static_cast<uint16_t>(ola::rdm::PID_STATUS_MESSAGES),
+                m_status[2].second);
+
+  // uid3 doesn't support either, and the empty status messages aren't
+  // reported.
+  m_polls.clear();
+  AdvanceAndPoll(100);
+  expected.clear();
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_STATUS_MESSAGES));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  OLA_ASSERT_EQ(3u, static_cast<unsigned int>(m_status.size()));
+
+  delete collector;
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that only a NACK with NR_UNKNOWN_PID causes the collector to stop
+ * using a PID.
+ */
+void RDMStatusCollectorTest::testNackReason() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMStatusCollectorTest::Respond));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+  m_nack_reason = ola::rdm::NR_HARDWARE_FAULT;
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+
+  // uid2 & uid3 keep being polled with QUEUED_MESSAGE
+  PollList expected;
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  for (unsigned int i = 0; i < 2; i++) {
+    m_polls.clear();
+    AdvanceAndPoll(100);
+    OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+  }
+
+  // once uid3 reports the PID as unknown, it falls back to STATUS_MESSAGES
+  m_nack_reason = ola::rdm::NR_UNKNOWN_PID;
+  m_polls.clear();
+  AdvanceAndPoll(100);
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  m_polls.clear();
+  AdvanceAndPoll(100);
+  expected.clear();
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_STATUS_MESSAGES));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_STATUS_MESSAGES));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  delete collector;
+  universe->RemovePort(&port);
+}
+
+
+/*
+ * Check that the in flight limit applies to each port.
+ */
+void RDMStatusCollectorTest::testPerPortLimit() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  UIDSet port1_uids, port2_uids;
+  port1_uids.AddUID(m_uid1);
+  port1_uids.AddUID(m_uid2);
+  port2_uids.AddUID(m_uid3);
+  TestMockRDMOutputPort port1(NULL, 1, &port1_uids, true);
+  TestMockRDMOutputPort port2(NULL, 2, &port2_uids, true);
+  port1.SetRDMHandler(
+      NewCallback(this, &RDMStatusCollectorTest::HoldRequest));
+  port2.SetRDMHandler(
+      NewCallback(this, &RDMStatusCollectorTest::HoldRequest));
+  universe->AddPort(&port1);
+  port1.SetUniverse(universe);
+  universe->AddPort(&port2);
+  port2.SetUniverse(universe);
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+
+  // one poll on each port, uid2 waits for port 1
+  AdvanceAndPoll(100);
+  OLA_ASSERT_EQ(2u, collector->InFlightCount());
+  PollList expected;
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  // port 2 frees up, uid2 is still waiting for port 1 so a new sweep starts
+  // and uid3 is polled again.
+  m_clock.AdvanceTime(0, 1000);
+  CompleteRequest(1);
+  OLA_ASSERT_EQ(2u, collector->InFlightCount());
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  // port 1 frees up and uid2 goes next, it isn't queued twice.
+  m_clock.AdvanceTime(0, 1000);
+  CompleteRequest(0);
+  OLA_ASSERT_EQ(2u, collector->InFlightCount());
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  delete collector;
+  CompleteRequest(2);
+  CompleteRequest(3);
+  universe->RemovePort(&port1);
+  universe->RemovePort(&port2);
+}
+
+
+/*
+ * Check that the round trip time is charged to the port the poll was sent on,
+ * so a slow port doesn't stop the others being polled.
+ */
+void RDMStatusCollectorTest::testPerPortBudget() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  UIDSet port1_uids, port2_uids;
+  port1_uids.AddUID(m_uid1);
+  port1_uids.AddUID(m_uid2);
+  port2_uids.AddUID(m_uid3);
+  TestMockRDMOutputPort port1(NULL, 1, &port1_uids, true);
+  TestMockRDMOutputPort port2(NULL, 2, &port2_uids, true);
+  port1.SetRDMHandler(
+      NewCallback(this, &RDMStatusCollectorTest::HoldRequest));
+  port2.SetRDMHandler(NewCallback(this, &RDMStatusCollectorTest::Respond));
+  universe->AddPort(&port1);
+  port1.SetUniverse(universe);
+  universe->AddPort(&port2);
+  port2.SetUniverse(universe);
+  // keep uid3 on QUEUED_MESSAGE
+  m_nack_reason = ola::rdm::NR_HARDWARE_FAULT;
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+
+  // each port has 20ms of bus time, uid3 answers straight away
+  AdvanceAndPoll(100);
+  PollList expected;
+  expected.push_back(PollName(m_uid1, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  // the poll to uid1 takes 60ms, which uses up the budget for port 1, but
+  // port 2 carries on.
+  m_clock.AdvanceTime(0, 60000);
+  CompleteRequest(0);
+  OLA_ASSERT_EQ(0u, collector->InFlightCount());
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  // port 1 is still paying off the overspend
+  AdvanceAndPoll(100);
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  // and then uid2 is polled
+  AdvanceAndPoll(200);
+  expected.push_back(PollName(m_uid2, ola::rdm::PID_QUEUED_MESSAGE));
+  expected.push_back(PollName(m_uid3, ola::rdm::PID_QUEUED_MESSAGE));
+  OLA_ASSERT_VECTOR_EQ(expected, m_polls);
+
+  delete collector;
+  CompleteRequest(1);
+  universe->RemovePort(&port1);
+  universe->RemovePort(&port2);
+}
+
+
+/*
+ * Check that the state is cleaned up when a universe is removed.
+ */
+void RDMStatusCollectorTest::testDelete() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT_NOT_NULL(universe);
+  TestMockRDMOutputPort port(NULL, 1, &m_uids, true);
+  port.SetRDMHandler(NewCallback(this, &RDMStatusCollectorTest::HoldRequest));
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+
+  RDMStatusCollector *collector = NewCollector();
+  collector->Start();
+  AdvanceAndPoll(100);
+  OLA_ASSERT_EQ(1u, collector->InFlightCount());
+
+  // the poll uses up the budget
+  m_clock.AdvanceTime(0, 20000);
+  CompleteRequest(0);
+  OLA_ASSERT_EQ(0u, collector->InFlightCount());
+
+  universe->RemovePort(&port);
+  m_store->GarbageCollectUniverses();
+  OLA_ASSERT_NULL(m_store->GetUniverse(TEST_UNIVERSE));
+
+  // no more polls are sent once the universe has gone
+  AdvanceAndPoll(100);
+  OLA_ASSERT_EQ(1u, static_cast<unsigned int>(m_polls.size()));
+
+  collector->Stop();
+  OLA_ASSERT_FALSE(m_scheduler.HasTimeout());
+  delete collector;
+}
+
+
+RDMStatusCollector *RDMStatusCollectorTest::NewCollector() {
+  return new RDMStatusCollector(
+      m_store, &m_broker, &m_scheduler, &m_clock, m_source_uid,
+      NewCallback(this, &RDMStatusCollectorTest::StatusReceived));
+}
+
+
+void RDMStatusCollectorTest::AdvanceAndPoll(unsigned int ms) {
+  m_clock.AdvanceTime(0, ms * 1000);
+  m_scheduler.RunTimeout();
+}
+
+
+/*
+ * Time out a request that was held by the port.
+ */
+void RDMStatusCollectorTest::CompleteRequest(unsigned int i) {
+  OLA_ASSERT_LT(i, static_cast<unsigned int>(m_held_requests.size()));
+  delete m_held_requests[i].first;
+  vector<string> packets;
+  m_held_requests[i].second->Run(ola::rdm::RDM_TIMEOUT, NULL, packets);
+}
+
+
+void RDMStatusCollectorTest::HoldRequest(const RDMRequest *request,
+                                         RDMCallback *callback) {
+  m_polls.push_back(PollName(request->DestinationUID(), request->ParamId()));
+  m_held_requests.push_back(
+      pair<const RDMRequest*, RDMCallback*>(request, callback));
+}
+
+
+/*
+ * A responder for each UID:
+ *  uid1 supports QUEUED_MESSAGE, and returns the queued DMX_START_ADDRESS
+ *    messages.
+ *  uid2 only supports STATUS_MESSAGES, and returns one status message for
+ *    each queued message.
+ *  uid3 supports neither, and NACKs with m_nack_reason.
+ */
+void RDMStatusCollectorTest::Respond(const RDMRequest *request,
+                                     RDMCallback *callback) {
+  const UID uid = request->DestinationUID();
+  const uint16_t pid = request->ParamId();
+  m_polls.push_back(PollName(uid, pid));
+
+  RDMResponse *response;
+  unsigned int &queued = m_queued_messages[uid];
+  if (uid == m_uid1 && pid == ola::rdm::PID_QUEUED_MESSAGE && queued) {
+    queued--;
+    uint8_t start_address[] = {0, 1};
+    response = ola::rdm::GetResponseWithPid(
+        request, ola::rdm::PID_DMX_START_ADDRESS, start_address,
+        sizeof(start_address), ola::rdm::RDM_ACK, queued);
+  } else if ((uid == m_uid1 && pid == ola::rdm::PID_QUEUED_MESSAGE) ||
+             (uid == m_uid2 && pid == ola::rdm::PID_STATUS_MESSAGES)) {
+    // sub device, status type, message id, data value 1 & 2
+    uint8_t status_message[] = {0, 0, ola::rdm::STATUS_ERROR, 0, 0x33,
+                                0, 1, 0, 0};
+    response = ola::rdm::GetResponseWithPid(
+        request, ola::rdm::PID_STATUS_MESSAGES, status_message,
+        queued ? sizeof(status_message) : 0);
+    if (queued)
+      queued--;
+  } else {
+    response = ola::rdm::NackWithReason(request, m_nack_reason);
+  }
+
+  delete request;
+  vector<string> packets;
+  callback->Run(ola::rdm::RDM_COMPLETED_OK, response, packets);
+}
+
+
+void RDMStatusCollectorTest::StatusReceived(unsigned int universe,
+                                            const RDMResponse *response) {
+  OLA_ASSERT_EQ(TEST_UNIVERSE, universe);
+  m_status.push_back(Status(response->SourceUID(), response->ParamId()));
+}
+
+
+string RDMStatusCollectorTest::PollName(const UID &uid, uint16_t pid) {
+  return uid.ToString() + " " + ola::IntToString(pid);
+}
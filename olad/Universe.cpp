@@ -57,8 +57,14 @@ const char Universe::K_MERGE_HTP_STR[] = "htp";
 const char Universe::K_MERGE_LTP_STR[] = "ltp";
 const char Universe::K_UNIVERSE_INPUT_PORT_VAR[] = "universe-input-ports";
 const char Universe::K_UNIVERSE_MODE_VAR[] = "universe-mode";
+const char Universe::K_PORT_RDM_DISCOVERY_TIME_VAR[] =
+    "port-rdm-discovery-time-ms";
 const char Universe::K_UNIVERSE_NAME_VAR[] = "universe-name";
 const char Universe::K_UNIVERSE_OUTPUT_PORT_VAR[] = "universe-output-ports";
+const char Universe::K_UNIVERSE_RDM_CACHE_HITS_VAR[] =
+    "universe-rdm-cache-hits";
+const char Universe::K_UNIVERSE_RDM_CACHE_MISSES_VAR[] =
+    "universe-rdm-cache-misses";
 const char Universe::K_UNIVERSE_RDM_REQUESTS[] = "universe-rdm-requests";
 const char Universe::K_UNIVERSE_SINK_CLIENTS_VAR[] = "universe-sink-clients";
 const char Universe::K_UNIVERSE_SOURCE_CLIENTS_VAR[] =
@@ -81,7 +87,8 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
       m_export_map(export_map),
       m_clock(clock),
       m_rdm_discovery_interval(),
-      m_last_discovery_time() {
+      m_last_discovery_time(),
+      m_rdm_cache(clock) {
   stringstream universe_id_str, universe_name_str;
   universe_id_str << universe_id;
   m_universe_id_str = universe_id_str.str();
@@ -95,6 +102,8 @@ Universe::Universe(unsigned int universe_id, UniverseStore *store,
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS_VAR,
+    K_UNIVERSE_RDM_CACHE_MISSES_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -125,6 +134,8 @@ Universe::~Universe() {
     K_FPS_VAR,
     K_UNIVERSE_INPUT_PORT_VAR,
     K_UNIVERSE_OUTPUT_PORT_VAR,
+    K_UNIVERSE_RDM_CACHE_HITS_VAR,
+    K_UNIVERSE_RDM_CACHE_MISSES_VAR,
     K_UNIVERSE_RDM_REQUESTS,
     K_UNIVERSE_SINK_CLIENTS_VAR,
     K_UNIVERSE_SOURCE_CLIENTS_VAR,
@@ -201,10 +212,14 @@ bool Universe::RemovePort(InputPort *port) {
  */
 bool Universe::RemovePort(OutputPort *port) {
   bool ret = GenericRemovePort(port, &m_output_ports, &m_output_uids);
+  m_rdm_cache.InvalidateAll();
 
-  if (m_export_map)
+  if (m_export_map) {
     (*m_export_map->GetUIntMapVar(K_UNIVERSE_UID_COUNT_VAR))[m_universe_id_str]
       = m_output_uids.size();
+    m_export_map->GetUIntMapVar(K_PORT_RDM_DISCOVERY_TIME_VAR)->Remove(
+        port->UniqueId());
+  }
   return ret;
 }
 
@@ -421,11 +436,27 @@ void Universe::CleanStaleSourceClients() {
 
 /*
  * Handle a RDM request for this universe, ownership of the request object is
- * transferred to this method.
- * @returns true if this request was sent to an Output port, false otherwise
+ * transferred to this method. The request is sent with interactive priority.
  */
 void Universe::SendRDMRequest(const ola::rdm::RDMRequest *request,
                               ola::rdm::RDMCallback *callback) {
+  SendRDMRequest(request, callback,
+                 ola::rdm::QueueingRDMController::INTERACTIVE_PRIORITY);
+}
+
+
+/*
+ * Handle a RDM request for this universe, ownership of the request object is
+ * transferred to this method.
+ * @param request the RDM request
+ * @param callback the callback to run when the request completes
+ * @param priority the queueing priority, polling and other bulk requests
+ *   should use BACKGROUND_PRIORITY so they don't delay interactive ones.
+ */
+void Universe::SendRDMRequest(
+    const ola::rdm::RDMRequest *request,
+    ola::rdm::RDMCallback *callback,
+    ola::rdm::QueueingRDMController::RequestPriority priority) {
   OLA_INFO << "Universe " << UniverseId() << ", RDM request to " <<
     request->DestinationUID() << ", SD: " << request->SubDevice() << ", CC "
       << std::hex << request->CommandClass() << ", TN "
@@ -435,6 +466,14 @@ void Universe::SendRDMRequest(const ola::rdm::RDMRequest *request,
 
   SafeIncrement(K_UNIVERSE_RDM_REQUESTS);
 
+  // a SET may change what the device returns for a GET
+  if (request->CommandClass() == ola::rdm::RDMCommand::SET_COMMAND) {
+    if (request->DestinationUID().IsBroadcast())
+      m_rdm_cache.InvalidateAll();
+    else
+      m_rdm_cache.Invalidate(request->DestinationUID());
+  }
+
   if (request->DestinationUID().IsBroadcast()) {
     const bool is_dub = (
         request->CommandClass() == ola::rdm::RDMCommand::DISCOVER_COMMAND &&
@@ -460,9 +499,10 @@ void Universe::SendRDMRequest(const ola::rdm::RDMRequest *request,
                               &Universe::HandleBroadcastDiscovery,
                               tracker));
       } else  {
-        (*port_iter)->SendRDMRequest(
+        (*port_iter)->SendPrioritizedRDMRequest(
             request->Duplicate(),
-            NewSingleCallback(this, &Universe::HandleBroadcastAck, tracker));
+            NewSingleCallback(this, &Universe::HandleBroadcastAck, tracker),
+            priority);
       }
     }
     delete request;
@@ -476,8 +516,10 @@ void Universe::SendRDMRequest(const ola::rdm::RDMRequest *request,
       std::vector<std::string> packets;
       callback->Run(ola::rdm::RDM_UNKNOWN_UID, NULL, packets);
       delete request;
+    } else if (m_rdm_cache.IsCacheable(*request)) {
+      SendCacheableRDMRequest(iter->second, request, callback, priority);
     } else {
-      iter->second->SendRDMRequest(request, callback);
+      iter->second->SendPrioritizedRDMRequest(request, callback, priority);
     }
   }
 }
@@ -494,6 +536,7 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
       m_universe_id;
 
   m_clock->CurrentTime(&m_last_discovery_time);
+  const TimeStamp start_time = m_last_discovery_time;
 
   // we need to make a copy of the ports first, because the callback may run at
   // any time so we need to guard against the port list changing.
@@ -515,13 +558,15 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
           NewSingleCallback(this,
                             &Universe::PortDiscoveryComplete,
                             discovery_complete,
-                            *iter));
+                            *iter,
+                            start_time));
     } else {
       (*iter)->RunIncrementalDiscovery(
           NewSingleCallback(this,
                             &Universe::PortDiscoveryComplete,
                             discovery_complete,
-                            *iter));
+                            *iter,
+                            start_time));
     }
   }
 }
@@ -533,9 +578,10 @@ void Universe::RunRDMDiscovery(RDMDiscoveryCallback *on_complete, bool full) {
 void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
   map<UID, OutputPort*>::iterator iter = m_output_uids.begin();
   while (iter != m_output_uids.end()) {
-    if (iter->second == port && !uids.Contains(iter->first))
+    if (iter->second == port && !uids.Contains(iter->first)) {
+      m_rdm_cache.Invalidate(iter->first);
       m_output_uids.erase(iter++);
-    else
+    } else
       ++iter;
   }
 
@@ -543,6 +589,7 @@ void Universe::NewUIDList(OutputPort *port, const ola::rdm::UIDSet &uids) {
   for (; set_iter != uids.End(); ++set_iter) {
     iter = m_output_uids.find(*set_iter);
     if (iter == m_output_uids.end()) {
+      m_rdm_cache.Invalidate(*set_iter);
       m_output_uids[*set_iter] = port;
     } else if (iter->second != port) {
       OLA_WARN << "UID " << *set_iter << " seen on more than one port";
@@ -573,6 +620,16 @@ unsigned int Universe::UIDCount() const {
 }
 
 
+/**
+ * Return the output port a UID was discovered on, or NULL if the UID isn't
+ * in this universe.
+ */
+const OutputPort *Universe::OutputPortForUID(const UID &uid) const {
+  map<UID, OutputPort*>::const_iterator iter = m_output_uids.find(uid);
+  return iter == m_output_uids.end() ? NULL : iter->second;
+}
+
+
 /*
  * Return true if this universe is in use (has at least one port or client).
  */
@@ -750,11 +807,24 @@ bool Universe::MergeAll(const InputPort *port, const Client *client) {
 
 
 /**
- * Called when discovery completes on a single ports.
+ * Called when discovery completes on a single port. This records how long
+ * discovery took on the port.
  */
 void Universe::PortDiscoveryComplete(BaseCallback0<void> *on_complete,
                                      OutputPort *output_port,
+                                     TimeStamp start_time,
                                      const ola::rdm::UIDSet &uids) {
+  TimeStamp now;
+  m_clock->CurrentTime(&now);
+  TimeInterval duration = now - start_time;
+  const string port_id = output_port->UniqueId();
+  OLA_INFO << "RDM discovery on port " << port_id << " took " << duration
+           << ", found " << uids.Size() << " UIDs";
+  if (m_export_map && !port_id.empty()) {
+    (*m_export_map->GetUIntMapVar(K_PORT_RDM_DISCOVERY_TIME_VAR))[port_id] =
+        duration.InMilliSeconds();
+  }
+
   NewUIDList(output_port, uids);
   on_complete->Run();
 }
@@ -849,6 +919,54 @@ void Universe::HandleBroadcastDiscovery(
 }
 
 
+/*
+ * Send a GET that can be answered from the RDM response cache. If there isn't
+ * a cached response the request is sent to the port and the response is
+ * added to the cache.
+ */
+void Universe::SendCacheableRDMRequest(
+    OutputPort *port,
+    const ola::rdm::RDMRequest *request,
+    ola::rdm::RDMCallback *callback,
+    ola::rdm::QueueingRDMController::RequestPriority priority) {
+  vector<string> packets;
+  const ola::rdm::RDMResponse *response = m_rdm_cache.Lookup(*request,
+                                                             &packets);
+  if (response) {
+    SafeIncrement(K_UNIVERSE_RDM_CACHE_HITS_VAR);
+    OLA_DEBUG << "Using cached response for PID 0x" << std::hex
+              << request->ParamId() << " from " << request->DestinationUID();
+    delete request;
+    callback->Run(ola::rdm::RDM_COMPLETED_OK, response, packets);
+    return;
+  }
+
+  SafeIncrement(K_UNIVERSE_RDM_CACHE_MISSES_VAR);
+  cacheable_request_tracker *tracker = new cacheable_request_tracker(
+      *request,
+      m_rdm_cache.Generation(request->DestinationUID()),
+      callback);
+  port->SendPrioritizedRDMRequest(
+      request,
+      NewSingleCallback(this, &Universe::HandleCacheableResponse, tracker),
+      priority);
+}
+
+
+/*
+ * Handle the response to a cacheable GET.
+ */
+void Universe::HandleCacheableResponse(cacheable_request_tracker *tracker,
+                                       ola::rdm::rdm_response_code code,
+                                       const ola::rdm::RDMResponse *response,
+                                       const vector<string> &packets) {
+  if (code == ola::rdm::RDM_COMPLETED_OK && response)
+    m_rdm_cache.Add(tracker->key, tracker->generation, *response, packets);
+  tracker->callback->Run(code, response, packets);
+  delete tracker;
+}
+
+
 /*
  * Helper function to increment an Export Map variable
  */
@@ -19,13 +19,16 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <deque>
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "ola/Callback.h"
 #include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
+#include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMResponseCodes.h"
 #include "ola/rdm/UID.h"
@@ -50,12 +53,14 @@ using ola::NewSingleCallback;
 using ola::TimeStamp;
 using ola::Universe;
 using ola::rdm::NewDiscoveryUniqueBranchRequest;
+using ola::rdm::QueueingRDMController;
 using ola::rdm::RDMCallback;
 using ola::rdm::RDMRequest;
 using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using ola::rdm::rdm_response_code;
+using std::pair;
 using std::string;
 using std::vector;
 
@@ -75,6 +80,7 @@ class UniverseTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testHtpMerging);
   CPPUNIT_TEST(testRDMDiscovery);
   CPPUNIT_TEST(testRDMSend);
+  CPPUNIT_TEST(testRDMPriority);
   CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -90,6 +96,7 @@ class UniverseTest: public CppUnit::TestFixture {
     void testHtpMerging();
     void testRDMDiscovery();
     void testRDMSend();
+    void testRDMPriority();
 
   private:
     ola::MemoryPreferences *m_preferences;
@@ -134,6 +141,78 @@ class MockClient: public ola::Client {
 CPPUNIT_TEST_SUITE_REGISTRATION(UniverseTest);
 
 
+/*
+ * A controller that holds each request until the test completes it, this
+ * lets us see the order the requests are put on the wire.
+ */
+class HoldingRDMController: public ola::rdm::RDMControllerInterface {
+  public:
+    HoldingRDMController() {}
+    ~HoldingRDMController() { OLA_ASSERT_TRUE(m_requests.empty()); }
+
+    void SendRDMRequest(const RDMRequest *request, RDMCallback *callback) {
+      m_requests.push_back(std::make_pair(request, callback));
+    }
+
+    unsigned int PendingCount() const { return m_requests.size(); }
+    uint16_t PendingParamId() const {
+      return m_requests.front().first->ParamId();
+    }
+
+    // Complete the oldest request with a timeout.
+    void TimeoutRequest() {
+      pair<const RDMRequest*, RDMCallback*> request = m_requests.front();
+      m_requests.pop_front();
+      delete request.first;
+      vector<string> packets;
+      request.second->Run(ola::rdm::RDM_TIMEOUT, NULL, packets);
+    }
+
+  private:
+    std::deque<pair<const RDMRequest*, RDMCallback*> > m_requests;
+};
+
+
+/*
+ * An RDM output port that queues requests, like most of the hardware
+ * plugins do.
+ */
+class QueueingMockOutputPort: public TestMockOutputPort {
+  public:
+    QueueingMockOutputPort(unsigned int port_id,
+                           UIDSet *uids,
+                           HoldingRDMController *wire)
+        : TestMockOutputPort(NULL, port_id, true, true),
+          m_uids(uids),
+          m_controller(wire, 10) {
+    }
+
+    void SendRDMRequest(const RDMRequest *request, RDMCallback *callback) {
+      m_controller.SendRDMRequest(request, callback);
+    }
+
+    void SendPrioritizedRDMRequest(
+        const RDMRequest *request,
+        RDMCallback *callback,
+        QueueingRDMController::RequestPriority priority) {
+      m_controller.SendRDMRequest(request, callback, priority);
+    }
+
+    void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *on_complete) {
+      on_complete->Run(*m_uids);
+    }
+
+    void RunIncrementalDiscovery(
+        ola::rdm::RDMDiscoveryCallback *on_complete) {
+      on_complete->Run(*m_uids);
+    }
+
+  private:
+    UIDSet *m_uids;
+    QueueingRDMController m_controller;
+};
+
+
 void UniverseTest::setUp() {
   ola::InitLogging(ola::OLA_LOG_INFO, ola::OLA_LOG_STDERR);
   m_preferences = new ola::MemoryPreferences("foo");
@@ -802,6 +881,66 @@ void UniverseTest::testRDMSend() {
 }
 
 
+/**
+ * Check that an interactive GET sent through the universe overtakes queued
+ * background polls.
+ */
+void UniverseTest::testRDMPriority() {
+  Universe *universe = m_store->GetUniverseOrCreate(TEST_UNIVERSE);
+  OLA_ASSERT(universe);
+
+  UID uid(0x7a70, 1);
+  UID source_uid(0x7a70, 100);
+  UIDSet port_uids;
+  port_uids.AddUID(uid);
+  HoldingRDMController wire;
+  QueueingMockOutputPort port(1, &port_uids, &wire);
+  universe->AddPort(&port);
+  port.SetUniverse(universe);
+  OLA_ASSERT_EQ(1u, universe->UIDCount());
+
+  // three background polls, the first goes straight on the wire
+  for (uint16_t pid = 0x8000; pid < 0x8003; pid++) {
+    universe->SendRDMRequest(
+        new ola::rdm::RDMGetRequest(source_uid, uid, 0, 1, 0, 10, pid, NULL,
+                                    0),
+        NewSingleCallback(this,
+                          &UniverseTest::ConfirmRDM,
+                          __LINE__,
+                          ola::rdm::RDM_TIMEOUT,
+                          reinterpret_cast<const RDMResponse*>(NULL)),
+        QueueingRDMController::BACKGROUND_PRIORITY);
+  }
+  OLA_ASSERT_EQ(1u, wire.PendingCount());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8000), wire.PendingParamId());
+
+  // now an interactive GET, using the default priority
+  universe->SendRDMRequest(
+      new ola::rdm::RDMGetRequest(source_uid, uid, 0, 1, 0, 10, 0x8100, NULL,
+                                  0),
+      NewSingleCallback(this,
+                        &UniverseTest::ConfirmRDM,
+                        __LINE__,
+                        ola::rdm::RDM_TIMEOUT,
+                        reinterpret_cast<const RDMResponse*>(NULL)));
+
+  // once the poll on the wire completes, the interactive GET goes next
+  wire.TimeoutRequest();
+  OLA_ASSERT_EQ(1u, wire.PendingCount());
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8100), wire.PendingParamId());
+
+  // and then the rest of the polls, in order
+  wire.TimeoutRequest();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8001), wire.PendingParamId());
+  wire.TimeoutRequest();
+  OLA_ASSERT_EQ(static_cast<uint16_t>(0x8002), wire.PendingParamId());
+  wire.TimeoutRequest();
+  OLA_ASSERT_EQ(0u, wire.PendingCount());
+
+  universe->RemovePort(&port);
+}
+
+
 /**
  * Check we got the uids we expect
  */
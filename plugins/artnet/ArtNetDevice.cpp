@@ -70,6 +70,7 @@ const char ArtNetDevice::K_LONG_NAME_KEY[] = "long_name";
 const char ArtNetDevice::K_LOOPBACK_KEY[] = "use_loopback";
 const char ArtNetDevice::K_NET_KEY[] = "net";
 const char ArtNetDevice::K_OUTPUT_PORT_KEY[] = "output_ports";
+const char ArtNetDevice::K_POLL_REPLY_RATE_KEY[] = "poll_reply_rate";
 const char ArtNetDevice::K_SHORT_NAME_KEY[] = "short_name";
 const char ArtNetDevice::K_SUBNET_KEY[] = "subnet";
 
@@ -117,6 +118,8 @@ bool ArtNetDevice::StartHook() {
   // OLA Output ports are ArtNet input ports
   StringToInt(m_preferences->GetValue(K_OUTPUT_PORT_KEY),
               &node_options.input_port_count);
+  StringToInt(m_preferences->GetValue(K_POLL_REPLY_RATE_KEY),
+              &node_options.poll_reply_rate);
 
   m_node = new ArtNetNode(interface, m_plugin_adaptor, node_options);
   m_node->SetNetAddress(net);
@@ -63,6 +63,7 @@ class ArtNetDevice: public Device {
   static const char K_LOOPBACK_KEY[];
   static const char K_NET_KEY[];
   static const char K_OUTPUT_PORT_KEY[];
+  static const char K_POLL_REPLY_RATE_KEY[];
   static const char K_SHORT_NAME_KEY[];
   static const char K_SUBNET_KEY[];
   // 10s between polls when we're sending data, DMX-workshop uses 8s;
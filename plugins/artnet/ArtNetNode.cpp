@@ -34,6 +34,7 @@
 #include "ola/network/SocketAddress.h"
 #include "ola/rdm/RDMCommandSerializer.h"
 #include "ola/rdm/RDMEnums.h"
+#include "ola/rdm/RDMHelper.h"
 #include "ola/stl/STLUtils.h"
 #include "plugins/artnet/ArtNetNode.h"
 
@@ -196,7 +197,10 @@ ArtNetNodeImpl::ArtNetNodeImpl(const ola::network::Interface &interface,
       m_use_limited_broadcast_address(options.use_limited_broadcast_address),
       m_in_configuration_mode(false),
       m_interface(interface),
-      m_socket(socket) {
+      m_socket(socket),
+      m_poll_reply_valid(false),
+      m_poll_reply_rate(options.poll_reply_rate),
+      m_poll_reply_timeout(ola::thread::INVALID_TIMEOUT) {
 
   if (!m_socket.get())
     m_socket.reset(new UDPSocket());
@@ -249,6 +253,12 @@ bool ArtNetNodeImpl::Start() {
   if (m_running || !InitNetwork())
     return false;
 
+  if (m_poll_reply_rate) {
+    m_poll_reply_bucket.reset(new TokenBucket(m_poll_reply_rate,
+                                              m_poll_reply_rate,
+                                              m_poll_reply_rate,
+                                              *m_ss->WakeUpTime()));
+  }
   m_running = true;
   return true;
 }
@@ -293,6 +303,11 @@ bool ArtNetNodeImpl::Stop() {
     }
   }
 
+  if (m_poll_reply_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_poll_reply_timeout);
+    m_poll_reply_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
   m_ss->RemoveReadDescriptor(m_socket.get());
 
   m_running = false;
@@ -431,6 +446,8 @@ bool ArtNetNodeImpl::SetInputPortUniverse(uint8_t port_id,
   if (!port)
     return false;
 
+  if (!port->enabled)
+    InvalidatePollReply();
   port->enabled = true;
   if (port->SetUniverseAddress(universe_id)) {
     SendPollIfAllowed();
@@ -987,8 +1004,12 @@ bool ArtNetNodeImpl::SendPollIfAllowed() {
  * Send an ArtPollReply if we're both running and m_send_reply_on_change is
  * true. If we're in configuration mode, this sets m_artpollreply_required
  * instead of sending.
+ *
+ * This is called whenever the node state changes, so it also invalidates the
+ * cached ArtPollReply.
  */
 bool ArtNetNodeImpl::SendPollReplyIfRequired() {
+  InvalidatePollReply();
   if (m_running && m_send_reply_on_change) {
     if (m_in_configuration_mode) {
       m_artpollreply_required = true;
@@ -1004,7 +1025,34 @@ bool ArtNetNodeImpl::SendPollReplyIfRequired() {
  * Send an ArtPollReply message
  */
 bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
-  artnet_packet packet;
+  if (!m_poll_reply_valid)
+    BuildPollReply();
+
+  if (!SendPacket(m_poll_reply, sizeof(m_poll_reply.data.reply),
+                  destination)) {
+    OLA_INFO << "Failed to send ArtPollReply";
+    return false;
+  }
+  return true;
+}
+
+
+/*
+ * Called after we ran out of tokens for ArtPollReplies. This sends a single
+ * reply on behalf of all the ArtPolls received since then.
+ */
+void ArtNetNodeImpl::SendDeferredPollReply() {
+  m_poll_reply_timeout = ola::thread::INVALID_TIMEOUT;
+  SendPollReply(m_interface.bcast_address);
+}
+
+
+/*
+ * Build the ArtPollReply from the current state of the node and store it in
+ * m_poll_reply.
+ */
+void ArtNetNodeImpl::BuildPollReply() {
+  artnet_packet &packet = m_poll_reply;
   PopulatePacketHeader(&packet, ARTNET_REPLY);
   memset(&packet.data.reply, 0, sizeof(packet.data.reply));
 
@@ -1044,11 +1092,7 @@ bool ArtNetNodeImpl::SendPollReply(const IPV4Address &destination) {
   m_interface.ip_address.Get(packet.data.reply.bind_ip);
   // maybe set status2 here if the web UI is enabled
   packet.data.reply.status2 = 0x08;  // node supports 15 bit port addresses
-  if (!SendPacket(packet, sizeof(packet.data.reply), destination)) {
-    OLA_INFO << "Failed to send ArtPollReply";
-    return false;
-  }
-  return true;
+  m_poll_reply_valid = true;
 }
 
 
@@ -1153,6 +1197,18 @@ void ArtNetNodeImpl::HandlePollPacket(const IPV4Address &source_address,
     return;
 
   m_send_reply_on_change = packet.talk_to_me & 0x02;
+
+  if (m_poll_reply_bucket.get() &&
+      !m_poll_reply_bucket->GetToken(*m_ss->WakeUpTime())) {
+    // Too many polls, coalesce them into a single reply which is sent once
+    // there are tokens available again.
+    if (m_poll_reply_timeout == ola::thread::INVALID_TIMEOUT) {
+      m_poll_reply_timeout = m_ss->RegisterSingleTimeout(
+          (ONE_THOUSAND + m_poll_reply_rate - 1) / m_poll_reply_rate,
+          NewSingleCallback(this, &ArtNetNodeImpl::SendDeferredPollReply));
+    }
+    return;
+  }
   // It's unclear if this should be broadcast or unicast, stick with broadcast
   SendPollReply(m_interface.bcast_address);
   (void) source_address;
@@ -1413,14 +1469,23 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
   if (!rdm_length)
     return;
 
+  // Validate the message in place, the RDMCommands are only created once we
+  // know a port wants them.
+  RDMCommandView view;
+  ola::rdm::rdm_response_code code = view.Init(packet.data, rdm_length);
+  if (code != ola::rdm::RDM_COMPLETED_OK) {
+    OLA_INFO << "Dropping invalid ArtRDM from " << source_address << ": "
+             << ola::rdm::ResponseCodeToString(code);
+    return;
+  }
+
   // look for the port that this was sent to, once we know the port we can try
   // to parse the message
   for (uint8_t port_id = 0; port_id < ARTNET_MAX_PORTS; port_id++) {
     if (m_output_ports[port_id].enabled &&
         m_output_ports[port_id].universe_address == packet.address &&
         m_output_ports[port_id].on_rdm_request) {
-      RDMRequest *request = RDMRequest::InflateFromData(packet.data,
-                                                        rdm_length);
+      RDMRequest *request = view.ToRequest();
 
       if (request) {
         m_output_ports[port_id].on_rdm_request->Run(
@@ -1436,11 +1501,8 @@ void ArtNetNodeImpl::HandleRdm(const IPV4Address &source_address,
 
   InputPorts::iterator iter = m_input_ports.begin();
   for (; iter != m_input_ports.end(); ++iter) {
-    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address) {
-      string rdm_response(reinterpret_cast<const char*>(packet.data),
-                          rdm_length);
-      HandleRDMResponse(*iter, rdm_response, source_address);
-    }
+    if ((*iter)->enabled && (*iter)->PortAddress() == packet.address)
+      HandleRDMResponse(*iter, view, source_address);
   }
 }
 
@@ -1487,15 +1549,11 @@ void ArtNetNodeImpl::RDMRequestCompletion(
  * </rant>
  */
 void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
-                                       const string &response_data,
+                                       const RDMCommandView &response,
                                        const IPV4Address &source_address) {
-  ola::rdm::rdm_response_code code;
-  auto_ptr<const RDMResponse> response(RDMResponse::InflateFromData(
-      response_data, &code));
-
   // without a valid response, we don't know which request this matches. This
   // makes ArtNet rather useless for RDM regression testing
-  if (!response.get())
+  if (response.MessageType() != ola::rdm::RDM_RESPONSE)
     return;
 
   if (!port->pending_request) {
@@ -1503,44 +1561,44 @@ void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
   }
 
   const RDMRequest *request = port->pending_request;
-  if (request->SourceUID() != response->DestinationUID() ||
-      request->DestinationUID() != response->SourceUID()) {
+  if (request->SourceUID() != response.DestinationUID() ||
+      request->DestinationUID() != response.SourceUID()) {
     OLA_INFO << "Got response from/to unexpected UID: req "
              << request->SourceUID() << " -> " << request->DestinationUID()
-             << ", res " << response->SourceUID() << " -> "
-             << response->DestinationUID();
+             << ", res " << response.SourceUID() << " -> "
+             << response.DestinationUID();
     return;
   }
 
   if (request->ParamId() != ola::rdm::PID_QUEUED_MESSAGE &&
-      request->ParamId() != response->ParamId()) {
+      request->ParamId() != response.ParamId()) {
     OLA_INFO << "Param ID mismatch, request was 0x" << std::hex
              << request->ParamId() << ", response was 0x" << std::hex
-             << response->ParamId();
+             << response.ParamId();
     return;
   }
 
   if (request->ParamId() != ola::rdm::PID_QUEUED_MESSAGE &&
       request->SubDevice() != ola::rdm::ALL_RDM_SUBDEVICES &&
-      request->SubDevice() != response->SubDevice()) {
+      request->SubDevice() != response.SubDevice()) {
     OLA_INFO << "Subdevice mismatch, request was for"
              << request->SubDevice() << ", response was "
-             << response->SubDevice();
+             << response.SubDevice();
     return;
   }
 
   if (request->CommandClass() == RDMCommand::GET_COMMAND &&
-      response->CommandClass() != RDMCommand::GET_COMMAND_RESPONSE &&
+      response.CommandClass() != RDMCommand::GET_COMMAND_RESPONSE &&
       request->ParamId() != ola::rdm::PID_QUEUED_MESSAGE) {
     OLA_INFO << "Invalid return CC in response to get, was "
-             << static_cast<int>(response->CommandClass());
+             << static_cast<int>(response.CommandClass());
     return;
   }
 
   if (request->CommandClass() == RDMCommand::SET_COMMAND &&
-      response->CommandClass() != RDMCommand::SET_COMMAND_RESPONSE) {
+      response.CommandClass() != RDMCommand::SET_COMMAND_RESPONSE) {
     OLA_INFO << "Invalid return CC in response to set, was "
-             << static_cast<int>(response->CommandClass());
+             << static_cast<int>(response.CommandClass());
     return;
   }
 
@@ -1550,13 +1608,19 @@ void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
     return;
   }
 
+  // only now do we need an RDMResponse
+  auto_ptr<const RDMResponse> rdm_response(response.ToResponse());
+  if (!rdm_response.get())
+    return;
+
   // at this point we've decided it's for us
   port->pending_request = NULL;
   delete request;
   ola::rdm::RDMCallback *callback = port->rdm_request_callback;
   port->rdm_request_callback = NULL;
   vector<string> packets;
-  packets.push_back(response_data);
+  packets.push_back(string(reinterpret_cast<const char*>(response.Data()),
+                           response.Size()));
 
   // remove the timeout
   if (port->rdm_send_timeout != ola::thread::INVALID_TIMEOUT) {
@@ -1564,7 +1628,7 @@ void ArtNetNodeImpl::HandleRDMResponse(InputPort *port,
     port->rdm_send_timeout = ola::thread::INVALID_TIMEOUT;
   }
 
-  callback->Run(ola::rdm::RDM_COMPLETED_OK, response.release(), packets);
+  callback->Run(ola::rdm::RDM_COMPLETED_OK, rdm_response.release(), packets);
 }
 
 
@@ -1700,6 +1764,8 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
       return;
     }
     if (active_sources == 0) {
+      if (port->is_merging)
+        InvalidatePollReply();
       port->is_merging = false;
     } else {
       OLA_INFO << "Entered merge mode for universe "
@@ -1709,6 +1775,8 @@ void ArtNetNodeImpl::UpdatePortFromSource(OutputPort *port,
     }
     source_slot = first_empty_slot;
   } else if (active_sources == 1) {
+    if (port->is_merging)
+      InvalidatePollReply();
     port->is_merging = false;
   }
 
@@ -2065,14 +2133,17 @@ void ArtNetNode::RunIncrementalDiscovery(uint8_t port_id,
 /**
  * Send a RDM request by passing it though the Queuing Controller
  */
-void ArtNetNode::SendRDMRequest(uint8_t port_id, const RDMRequest *request,
-                                ola::rdm::RDMCallback *on_complete) {
+void ArtNetNode::SendRDMRequest(
+    uint8_t port_id,
+    const RDMRequest *request,
+    ola::rdm::RDMCallback *on_complete,
+    ola::rdm::QueueingRDMController::RequestPriority priority) {
   if (!CheckInputPortId(port_id)) {
     vector<std::string> packets;
     on_complete->Run(ola::rdm::RDM_FAILED_TO_SEND, NULL, packets);
     delete request;
   } else {
-    m_controllers[port_id]->SendRDMRequest(request, on_complete);
+    m_controllers[port_id]->SendRDMRequest(request, on_complete, priority);
   }
 }
 
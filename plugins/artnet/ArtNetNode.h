@@ -38,9 +38,11 @@
 #include "ola/network/Socket.h"
 #include "ola/rdm/QueueingRDMController.h"
 #include "ola/rdm/RDMCommand.h"
+#include "ola/rdm/RDMCommandView.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UIDSet.h"
 #include "ola/timecode/TimeCode.h"
+#include "olad/TokenBucket.h"
 #include "plugins/artnet/ArtNetPackets.h"
 
 namespace ola {
@@ -50,6 +52,7 @@ namespace artnet {
 using ola::network::IPV4Address;
 using ola::rdm::RDMCallback;
 using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandView;
 using ola::rdm::RDMDiscoveryCallback;
 using ola::rdm::RDMRequest;
 using ola::rdm::RDMResponse;
@@ -83,7 +86,8 @@ class ArtNetNodeOptions {
         use_limited_broadcast_address(false),
         rdm_queue_size(20),
         broadcast_threshold(30),
-        input_port_count(4) {
+        input_port_count(4),
+        poll_reply_rate(0) {
   }
 
   bool always_broadcast;
@@ -91,6 +95,9 @@ class ArtNetNodeOptions {
   unsigned int rdm_queue_size;
   unsigned int broadcast_threshold;
   uint8_t input_port_count;
+  // The maximum number of ArtPollReplies we'll send per second in response to
+  // ArtPolls, 0 means no limit.
+  unsigned int poll_reply_rate;
 };
 
 
@@ -236,6 +243,15 @@ class ArtNetNodeImpl {
   ola::network::Interface m_interface;
   std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
 
+  // The serialized ArtPollReply, this is rebuilt when the node state changes.
+  artnet_packet m_poll_reply;
+  bool m_poll_reply_valid;
+
+  // Limits the rate of ArtPollReplies sent in response to ArtPolls.
+  unsigned int m_poll_reply_rate;
+  std::auto_ptr<TokenBucket> m_poll_reply_bucket;
+  ola::thread::timeout_id m_poll_reply_timeout;
+
   ArtNetNodeImpl(const ArtNetNodeImpl&);
   ArtNetNodeImpl& operator=(const ArtNetNodeImpl&);
 
@@ -243,6 +259,9 @@ class ArtNetNodeImpl {
   bool SendPollIfAllowed();
   bool SendPollReplyIfRequired();
   bool SendPollReply(const IPV4Address &destination);
+  void SendDeferredPollReply();
+  void InvalidatePollReply() { m_poll_reply_valid = false; }
+  void BuildPollReply();
   bool SendIPReply(const IPV4Address &destination);
   void HandlePacket(const IPV4Address &source_address,
                     const artnet_packet &packet,
@@ -275,7 +294,7 @@ class ArtNetNodeImpl {
                             const RDMResponse *response,
                             const std::vector<std::string> &packets);
   void HandleRDMResponse(InputPort *port,
-                         const string &rdm_data,
+                         const RDMCommandView &response,
                          const IPV4Address &source_address);
   void HandleIPProgram(const IPV4Address &source_address,
                        const artnet_ip_prog_t &packet,
@@ -462,9 +481,12 @@ class ArtNetNode {
                         ola::rdm::RDMDiscoveryCallback *callback);
   void RunIncrementalDiscovery(uint8_t port_id,
                                ola::rdm::RDMDiscoveryCallback *callback);
-  void SendRDMRequest(uint8_t port_id,
-                      const RDMRequest *request,
-                      ola::rdm::RDMCallback *on_complete);
+  void SendRDMRequest(
+      uint8_t port_id,
+      const RDMRequest *request,
+      ola::rdm::RDMCallback *on_complete,
+      ola::rdm::QueueingRDMController::RequestPriority priority =
+          ola::rdm::QueueingRDMController::INTERACTIVE_PRIORITY);
 
   /*
    * This handler is called if we recieve ArtTod packets and a discovery
@@ -71,6 +71,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(ArtNetNodeTest);
   CPPUNIT_TEST(testBasicBehaviour);
   CPPUNIT_TEST(testConfigurationMode);
+  CPPUNIT_TEST(testPollReplyRateLimit);
   CPPUNIT_TEST(testExtendedInputPorts);
   CPPUNIT_TEST(testBroadcastSendDMX);
   CPPUNIT_TEST(testBroadcastSendDMXZeroUniverse);
@@ -112,6 +113,7 @@ class ArtNetNodeTest: public CppUnit::TestFixture {
 
   void testBasicBehaviour();
   void testConfigurationMode();
+  void testPollReplyRateLimit();
   void testExtendedInputPorts();
   void testBroadcastSendDMX();
   void testBroadcastSendDMXZeroUniverse();
@@ -423,6 +425,49 @@ void ArtNetNodeTest::testBasicBehaviour() {
 }
 
 
+/**
+ * Check that ArtPollReplies are rate limited.
+ */
+void ArtNetNodeTest::testPollReplyRateLimit() {
+  ArtNetNodeOptions node_options;
+  node_options.poll_reply_rate = 1;
+  ArtNetNode node(interface, &ss, node_options, m_socket);
+
+  node.SetShortName("Short Name");
+  node.SetLongName("This is the very long name");
+  node.SetNetAddress(4);
+  node.SetSubnetAddress(2);
+  node.SetOutputPortUniverse(0, 3);
+
+  OLA_ASSERT(node.Start());
+  ss.RemoveReadDescriptor(m_socket);
+  m_socket->Verify();
+
+  // the first poll is replied to immediately
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+  }
+
+  // the next two are over the limit and should be coalesced into a single
+  // reply
+  {
+    SocketVerifier verifer(m_socket);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip);
+    ReceiveFromPeer(POLL_MESSAGE, sizeof(POLL_MESSAGE), peer_ip2);
+  }
+
+  {
+    SocketVerifier verifer(m_socket);
+    ExpectedBroadcast(POLL_REPLY_MESSAGE, sizeof(POLL_REPLY_MESSAGE));
+    m_clock.AdvanceTime(1, 0);
+    ss.RunOnce(0, 0);
+  }
+  OLA_ASSERT(node.Stop());
+}
+
+
 /**
  * Check that configuration mode works correctly.
  */
@@ -141,6 +141,11 @@ string ArtNetPlugin::Description() const {
       "The number of output ports (Send ArtNet) to create. Only the first 4\n"
       "will appear in ArtPoll messages\n"
       "\n"
+      "poll_reply_rate = 0\n"
+      "The maximum number of ArtPollReply messages to send per second in\n"
+      "response to ArtPolls. Polls received once this is reached are answered\n"
+      "with a single delayed reply. 0 means no limit.\n"
+      "\n"
       "short_name = ola - ArtNet node\n"
       "The short name of the node (first 17 chars will be used).\n"
       "\n"
@@ -184,6 +189,9 @@ bool ArtNetPlugin::SetDefaultPreferences() {
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_OUTPUT_PORT_KEY,
                                          IntValidator(0, 16),
                                          "4");
+  save |= m_preferences->SetDefaultValue(ArtNetDevice::K_POLL_REPLY_RATE_KEY,
+                                         IntValidator(0, 1000),
+                                         "0");
   save |= m_preferences->SetDefaultValue(ArtNetDevice::K_ALWAYS_BROADCAST_KEY,
                                          BoolValidator(),
                                          BoolValidator::DISABLED);
@@ -134,6 +134,20 @@ bool ArtNetOutputPort::WriteDMX(const DmxBuffer &buffer,
  */
 void ArtNetOutputPort::SendRDMRequest(const ola::rdm::RDMRequest *request,
                                       ola::rdm::RDMCallback *on_complete) {
+  SendPrioritizedRDMRequest(
+      request,
+      on_complete,
+      ola::rdm::QueueingRDMController::INTERACTIVE_PRIORITY);
+}
+
+
+/*
+ * Handle an RDMRequest with a queueing priority
+ */
+void ArtNetOutputPort::SendPrioritizedRDMRequest(
+    const ola::rdm::RDMRequest *request,
+    ola::rdm::RDMCallback *on_complete,
+    ola::rdm::QueueingRDMController::RequestPriority priority) {
   // Discovery requests aren't proxied
   std::vector<std::string> packets;
   if (request->CommandClass() == RDMCommand::DISCOVER_COMMAND) {
@@ -141,7 +155,7 @@ void ArtNetOutputPort::SendRDMRequest(const ola::rdm::RDMRequest *request,
     on_complete->Run(ola::rdm::RDM_FAILED_TO_SEND, NULL, packets);
     delete request;
   } else {
-    m_node->SendRDMRequest(PortId(), request, on_complete);
+    m_node->SendRDMRequest(PortId(), request, on_complete, priority);
   }
 }
 
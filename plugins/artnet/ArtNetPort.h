@@ -66,6 +66,10 @@ class ArtNetOutputPort: public BasicOutputPort {
   bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
   void SendRDMRequest(const ola::rdm::RDMRequest *request,
                       ola::rdm::RDMCallback *on_complete);
+  void SendPrioritizedRDMRequest(
+      const ola::rdm::RDMRequest *request,
+      ola::rdm::RDMCallback *on_complete,
+      ola::rdm::QueueingRDMController::RequestPriority priority);
   void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
   void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
 
@@ -18,7 +18,9 @@
  * Copyright (C) 2005-2009 Simon Newton
  */
 
+#include <string.h>
 #include <ola/BaseTypes.h>
+#include <algorithm>
 #include "plugins/espnet/RunLengthDecoder.h"
 
 namespace ola {
@@ -34,26 +36,33 @@ namespace espnet {
 void RunLengthDecoder::Decode(DmxBuffer *dst,
                               const uint8_t *src_data,
                               unsigned int length) {
-  dst->Reset();
+  uint8_t frame[DMX_UNIVERSE_SIZE];
   unsigned int i = 0;
   const uint8_t *value = src_data;
-  uint8_t count;
-  while (i < DMX_UNIVERSE_SIZE && value < src_data + length) {
+  const uint8_t *end = src_data + length;
+  unsigned int count;
+  while (i < DMX_UNIVERSE_SIZE && value < end) {
     switch (*value) {
       case REPEAT_VALUE:
+        if (value + 2 >= end) {
+          value = end;
+          continue;
+        }
         value++;
-        count = *(value++);
-        dst->SetRangeToValue(i, *value, count);
-        i+= count;
+        count = std::min(static_cast<unsigned int>(*(value++)),
+                         DMX_UNIVERSE_SIZE - i);
+        memset(frame + i, *value, count);
+        i += count;
         break;
       case ESCAPE_VALUE:
-        value++;
+        if (++value == end)
+          continue;
       default:
-        dst->SetChannel(i, *value);
-        i++;
+        frame[i++] = *value;
     }
     value++;
   }
+  dst->Set(frame, i);
 }
 }  // namespace espnet
 }  // namespace plugin
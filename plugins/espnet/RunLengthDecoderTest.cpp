@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <ola/BaseTypes.h>
 #include <ola/DmxBuffer.h>
 
 #include "ola/testing/TestUtils.h"
@@ -27,10 +28,12 @@
 class RunLengthDecoderTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(RunLengthDecoderTest);
   CPPUNIT_TEST(testDecode);
+  CPPUNIT_TEST(testDecodeTruncated);
   CPPUNIT_TEST_SUITE_END();
 
   public:
     void testDecode();
+    void testDecodeTruncated();
   private:
 };
 
@@ -56,3 +59,29 @@ void RunLengthDecoderTest::testDecode() {
   decoder.Decode(&buffer, data, sizeof(data));
   OLA_ASSERT(buffer == expected);
 }
+
+
+/*
+ * Check that truncated data and long repeats are handled
+ */
+void RunLengthDecoderTest::testDecodeTruncated() {
+  ola::plugin::espnet::RunLengthDecoder decoder;
+  ola::DmxBuffer buffer;
+
+  uint8_t truncated_repeat[] = {0x12, 0xFE, 0x5};
+  decoder.Decode(&buffer, truncated_repeat, sizeof(truncated_repeat));
+  OLA_ASSERT_EQ(ola::DmxBuffer(truncated_repeat, 1), buffer);
+
+  uint8_t truncated_escape[] = {0x12, 0xFD};
+  decoder.Decode(&buffer, truncated_escape, sizeof(truncated_escape));
+  OLA_ASSERT_EQ(ola::DmxBuffer(truncated_escape, 1), buffer);
+
+  // 3 x 255 repeats is more than a universe
+  uint8_t repeats[] = {0xFE, 0xFF, 0x1, 0xFE, 0xFF, 0x2, 0xFE, 0xFF, 0x3};
+  decoder.Decode(&buffer, repeats, sizeof(repeats));
+  OLA_ASSERT_EQ(static_cast<unsigned int>(DMX_UNIVERSE_SIZE), buffer.Size());
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), buffer.Get(0));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), buffer.Get(255));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), buffer.Get(510));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), buffer.Get(511));
+}
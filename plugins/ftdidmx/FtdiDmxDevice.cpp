@@ -21,6 +21,7 @@
 #include <string>
 #include <memory>
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "plugins/ftdidmx/FtdiDmxDevice.h"
 #include "plugins/ftdidmx/FtdiDmxPort.h"
 
@@ -30,12 +31,17 @@ namespace ftdidmx {
 
 using std::string;
 
+const char FtdiDmxDevice::K_FPS_VAR[] = "ftdidmx-fps";
+const char FtdiDmxDevice::K_FRAMES_VAR[] = "ftdidmx-frames";
+const char FtdiDmxDevice::K_OVERRUNS_VAR[] = "ftdidmx-overruns";
+const char FtdiDmxDevice::K_JITTER_VAR_PREFIX[] = "ftdidmx-jitter-";
+
 FtdiDmxDevice::FtdiDmxDevice(AbstractPlugin *owner,
-                             const FtdiWidgetInfo &widget_info,
-                             unsigned int frequency)
+                             const FtdiWidgetInfo &widget_info)
     : Device(owner, widget_info.Description()),
       m_widget_info(widget_info),
-      m_frequency(frequency) {
+      m_thread(NULL),
+      m_output_id(0) {
   m_widget.reset(
       new FtdiWidget(widget_info.Serial(),
                      widget_info.Name(),
@@ -48,12 +54,77 @@ FtdiDmxDevice::~FtdiDmxDevice() {
 }
 
 bool FtdiDmxDevice::StartHook() {
+  if (!m_thread) {
+    OLA_WARN << "No output thread for " << Description();
+    return false;
+  }
+
+  if (!m_thread->AddWidget(m_widget.get(), &m_output_id)) {
+    OLA_WARN << "Output thread is full, can't add " << Description();
+    return false;
+  }
   AddPort(new FtdiDmxOutputPort(this,
                                 m_widget.get(),
                                 m_widget_info.Id(),
-                                m_frequency));
+                                m_thread,
+                                m_output_id));
   return true;
 }
+
+
+/**
+ * Copy the frame timing stats from the output thread into the export map.
+ * The frame rate, frame count and overruns are keyed by widget serial
+ * number, the jitter histogram gets a variable per widget.
+ */
+void FtdiDmxDevice::ExportStats(ExportMap *export_map) {
+  if (!m_thread)
+    return;
+
+  FrameStats stats;
+  m_thread->GetStats(m_output_id, &stats);
+
+  const string serial = m_widget->Serial();
+  (*export_map->GetUIntMapVar(K_FPS_VAR, "device"))[serial] = stats.fps;
+  (*export_map->GetUIntMapVar(K_FRAMES_VAR, "device"))[serial] =
+    stats.frames;
+  (*export_map->GetUIntMapVar(K_OVERRUNS_VAR, "device"))[serial] =
+    stats.overruns;
+
+  UIntMap *jitter = export_map->GetUIntMapVar(JitterVariable(), "usec");
+  for (unsigned int i = 0; i < FrameStats::JITTER_BUCKET_COUNT; i++)
+    (*jitter)[JitterBucket(i)] = stats.jitter[i];
+}
+
+
+/**
+ * Remove this device's entries from the export map.
+ */
+void FtdiDmxDevice::RemoveStats(ExportMap *export_map) {
+  const string serial = m_widget->Serial();
+  export_map->GetUIntMapVar(K_FPS_VAR)->Remove(serial);
+  export_map->GetUIntMapVar(K_FRAMES_VAR)->Remove(serial);
+  export_map->GetUIntMapVar(K_OVERRUNS_VAR)->Remove(serial);
+
+  UIntMap *jitter = export_map->GetUIntMapVar(JitterVariable());
+  for (unsigned int i = 0; i < FrameStats::JITTER_BUCKET_COUNT; i++)
+    jitter->Remove(JitterBucket(i));
+}
+
+
+string FtdiDmxDevice::JitterVariable() const {
+  return K_JITTER_VAR_PREFIX + m_widget->Serial();
+}
+
+
+/**
+ * Return the key for a jitter bucket, e.g. "<=100" or ">5000".
+ */
+string FtdiDmxDevice::JitterBucket(unsigned int i) {
+  if (i < FrameStats::JITTER_BUCKET_COUNT - 1)
+    return "<=" + IntToString(FrameStats::JITTER_BUCKET_LIMITS[i]);
+  return ">" + IntToString(FrameStats::JITTER_BUCKET_LIMITS[i - 1]);
+}
 }  // namespace ftdidmx
 }  // namespace plugin
 }  // namespace ola
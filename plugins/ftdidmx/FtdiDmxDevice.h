@@ -24,6 +24,7 @@
 #include <string>
 #include <memory>
 #include "ola/DmxBuffer.h"
+#include "ola/ExportMap.h"
 #include "olad/Device.h"
 #include "olad/Preferences.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
@@ -36,24 +37,41 @@ using std::string;
 using ola::Device;
 using std::auto_ptr;
 
+class FtdiDmxThread;
+
 class FtdiDmxDevice : public Device {
  public:
   FtdiDmxDevice(AbstractPlugin *owner,
-                const FtdiWidgetInfo &widget_info,
-                unsigned int frequency);
+                const FtdiWidgetInfo &widget_info);
   ~FtdiDmxDevice();
 
   string DeviceId() const { return m_widget->Serial(); }
   string Description() const { return m_widget_info.Description(); }
   FtdiWidget* GetDevice() {return m_widget.get(); }
 
+  // Must be called before the device is started.
+  void SetThread(FtdiDmxThread *thread) { m_thread = thread; }
+
+  void ExportStats(ExportMap *export_map);
+  void RemoveStats(ExportMap *export_map);
+
+  static const char K_FPS_VAR[];
+  static const char K_FRAMES_VAR[];
+  static const char K_OVERRUNS_VAR[];
+  static const char K_JITTER_VAR_PREFIX[];
+
  protected:
   bool StartHook();
 
  private:
   auto_ptr<FtdiWidget> m_widget;
   const FtdiWidgetInfo m_widget_info;
-  unsigned int m_frequency;
+  FtdiDmxThread *m_thread;
+  unsigned int m_output_id;
+
+  string JitterVariable() const;
+
+  static string JitterBucket(unsigned int i);
 };
 }  // namespace ftdidmx
 }  // namespace plugin
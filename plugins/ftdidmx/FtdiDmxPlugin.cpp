@@ -22,6 +22,7 @@
 #include <string>
 
 #include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
 #include "olad/Preferences.h"
 #include "olad/PluginAdaptor.h"
 #include "plugins/ftdidmx/FtdiDmxPlugin.h"
@@ -35,14 +36,20 @@ namespace ftdidmx {
 
 const char FtdiDmxPlugin::DEFAULT_FREQUENCY[] = "30";
 const char FtdiDmxPlugin::K_FREQUENCY[] = "frequency";
+const char FtdiDmxPlugin::DEFAULT_PRIORITY[] = "0";
+const char FtdiDmxPlugin::K_PRIORITY[] = "realtime_priority";
+const char FtdiDmxPlugin::DEFAULT_THREADS[] = "0";
+const char FtdiDmxPlugin::K_THREADS[] = "output_threads";
 const char FtdiDmxPlugin::PLUGIN_NAME[] = "FTDI USB DMX";
 const char FtdiDmxPlugin::PLUGIN_PREFIX[] = "ftdidmx";
 
 /**
  * Attempt to start a device and, if successfull, register it
  * Ownership of the FtdiDmxDevice is transfered to us here.
+ * @param device the new device
+ * @param thread the thread to send the device's DMX from
  */
-void FtdiDmxPlugin::AddDevice(FtdiDmxDevice *device) {
+void FtdiDmxPlugin::AddDevice(FtdiDmxDevice *device, FtdiDmxThread *thread) {
   // Check if device is working before adding
   if (device->GetDevice()->SetupOutput() == false) {
     OLA_WARN << "Unable to setup device for output, device ignored "
@@ -51,6 +58,7 @@ void FtdiDmxPlugin::AddDevice(FtdiDmxDevice *device) {
     return;
   }
 
+  device->SetThread(thread);
   if (device->Start()) {
       m_devices.push_back(device);
       m_plugin_adaptor->RegisterDevice(device);
@@ -63,16 +71,48 @@ void FtdiDmxPlugin::AddDevice(FtdiDmxDevice *device) {
 
 /**
  * Fetch a list of all FTDI widgets and create a new device for each of them.
+ * The devices are spread across the output threads, and each thread is
+ * started once all its widgets have been added.
  */
 bool FtdiDmxPlugin::StartHook() {
   typedef vector<FtdiWidgetInfo> FtdiWidgetInfoVector;
   FtdiWidgetInfoVector widgets;
   FtdiWidget::Widgets(&widgets);
 
+  // Never put more than MAX_WIDGETS on a thread. With asynchronous writes
+  // the default is to use as few threads as possible, otherwise the blocking
+  // writes mean each extra widget lowers the frame rate, so the default is a
+  // thread per widget.
+  const unsigned int max_widgets = FtdiDmxThread::MAX_WIDGETS;
+  unsigned int min_threads = (widgets.size() + max_widgets - 1) / max_widgets;
+  unsigned int thread_count = GetThreadCount();
+  if (!thread_count) {
+    thread_count = FtdiWidget::HasAsyncWrites() ? min_threads :
+                   widgets.size();
+  } else if (thread_count > widgets.size()) {
+    thread_count = widgets.size();
+  } else if (thread_count < min_threads) {
+    thread_count = min_threads;
+  }
+
+  for (unsigned int i = 0; i < thread_count; i++)
+    m_threads.push_back(new FtdiDmxThread(GetFrequency(), GetPriority()));
+
   FtdiWidgetInfoVector::const_iterator iter;
   for (iter = widgets.begin(); iter != widgets.end(); ++iter) {
-    AddDevice(new FtdiDmxDevice(this, *iter, GetFrequency()));
+    AddDevice(new FtdiDmxDevice(this, *iter),
+              m_threads[m_devices.size() % thread_count]);
+  }
+
+  FtdiThreadVector::iterator thread_iter = m_threads.begin();
+  for (; thread_iter != m_threads.end(); ++thread_iter) {
+    if ((*thread_iter)->WidgetCount())
+      (*thread_iter)->Start();
   }
+
+  m_stats_timeout = m_plugin_adaptor->RegisterRepeatingTimeout(
+      STATS_INTERVAL_MS,
+      NewCallback(this, &FtdiDmxPlugin::UpdateStats));
   return true;
 }
 
@@ -81,12 +121,27 @@ bool FtdiDmxPlugin::StartHook() {
  * Stop all the devices.
  */
 bool FtdiDmxPlugin::StopHook() {
+  if (m_stats_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_plugin_adaptor->RemoveTimeout(m_stats_timeout);
+    m_stats_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  // The threads use the widgets, so they need to stop before the devices are
+  // deleted.
+  FtdiThreadVector::iterator thread_iter = m_threads.begin();
+  for (; thread_iter != m_threads.end(); ++thread_iter)
+    (*thread_iter)->Stop();
+
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
   FtdiDeviceVector::iterator iter;
   for (iter = m_devices.begin(); iter != m_devices.end(); ++iter) {
+    if (export_map)
+      (*iter)->RemoveStats(export_map);
     m_plugin_adaptor->UnregisterDevice(*iter);
     (*iter)->Stop();
   }
   m_devices.clear();
+  STLDeleteElements(&m_threads);
   return true;
 }
 
@@ -108,6 +163,19 @@ string FtdiDmxPlugin::Description() const {
 "\n"
 "frequency = 30\n"
 "The DMX stream frequency (30 to 44 Hz max are the usual).\n"
+"\n"
+"realtime_priority = 0\n"
+"If non-0, run the output threads with the SCHED_FIFO policy at this\n"
+"priority. This usually requires olad to run as root or have the\n"
+"CAP_SYS_NICE capability.\n"
+"\n"
+"output_threads = 0\n"
+"The number of threads used to send DMX. Widgets are shared between the\n"
+"threads, and a thread drives at most 4 widgets, more threads are used if\n"
+"required. With libftdi 1.0 or later the writes to the widgets on a thread\n"
+"overlap and 0 uses as few threads as possible. With older versions the\n"
+"writes block while the frame is sent, so sharing a thread lowers the\n"
+"maximum frame rate, and 0 uses one thread per widget.\n"
 "\n";
 }
 
@@ -124,7 +192,19 @@ bool FtdiDmxPlugin::SetDefaultPreferences() {
                                      DEFAULT_FREQUENCY))
     m_preferences->Save();
 
-  if (m_preferences->GetValue(FtdiDmxPlugin::K_FREQUENCY).empty())
+  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_PRIORITY,
+                                     IntValidator(0, 99),
+                                     DEFAULT_PRIORITY))
+    m_preferences->Save();
+
+  if (m_preferences->SetDefaultValue(FtdiDmxPlugin::K_THREADS,
+                                     IntValidator(0, 64),
+                                     DEFAULT_THREADS))
+    m_preferences->Save();
+
+  if (m_preferences->GetValue(FtdiDmxPlugin::K_FREQUENCY).empty() ||
+      m_preferences->GetValue(FtdiDmxPlugin::K_PRIORITY).empty() ||
+      m_preferences->GetValue(FtdiDmxPlugin::K_THREADS).empty())
     return false;
 
   return true;
@@ -141,6 +221,45 @@ int unsigned FtdiDmxPlugin::GetFrequency() {
     StringToInt(DEFAULT_FREQUENCY, &frequency);
   return frequency;
 }
+
+
+/**
+ * Return the SCHED_FIFO priority as specified in the config file.
+ */
+int FtdiDmxPlugin::GetPriority() {
+  int priority;
+
+  if (!StringToInt(m_preferences->GetValue(K_PRIORITY), &priority))
+    StringToInt(DEFAULT_PRIORITY, &priority);
+  return priority;
+}
+
+
+/**
+ * Return the number of output threads as specified in the config file.
+ */
+unsigned int FtdiDmxPlugin::GetThreadCount() {
+  unsigned int threads;
+
+  if (!StringToInt(m_preferences->GetValue(K_THREADS), &threads))
+    StringToInt(DEFAULT_THREADS, &threads);
+  return threads;
+}
+
+
+/**
+ * Copy the frame timing stats for each device into the export map.
+ */
+bool FtdiDmxPlugin::UpdateStats() {
+  ExportMap *export_map = m_plugin_adaptor->GetExportMap();
+  if (!export_map)
+    return true;
+
+  FtdiDeviceVector::iterator iter;
+  for (iter = m_devices.begin(); iter != m_devices.end(); ++iter)
+    (*iter)->ExportStats(export_map);
+  return true;
+}
 }  // namespace ftdidmx
 }  // namespace plugin
 }  // namespace ola
@@ -25,10 +25,12 @@
 #include <string>
 #include <vector>
 
+#include "ola/thread/SchedulerInterface.h"
 #include "olad/Plugin.h"
 #include "ola/plugin_id.h"
 
 #include "plugins/ftdidmx/FtdiDmxDevice.h"
+#include "plugins/ftdidmx/FtdiDmxThread.h"
 
 namespace ola {
 namespace plugin {
@@ -38,7 +40,8 @@ namespace ftdidmx {
 class FtdiDmxPlugin : public Plugin {
  public:
   explicit FtdiDmxPlugin(ola::PluginAdaptor *plugin_adaptor)
-      : Plugin(plugin_adaptor) {
+      : Plugin(plugin_adaptor),
+        m_stats_timeout(ola::thread::INVALID_TIMEOUT) {
   }
 
   ola_plugin_id Id() const { return OLA_PLUGIN_FTDIDMX; }
@@ -56,16 +59,27 @@ class FtdiDmxPlugin : public Plugin {
 
  private:
   typedef vector<FtdiDmxDevice*> FtdiDeviceVector;
+  typedef vector<FtdiDmxThread*> FtdiThreadVector;
   FtdiDeviceVector m_devices;
+  FtdiThreadVector m_threads;
+  ola::thread::timeout_id m_stats_timeout;
 
-  void AddDevice(FtdiDmxDevice *device);
+  void AddDevice(FtdiDmxDevice *device, FtdiDmxThread *thread);
   bool StartHook();
   bool StopHook();
   bool SetDefaultPreferences();
   unsigned int GetFrequency();
+  int GetPriority();
+  unsigned int GetThreadCount();
+  bool UpdateStats();
 
   static const char DEFAULT_FREQUENCY[];
   static const char K_FREQUENCY[];
+  static const char DEFAULT_PRIORITY[];
+  static const char K_PRIORITY[];
+  static const char DEFAULT_THREADS[];
+  static const char K_THREADS[];
+  static const unsigned int STATS_INTERVAL_MS = 1000;
   static const char PLUGIN_NAME[];
   static const char PLUGIN_PREFIX[];
 };
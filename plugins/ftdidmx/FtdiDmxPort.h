@@ -36,26 +36,28 @@ namespace ftdidmx {
 
 class FtdiDmxOutputPort : public ola::BasicOutputPort {
   public:
+    // The thread is owned by the plugin and may be shared with other ports.
     FtdiDmxOutputPort(FtdiDmxDevice *parent,
                       FtdiWidget *device,
                       unsigned int id,
-                      unsigned int freq)
+                      FtdiDmxThread *thread,
+                      unsigned int output_id)
         : BasicOutputPort(parent, id),
           m_device(device),
-          m_thread(device, freq) {
-      m_thread.Start();
+          m_thread(thread),
+          m_output_id(output_id) {
     }
-    ~FtdiDmxOutputPort() { m_thread.Stop(); }
 
     bool WriteDMX(const ola::DmxBuffer &buffer, uint8_t) {
-      return m_thread.WriteDMX(buffer);
+      return m_thread->WriteDMX(m_output_id, buffer);
     }
 
     string Description() const { return m_device->Description(); }
 
   private:
     FtdiWidget *m_device;
-    FtdiDmxThread m_thread;
+    FtdiDmxThread *m_thread;
+    const unsigned int m_output_id;
 };
 }  // namespace ftdidmx
 }  // namespace plugin
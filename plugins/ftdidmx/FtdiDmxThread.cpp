@@ -18,12 +18,23 @@
  * Copyright (C) 2011 Rui Barreiros
  */
 
-#include <math.h>
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include <string>
+#include <vector>
 
 #include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/StringUtils.h"
+#include "ola/stl/STLUtils.h"
 #include "plugins/ftdidmx/FtdiWidget.h"
 #include "plugins/ftdidmx/FtdiDmxThread.h"
 
@@ -31,21 +42,68 @@ namespace ola {
 namespace plugin {
 namespace ftdidmx {
 
-FtdiDmxThread::FtdiDmxThread(FtdiWidget *widget, unsigned int frequency)
-  : m_granularity(UNKNOWN),
-    m_widget(widget),
-    m_term(false),
-    m_frequency(frequency) {
+using std::vector;
+
+const unsigned int FrameStats::JITTER_BUCKET_LIMITS[] = {
+  50, 100, 250, 500, 1000, 5000};
+
+
+FrameStats::FrameStats()
+    : frames(0),
+      fps(0),
+      overruns(0) {
+  for (unsigned int i = 0; i < JITTER_BUCKET_COUNT; i++)
+    jitter[i] = 0;
+}
+
+
+/**
+ * Record that a frame was sent.
+ * @param lateness how far after the scheduled time the frame started.
+ */
+void FrameStats::RecordFrame(const TimeInterval &lateness) {
+  frames++;
+  int64_t usecs = lateness.AsInt();
+  unsigned int i = 0;
+  while (i < JITTER_BUCKET_COUNT - 1 && usecs > JITTER_BUCKET_LIMITS[i])
+    i++;
+  jitter[i]++;
+}
+
+
+FtdiDmxThread::FtdiDmxThread(unsigned int frequency, int priority)
+  : m_term(false),
+    m_frequency(frequency),
+    m_priority(priority) {
 }
 
 FtdiDmxThread::~FtdiDmxThread() {
   Stop();
+  STLDeleteElements(&m_outputs);
 }
 
 
 /**
- * Stop this thread
+ * Add a widget to this thread.
+ * @param widget the widget to send DMX to
+ * @param output_id set to the id to use with WriteDMX() and GetStats().
+ * @returns false if this thread is already driving MAX_WIDGETS.
  */
+bool FtdiDmxThread::AddWidget(FtdiWidget *widget, unsigned int *output_id) {
+  if (m_outputs.size() >= MAX_WIDGETS)
+    return false;
+
+  WidgetOutput *output = new WidgetOutput();
+  output->widget = widget;
+  output->ok = false;
+  output->sent = false;
+  output->window_frames = 0;
+  m_outputs.push_back(output);
+  *output_id = m_outputs.size() - 1;
+  return true;
+}
+
+
 bool FtdiDmxThread::Stop() {
   {
     ola::thread::MutexLocker locker(&m_term_mutex);
@@ -55,33 +113,60 @@ bool FtdiDmxThread::Stop() {
 }
 
 
-/**
- * Copy a DMXBuffer to the output thread
- */
-bool FtdiDmxThread::WriteDMX(const DmxBuffer &buffer) {
+bool FtdiDmxThread::WriteDMX(unsigned int output_id,
+                             const DmxBuffer &buffer) {
+  if (output_id >= m_outputs.size())
+    return false;
+
   {
     ola::thread::MutexLocker locker(&m_buffer_mutex);
-    m_buffer.Set(buffer);
+    m_outputs[output_id]->buffer.Set(buffer);
     return true;
   }
 }
 
 
 /**
- * The method called by the thread
+ * Get a copy of the timing stats for a widget.
+ */
+void FtdiDmxThread::GetStats(unsigned int output_id, FrameStats *stats) {
+  if (output_id >= m_outputs.size())
+    return;
+
+  ola::thread::MutexLocker locker(&m_stats_mutex);
+  *stats = m_outputs[output_id]->stats;
+}
+
+
+/**
+ * Frames are scheduled against absolute deadlines on the monotonic clock,
+ * so time spent writing to the widgets doesn't accumulate as drift. If we
+ * fall more than a frame behind we start again from the current time rather
+ * than sending a burst of frames to catch up.
+ *
+ * All widgets enter the break together, then the MAB, then the data writes
+ * are started for every widget before waiting for any of them to complete.
+ * A widget's lateness is measured from when its data would ideally have
+ * started.
  */
 void *FtdiDmxThread::Run() {
-  TimeStamp ts1, ts2;
-  Clock clock;
-  CheckTimeGranularity();
-  DmxBuffer buffer;
+  SetPriority();
+
+  const TimeInterval frame_interval(0, USEC_IN_SECONDS / m_frequency);
+  const TimeInterval break_time(0, DMX_BREAK);
+  const TimeInterval mab_time(0, DMX_MAB);
+  const TimeInterval one_second(1, 0);
+  vector<WidgetOutput*>::iterator iter;
 
-  int frameTime = static_cast<int>(floor(
-    (static_cast<double>(1000) / m_frequency) + static_cast<double>(0.5)));
+  // Setup the widgets
+  for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+    if (!(*iter)->widget->IsOpen())
+      (*iter)->widget->SetupOutput();
+  }
 
-  // Setup the widget
-  if (!m_widget->IsOpen())
-    m_widget->SetupOutput();
+  TimeStamp next_frame, frame_start, write_start, now;
+  MonotonicTime(&next_frame);
+  TimeStamp window_start = next_frame;
 
   while (1) {
     {
@@ -92,63 +177,130 @@ void *FtdiDmxThread::Run() {
 
     {
       ola::thread::MutexLocker locker(&m_buffer_mutex);
-      buffer.Set(m_buffer);
+      for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter)
+        (*iter)->frame.Set((*iter)->buffer);
     }
 
-    clock.CurrentTime(&ts1);
-
-    if (!m_widget->SetBreak(true))
-      goto framesleep;
+    MonotonicTime(&frame_start);
+    const TimeStamp data_start = next_frame + break_time + mab_time;
 
-    if (m_granularity == GOOD)
-      usleep(DMX_BREAK);
+    for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+      (*iter)->ok = (*iter)->widget->SetBreak(true);
+      (*iter)->sent = false;
+    }
 
-    if (!m_widget->SetBreak(false))
-      goto framesleep;
+    SleepUntil(frame_start + break_time);
+    for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+      if ((*iter)->ok)
+        (*iter)->ok = (*iter)->widget->SetBreak(false);
+    }
 
-    if (m_granularity == GOOD)
-      usleep(DMX_MAB);
+    SleepUntil(frame_start + break_time + mab_time);
+    for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+      if (!(*iter)->ok)
+        continue;
+      MonotonicTime(&write_start);
+      (*iter)->lateness = write_start > data_start ?
+          write_start - data_start : TimeInterval(0, 0);
+      (*iter)->sent = (*iter)->widget->StartWrite((*iter)->frame);
+    }
 
-    if (!m_widget->Write(buffer))
-      goto framesleep;
+    for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+      if ((*iter)->sent)
+        (*iter)->sent = (*iter)->widget->WaitForWrite();
+    }
 
-  framesleep:
-    // Sleep for the remainder of the DMX frame time
-    clock.CurrentTime(&ts2);
-    TimeInterval elapsed = ts2 - ts1;
-
-    if (m_granularity == GOOD) {
-      while (elapsed.InMilliSeconds() < frameTime) {
-        usleep(1000);
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
-      }
-    } else {
-      while (elapsed.InMilliSeconds() < frameTime) {
-        clock.CurrentTime(&ts2);
-        elapsed = ts2 - ts1;
+    MonotonicTime(&now);
+    next_frame += frame_interval;
+    bool overrun = now > next_frame + frame_interval;
+    bool end_of_window = now - window_start >= one_second;
+    {
+      ola::thread::MutexLocker locker(&m_stats_mutex);
+      for (iter = m_outputs.begin(); iter != m_outputs.end(); ++iter) {
+        WidgetOutput *output = *iter;
+        if (output->sent) {
+          output->stats.RecordFrame(output->lateness);
+          output->window_frames++;
+        }
+        if (overrun)
+          output->stats.overruns++;
+        if (end_of_window) {
+          output->stats.fps = (
+              (output->window_frames * USEC_IN_SECONDS +
+               USEC_IN_SECONDS / 2) / (now - window_start).AsInt());
+          output->window_frames = 0;
+        }
       }
     }
+
+    if (end_of_window)
+      window_start = now;
+    if (overrun)
+      next_frame = now;
+
+    // Sleep for the remainder of the DMX frame time
+    SleepUntil(next_frame);
   }
   return NULL;
 }
 
 
 /**
- * Check the granularity of usleep.
+ * Get the current time from a monotonic clock if we have one, otherwise fall
+ * back to the wall clock.
  */
-void FtdiDmxThread::CheckTimeGranularity() {
-  TimeStamp ts1, ts2;
+void FtdiDmxThread::MonotonicTime(TimeStamp *now) {
+#ifdef HAVE_CLOCK_NANOSLEEP
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  struct timeval tv;
+  tv.tv_sec = ts.tv_sec;
+  tv.tv_usec = ts.tv_nsec / ONE_THOUSAND;
+  *now = tv;
+#else
   Clock clock;
+  clock.CurrentTime(now);
+#endif
+}
+
+
+/**
+ * Sleep until the deadline, which is a time returned from MonotonicTime().
+ */
+void FtdiDmxThread::SleepUntil(const TimeStamp &deadline) {
+#ifdef HAVE_CLOCK_NANOSLEEP
+  struct timespec ts;
+  ts.tv_sec = deadline.Seconds();
+  ts.tv_nsec = deadline.MicroSeconds() * ONE_THOUSAND;
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+  }
+#else
+  TimeStamp now;
+  MonotonicTime(&now);
+  if (deadline > now)
+    usleep((deadline - now).AsInt());
+#endif
+}
+
 
-  clock.CurrentTime(&ts1);
-  usleep(1000);
-  clock.CurrentTime(&ts2);
+/**
+ * Switch this thread to SCHED_FIFO if a priority was requested.
+ */
+void FtdiDmxThread::SetPriority() {
+  if (m_priority <= 0)
+    return;
 
-  TimeInterval interval = ts2 - ts1;
-  m_granularity = interval.InMilliSeconds() > 3 ? BAD : GOOD;
-  OLA_INFO << "Granularity for ftdi thread is " <<
-    (m_granularity == GOOD ? "GOOD" : "BAD");
+  struct sched_param param;
+  memset(&param, 0, sizeof(param));
+  param.sched_priority = m_priority;
+  int r = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (r) {
+    OLA_WARN << "Failed to set SCHED_FIFO priority " << m_priority
+             << " for FTDI output thread: " << strerror(r);
+  } else {
+    OLA_INFO << "FTDI output thread for " << m_outputs.size()
+             << " widget(s) running with SCHED_FIFO priority " << m_priority;
+  }
 }
 }  // namespace ftdidmx
 }  // namespace plugin
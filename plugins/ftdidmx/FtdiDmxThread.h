@@ -21,6 +21,9 @@
 #ifndef PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 #define PLUGINS_FTDIDMX_FTDIDMXTHREAD_H_
 
+#include <stdint.h>
+#include <vector>
+#include "ola/Clock.h"
 #include "ola/DmxBuffer.h"
 #include "ola/thread/Thread.h"
 
@@ -28,27 +31,92 @@ namespace ola {
 namespace plugin {
 namespace ftdidmx {
 
+class FtdiWidget;
+
+/**
+ * Timing information for the frames sent by a thread.
+ */
+struct FrameStats {
+  // The upper bound of each jitter bucket in microseconds, the last bucket
+  // holds everything larger.
+  enum { JITTER_BUCKET_COUNT = 7 };
+  static const unsigned int JITTER_BUCKET_LIMITS[JITTER_BUCKET_COUNT - 1];
+
+  FrameStats();
+
+  // total number of frames sent
+  unsigned int frames;
+  // the frames per second achieved over the last second
+  unsigned int fps;
+  // the number of times we fell more than a frame behind.
+  unsigned int overruns;
+  // how late each frame started, bucketed.
+  unsigned int jitter[JITTER_BUCKET_COUNT];
+
+  void RecordFrame(const TimeInterval &lateness);
+};
+
+
+/**
+ * A thread that sends DMX to one or more FTDI widgets. Each frame the break,
+ * MAB and data phases are run for all widgets together, so the break and MAB
+ * times are shared rather than paid once per widget.
+ *
+ * If the backend has asynchronous writes (libftdi 1.0 and later), the data
+ * phases of the widgets overlap. Otherwise each write blocks while the frame
+ * drains, so each extra widget delays the ones after it by roughly a frame's
+ * transmit time, which lowers the achievable frame rate. The break and MAB
+ * are always set one widget at a time, so a thread never drives more than
+ * MAX_WIDGETS.
+ */
 class FtdiDmxThread : public ola::thread::Thread {
   public:
-    FtdiDmxThread(FtdiWidget *widget, unsigned int frequency);
+    /*
+     * @param frequency the number of frames per second
+     * @param priority if non-0, run the thread with SCHED_FIFO at this
+     *   priority.
+     */
+    explicit FtdiDmxThread(unsigned int frequency, int priority = 0);
     ~FtdiDmxThread();
 
+    // Widgets must be added before the thread is started. Ownership is not
+    // transferred. Returns false if the thread already has MAX_WIDGETS.
+    bool AddWidget(FtdiWidget *widget, unsigned int *output_id);
+    unsigned int WidgetCount() const { return m_outputs.size(); }
+
     bool Stop();
     void *Run();
-    bool WriteDMX(const DmxBuffer &buffer);
+    bool WriteDMX(unsigned int output_id, const DmxBuffer &buffer);
+    void GetStats(unsigned int output_id, FrameStats *stats);
+
+    static void MonotonicTime(TimeStamp *now);
+    static void SleepUntil(const TimeStamp &deadline);
+
+    // The most widgets a single thread will drive.
+    static const unsigned int MAX_WIDGETS = 4;
 
   private:
-    enum TimerGranularity { UNKNOWN, GOOD, BAD };
+    typedef struct {
+      FtdiWidget *widget;
+      DmxBuffer buffer;  // protected by m_buffer_mutex
+      FrameStats stats;  // protected by m_stats_mutex
+      // the following are only used by the thread
+      DmxBuffer frame;
+      bool ok;
+      bool sent;
+      TimeInterval lateness;
+      unsigned int window_frames;
+    } WidgetOutput;
 
-    TimerGranularity m_granularity;
-    FtdiWidget *m_widget;
+    std::vector<WidgetOutput*> m_outputs;
     bool m_term;
     int unsigned m_frequency;
-    DmxBuffer m_buffer;
+    int m_priority;
     ola::thread::Mutex m_term_mutex;
     ola::thread::Mutex m_buffer_mutex;
+    ola::thread::Mutex m_stats_mutex;
 
-    void CheckTimeGranularity();
+    void SetPriority();
 
     static const uint32_t DMX_MAB = 16;
     static const uint32_t DMX_BREAK = 110;
@@ -93,7 +93,8 @@ FtdiWidget::FtdiWidget(const string& serial,
                              uint32_t id)
   : m_serial(serial)
   , m_name(name)
-  , m_id(id) {
+  , m_id(id)
+  , m_write_ok(false) {
 }
 
 FtdiWidget::~FtdiWidget() {
@@ -251,6 +252,23 @@ bool FtdiWidget::Write(const DmxBuffer& data) {
   }
 }
 
+/**
+ * FTD2XX doesn't have asynchronous writes, so this blocks until the data has
+ * been sent.
+ */
+bool FtdiWidget::StartWrite(const DmxBuffer& data) {
+  m_write_ok = Write(data);
+  return m_write_ok;
+}
+
+bool FtdiWidget::WaitForWrite() {
+  return m_write_ok;
+}
+
+bool FtdiWidget::HasAsyncWrites() {
+  return false;
+}
+
 bool FtdiWidget::Read(unsigned char *buffer, int size) {
   DWORD read = 0;
 
@@ -26,6 +26,10 @@
  * by Rui Barreiros
  */
 
+#if HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
 #include <strings.h>
 #include <ftdi.h>
 #include <assert.h>
@@ -50,7 +54,9 @@ FtdiWidget::FtdiWidget(const string& serial,
                        uint32_t id)
     : m_serial(serial),
       m_name(name),
-      m_id(id) {
+      m_id(id),
+      m_write_ok(false),
+      m_transfer(NULL) {
   bzero(&m_handle, sizeof(struct ftdi_context));
   ftdi_init(&m_handle);
 }
@@ -181,6 +187,51 @@ bool FtdiWidget::Write(const ola::DmxBuffer& data) {
   }
 }
 
+bool FtdiWidget::StartWrite(const ola::DmxBuffer& data) {
+#ifdef HAVE_FTDI_WRITE_DATA_SUBMIT
+  int unsigned length = DMX_UNIVERSE_SIZE;
+  m_write_buffer[0] = 0x00;
+
+  data.Get(m_write_buffer + 1, &length);
+
+  m_transfer = ftdi_write_data_submit(&m_handle, m_write_buffer, length + 1);
+  if (!m_transfer) {
+    OLA_WARN << Name() << " " << ftdi_get_error_string(&m_handle);
+    return false;
+  }
+  return true;
+#else
+  m_write_ok = Write(data);
+  return m_write_ok;
+#endif
+}
+
+bool FtdiWidget::WaitForWrite() {
+#ifdef HAVE_FTDI_WRITE_DATA_SUBMIT
+  if (!m_transfer)
+    return false;
+
+  // This frees the transfer
+  int ret = ftdi_transfer_data_done(m_transfer);
+  m_transfer = NULL;
+  if (ret < 0) {
+    OLA_WARN << Name() << " " << ftdi_get_error_string(&m_handle);
+    return false;
+  }
+  return true;
+#else
+  return m_write_ok;
+#endif
+}
+
+bool FtdiWidget::HasAsyncWrites() {
+#ifdef HAVE_FTDI_WRITE_DATA_SUBMIT
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool FtdiWidget::Read(unsigned char *buff, int size) {
   int read = ftdi_read_data(&m_handle, buff, size);
   if (read <= 0) {
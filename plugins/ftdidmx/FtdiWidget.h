@@ -41,6 +41,7 @@
 #include <string>
 #include <vector>
 
+#include "ola/BaseTypes.h"
 #include "ola/DmxBuffer.h"
 
 namespace ola {
@@ -157,6 +158,20 @@ class FtdiWidget {
     /** Write data to a previously-opened line */
     bool Write(const ola::DmxBuffer &data);
 
+    /**
+     * Start writing data to a previously-opened line, without waiting for it
+     * to be sent. If this returns true, WaitForWrite() must be called before
+     * the next write. Backends without asynchronous writes block here, like
+     * Write().
+     */
+    bool StartWrite(const ola::DmxBuffer &data);
+
+    /** Wait for the write started with StartWrite() to complete */
+    bool WaitForWrite();
+
+    /** Check if StartWrite() returns before the data has been sent */
+    static bool HasAsyncWrites();
+
     /** Read data from a previously-opened line */
     bool Read(unsigned char* buff, int size);
 
@@ -173,11 +188,16 @@ class FtdiWidget {
     string m_serial;
     string m_name;
     uint32_t m_id;
+    // The frame being sent by StartWrite(), this must stay valid until the
+    // write completes.
+    unsigned char m_write_buffer[DMX_UNIVERSE_SIZE + 1];
+    bool m_write_ok;
 
 #ifdef FTD2XX
     FT_HANDLE m_handle;
 #else
     struct ftdi_context m_handle;
+    struct ftdi_transfer_control *m_transfer;
 #endif
 };
 }  // namespace ftdidmx
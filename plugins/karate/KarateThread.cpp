@@ -43,16 +43,14 @@ namespace plugin {
 namespace karate {
 
 using std::string;
-using ola::thread::Mutex;
-using ola::thread::MutexLocker;
+using ola::thread::FrameMailbox;
 
 /*
  * Create a new KarateThread object
  */
 KarateThread::KarateThread(const string &path)
     : ola::thread::Thread(),
-      m_path(path),
-      m_term(false) {
+      m_path(path) {
 }
 
 
@@ -60,45 +58,40 @@ KarateThread::KarateThread(const string &path)
  * Run this thread
  */
 void *KarateThread::Run() {
-  bool write_success;
   Clock clock;
 
   KarateLight k(m_path);
   k.Init();
 
   while (true) {
-    {
-      MutexLocker lock(&m_term_mutex);
-      if (m_term)
-        break;
-    }
+    TimeStamp wake_up;
+    clock.CurrentTime(&wake_up);
 
     if (!k.IsActive()) {
       // try to reopen the device...
-      TimeStamp wake_up;
-      clock.CurrentTime(&wake_up);
       wake_up += TimeInterval(1, 0);
 
-      // wait for either a signal that we should terminate, or ts seconds
-      m_term_mutex.Lock();
-      if (m_term)
+      // wait for either a signal that we should terminate, or one second.
+      // New frames wake us up as well, so keep waiting until the time is up.
+      FrameMailbox::WaitResult result;
+      do {
+        result = m_mailbox.TimedWait(wake_up);
+      } while (result == FrameMailbox::NEW_FRAME);
+      if (result == FrameMailbox::CLOSED)
         break;
-      m_term_cond.TimedWait(&m_term_mutex, wake_up);
-      m_term_mutex.Unlock();
 
       OLA_WARN << "Re-Initialising device " << m_path;
       k.Init();
 
     } else {
-      {
-        MutexLocker locker(&m_mutex);
-        write_success = k.SetColors(m_buffer);
-      }
-      if (!write_success) {
+      // block until there is new data, resending the current colors if
+      // nothing changes within the refresh interval
+      wake_up += TimeInterval(REFRESH_INTERVAL_S, 0);
+      if (m_mailbox.TimedWait(wake_up) == FrameMailbox::CLOSED)
+        break;
+
+      if (!k.SetColors(m_mailbox.Frame()))
         OLA_WARN << "Failed to write color data";
-      }  else {
-        usleep(20000);  // 50Hz
-      }
     }  // port is okay
   }
   return NULL;
@@ -109,22 +102,16 @@ void *KarateThread::Run() {
  * Stop the thread
  */
 bool KarateThread::Stop() {
-  {
-    MutexLocker locker(&m_mutex);
-    m_term = true;
-  }
-  m_term_cond.Signal();
+  m_mailbox.Close();
   return Join();
 }
 
 
 /*
- * Store the data in the shared buffer.
+ * Hand the data to the output thread.
  */
 bool KarateThread::WriteDmx(const DmxBuffer &buffer) {
-  MutexLocker locker(&m_mutex);
-  // avoid the reference counting
-  m_buffer.Set(buffer);
+  m_mailbox.Put(buffer);
   return true;
 }
 }  // namespace karate
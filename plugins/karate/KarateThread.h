@@ -23,6 +23,7 @@
 
 #include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/thread/FrameMailbox.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
@@ -39,11 +40,10 @@ class KarateThread: public ola::thread::Thread {
 
   private:
     string m_path;
-    DmxBuffer m_buffer;
-    bool m_term;
-    ola::thread::Mutex m_mutex;
-    ola::thread::Mutex m_term_mutex;
-    ola::thread::ConditionVariable m_term_cond;
+    ola::thread::FrameMailbox m_mailbox;
+
+    // how often we resend the colors if nothing has changed
+    static const unsigned int REFRESH_INTERVAL_S = 1;
 };
 }  // namespace karate
 }  // namespace plugin
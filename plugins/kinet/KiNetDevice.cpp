@@ -19,6 +19,7 @@
  */
 
 #include <memory>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -30,6 +31,7 @@
 #include "ola/network/NetworkUtils.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
+#include "olad/Preferences.h"
 #include "plugins/kinet/KiNetDevice.h"
 #include "plugins/kinet/KiNetPort.h"
 
@@ -39,19 +41,41 @@ namespace kinet {
 
 using ola::network::IPV4Address;
 using std::auto_ptr;
+using std::string;
 using std::vector;
 
+const char KiNetDevice::DMXOUT_MODE[] = "dmxout";
+const char KiNetDevice::PORTOUT_MODE[] = "portout";
+
 /*
  * Create a new KiNet Device
  */
 KiNetDevice::KiNetDevice(
     AbstractPlugin *owner,
     const std::vector<ola::network::IPV4Address> &power_supplies,
-    PluginAdaptor *plugin_adaptor)
+    PluginAdaptor *plugin_adaptor,
+    Preferences *preferences)
     : Device(owner, "KiNet Device"),
       m_power_supplies(power_supplies),
       m_node(NULL),
-      m_plugin_adaptor(plugin_adaptor) {
+      m_plugin_adaptor(plugin_adaptor),
+      m_preferences(preferences) {
+}
+
+
+/*
+ * The preference key for the mode of a power supply.
+ */
+string KiNetDevice::ModeKey(const IPV4Address &power_supply) {
+  return power_supply.ToString() + "-mode";
+}
+
+
+/*
+ * The preference key for the number of ports on a power supply.
+ */
+string KiNetDevice::PortCountKey(const IPV4Address &power_supply) {
+  return power_supply.ToString() + "-ports";
 }
 
 
@@ -71,7 +95,15 @@ bool KiNetDevice::StartHook() {
   vector<IPV4Address>::const_iterator iter = m_power_supplies.begin();
   unsigned int port_id = 0;
   for (; iter != m_power_supplies.end(); ++iter) {
-    AddPort(new KiNetOutputPort(this, *iter, m_node, port_id++));
+    if (m_preferences->GetValue(ModeKey(*iter)) == PORTOUT_MODE) {
+      uint8_t port_count = KiNetNode::KINET_MAX_PORTS;
+      StringToInt(m_preferences->GetValue(PortCountKey(*iter)), &port_count);
+      for (uint8_t i = 1; i <= port_count; i++) {
+        AddPort(new KiNetPortOutOutputPort(this, *iter, m_node, port_id++, i));
+      }
+    } else {
+      AddPort(new KiNetOutputPort(this, *iter, m_node, port_id++));
+    }
   }
   return true;
 }
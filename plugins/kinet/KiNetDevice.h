@@ -38,11 +38,18 @@ class KiNetDevice: public ola::Device {
   public:
     KiNetDevice(AbstractPlugin *owner,
                 const vector<IPV4Address> &power_supplies,
-                class PluginAdaptor *plugin_adaptor);
+                class PluginAdaptor *plugin_adaptor,
+                class Preferences *preferences);
 
     // Only one KiNet device
     std::string DeviceId() const { return "1"; }
 
+    static std::string ModeKey(const IPV4Address &power_supply);
+    static std::string PortCountKey(const IPV4Address &power_supply);
+
+    static const char DMXOUT_MODE[];
+    static const char PORTOUT_MODE[];
+
   protected:
     bool StartHook();
     void PrePortStop();
@@ -52,6 +59,7 @@ class KiNetDevice: public ola::Device {
     const vector<IPV4Address> m_power_supplies;
     class KiNetNode *m_node;
     class PluginAdaptor *m_plugin_adaptor;
+    class Preferences *m_preferences;
 };
 }  // namespace kinet
 }  // namespace plugin
@@ -18,12 +18,17 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <string.h>
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "ola/BaseTypes.h"
 #include "ola/Logging.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/SocketAddress.h"
+#include "ola/stl/STLUtils.h"
 #include "plugins/kinet/KiNetNode.h"
 
 namespace ola {
@@ -45,7 +50,9 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
     : m_running(false),
       m_ss(ss),
       m_output_stream(&m_output_queue),
-      m_socket(socket) {
+      m_socket(socket),
+      m_flush_timeout(ola::thread::INVALID_TIMEOUT) {
+  BuildHeaders();
 }
 
 
@@ -54,6 +61,7 @@ KiNetNode::KiNetNode(ola::io::SelectServerInterface *ss,
  */
 KiNetNode::~KiNetNode() {
   Stop();
+  STLDeleteValues(&m_port_out_packets);
 }
 
 
@@ -78,6 +86,16 @@ bool KiNetNode::Stop() {
   if (!m_running)
     return false;
 
+  if (m_flush_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_ss->RemoveTimeout(m_flush_timeout);
+    m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+  // The packets are kept, so they must be queued again after a restart.
+  std::vector<PortOutPacket*>::iterator iter = m_pending_packets.begin();
+  for (; iter != m_pending_packets.end(); ++iter)
+    (*iter)->pending = false;
+  m_pending_packets.clear();
+
   m_ss->RemoveReadDescriptor(m_socket.get());
   m_socket.reset();
   m_running = false;
@@ -89,32 +107,105 @@ bool KiNetNode::Stop() {
  * Send some DMX data
  */
 bool KiNetNode::SendDMX(const IPV4Address &target_ip, const DmxBuffer &buffer) {
-  static const uint8_t port = 0;
-  static const uint8_t flags = 0;
-  static const uint16_t timer_val = 0;
-  static const uint32_t universe = 0xffffffff;
+  if (!buffer.Size()) {
+    OLA_DEBUG << "Not sending 0 length packet";
+    return true;
+  }
+
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(m_dmx_packet + DMX_HEADER_SIZE, &length);
+  return SendPacket(target_ip, m_dmx_packet, DMX_HEADER_SIZE + length);
+}
+
+
+/*
+ * Queue DMX data for a port on a power supply.
+ * @param target_ip the IP of the power supply
+ * @param port the port on the power supply, 1 - KINET_MAX_PORTS
+ * @param buffer the DMX data
+ */
+bool KiNetNode::SendPortOut(const IPV4Address &target_ip,
+                            uint8_t port,
+                            const DmxBuffer &buffer) {
+  if (port == 0 || port > KINET_MAX_PORTS) {
+    OLA_WARN << "Invalid KiNet port " << static_cast<int>(port);
+    return false;
+  }
 
   if (!buffer.Size()) {
     OLA_DEBUG << "Not sending 0 length packet";
     return true;
   }
 
-  m_output_queue.Clear();
-  PopulatePacketHeader(KINET_DMX_MSG);
-  m_output_stream << port << flags << timer_val << universe;
-  m_output_stream << DMX512_START_CODE;
-  m_output_stream.Write(buffer.GetRaw(), buffer.Size());
+  if (!m_running)
+    return false;
+
+  const std::pair<IPV4Address, uint8_t> key(target_ip, port);
+  PortOutPacket *packet = STLFindOrNull(m_port_out_packets, key);
+  if (!packet) {
+    packet = new PortOutPacket();
+    packet->target = target_ip;
+    packet->pending = false;
+    packet->size = 0;
+    memcpy(packet->data, m_port_out_header, PORTOUT_HEADER_SIZE);
+    packet->data[PORTOUT_PORT_OFFSET] = port;
+    m_port_out_packets[key] = packet;
+  }
+
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(packet->data + PORTOUT_HEADER_SIZE, &length);
+  // The length is little endian
+  packet->data[PORTOUT_LENGTH_OFFSET] = length & 0xff;
+  packet->data[PORTOUT_LENGTH_OFFSET + 1] = length >> 8;
+  packet->size = PORTOUT_HEADER_SIZE + length;
+
+  if (!packet->pending) {
+    packet->pending = true;
+    m_pending_packets.push_back(packet);
+  }
+
+  if (m_flush_timeout == ola::thread::INVALID_TIMEOUT) {
+    m_flush_timeout = m_ss->RegisterSingleTimeout(
+        0, NewSingleCallback(this, &KiNetNode::FlushPortOut));
+  }
+  return true;
+}
+
 
+/*
+ * Send all the queued PORTOUT packets.
+ */
+void KiNetNode::FlushPortOut() {
+  m_flush_timeout = ola::thread::INVALID_TIMEOUT;
+
+  std::vector<PortOutPacket*>::iterator iter = m_pending_packets.begin();
+  for (; iter != m_pending_packets.end(); ++iter) {
+    (*iter)->pending = false;
+    SendPacket((*iter)->target, (*iter)->data, (*iter)->size);
+  }
+  m_pending_packets.clear();
+}
+
+
+/*
+ * Send a packet to a power supply
+ */
+bool KiNetNode::SendPacket(const IPV4Address &target_ip,
+                           const uint8_t *data,
+                           unsigned int size) {
   IPV4SocketAddress target(target_ip, KINET_PORT);
-  bool ok = m_socket->SendTo(&m_output_queue, target);
-  if (!ok)
-    OLA_WARN << "Failed to send KiNet DMX packet";
+  ssize_t bytes_sent = m_socket->SendTo(data, size, target);
+  if (bytes_sent < 0) {
+    OLA_WARN << "Failed to send KiNet packet";
+    return false;
+  }
 
-  if (!m_output_queue.Empty()) {
-    OLA_WARN << "Failed to send complete KiNet packet";
-    m_output_queue.Clear();
+  if (static_cast<unsigned int>(bytes_sent) != size) {
+    OLA_WARN << "Failed to send complete KiNet packet, only sent "
+             << bytes_sent << " of " << size;
+    return false;
   }
-  return ok;
+  return true;
 }
 
 
@@ -135,12 +226,44 @@ void KiNetNode::SocketReady() {
 }
 
 
+/*
+ * Build the headers for the DMXOUT and PORTOUT messages. Only the data (and
+ * for PORTOUT, the port & length) changes between packets so we only need to
+ * do this once.
+ */
+void KiNetNode::BuildHeaders() {
+  static const uint8_t port = 0;
+  static const uint8_t flags = 0;
+  static const uint16_t timer_val = 0;
+  static const uint32_t universe = 0xffffffff;
+  static const uint8_t pad = 0;
+  static const uint16_t port_flags = 0;
+  static const uint16_t length = 0;
+  static const uint16_t start_code = 0;
+
+  PopulatePacketHeader(KINET_VERSION_ONE, KINET_DMX_MSG);
+  m_output_stream << port << flags << timer_val << universe;
+  m_output_stream << DMX512_START_CODE;
+  m_output_queue.Read(m_dmx_packet, DMX_HEADER_SIZE);
+
+  PopulatePacketHeader(KINET_VERSION_TWO, KINET_PORTOUT_MSG);
+  m_output_stream << universe << port << pad << port_flags << length;
+  m_output_stream << start_code;
+  m_output_queue.Read(m_port_out_header, PORTOUT_HEADER_SIZE);
+
+  if (!m_output_queue.Empty()) {
+    OLA_WARN << "KiNet header size mismatch";
+    m_output_queue.Clear();
+  }
+}
+
+
 /*
  * Fill in the header for a packet
  */
-void KiNetNode::PopulatePacketHeader(uint16_t msg_type) {
+void KiNetNode::PopulatePacketHeader(uint16_t version, uint16_t msg_type) {
   uint32_t sequence_number = 0;  // everything seems to set this to 0.
-  m_output_stream << KINET_MAGIC_NUMBER << KINET_VERSION_ONE;
+  m_output_stream << KINET_MAGIC_NUMBER << version;
   m_output_stream << msg_type << sequence_number;
 }
 
@@ -21,8 +21,12 @@
 #ifndef PLUGINS_KINET_KINETNODE_H_
 #define PLUGINS_KINET_KINETNODE_H_
 
+#include <map>
 #include <memory>
+#include <utility>
+#include <vector>
 
+#include "ola/BaseTypes.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/BigEndianStream.h"
 #include "ola/io/IOQueue.h"
@@ -48,25 +52,68 @@ class KiNetNode {
     // The following apply to Input Ports (those which send data)
     bool SendDMX(const IPV4Address &target, const ola::DmxBuffer &buffer);
 
+    // Send data to a single port on a power supply using the V2 PORTOUT
+    // message. Ports are numbered from 1. Packets are queued and sent
+    // together on the next iteration of the SelectServer loop.
+    bool SendPortOut(const IPV4Address &target,
+                     uint8_t port,
+                     const ola::DmxBuffer &buffer);
+
+    static const uint8_t KINET_MAX_PORTS = 16;
+
   private:
+    // The size of the header portion of a DMXOUT message, including the
+    // start code.
+    static const unsigned int DMX_HEADER_SIZE = 21;
+    // The size of the header portion of a PORTOUT message, including the
+    // start code.
+    static const unsigned int PORTOUT_HEADER_SIZE = 24;
+    static const unsigned int PORTOUT_PORT_OFFSET = 16;
+    static const unsigned int PORTOUT_LENGTH_OFFSET = 20;
+
+    // A PORTOUT packet for a single port on a power supply. The header is
+    // built once when the port is first used.
+    struct PortOutPacket {
+      IPV4Address target;
+      bool pending;
+      unsigned int size;
+      uint8_t data[PORTOUT_HEADER_SIZE + DMX_UNIVERSE_SIZE];
+    };
+
+    typedef std::map<std::pair<IPV4Address, uint8_t>, PortOutPacket*>
+      PortOutPacketMap;
+
     bool m_running;
     ola::io::SelectServerInterface *m_ss;
     ola::io::IOQueue m_output_queue;
     ola::io::BigEndianOutputStream m_output_stream;
     ola::network::Interface m_interface;
     std::auto_ptr<ola::network::UDPSocketInterface> m_socket;
+    uint8_t m_dmx_packet[DMX_HEADER_SIZE + DMX_UNIVERSE_SIZE];
+    uint8_t m_port_out_header[PORTOUT_HEADER_SIZE];
+    PortOutPacketMap m_port_out_packets;
+    std::vector<PortOutPacket*> m_pending_packets;
+    ola::thread::timeout_id m_flush_timeout;
 
     KiNetNode(const KiNetNode&);
     KiNetNode& operator=(const KiNetNode&);
 
     void SocketReady();
-    void PopulatePacketHeader(uint16_t msg_type);
+    void FlushPortOut();
+    bool SendPacket(const IPV4Address &target,
+                    const uint8_t *data,
+                    unsigned int size);
+    void BuildHeaders();
+    void PopulatePacketHeader(uint16_t version, uint16_t msg_type);
     bool InitNetwork();
 
     static const uint16_t KINET_PORT = 6038;
     static const uint32_t KINET_MAGIC_NUMBER = 0x0401dc4a;
     static const uint16_t KINET_VERSION_ONE = 0x0100;
+    static const uint16_t KINET_VERSION_TWO = 0x0200;
     static const uint16_t KINET_DMX_MSG = 0x0101;
+    // 0x0108 in little endian
+    static const uint16_t KINET_PORTOUT_MSG = 0x0801;
 };
 }  // namespace kinet
 }  // namespace plugin
@@ -37,6 +37,7 @@ using ola::testing::MockUDPSocket;
 class KiNetNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(KiNetNodeTest);
   CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testSendPortOut);
   CPPUNIT_TEST_SUITE_END();
 
   public:
@@ -48,6 +49,7 @@ class KiNetNodeTest: public CppUnit::TestFixture {
     void setUp();
 
     void testSendDMX();
+    void testSendPortOut();
 
   private:
     ola::io::SelectServer ss;
@@ -88,3 +90,51 @@ void KiNetNodeTest::testSendDMX() {
   m_socket->Verify();
   OLA_ASSERT(node.Stop());
 }
+
+
+/**
+ * Check sending PORTOUT messages works.
+ */
+void KiNetNodeTest::testSendPortOut() {
+  KiNetNode node(&ss, m_socket);
+  OLA_ASSERT_TRUE(node.Start());
+
+  const uint8_t expected_port1[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x02, 0x00,
+    0x08, 0x01, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff,
+    1, 0, 0, 0, 8, 0, 0, 0,
+    1, 5, 8, 10, 14, 45, 100, 255
+  };
+
+  const uint8_t expected_port16[] = {
+    0x04, 0x01, 0xdc, 0x4a, 0x02, 0x00,
+    0x08, 0x01, 0, 0, 0, 0,
+    0xff, 0xff, 0xff, 0xff,
+    16, 0, 0, 0, 3, 0, 0, 0,
+    9, 8, 7
+  };
+
+  DmxBuffer buffer;
+  buffer.SetFromString("2,2,2");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 1, buffer));
+  buffer.SetFromString("9,8,7");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 16, buffer));
+  // the second frame for port 1 replaces the first
+  buffer.SetFromString("1,5,8,10,14,45,100,255");
+  OLA_ASSERT_TRUE(node.SendPortOut(target_ip, 1, buffer));
+
+  OLA_ASSERT_FALSE(node.SendPortOut(target_ip, 0, buffer));
+  OLA_ASSERT_FALSE(node.SendPortOut(target_ip, 17, buffer));
+
+  // nothing is sent until the select server runs
+  m_socket->Verify();
+
+  m_socket->AddExpectedData(expected_port1, sizeof(expected_port1), target_ip,
+                            KINET_PORT);
+  m_socket->AddExpectedData(expected_port16, sizeof(expected_port16),
+                            target_ip, KINET_PORT);
+  ss.RunOnce(0, 0);
+  m_socket->Verify();
+  OLA_ASSERT(node.Stop());
+}
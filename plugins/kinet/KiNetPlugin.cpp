@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -27,12 +28,14 @@
 #include "olad/Preferences.h"
 #include "plugins/kinet/KiNetPlugin.h"
 #include "plugins/kinet/KiNetDevice.h"
+#include "plugins/kinet/KiNetNode.h"
 
 
 namespace ola {
 namespace plugin {
 namespace kinet {
 
+using std::set;
 using std::vector;
 using ola::network::IPV4Address;
 
@@ -51,15 +54,32 @@ bool KiNetPlugin::StartHook() {
   vector<string>::const_iterator iter = power_supplies_strings.begin();
   vector<IPV4Address> power_supplies;
 
+  set<string> valid_modes;
+  valid_modes.insert(KiNetDevice::DMXOUT_MODE);
+  valid_modes.insert(KiNetDevice::PORTOUT_MODE);
+
+  bool save = false;
   for (; iter != power_supplies_strings.end(); ++iter) {
     IPV4Address target;
     if (IPV4Address::FromString(*iter, &target)) {
       power_supplies.push_back(target);
+      save |= m_preferences->SetDefaultValue(
+          KiNetDevice::ModeKey(target),
+          SetValidator(valid_modes),
+          KiNetDevice::DMXOUT_MODE);
+      save |= m_preferences->SetDefaultValue(
+          KiNetDevice::PortCountKey(target),
+          IntValidator(1, KiNetNode::KINET_MAX_PORTS),
+          "16");
     } else {
       OLA_WARN << "Invalid power supply IP address : " << *iter;
     }
   }
-  m_device.reset(new KiNetDevice(this, power_supplies, m_plugin_adaptor));
+  if (save)
+    m_preferences->Save();
+
+  m_device.reset(new KiNetDevice(this, power_supplies, m_plugin_adaptor,
+                                 m_preferences));
 
   if (!m_device->Start()) {
     m_device.reset();
@@ -96,14 +116,23 @@ string KiNetPlugin::Description() const {
 "----------------------------\n"
 "\n"
 "This plugin creates a single device with multiple output ports. Each port\n"
-"represents a power supply. This plugin uses the V1 DMX-Out version of the\n"
-"KiNET protocol\n"
+"represents a power supply, or in portout mode, one port on a power\n"
+"supply. Power supplies use the V1 DMX-Out version of the KiNET protocol\n"
+"unless they are configured to use the V2 Port-Out version.\n"
 "\n"
 "--- Config file : ola-kinet.conf ---\n"
 "\n"
 "power_supply = <ip>\n"
 "The IP of the power supply to send to. You can communicate with more than\n"
 "one power supply by adding multiple power_supply = lines\n"
+"\n"
+"<ip>-mode = [dmxout | portout]\n"
+"The protocol to use for the power supply. portout should be used for\n"
+"multi-port power supplies such as the PDS-480.\n"
+"\n"
+"<ip>-ports = 16\n"
+"The number of ports on the power supply, this only applies in portout\n"
+"mode.\n"
 "\n";
 }
 
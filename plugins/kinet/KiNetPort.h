@@ -21,6 +21,7 @@
 #ifndef PLUGINS_KINET_KINETPORT_H_
 #define PLUGINS_KINET_KINETPORT_H_
 
+#include <sstream>
 #include <string>
 #include "ola/network/IPV4Address.h"
 #include "olad/Port.h"
@@ -57,6 +58,42 @@ class KiNetOutputPort: public BasicOutputPort {
     KiNetNode *m_node;
     const IPV4Address m_target;
 };
+
+
+/*
+ * An output port which drives a single port on a multi-port power supply
+ * using the V2 PORTOUT message.
+ */
+class KiNetPortOutOutputPort: public BasicOutputPort {
+  public:
+    KiNetPortOutOutputPort(KiNetDevice *device,
+                           const IPV4Address &target,
+                           KiNetNode *node,
+                           unsigned int port_id,
+                           uint8_t kinet_port)
+        : BasicOutputPort(device, port_id),
+          m_node(node),
+          m_target(target),
+          m_kinet_port(kinet_port) {
+    }
+
+    bool WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
+      return m_node->SendPortOut(m_target, m_kinet_port, buffer);
+      (void) priority;
+    }
+
+    string Description() const {
+      std::ostringstream str;
+      str << "Power Supply: " << m_target << ", Port: "
+          << static_cast<int>(m_kinet_port);
+      return str.str();
+    }
+
+  private:
+    KiNetNode *m_node;
+    const IPV4Address m_target;
+    const uint8_t m_kinet_port;
+};
 }  // namespace kinet
 }  // namespace plugin
 }  // namespace ola
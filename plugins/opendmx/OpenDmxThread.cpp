@@ -41,8 +41,7 @@ namespace plugin {
 namespace opendmx {
 
 using std::string;
-using ola::thread::Mutex;
-using ola::thread::MutexLocker;
+using ola::thread::FrameMailbox;
 
 /*
  * Create a new OpenDmxThread object
@@ -50,8 +49,7 @@ using ola::thread::MutexLocker;
 OpenDmxThread::OpenDmxThread(const string &path)
     : ola::thread::Thread(),
     m_fd(INVALID_FD),
-    m_path(path),
-    m_term(false) {
+    m_path(path) {
 }
 
 
@@ -69,36 +67,35 @@ void *OpenDmxThread::Run() {
   buffer[0] = 0x00;
   m_fd = open(m_path.c_str(), O_WRONLY);
 
-  while (true) {
-    {
-      MutexLocker lock(&m_term_mutex);
-      if (m_term)
-        break;
-    }
-
+  while (!m_mailbox.IsClosed()) {
     if (m_fd == INVALID_FD) {
       TimeStamp wake_up;
       clock.CurrentTime(&wake_up);
       wake_up += TimeInterval(1, 0);
 
-      // wait for either a signal that we should terminate, or ts seconds
-      m_term_mutex.Lock();
-      if (m_term)
+      // wait for either a signal that we should terminate, or one second.
+      // New frames wake us up as well, so keep waiting until the time is up.
+      FrameMailbox::WaitResult result;
+      do {
+        result = m_mailbox.TimedWait(wake_up);
+      } while (result == FrameMailbox::NEW_FRAME);
+      if (result == FrameMailbox::CLOSED)
         break;
-      m_term_cond.TimedWait(&m_term_mutex, wake_up);
-      m_term_mutex.Unlock();
 
       m_fd = open(m_path.c_str(), O_WRONLY);
 
       if (m_fd == INVALID_FD)
         OLA_WARN << "Open " << m_path << ": " << strerror(errno);
 
+    } else if (!m_mailbox.Frame().Size()) {
+      // nothing to send yet, block until the first frame arrives
+      if (m_mailbox.Wait() == FrameMailbox::CLOSED)
+        break;
     } else {
+      // the write blocks for the duration of the frame, which paces the loop
+      m_mailbox.Poll();
       length = DMX_UNIVERSE_SIZE;
-      {
-        MutexLocker locker(&m_mutex);
-        m_buffer.Get(buffer + 1, &length);
-      }
+      m_mailbox.Frame().Get(buffer + 1, &length);
 
       if (write(m_fd, buffer, length + 1) < 0) {
         // if you unplug the dongle
@@ -118,23 +115,16 @@ void *OpenDmxThread::Run() {
  * Stop the thread
  */
 bool OpenDmxThread::Stop() {
-  {
-    MutexLocker locker(&m_mutex);
-    m_term = true;
-  }
-  m_term_cond.Signal();
+  m_mailbox.Close();
   return Join();
 }
 
 
 /*
- * Store the data in the shared buffer
- *
+ * Hand the data to the output thread
  */
 bool OpenDmxThread::WriteDmx(const DmxBuffer &buffer) {
-  MutexLocker locker(&m_mutex);
-  // avoid the reference counting
-  m_buffer.Set(buffer);
+  m_mailbox.Put(buffer);
   return true;
 }
 }  // namespace opendmx
@@ -23,6 +23,7 @@
 
 #include <string>
 #include "ola/DmxBuffer.h"
+#include "ola/thread/FrameMailbox.h"
 #include "ola/thread/Thread.h"
 
 namespace ola {
@@ -41,11 +42,7 @@ class OpenDmxThread: public ola::thread::Thread {
   private:
     int m_fd;
     string m_path;
-    DmxBuffer m_buffer;
-    bool m_term;
-    ola::thread::Mutex m_mutex;
-    ola::thread::Mutex m_term_mutex;
-    ola::thread::ConditionVariable m_term_cond;
+    ola::thread::FrameMailbox m_mailbox;
 
     static const int INVALID_FD = -1;
 };
@@ -18,11 +18,16 @@
  * Copyright (C) 2012 Simon Newton
  */
 
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
 #include <ola/BaseTypes.h>
 #include <ola/Callback.h>
 #include <ola/ExportMap.h>
 #include <ola/Logging.h>
 #include <ola/StringUtils.h>
+#include <ola/network/NetworkUtils.h>
 #include <ola/stl/STLUtils.h>
 #include <algorithm>
 #include <string>
@@ -35,12 +40,19 @@ namespace plugin {
 namespace osc {
 
 using ola::IntToString;
+using ola::network::HostToNetwork;
 using std::make_pair;
 using std::max;
 using std::min;
 
 const char OSCNode::OSC_PORT_VARIABLE[] = "osc-listen-port";
 
+// The bundle header, followed by the 'immediate' time tag.
+const uint8_t OSCNode::BUNDLE_HEADER[] = {
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  0, 0, 0, 0, 0, 0, 0, 1
+};
+
 /*
  * The Error handler for the OSC server.
  */
@@ -170,6 +182,34 @@ OSCNode::NodeOSCTarget::~NodeOSCTarget() {
 }
 
 
+/**
+ * Return the OSC address for a slot. The addresses are built the first time
+ * they're needed.
+ * @param slot the slot, starting from 0.
+ */
+const string &OSCNode::NodeOSCTarget::SlotAddress(unsigned int slot) {
+  if (m_slot_addresses.empty()) {
+    m_slot_addresses.reserve(DMX_UNIVERSE_SIZE);
+    for (unsigned int i = 0; i < DMX_UNIVERSE_SIZE; i++) {
+      m_slot_addresses.push_back(osc_address + "/" + IntToString(i + 1));
+    }
+  }
+  return m_slot_addresses[slot];
+}
+
+
+/**
+ * Free the cached slot messages.
+ */
+OSCNode::OSCOutputGroup::~OSCOutputGroup() {
+  vector<lo_message>::iterator iter = slot_messages.begin();
+  for (; iter != slot_messages.end(); ++iter) {
+    if (*iter)
+      lo_message_free(*iter);
+  }
+}
+
+
 /**
  * Create a new OSCNode.
  * @param ss the SelectServer to use
@@ -348,11 +388,15 @@ bool OSCNode::SendData(unsigned int group, DataFormat data_format,
     case FORMAT_INT_INDIVIDUAL:
       return SendIndividualInts(dmx_data, output_group);
     case FORMAT_INT_ARRAY:
-      return SendIntArray(dmx_data, output_group->targets);
+      return SendIntArray(dmx_data, output_group);
     case FORMAT_FLOAT_INDIVIDUAL:
       return SendIndividualFloats(dmx_data, output_group);
     case FORMAT_FLOAT_ARRAY:
-      return SendFloatArray(dmx_data, output_group->targets);
+      return SendFloatArray(dmx_data, output_group);
+    case FORMAT_INT_BUNDLE:
+      return SendBundles(dmx_data, output_group, "i");
+    case FORMAT_FLOAT_BUNDLE:
+      return SendBundles(dmx_data, output_group, "f");
     default:
       OLA_WARN << "Unimplemented data format";
       return false;
@@ -497,14 +541,9 @@ bool OSCNode::SendIndividualInts(const DmxBuffer &dmx_data,
  * Send the DmxBuffer as an array of ints.
  */
 bool OSCNode::SendIntArray(const DmxBuffer &dmx_data,
-                           const OSCTargetVector &targets) {
-  lo_message message = lo_message_new();
-
-  for (size_t i = 0; i < dmx_data.Size(); ++i) {
-    lo_message_add_int32(message, dmx_data.Get(i));
-  }
-
-  bool ok = SendMessageToTargets(message, targets);
+                           OSCOutputGroup *group) {
+  lo_message message = BuildArrayMessage(dmx_data, "i");
+  bool ok = SendMessageToTargets(message, group->targets);
   lo_message_free(message);
   return ok;
 }
@@ -513,14 +552,9 @@ bool OSCNode::SendIntArray(const DmxBuffer &dmx_data,
  * Send the DmxBuffer as an array of normalized floats.
  */
 bool OSCNode::SendFloatArray(const DmxBuffer &dmx_data,
-                             const OSCTargetVector &targets) {
-  lo_message message = lo_message_new();
-
-  for (size_t i = 0; i < dmx_data.Size(); ++i) {
-    lo_message_add_float(message, dmx_data.Get(i) / 255.0f);
-  }
-
-  bool ok = SendMessageToTargets(message, targets);
+                             OSCOutputGroup *group) {
+  lo_message message = BuildArrayMessage(dmx_data, "f");
+  bool ok = SendMessageToTargets(message, group->targets);
   lo_message_free(message);
   return ok;
 }
@@ -558,48 +592,187 @@ bool OSCNode::SendIndividualMessages(const DmxBuffer &dmx_data,
   bool ok = true;
   const OSCTargetVector &targets = group->targets;
 
-  vector<SlotMessage> messages;
-
   // We only send the slots that have changed.
-  for (unsigned int i = 0; i < dmx_data.Size(); ++i) {
-    if (i > group->dmx.Size() || dmx_data.Get(i) != group->dmx.Get(i)) {
-      SlotMessage message = {i, lo_message_new()};
-      if (osc_type == "i") {
-        lo_message_add_int32(message.message, dmx_data.Get(i));
-      } else {
-        lo_message_add_float(message.message, dmx_data.Get(i) / 255.0f);
-      }
-      messages.push_back(message);
-    }
-  }
-  group->dmx.Set(dmx_data);
+  vector<unsigned int> slots;
+  UpdateSlotMessages(dmx_data, group, osc_type, &slots);
 
   // Send all messages to each target.
   OSCTargetVector::const_iterator target_iter = targets.begin();
   for (; target_iter != targets.end(); ++target_iter) {
     OLA_DEBUG << "Sending to " << (*target_iter)->socket_address;
 
-    vector<SlotMessage>::const_iterator message_iter = messages.begin();
-    for (; message_iter != messages.end(); ++message_iter) {
-      std::stringstream path;
-      path << (*target_iter)->osc_address << "/" << message_iter->slot + 1;
-
-      int ret = lo_send_message_from((*target_iter)->liblo_address,
-                                     m_osc_server,
-                                     path.str().c_str(),
-                                     message_iter->message);
+    vector<unsigned int>::const_iterator slot_iter = slots.begin();
+    for (; slot_iter != slots.end(); ++slot_iter) {
+      int ret = lo_send_message_from(
+          (*target_iter)->liblo_address,
+          m_osc_server,
+          (*target_iter)->SlotAddress(*slot_iter).c_str(),
+          group->slot_messages[*slot_iter]);
       ok &= (ret > 0);
     }
   }
+  return ok;
+}
 
-  // Clean up the messages.
-  vector<SlotMessage>::iterator message_iter = messages.begin();
-  for (; message_iter != messages.end(); ++message_iter) {
-    lo_message_free(message_iter->message);
+
+/**
+ * Send the changed slots to a set of targets, packing as many individual
+ * messages into each OSC bundle as will fit in MAX_BUNDLE_SIZE.
+ * @param dmx_data the DmxBuffer to send
+ * @param group the OSCOutputGroup with the targets.
+ * @param osc_type the type of OSC message, either "i" or "f"
+ */
+bool OSCNode::SendBundles(const DmxBuffer &dmx_data,
+                          OSCOutputGroup *group,
+                          const string &osc_type) {
+  vector<unsigned int> slots;
+  UpdateSlotMessages(dmx_data, group, osc_type, &slots);
+  if (slots.empty())
+    return true;
+
+  bool ok = true;
+  OSCTargetVector::const_iterator target_iter = group->targets.begin();
+  for (; target_iter != group->targets.end(); ++target_iter) {
+    OLA_DEBUG << "Sending bundles to " << (*target_iter)->socket_address;
+    ok &= SendBundlesToTarget(*target_iter, *group, slots);
   }
+  return ok;
+}
+
+
+/**
+ * Build and send the bundles for a single target.
+ *
+ * liblo's lo_bundle API differs in who owns the messages between versions,
+ * so we serialize the pre-allocated messages into our own buffer instead.
+ */
+bool OSCNode::SendBundlesToTarget(NodeOSCTarget *target,
+                                  const OSCOutputGroup &group,
+                                  const vector<unsigned int> &slots) {
+  bool ok = true;
+  unsigned int offset = 0;
+
+  vector<unsigned int>::const_iterator iter = slots.begin();
+  for (; iter != slots.end(); ++iter) {
+    const char *path = target->SlotAddress(*iter).c_str();
+    lo_message message = group.slot_messages[*iter];
+    size_t length = lo_message_length(message, path);
+    const unsigned int element_size = sizeof(uint32_t) + length;
 
+    if (sizeof(BUNDLE_HEADER) + element_size > MAX_BUNDLE_SIZE) {
+      OLA_WARN << "OSC address " << path << " is too long to bundle";
+      return false;
+    }
+
+    if (offset && offset + element_size > MAX_BUNDLE_SIZE) {
+      ok &= SendBundleBuffer(*target, offset);
+      offset = 0;
+    }
+
+    if (!offset) {
+      memcpy(m_bundle_buffer, BUNDLE_HEADER, sizeof(BUNDLE_HEADER));
+      offset = sizeof(BUNDLE_HEADER);
+    }
+
+    uint32_t network_length = HostToNetwork(static_cast<uint32_t>(length));
+    memcpy(m_bundle_buffer + offset, &network_length, sizeof(network_length));
+    offset += sizeof(network_length);
+    lo_message_serialise(message, path, m_bundle_buffer + offset, &length);
+    offset += length;
+  }
+
+  if (offset)
+    ok &= SendBundleBuffer(*target, offset);
   return ok;
 }
+
+
+/**
+ * Send the first size bytes of m_bundle_buffer to a target, using the same
+ * socket as liblo.
+ */
+bool OSCNode::SendBundleBuffer(const NodeOSCTarget &target,
+                               unsigned int size) {
+  struct sockaddr destination;
+  if (!target.socket_address.ToSockAddr(&destination, sizeof(destination)))
+    return false;
+
+  ssize_t bytes_sent = sendto(lo_server_get_socket_fd(m_osc_server),
+                              m_bundle_buffer, size, 0, &destination,
+                              sizeof(struct sockaddr_in));
+  if (bytes_sent != static_cast<ssize_t>(size)) {
+    OLA_WARN << "Failed to send OSC bundle to " << target.socket_address
+             << ": " << strerror(errno);
+    return false;
+  }
+  return true;
+}
+
+
+/**
+ * Rebuild the slot messages for the slots that changed since the last frame.
+ * Messages are only built with the public liblo API, the arguments of an
+ * existing message are never modified in place.
+ * @param dmx_data the DmxBuffer to send
+ * @param group the OSCOutputGroup with the messages.
+ * @param osc_type the type of OSC message, either "i" or "f"
+ * @param changed_slots populated with the slots that differ from the last
+ *   frame.
+ */
+void OSCNode::UpdateSlotMessages(const DmxBuffer &dmx_data,
+                                 OSCOutputGroup *group,
+                                 const string &osc_type,
+                                 vector<unsigned int> *changed_slots) {
+  if (group->slot_type != osc_type) {
+    // the type changed, the existing messages are no use.
+    vector<lo_message>::iterator iter = group->slot_messages.begin();
+    for (; iter != group->slot_messages.end(); ++iter) {
+      if (*iter)
+        lo_message_free(*iter);
+    }
+    group->slot_messages.assign(DMX_UNIVERSE_SIZE, NULL);
+    group->slot_type = osc_type;
+    group->dmx.Reset();
+  }
+
+  for (unsigned int i = 0; i < dmx_data.Size(); ++i) {
+    uint8_t value = dmx_data.Get(i);
+    if (i < group->dmx.Size() && value == group->dmx.Get(i))
+      continue;
+
+    lo_message &message = group->slot_messages[i];
+    if (message)
+      lo_message_free(message);
+    message = lo_message_new();
+    if (osc_type == "i") {
+      lo_message_add_int32(message, value);
+    } else {
+      lo_message_add_float(message, value / 255.0f);
+    }
+    changed_slots->push_back(i);
+  }
+  group->dmx.Set(dmx_data);
+}
+
+
+/**
+ * Build a message containing every slot in the DmxBuffer.
+ * @param dmx_data the DmxBuffer to send
+ * @param osc_type the type of OSC message, either "i" or "f"
+ * @returns a new lo_message, ownership is transferred to the caller.
+ */
+lo_message OSCNode::BuildArrayMessage(const DmxBuffer &dmx_data,
+                                      const string &osc_type) {
+  lo_message message = lo_message_new();
+  for (unsigned int i = 0; i < dmx_data.Size(); ++i) {
+    if (osc_type == "i") {
+      lo_message_add_int32(message, dmx_data.Get(i));
+    } else {
+      lo_message_add_float(message, dmx_data.Get(i) / 255.0f);
+    }
+  }
+  return message;
+}
 }  // namespace osc
 }  // namespace plugin
 }  // namespace ola
@@ -83,6 +83,8 @@ class OSCNode {
       FORMAT_INT_INDIVIDUAL,
       FORMAT_FLOAT_ARRAY,
       FORMAT_FLOAT_INDIVIDUAL,
+      FORMAT_INT_BUNDLE,
+      FORMAT_FLOAT_BUNDLE,
     };
 
     // The options for the OSCNode object.
@@ -136,11 +138,17 @@ class OSCNode {
                   osc_address == other.osc_address);
         }
 
+        // The OSC address used for a slot (0 indexed) in the individual &
+        // bundle formats.
+        const string &SlotAddress(unsigned int slot);
+
         IPV4SocketAddress socket_address;
         string osc_address;
         lo_address liblo_address;
 
       private:
+        vector<string> m_slot_addresses;
+
         NodeOSCTarget(const NodeOSCTarget&);
         NodeOSCTarget& operator=(const NodeOSCTarget&);
     };
@@ -148,8 +156,15 @@ class OSCNode {
     typedef vector<NodeOSCTarget*> OSCTargetVector;
 
     struct OSCOutputGroup {
+      ~OSCOutputGroup();
+
       OSCTargetVector targets;
       DmxBuffer dmx;  // holds the last values.
+
+      // The last message built for each slot. A slot's message is rebuilt
+      // when its value changes.
+      vector<lo_message> slot_messages;  // one per slot, of slot_type
+      string slot_type;
     };
 
     struct OSCInputGroup {
@@ -162,11 +177,6 @@ class OSCNode {
     typedef map<unsigned int, OSCOutputGroup*> OutputGroupMap;
     typedef map<string, OSCInputGroup*> InputUniverseMap;
 
-    struct SlotMessage {
-      unsigned int slot;
-      lo_message message;
-    };
-
     SelectServerInterface *m_ss;
     const uint16_t m_listen_port;
     auto_ptr<ola::io::UnmanagedFileDescriptor> m_descriptor;
@@ -181,16 +191,35 @@ class OSCNode {
     bool SendIndividualInts(const DmxBuffer &data,
                             OSCOutputGroup *group);
     bool SendIntArray(const DmxBuffer &data,
-                      const OSCTargetVector &targets);
+                      OSCOutputGroup *group);
     bool SendFloatArray(const DmxBuffer &data,
-                        const OSCTargetVector &targets);
+                        OSCOutputGroup *group);
     bool SendMessageToTargets(lo_message message,
                               const OSCTargetVector &targets);
     bool SendIndividualMessages(const DmxBuffer &data,
                                 OSCOutputGroup *group,
                                 const string &osc_type);
+    bool SendBundles(const DmxBuffer &data,
+                     OSCOutputGroup *group,
+                     const string &osc_type);
+    bool SendBundlesToTarget(NodeOSCTarget *target,
+                             const OSCOutputGroup &group,
+                             const vector<unsigned int> &slots);
+    bool SendBundleBuffer(const NodeOSCTarget &target, unsigned int size);
+    void UpdateSlotMessages(const DmxBuffer &data,
+                            OSCOutputGroup *group,
+                            const string &osc_type,
+                            vector<unsigned int> *changed_slots);
+
+    static lo_message BuildArrayMessage(const DmxBuffer &data,
+                                        const string &osc_type);
 
     static const uint16_t DEFAULT_OSC_PORT = 7770;
+    // The largest bundle we'll send, this fits in a single ethernet frame.
+    static const unsigned int MAX_BUNDLE_SIZE = 1472;
+    static const uint8_t BUNDLE_HEADER[];
+
+    uint8_t m_bundle_buffer[MAX_BUNDLE_SIZE];
     static const char OSC_PORT_VARIABLE[];
 };
 }  // namespace osc
@@ -50,6 +50,7 @@ using std::auto_ptr;
 class OSCNodeTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(OSCNodeTest);
   CPPUNIT_TEST(testSendBlob);
+  CPPUNIT_TEST(testSendIntBundle);
   CPPUNIT_TEST(testReceive);
   CPPUNIT_TEST_SUITE_END();
 
@@ -59,7 +60,9 @@ class OSCNodeTest: public CppUnit::TestFixture {
      */
     OSCNodeTest()
         : CppUnit::TestFixture(),
-          m_timeout_id(ola::thread::INVALID_TIMEOUT) {
+          m_timeout_id(ola::thread::INVALID_TIMEOUT),
+          m_expected_data(NULL),
+          m_expected_size(0) {
       OSCNode::OSCNodeOptions options;
       options.listen_port = 0;
       m_osc_node.reset(new OSCNode(&m_ss, NULL, options));
@@ -70,8 +73,9 @@ class OSCNodeTest: public CppUnit::TestFixture {
     void setUp();
     void tearDown() { m_osc_node->Stop(); }
 
-    // our two tests
+    // our tests
     void testSendBlob();
+    void testSendIntBundle();
     void testReceive();
 
     // Called if we don't receive data in ABORT_TIMEOUT_IN_MS
@@ -84,14 +88,19 @@ class OSCNodeTest: public CppUnit::TestFixture {
     ola::thread::timeout_id m_timeout_id;
     DmxBuffer m_dmx_data;
     DmxBuffer m_received_data;
+    const uint8_t *m_expected_data;
+    unsigned int m_expected_size;
 
     void UDPSocketReady();
+    void ListenForPackets(IPV4SocketAddress *socket_address);
     void DMXHandler(const DmxBuffer &dmx);
 
     static const unsigned int TEST_GROUP = 10;  // the group to use for testing
     // The number of mseconds to wait before failing the test.
     static const int ABORT_TIMEOUT_IN_MS = 2000;
     static const uint8_t OSC_BLOB_DATA[];
+    static const uint8_t OSC_INT_BUNDLE_DATA[];
+    static const uint8_t OSC_INT_BUNDLE_UPDATE_DATA[];
     static const uint8_t OSC_SINGLE_FLOAT_DATA[];
     static const uint8_t OSC_SINGLE_INT_DATA[];
     static const uint8_t OSC_INT_TUPLE_DATA[];
@@ -116,6 +125,48 @@ const uint8_t OSCNodeTest::OSC_BLOB_DATA[] = {
   8, 9, 0xa, 0
 };
 
+// A bundle of int messages for slots 1 - 3
+const uint8_t OSCNodeTest::OSC_INT_BUNDLE_DATA[] = {
+  // bundle header & immediate time tag
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  0, 0, 0, 0, 0, 0, 0, 1,
+  // slot 1
+  0, 0, 0, 28,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '1', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 0,
+  // slot 2
+  0, 0, 0, 28,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '2', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 1,
+  // slot 3
+  0, 0, 0, 28,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '3', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 2
+};
+
+// A bundle with only slot 2, which changed.
+const uint8_t OSCNodeTest::OSC_INT_BUNDLE_UPDATE_DATA[] = {
+  // bundle header & immediate time tag
+  '#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+  0, 0, 0, 0, 0, 0, 0, 1,
+  // slot 2
+  0, 0, 0, 28,
+  '/', 'd', 'm', 'x', '/', 'u', 'n', 'i',
+  'v', 'e', 'r', 's', 'e', '/', '1', '0',
+  '/', '2', 0, 0,
+  ',', 'i', 0, 0,
+  0, 0, 0, 200
+};
+
 // An OSC single float packet for slot 1
 const uint8_t OSCNodeTest::OSC_SINGLE_FLOAT_DATA[] = {
   // osc address
@@ -198,12 +249,29 @@ void OSCNodeTest::UDPSocketReady() {
   // Read the received packet into 'data'.
   OLA_ASSERT_TRUE(m_udp_socket.RecvFrom(data, &data_read));
   // Verify it matches the expected packet
-  ASSERT_DATA_EQUALS(__LINE__, OSC_BLOB_DATA,
-                     sizeof(OSC_BLOB_DATA), data, data_read);
+  ASSERT_DATA_EQUALS(__LINE__, m_expected_data, m_expected_size,
+                     data, data_read);
   // Stop the SelectServer
   m_ss.Terminate();
 }
 
+/**
+ * Bind the UDP socket to an ephemeral port on the loopback interface and
+ * start listening for packets.
+ */
+void OSCNodeTest::ListenForPackets(IPV4SocketAddress *socket_address) {
+  // Port 0 means 'ANY'
+  *socket_address = IPV4SocketAddress(IPV4Address::Loopback(), 0);
+  // Bind the socket, set the callback, and register with the select server.
+  OLA_ASSERT_TRUE(m_udp_socket.Bind(*socket_address));
+  m_udp_socket.SetOnData(NewCallback(this, &OSCNodeTest::UDPSocketReady));
+  OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(&m_udp_socket));
+  // Store the local address of the UDP socket so we know where to tell the
+  // OSCNode to send to.
+  OLA_ASSERT_TRUE(m_udp_socket.GetSocketAddress(socket_address));
+}
+
+
 /**
  * Called when we receive DMX data via OSC. We check this matches what we
  * expect, and then stop the SelectServer.
@@ -219,15 +287,10 @@ void OSCNodeTest::DMXHandler(const DmxBuffer &dmx) {
  */
 void OSCNodeTest::testSendBlob() {
   // First up create a UDP socket to receive the messages on.
-  // Port 0 means 'ANY'
-  IPV4SocketAddress socket_address(IPV4Address::Loopback(), 0);
-  // Bind the socket, set the callback, and register with the select server.
-  OLA_ASSERT_TRUE(m_udp_socket.Bind(socket_address));
-  m_udp_socket.SetOnData(NewCallback(this, &OSCNodeTest::UDPSocketReady));
-  OLA_ASSERT_TRUE(m_ss.AddReadDescriptor(&m_udp_socket));
-  // Store the local address of the UDP socket so we know where to tell the
-  // OSCNode to send to.
-  OLA_ASSERT_TRUE(m_udp_socket.GetSocketAddress(&socket_address));
+  IPV4SocketAddress socket_address;
+  ListenForPackets(&socket_address);
+  m_expected_data = OSC_BLOB_DATA;
+  m_expected_size = sizeof(OSC_BLOB_DATA);
 
   // Setup the OSCTarget pointing to the local socket address
   OSCTarget target(socket_address, TEST_OSC_ADDRESS);
@@ -251,6 +314,39 @@ void OSCNodeTest::testSendBlob() {
 }
 
 
+/**
+ * Check that we send bundles of the changed slots.
+ */
+void OSCNodeTest::testSendIntBundle() {
+  IPV4SocketAddress socket_address;
+  ListenForPackets(&socket_address);
+
+  OSCTarget target(socket_address, TEST_OSC_ADDRESS);
+  m_osc_node->AddTarget(TEST_GROUP, target);
+
+  DmxBuffer dmx;
+  dmx.SetFromString("0,1,2");
+  m_expected_data = OSC_INT_BUNDLE_DATA;
+  m_expected_size = sizeof(OSC_INT_BUNDLE_DATA);
+  OLA_ASSERT_TRUE(m_osc_node->SendData(TEST_GROUP, OSCNode::FORMAT_INT_BUNDLE,
+                  dmx));
+  m_ss.Run();
+
+  // Nothing has changed, so nothing is sent. Then update slot 2, only that
+  // slot should be sent.
+  OLA_ASSERT_TRUE(m_osc_node->SendData(TEST_GROUP, OSCNode::FORMAT_INT_BUNDLE,
+                  dmx));
+  dmx.SetChannel(1, 200);
+  m_expected_data = OSC_INT_BUNDLE_UPDATE_DATA;
+  m_expected_size = sizeof(OSC_INT_BUNDLE_UPDATE_DATA);
+  OLA_ASSERT_TRUE(m_osc_node->SendData(TEST_GROUP, OSCNode::FORMAT_INT_BUNDLE,
+                  dmx));
+  m_ss.Run();
+
+  OLA_ASSERT_TRUE(m_osc_node->RemoveTarget(TEST_GROUP, target));
+}
+
+
 /**
  * Check that we receive OSC messages correctly.
  */
@@ -52,8 +52,10 @@ const char OSCPlugin::UDP_PORT_KEY[] = "udp_listen_port";
 
 const char OSCPlugin::BLOB_FORMAT[] = "blob";
 const char OSCPlugin::FLOAT_ARRAY_FORMAT[] = "float_array";
+const char OSCPlugin::FLOAT_BUNDLE_FORMAT[] = "float_bundle";
 const char OSCPlugin::FLOAT_INDIVIDUAL_FORMAT[] = "individual_float";
 const char OSCPlugin::INT_ARRAY_FORMAT[] = "int_array";
+const char OSCPlugin::INT_BUNDLE_FORMAT[] = "int_bundle";
 const char OSCPlugin::INT_INDIVIDUAL_FORMAT[] = "individual_int";
 
 /*
@@ -145,13 +147,18 @@ string OSCPlugin::Description() const {
 "The OSC address to listen on for port N. If the address contains %d\n"
 "it's replaced by the universe number for port N.\n"
 "\n"
-"port_N_format = [blob|float_array,individual_float,individual_int,int_array]\n"
+"port_N_format = [blob|float_array,float_bundle,individual_float,\n"
+"                 individual_int,int_array,int_bundle]\n"
 "The format (OSC Type) to send the DMX data in:\n"
 " - blob: a OSC-blob\n"
 " - float_array: an array of float values. 0.0 - 1.0\n"
+" - float_bundle: the same messages as individual_float, packed into OSC\n"
+"   bundles. Only slots that changed are sent.\n"
 " - individual_float: one float message for each slot (channel). 0.0 - 1.0 \n"
 " - individual_int: one int message for each slot (channel). 0 - 255.\n"
 " - int_array: an array of int values. 0 - 255.\n"
+" - int_bundle: the same messages as individual_int, packed into OSC\n"
+"   bundles. Only slots that changed are sent.\n"
 "\n"
 "udp_listen_port = <int>\n"
 "The UDP Port to listen on for OSC messages.\n"
@@ -242,10 +249,14 @@ void OSCPlugin::SetDataFormat(const string &format_option,
     port_config->data_format = OSCNode::FORMAT_BLOB;
   } else if (format_option == FLOAT_ARRAY_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_FLOAT_ARRAY;
+  } else if (format_option == FLOAT_BUNDLE_FORMAT) {
+    port_config->data_format = OSCNode::FORMAT_FLOAT_BUNDLE;
   } else if (format_option == FLOAT_INDIVIDUAL_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_FLOAT_INDIVIDUAL;
   } else if (format_option == INT_ARRAY_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_INT_ARRAY;
+  } else if (format_option == INT_BUNDLE_FORMAT) {
+    port_config->data_format = OSCNode::FORMAT_INT_BUNDLE;
   } else if (format_option == INT_INDIVIDUAL_FORMAT) {
     port_config->data_format = OSCNode::FORMAT_INT_INDIVIDUAL;
   } else {
@@ -73,8 +73,10 @@ class OSCPlugin: public Plugin {
 
     static const char BLOB_FORMAT[];
     static const char FLOAT_ARRAY_FORMAT[];
+    static const char FLOAT_BUNDLE_FORMAT[];
     static const char FLOAT_INDIVIDUAL_FORMAT[];
     static const char INT_ARRAY_FORMAT[];
+    static const char INT_BUNDLE_FORMAT[];
     static const char INT_INDIVIDUAL_FORMAT[];
 };
 }  // namespace osc
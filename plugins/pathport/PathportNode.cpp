@@ -21,7 +21,6 @@
 #include <string.h>
 #include <algorithm>
 #include <string>
-#include <map>
 #include <vector>
 #include "ola/Logging.h"
 #include "ola/BaseTypes.h"
@@ -35,7 +34,6 @@ namespace plugin {
 namespace pathport {
 
 using std::string;
-using std::map;
 using std::vector;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
@@ -65,12 +63,6 @@ PathportNode::PathportNode(const string &ip_address,
  */
 PathportNode::~PathportNode() {
   Stop();
-
-  universe_handlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
-  }
-  m_handlers.clear();
 }
 
 
@@ -196,18 +188,7 @@ bool PathportNode::SetHandler(uint8_t universe,
   if (!closure)
     return false;
 
-  universe_handlers::iterator iter = m_handlers.find(universe);
-
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
-    handler.buffer = buffer;
-    handler.closure = closure;
-    m_handlers[universe] = handler;
-  } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    delete old_closure;
-  }
+  m_handlers.SetHandler(universe, buffer, closure);
   return true;
 }
 
@@ -218,15 +199,7 @@ bool PathportNode::SetHandler(uint8_t universe,
  * @param true if removed, false if it didn't exist
  */
 bool PathportNode::RemoveHandler(uint8_t universe) {
-  universe_handlers::iterator iter = m_handlers.find(universe);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
-    return true;
-  }
-  return false;
+  return m_handlers.RemoveHandler(universe);
 }
 
 
@@ -403,13 +376,9 @@ void PathportNode::HandleDmxData(const pathport_pdu_data &packet,
     unsigned int channels_for_this_universe =
       std::min(data_size, DMX_UNIVERSE_SIZE - offset);
 
-    universe_handlers::iterator iter = m_handlers.find(universe);
-    if (iter != m_handlers.end()) {
-      iter->second.buffer->SetRange(offset,
-                                    dmx_data,
-                                    channels_for_this_universe);
-      iter->second.closure->Run();
-    }
+    // this is a no-op if we don't have a handler for the universe
+    m_handlers.SetRange(universe, offset, dmx_data,
+                        channels_for_this_universe);
     data_size -= channels_for_this_universe;
     dmx_data += channels_for_this_universe;
     offset = 0;
@@ -21,10 +21,10 @@
 #ifndef PLUGINS_PATHPORT_PATHPORTNODE_H_
 #define PLUGINS_PATHPORT_PATHPORTNODE_H_
 
-#include <map>
 #include <string>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
+#include "ola/dmx/UniverseDispatchTable.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
@@ -63,11 +63,6 @@ class PathportNode {
     static const uint8_t MAX_UNIVERSES = 127;
 
   private:
-    typedef struct {
-      DmxBuffer *buffer;
-      Callback0<void> *closure;
-    } universe_handler;
-
     enum {
       XDMX_DATA_FLAT = 0x0101,
       XDMX_DATA_RELEASE = 0x0103
@@ -101,8 +96,6 @@ class PathportNode {
       NODE_DEVICE_ONEPORT = 2,
     };
 
-    typedef std::map<uint8_t, universe_handler> universe_handlers;
-
     bool InitNetwork();
     void PopulateHeader(pathport_packet_header *header, uint32_t destination);
     bool ValidateHeader(const pathport_packet_header &header);
@@ -119,7 +112,7 @@ class PathportNode {
     uint32_t m_device_id;  // the pathport device id
     uint16_t m_sequence_number;
 
-    universe_handlers m_handlers;
+    ola::dmx::UniverseDispatchTable m_handlers;
     ola::network::Interface m_interface;
     UDPSocket m_socket;
     IPV4Address m_config_addr;
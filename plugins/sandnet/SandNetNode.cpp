@@ -21,7 +21,6 @@
 #include <string.h>
 #include <algorithm>
 #include <string>
-#include <map>
 #include <vector>
 #include "ola/Logging.h"
 #include "ola/network/IPV4Address.h"
@@ -35,7 +34,6 @@ namespace plugin {
 namespace sandnet {
 
 using std::string;
-using std::map;
 using std::vector;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
@@ -72,12 +70,6 @@ SandNetNode::SandNetNode(const string &ip_address)
  */
 SandNetNode::~SandNetNode() {
   Stop();
-
-  universe_handlers::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
-  }
-  m_handlers.clear();
 }
 
 
@@ -192,19 +184,7 @@ bool SandNetNode::SetHandler(uint8_t group, uint8_t universe,
   if (!closure)
     return false;
 
-  group_universe_pair key(group, universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
-    handler.buffer = buffer;
-    handler.closure = closure;
-    m_handlers[key] = handler;
-  } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    delete old_closure;
-  }
+  m_handlers.SetHandler(HandlerIndex(group, universe), buffer, closure);
   return true;
 }
 
@@ -215,16 +195,7 @@ bool SandNetNode::SetHandler(uint8_t group, uint8_t universe,
  * @param true if removed, false if it didn't exist
  */
 bool SandNetNode::RemoveHandler(uint8_t group, uint8_t universe) {
-  group_universe_pair key(group, universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
-    return true;
-  }
-  return false;
+  return m_handlers.RemoveHandler(HandlerIndex(group, universe));
 }
 
 
@@ -377,20 +348,16 @@ bool SandNetNode::HandleCompressedDMX(const sandnet_compressed_dmx &dmx_packet,
     return false;
   }
 
-  group_universe_pair key(dmx_packet.group, dmx_packet.universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter == m_handlers.end())
+  unsigned int index = HandlerIndex(dmx_packet.group, dmx_packet.universe);
+  if (!m_handlers.HasHandler(index))
     return false;
 
   unsigned int data_size = size - header_size;
-  bool r = m_encoder.Decode(0, dmx_packet.dmx, data_size, iter->second.buffer);
-  if (!r) {
+  if (!m_handlers.DecodeRunLength(index, 0, dmx_packet.dmx, data_size,
+                                  &m_encoder)) {
     OLA_WARN << "Failed to decode Sandnet Data";
     return false;
   }
-
-  iter->second.closure->Run();
   return true;
 }
 
@@ -407,16 +374,9 @@ bool SandNetNode::HandleDMX(const sandnet_dmx &dmx_packet,
     return false;
   }
 
-  group_universe_pair key(dmx_packet.group, dmx_packet.universe);
-  universe_handlers::iterator iter = m_handlers.find(key);
-
-  if (iter == m_handlers.end())
-    return false;
-
   unsigned int data_size = size - header_size;
-  iter->second.buffer->Set(dmx_packet.dmx, data_size);
-  iter->second.closure->Run();
-  return true;
+  return m_handlers.Set(HandlerIndex(dmx_packet.group, dmx_packet.universe),
+                        dmx_packet.dmx, data_size);
 }
 
 
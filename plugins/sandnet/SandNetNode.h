@@ -21,16 +21,15 @@
 #ifndef PLUGINS_SANDNET_SANDNETNODE_H_
 #define PLUGINS_SANDNET_SANDNETNODE_H_
 
-#include <map>
 #include <string>
 #include <vector>
-#include <utility>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/network/IPV4Address.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
 #include "ola/dmx/RunLengthEncoder.h"
+#include "ola/dmx/UniverseDispatchTable.h"
 #include "plugins/sandnet/SandNetPackets.h"
 
 namespace ola {
@@ -83,14 +82,6 @@ class SandNetNode {
       sandnet_port_type type;
     } sandnet_port;
 
-    typedef struct {
-      DmxBuffer *buffer;
-      Callback0<void> *closure;
-    } universe_handler;
-
-    typedef std::pair<uint8_t, uint8_t> group_universe_pair;
-    typedef std::map<group_universe_pair, universe_handler> universe_handlers;
-
     bool InitNetwork();
 
     bool HandleCompressedDMX(const sandnet_compressed_dmx &dmx_packet,
@@ -99,6 +90,11 @@ class SandNetNode {
     bool HandleDMX(const sandnet_dmx &dmx_packet,
                    unsigned int size);
     bool SendUncompressedDMX(uint8_t port_id, const DmxBuffer &buffer);
+
+    // the index of a group / universe pair in the dispatch table
+    static unsigned int HandlerIndex(uint8_t group, uint8_t universe) {
+      return (group << 8) | universe;
+    }
     bool SendPacket(const sandnet_packet &packet,
                     unsigned int size,
                     bool is_control = false);
@@ -108,7 +104,7 @@ class SandNetNode {
     string m_preferred_ip;
 
     sandnet_port m_ports[SANDNET_MAX_PORTS];
-    universe_handlers m_handlers;
+    ola::dmx::UniverseDispatchTable m_handlers;
     ola::network::Interface m_interface;
     UDPSocket m_control_socket;
     UDPSocket m_data_socket;
@@ -20,7 +20,6 @@
 
 #include <string.h>
 #include <algorithm>
-#include <map>
 #include <string>
 
 #include "ola/Logging.h"
@@ -34,7 +33,6 @@ namespace plugin {
 namespace shownet {
 
 using std::string;
-using std::map;
 using ola::network::UDPSocket;
 using ola::network::HostToNetwork;
 using ola::network::IPV4Address;
@@ -60,12 +58,6 @@ ShowNetNode::ShowNetNode(const string &ip_address)
  */
 ShowNetNode::~ShowNetNode() {
   Stop();
-
-  std::map<unsigned int, universe_handler>::iterator iter;
-  for (iter = m_handlers.begin(); iter != m_handlers.end(); ++iter) {
-    delete iter->second.closure;
-  }
-  m_handlers.clear();
 }
 
 
@@ -166,19 +158,7 @@ bool ShowNetNode::SetHandler(unsigned int universe,
   if (!closure)
     return false;
 
-  map<unsigned int, universe_handler>::iterator iter =
-    m_handlers.find(universe);
-
-  if (iter == m_handlers.end()) {
-    universe_handler handler;
-    handler.buffer = buffer;
-    handler.closure = closure;
-    m_handlers[universe] = handler;
-  } else {
-    Callback0<void> *old_closure = iter->second.closure;
-    iter->second.closure = closure;
-    delete old_closure;
-  }
+  m_handlers.SetHandler(universe, buffer, closure);
   return true;
 }
 
@@ -189,16 +169,7 @@ bool ShowNetNode::SetHandler(unsigned int universe,
  * @param true if removed, false if it didn't exist
  */
 bool ShowNetNode::RemoveHandler(unsigned int universe) {
-  map<unsigned int, universe_handler>::iterator iter =
-    m_handlers.find(universe);
-
-  if (iter != m_handlers.end()) {
-    Callback0<void> *old_closure = iter->second.closure;
-    m_handlers.erase(iter);
-    delete old_closure;
-    return true;
-  }
-  return false;
+  return m_handlers.RemoveHandler(universe);
 }
 
 
@@ -270,25 +241,23 @@ bool ShowNetNode::HandlePacket(const shownet_data_packet &packet,
 
   unsigned int start_channel = (packet.netSlot[0] - 1) % DMX_UNIVERSE_SIZE;
   unsigned int universe_id = (packet.netSlot[0] - 1) / DMX_UNIVERSE_SIZE;
-  map<unsigned int, universe_handler>::iterator iter =
-    m_handlers.find(universe_id);
-
-  if (iter == m_handlers.end()) {
-    OLA_DEBUG << "Not interested in universe " << universe_id <<
-      ", skipping ";
-    return false;
-  }
 
+  // the closure is only run if the data has changed
+  bool handled;
   if (packet.slotSize[0] != enc_len) {
-    m_encoder.Decode(start_channel, packet.data + data_offset,
-                     enc_len, iter->second.buffer);
+    handled = m_handlers.DecodeRunLength(universe_id, start_channel,
+                                         packet.data + data_offset, enc_len,
+                                         &m_encoder);
   } else {
-    iter->second.buffer->SetRange(start_channel,
-                                  packet.data + data_offset,
-                                  enc_len);
+    handled = m_handlers.SetRange(universe_id, start_channel,
+                                  packet.data + data_offset, enc_len);
   }
-  iter->second.closure->Run();
-  return true;
+
+  if (!handled) {
+    OLA_DEBUG << "Not interested in universe " << universe_id <<
+      ", skipping ";
+  }
+  return handled;
 }
 
 
@@ -22,10 +22,10 @@
 #define PLUGINS_SHOWNET_SHOWNETNODE_H_
 
 #include <string>
-#include <map>
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/dmx/RunLengthEncoder.h"
+#include "ola/dmx/UniverseDispatchTable.h"
 #include "ola/network/InterfacePicker.h"
 #include "ola/network/Socket.h"
 #include "plugins/shownet/ShowNetPackets.h"
@@ -63,16 +63,11 @@ class ShowNetNode {
     friend class ShowNetNodeTest;
 
   private:
-    typedef struct {
-      DmxBuffer *buffer;
-      Callback0<void> *closure;
-    } universe_handler;
-
     bool m_running;
     uint16_t m_packet_count;
     string m_node_name;
     string m_preferred_ip;
-    std::map<unsigned int, universe_handler> m_handlers;
+    ola::dmx::UniverseDispatchTable m_handlers;
     ola::network::Interface m_interface;
     ola::dmx::RunLengthEncoder m_encoder;
     ola::network::UDPSocket *m_socket;
@@ -26,12 +26,14 @@
 #include <string.h>
 #include <sys/ioctl.h>
 
+#include <algorithm>
 #include <numeric>
 #include <sstream>
 #include <string>
 #include <vector>
 
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/network/SocketCloser.h"
 #include "ola/stl/STLUtils.h"
 #include "plugins/spi/SPIBackend.h"
@@ -45,64 +47,76 @@ using ola::thread::MutexLocker;
 const char SPIBackendInterface::SPI_DROP_VAR[] = "spi-drops";
 const char SPIBackendInterface::SPI_DROP_VAR_KEY[] = "device";
 
-uint8_t *HardwareBackend::OutputData::Resize(unsigned int length) {
-  if (length < m_size) {
-    m_size = length;
-    return m_data;
-  } else if (length == m_size) {
-    return m_data;
-  }
-
-  if (length <= m_actual_size) {
-    m_size = length;
-    return m_data;
-  }
+const char HardwareBackend::SPI_LATENCY_VAR[] = "spi-write-latency-us";
+const char HardwareBackend::SPI_MAX_LATENCY_VAR[] =
+    "spi-max-write-latency-us";
+const char HardwareBackend::SPI_LATENCY_VAR_KEY[] = "output";
 
-  delete[] m_data;
-  m_data = new uint8_t[length];
-  if (m_data) {
-    m_size = m_data ? length : 0;
-    m_actual_size = m_size;
-    memset(m_data, 0, length);
-  }
+/*
+ * Set the size of the frame. The contents of the buffer are kept unless it
+ * needs to grow. The latch bytes are always zeroed.
+ */
+uint8_t *HardwareBackend::FrameBuffer::Resize(unsigned int length,
+                                              unsigned int latch_bytes) {
+  const unsigned int total_size = length + latch_bytes;
+  if (total_size > m_capacity) {
+    delete[] m_data;
+    m_data = new uint8_t[total_size];
+    m_capacity = total_size;
+    memset(m_data, 0, total_size);
+  }
+  m_size = length;
+  m_latch_bytes = latch_bytes;
+  memset(m_data + length, 0, latch_bytes);
   return m_data;
 }
 
-void HardwareBackend::OutputData::SetPending() {
-  m_write_pending = true;
+HardwareBackend::OutputData::OutputData()
+    : back(new FrameBuffer()),
+      ready(new FrameBuffer()),
+      wire(new FrameBuffer()),
+      latest(NULL),
+      write_pending(false),
+      last_latency(0),
+      max_latency(0) {
 }
 
-void HardwareBackend::OutputData::SetLatchBytes(unsigned int latch_bytes) {
-  m_latch_bytes = latch_bytes;
-}
-
-HardwareBackend::OutputData& HardwareBackend::OutputData::operator=(
-    const HardwareBackend::OutputData &other) {
-  if (this != &other) {
-    uint8_t *data = Resize(other.m_size + other.m_latch_bytes);
-    if (data) {
-      memcpy(data, other.m_data, other.m_size);
-      memset(data + other.m_size, 0, other.m_latch_bytes);
-      m_write_pending = true;
-    } else {
-      m_write_pending = false;
-    }
-  }
-  return *this;
+HardwareBackend::OutputData::~OutputData() {
+  delete back;
+  delete ready;
+  delete wire;
 }
 
 HardwareBackend::HardwareBackend(const Options &options,
                                  SPIWriterInterface *writer,
                                  ExportMap *export_map)
     : m_spi_writer(writer),
+      m_drop_map(NULL),
+      m_latency_map(NULL),
+      m_max_latency_map(NULL),
       m_output_count(1 << options.gpio_pins.size()),
       m_exit(false),
       m_gpio_pins(options.gpio_pins) {
-  SetupOutputs(&m_output_data);
+  const string device_path = m_spi_writer->DevicePath();
+  for (unsigned int i = 0; i < m_output_count; i++) {
+    OutputData *output = new OutputData();
+    output->stats_key = device_path + ":" + IntToString(i);
+    m_output_data.push_back(output);
+  }
+
   if (export_map) {
     m_drop_map = export_map->GetUIntMapVar(SPI_DROP_VAR,
                                            SPI_DROP_VAR_KEY);
-    (*m_drop_map)[m_spi_writer->DevicePath()] = 0;
+    (*m_drop_map)[device_path] = 0;
+    m_latency_map = export_map->GetUIntMapVar(SPI_LATENCY_VAR,
+                                              SPI_LATENCY_VAR_KEY);
+    m_max_latency_map = export_map->GetUIntMapVar(SPI_MAX_LATENCY_VAR,
+                                                  SPI_LATENCY_VAR_KEY);
+    Outputs::const_iterator iter = m_output_data.begin();
+    for (; iter != m_output_data.end(); ++iter) {
+      (*m_latency_map)[(*iter)->stats_key] = 0;
+      (*m_max_latency_map)[(*iter)->stats_key] = 0;
+    }
   }
 }
 
@@ -132,6 +146,11 @@ bool HardwareBackend::Init() {
   return true;
 }
 
+/*
+ * Checkout the back buffer for an output. The buffer holds the last frame
+ * committed for this output. The writer thread never touches the back buffer
+ * so no lock is required.
+ */
 uint8_t *HardwareBackend::Checkout(uint8_t output_id,
                                    unsigned int length,
                                    unsigned int latch_bytes) {
@@ -139,86 +158,114 @@ uint8_t *HardwareBackend::Checkout(uint8_t output_id,
     return NULL;
   }
 
-  m_mutex.Lock();
-  uint8_t *output = m_output_data[output_id]->Resize(length);
-  if (!output) {
-    m_mutex.Unlock();
+  OutputData *output = m_output_data[output_id];
+  uint8_t *data = output->back->Resize(length, latch_bytes);
+
+  // After a commit the back buffer holds an older frame. Bring it up to date
+  // so callers can update part of a frame. The latest frame is either
+  // waiting to be written or on the wire, both of which are read only so
+  // this is safe without the lock.
+  if (output->latest && output->latest != output->back) {
+    memcpy(data, output->latest->GetData(),
+           std::min(length, output->latest->Size()));
+    output->latest = output->back;
   }
-  m_output_data[output_id]->SetLatchBytes(latch_bytes);
-  return output;
+  return data;
 }
 
-void HardwareBackend::Commit(uint8_t output) {
-  if (output >= m_output_count) {
+/*
+ * Hand the back buffer to the writer thread.
+ */
+void HardwareBackend::Commit(uint8_t output_id) {
+  if (output_id >= m_output_count) {
     return;
   }
 
-  OutputData *output_data = m_output_data[output];
-  if (output_data->IsPending() && m_drop_map) {
-    // There was already another write pending which we're now stomping on
-    (*m_drop_map)[m_spi_writer->DevicePath()]++;
+  OutputData *output = m_output_data[output_id];
+  unsigned int last_latency, max_latency;
+  {
+    MutexLocker lock(&m_mutex);
+    if (output->write_pending && m_drop_map) {
+      // There was already another write pending which we're now stomping on
+      (*m_drop_map)[m_spi_writer->DevicePath()]++;
+    }
+    std::swap(output->back, output->ready);
+    // This must be done with the lock held, otherwise the writer thread may
+    // have swapped ready & wire already.
+    output->latest = output->ready;
+    output->write_pending = true;
+    m_clock.CurrentTime(&output->commit_time);
+    last_latency = output->last_latency;
+    max_latency = output->max_latency;
   }
-  output_data->SetPending();
-  m_mutex.Unlock();
   m_cond_var.Signal();
+
+  // The export map isn't thread safe, so the writer thread leaves the stats
+  // for us to publish.
+  if (m_latency_map) {
+    (*m_latency_map)[output->stats_key] = last_latency;
+    (*m_max_latency_map)[output->stats_key] = max_latency;
+  }
 }
 
 void *HardwareBackend::Run() {
-  Outputs outputs;
-  SetupOutputs(&outputs);
+  vector<bool> write_output(m_output_count, false);
+  vector<TimeStamp> commit_times(m_output_count);
 
   while (true) {
-    m_mutex.Lock();
-
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
-
-    bool action_pending = false;
-    Outputs::const_iterator iter = m_output_data.begin();
-    for (; iter != m_output_data.end(); ++iter) {
-      if ((*iter)->IsPending()) {
-        action_pending = true;
-        break;
+    {
+      MutexLocker lock(&m_mutex);
+
+      bool action_pending = false;
+      while (!m_exit && !action_pending) {
+        Outputs::const_iterator iter = m_output_data.begin();
+        for (; iter != m_output_data.end(); ++iter) {
+          if ((*iter)->write_pending) {
+            action_pending = true;
+            break;
+          }
+        }
+        if (!action_pending) {
+          m_cond_var.Wait(&m_mutex);
+        }
       }
-    }
-    if (!action_pending) {
-      m_cond_var.Wait(&m_mutex);
-    }
 
-    if (m_exit) {
-      m_mutex.Unlock();
-      STLDeleteElements(&outputs);
-      return NULL;
-    }
+      if (m_exit) {
+        return NULL;
+      }
 
-    for (unsigned int i = 0; i < m_output_data.size(); i++) {
-      if (m_output_data[i]->IsPending()) {
-        // take a copy
-        *outputs[i] = *m_output_data[i];
-        m_output_data[i]->ResetPending();
+      // Take the committed frames, this is just a pointer swap.
+      for (unsigned int i = 0; i < m_output_data.size(); i++) {
+        OutputData *output = m_output_data[i];
+        write_output[i] = output->write_pending;
+        if (output->write_pending) {
+          std::swap(output->ready, output->wire);
+          output->write_pending = false;
+          commit_times[i] = output->commit_time;
+        }
       }
     }
-    m_mutex.Unlock();
 
-    for (unsigned int i = 0; i < outputs.size(); i++) {
-      if (outputs[i]->IsPending()) {
-        WriteOutput(i, outputs[i]);
-        outputs[i]->ResetPending();
+    // The wire buffers belong to this thread until the next swap.
+    for (unsigned int i = 0; i < m_output_data.size(); i++) {
+      if (write_output[i]) {
+        WriteOutput(i, m_output_data[i]->wire);
+
+        TimeStamp now;
+        m_clock.CurrentTime(&now);
+        const int64_t latency = (now - commit_times[i]).AsInt();
+        OutputData *output = m_output_data[i];
+        MutexLocker lock(&m_mutex);
+        output->last_latency = latency > 0 ? latency : 0;
+        output->max_latency = std::max(output->max_latency,
+                                       output->last_latency);
       }
     }
   }
 }
 
-void HardwareBackend::SetupOutputs(Outputs *outputs) {
-  for (unsigned int i = 0; i < m_output_count; i++) {
-    outputs->push_back(new OutputData());
-  }
-}
-
-void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
+void HardwareBackend::WriteOutput(uint8_t output_id,
+                                  const FrameBuffer *output) {
   const string on("1");
   const string off("0");
 
@@ -241,7 +288,7 @@ void HardwareBackend::WriteOutput(uint8_t output_id, OutputData *output) {
     }
   }
 
-  m_spi_writer->WriteSPIData(output->GetData(), output->Size());
+  m_spi_writer->WriteSPIData(output->GetData(), output->WriteSize());
 }
 
 bool HardwareBackend::SetupGPIO() {
@@ -23,6 +23,8 @@
 #define PLUGINS_SPI_SPIBACKEND_H_
 
 #include <stdint.h>
+#include <ola/Clock.h>
+#include <ola/base/Macro.h>
 #include <ola/thread/Mutex.h>
 #include <ola/thread/Thread.h>
 #include <string>
@@ -94,36 +96,64 @@ class HardwareBackend : public ola::thread::Thread,
     void* Run();
 
   private:
-    class OutputData {
+    /*
+     * A buffer holding a frame for one output. Buffers are passed between the
+     * producer and the writer thread by swapping pointers, the data itself is
+     * never copied on the way to the wire.
+     */
+    class FrameBuffer {
       public:
-        OutputData()
+        FrameBuffer()
             : m_data(NULL),
-              m_write_pending(false),
               m_size(0),
-              m_actual_size(0),
+              m_capacity(0),
               m_latch_bytes(0) {
         }
 
-        ~OutputData() { delete[] m_data; }
+        ~FrameBuffer() { delete[] m_data; }
 
-        uint8_t *Resize(unsigned int length);
-        void SetLatchBytes(unsigned int latch_bytes);
-        void SetPending();
-        bool IsPending() const { return m_write_pending; }
-        void ResetPending() { m_write_pending = false; }
+        uint8_t *Resize(unsigned int length, unsigned int latch_bytes);
+        uint8_t *GetData() { return m_data; }
         const uint8_t *GetData() const { return m_data; }
+        // The size of the pixel data, excluding the latch bytes.
         unsigned int Size() const { return m_size; }
-
-        OutputData& operator=(const OutputData &other);
+        // The number of bytes to write, including the latch bytes.
+        unsigned int WriteSize() const { return m_size + m_latch_bytes; }
 
       private:
         uint8_t *m_data;
-        bool m_write_pending;
         unsigned int m_size;
-        unsigned int m_actual_size;
+        unsigned int m_capacity;
         unsigned int m_latch_bytes;
 
-        OutputData(const OutputData&);
+        DISALLOW_COPY_AND_ASSIGN(FrameBuffer);
+    };
+
+    /*
+     * Each output has three buffers:
+     *  - back, which is owned by the caller of Checkout() / Commit().
+     *  - ready, which holds the last committed frame until the writer thread
+     *    picks it up.
+     *  - wire, which the writer thread is writing from.
+     * Commit() swaps back & ready, the writer thread swaps ready & wire.
+     */
+    struct OutputData {
+      FrameBuffer *back;
+      FrameBuffer *ready;  // GUARDED_BY(m_mutex)
+      FrameBuffer *wire;  // GUARDED_BY(m_mutex)
+      // The buffer that holds the most recently committed frame. Only used by
+      // the producer.
+      const FrameBuffer *latest;
+      bool write_pending;  // GUARDED_BY(m_mutex)
+      TimeStamp commit_time;  // GUARDED_BY(m_mutex)
+      // Commit to wire latency, in microseconds
+      unsigned int last_latency;  // GUARDED_BY(m_mutex)
+      unsigned int max_latency;  // GUARDED_BY(m_mutex)
+      // The key for this output in the latency maps.
+      string stats_key;
+
+      OutputData();
+      ~OutputData();
     };
 
     typedef vector<int> GPIOFds;
@@ -131,10 +161,13 @@ class HardwareBackend : public ola::thread::Thread,
 
     SPIWriterInterface *m_spi_writer;
     UIntMap *m_drop_map;
+    UIntMap *m_latency_map;
+    UIntMap *m_max_latency_map;
     const uint8_t m_output_count;
     ola::thread::Mutex m_mutex;
     ola::thread::ConditionVariable m_cond_var;
     bool m_exit;
+    Clock m_clock;
 
     Outputs m_output_data;
 
@@ -143,10 +176,13 @@ class HardwareBackend : public ola::thread::Thread,
     const vector<uint8_t> m_gpio_pins;
     vector<bool> m_gpio_pin_state;
 
-    void SetupOutputs(Outputs *outputs);
-    void WriteOutput(uint8_t output_id, OutputData *output);
+    void WriteOutput(uint8_t output_id, const FrameBuffer *output);
     bool SetupGPIO();
     void CloseGPIOFDs();
+
+    static const char SPI_LATENCY_VAR[];
+    static const char SPI_MAX_LATENCY_VAR[];
+    static const char SPI_LATENCY_VAR_KEY[];
 };
 
 
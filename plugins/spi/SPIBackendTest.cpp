@@ -19,7 +19,9 @@
  */
 
 #include <string.h>
+#include <unistd.h>
 #include <cppunit/extensions/HelperMacros.h>
+#include <string>
 
 #include "ola/base/Array.h"
 #include "ola/DmxBuffer.h"
@@ -36,11 +38,13 @@ using ola::plugin::spi::HardwareBackend;
 using ola::plugin::spi::SoftwareBackend;
 using ola::plugin::spi::SPIBackendInterface;
 using ola::UIntMap;
+using std::string;
 
 class SPIBackendTest: public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(SPIBackendTest);
   CPPUNIT_TEST(testHardwareDrops);
   CPPUNIT_TEST(testHardwareVariousFrameLengths);
+  CPPUNIT_TEST(testHardwarePartialUpdates);
   CPPUNIT_TEST(testInvalidOutputs);
   CPPUNIT_TEST(testSoftwareDrops);
   CPPUNIT_TEST(testSoftwareVariousFrameLengths);
@@ -60,6 +64,7 @@ class SPIBackendTest: public CppUnit::TestFixture {
 
   void testHardwareDrops();
   void testHardwareVariousFrameLengths();
+  void testHardwarePartialUpdates();
   void testInvalidOutputs();
   void testSoftwareDrops();
   void testSoftwareVariousFrameLengths();
@@ -226,6 +231,41 @@ void SPIBackendTest::testHardwareVariousFrameLengths() {
   m_writer.ResetWrite();
 }
 
+/**
+ * Check that partial updates are applied on top of the last committed frame,
+ * even while the writer is busy, and that the latency is reported.
+ */
+void SPIBackendTest::testHardwarePartialUpdates() {
+  HardwareBackend backend(HardwareBackend::Options(), &m_writer,
+                          &m_export_map);
+  OLA_ASSERT(backend.Init());
+
+  m_writer.BlockWriter();
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1), m_total_size));
+  m_writer.WaitForWrite();  // now we know the writer is blocked
+  m_writer.ResetWrite();
+
+  // The first frame is on the wire, these build on it.
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA2, arraysize(DATA2), m_total_size));
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA2, arraysize(DATA2), m_total_size));
+  OLA_ASSERT_EQ(1u, DropCount());
+
+  usleep(2000);
+  m_writer.UnblockWriter();
+  m_writer.WaitForWrite();
+  OLA_ASSERT_EQ(2u, m_writer.WriteCount());
+  m_writer.CheckDataMatches(__LINE__, EXPECTED2, arraysize(EXPECTED2));
+  m_writer.ResetWrite();
+
+  // The stats are published on the next commit
+  OLA_ASSERT(SendSomeData(&backend, 0, DATA1, arraysize(DATA1), m_total_size));
+  m_writer.WaitForWrite();
+  m_writer.CheckDataMatches(__LINE__, EXPECTED1, arraysize(EXPECTED1));
+  UIntMap *max_latency = m_export_map.GetUIntMapVar(
+      "spi-max-write-latency-us", "output");
+  OLA_ASSERT_TRUE((*max_latency)[string(DEVICE_NAME) + ":0"] >= 2000);
+}
+
 /**
  * Check we can't send to invalid outputs.
  */
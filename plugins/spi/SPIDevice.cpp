@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <stdlib.h>
 #include <set>
 #include <sstream>
 #include <string>
@@ -93,12 +94,9 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
   }
 
   for (uint8_t i = 0; i < port_count; i++) {
+    SetPortDefaults(i);
     SPIOutput::Options spi_output_options(i);
-
-    uint8_t pixel_count;
-    if (StringToInt(m_preferences->GetValue(PixelCountKey(i)), &pixel_count)) {
-      spi_output_options.pixel_count = pixel_count;
-    }
+    PopulateOutputOptions(i, &spi_output_options);
 
     auto_ptr<UID> uid(uid_allocator->AllocateNext());
     if (!uid.get()) {
@@ -107,13 +105,29 @@ SPIDevice::SPIDevice(SPIPlugin *owner,
       continue;
     }
 
-    m_spi_ports.push_back(
-        new SPIOutputPort(this, m_backend.get(), *uid.get(),
-                          spi_output_options));
+    SPIOutput *output = new SPIOutput(*uid.get(), m_backend.get(),
+                                      spi_output_options);
+    m_spi_outputs.push_back(output);
+    // One OLA port per universe. The id only depends on the output and
+    // universe, so changing the universe count of one output doesn't move
+    // the patches of the others. The first universe keeps the output number
+    // as its id, as it did before outputs could span several universes.
+    for (uint8_t universe = 0; universe < output->UniverseCount();
+         universe++) {
+      m_spi_ports.push_back(new SPIOutputPort(
+          this, output, universe, universe * MAX_OUTPUTS + i));
+    }
   }
 }
 
 
+SPIDevice::~SPIDevice() {
+  // The ports reference the outputs, so they must be deleted first. This
+  // happens in Device::Stop().
+  STLDeleteElements(&m_spi_outputs);
+}
+
+
 string SPIDevice::DeviceId() const {
   return m_spi_device_name;
 }
@@ -128,20 +142,23 @@ bool SPIDevice::StartHook() {
     return false;
   }
 
-  SPIPorts::iterator iter = m_spi_ports.begin();
-  for (uint8_t i = 0; iter != m_spi_ports.end(); iter++, i++) {
+  SPIOutputs::iterator output_iter = m_spi_outputs.begin();
+  for (uint8_t i = 0; output_iter != m_spi_outputs.end(); output_iter++, i++) {
     uint8_t personality;
     if (StringToInt(m_preferences->GetValue(PersonalityKey(i)),
                     &personality)) {
-      (*iter)->SetPersonality(personality);
+      (*output_iter)->SetPersonality(personality);
     }
 
     uint16_t dmx_address;
     if (StringToInt(m_preferences->GetValue(StartAddressKey(i)),
                                             &dmx_address)) {
-      (*iter)->SetStartAddress(dmx_address);
+      (*output_iter)->SetStartAddress(dmx_address);
     }
+  }
 
+  SPIPorts::iterator iter = m_spi_ports.begin();
+  for (; iter != m_spi_ports.end(); iter++) {
     AddPort(*iter);
   }
   return true;
@@ -149,8 +166,8 @@ bool SPIDevice::StartHook() {
 
 
 void SPIDevice::PrePortStop() {
-  SPIPorts::iterator iter = m_spi_ports.begin();
-  for (uint8_t i = 0; iter != m_spi_ports.end(); iter++, i++) {
+  SPIOutputs::iterator iter = m_spi_outputs.begin();
+  for (uint8_t i = 0; iter != m_spi_outputs.end(); iter++, i++) {
     stringstream str;
     str << static_cast<int>((*iter)->GetPersonality());
     m_preferences->SetValue(PersonalityKey(i), str.str());
@@ -200,6 +217,22 @@ string SPIDevice::PixelCountKey(uint8_t port) const {
   return GetPortKey("pixel-count", port);
 }
 
+string SPIDevice::UniverseCountKey(uint8_t port) const {
+  return GetPortKey("universes", port);
+}
+
+string SPIDevice::GammaKey(uint8_t port) const {
+  return GetPortKey("gamma", port);
+}
+
+string SPIDevice::BrightnessKey(uint8_t port) const {
+  return GetPortKey("brightness", port);
+}
+
+string SPIDevice::ColorOrderKey(uint8_t port) const {
+  return GetPortKey("color-order", port);
+}
+
 string SPIDevice::GetPortKey(const string &suffix, uint8_t port) const {
   std::ostringstream str;
   str << m_spi_device_name << "-" << static_cast<int>(port) << "-" << suffix;
@@ -220,6 +253,51 @@ void SPIDevice::SetDefaults() {
   m_preferences->SetDefaultValue(SyncPortKey(), IntValidator(-2, 8), "0");
 }
 
+void SPIDevice::SetPortDefaults(uint8_t port) {
+  m_preferences->SetDefaultValue(UniverseCountKey(port),
+                                 IntValidator(1, MAX_UNIVERSES_PER_PORT),
+                                 "1");
+  m_preferences->SetDefaultValue(GammaKey(port), StringValidator(), "1.0");
+  m_preferences->SetDefaultValue(BrightnessKey(port), IntValidator(0, 100),
+                                 "100");
+  m_preferences->SetDefaultValue(ColorOrderKey(port), StringValidator(true),
+                                 "");
+}
+
+void SPIDevice::PopulateOutputOptions(uint8_t port,
+                                      SPIOutput::Options *options) {
+  uint16_t pixel_count;
+  if (StringToInt(m_preferences->GetValue(PixelCountKey(port)),
+                  &pixel_count)) {
+    options->pixel_count = pixel_count;
+  }
+
+  uint8_t universe_count;
+  if (StringToInt(m_preferences->GetValue(UniverseCountKey(port)),
+                  &universe_count) &&
+      universe_count >= 1 && universe_count <= MAX_UNIVERSES_PER_PORT) {
+    options->universe_count = universe_count;
+  }
+
+  const string gamma_str = m_preferences->GetValue(GammaKey(port));
+  char *end = NULL;
+  double gamma = strtod(gamma_str.c_str(), &end);
+  if (end && *end == 0 && gamma > 0) {
+    options->gamma = gamma;
+  } else {
+    OLA_WARN << "Invalid gamma " << gamma_str << " for SPI port "
+             << static_cast<int>(port);
+  }
+
+  uint8_t brightness;
+  if (StringToInt(m_preferences->GetValue(BrightnessKey(port)),
+                  &brightness) && brightness <= 100) {
+    options->brightness = brightness;
+  }
+
+  options->color_order = m_preferences->GetValue(ColorOrderKey(port));
+}
+
 void SPIDevice::PopulateHardwareBackendOptions(
     HardwareBackend::Options *options) {
   vector<string> pins = m_preferences->GetMultipleValue(GPIOPinKey());
@@ -30,6 +30,7 @@
 #include "ola/rdm/UIDAllocator.h"
 #include "ola/rdm/UID.h"
 #include "plugins/spi/SPIBackend.h"
+#include "plugins/spi/SPIOutput.h"
 #include "plugins/spi/SPIWriter.h"
 
 namespace ola {
@@ -45,6 +46,7 @@ class SPIDevice: public ola::Device {
               class PluginAdaptor *plugin_adaptor,
               const string &spi_device,
               ola::rdm::UIDAllocator *uid_allocator);
+    ~SPIDevice();
 
     string DeviceId() const;
 
@@ -56,11 +58,13 @@ class SPIDevice: public ola::Device {
 
   private:
     typedef std::vector<class SPIOutputPort*> SPIPorts;
+    typedef std::vector<class SPIOutput*> SPIOutputs;
 
     auto_ptr<SPIWriterInterface> m_writer;
     auto_ptr<SPIBackendInterface> m_backend;
     class Preferences *m_preferences;
     class PluginAdaptor *m_plugin_adaptor;
+    SPIOutputs m_spi_outputs;
     SPIPorts m_spi_ports;
     string m_spi_device_name;
 
@@ -76,9 +80,15 @@ class SPIDevice: public ola::Device {
     string PersonalityKey(uint8_t port) const;
     string PixelCountKey(uint8_t port) const;
     string StartAddressKey(uint8_t port) const;
+    string UniverseCountKey(uint8_t port) const;
+    string GammaKey(uint8_t port) const;
+    string BrightnessKey(uint8_t port) const;
+    string ColorOrderKey(uint8_t port) const;
     string GetPortKey(const string &suffix, uint8_t port) const;
 
     void SetDefaults();
+    void SetPortDefaults(uint8_t port);
+    void PopulateOutputOptions(uint8_t port, SPIOutput::Options *options);
     void PopulateHardwareBackendOptions(HardwareBackend::Options *options);
     void PopulateSoftwareBackendOptions(SoftwareBackend::Options *options);
     void PopulateWriterOptions(SPIWriter::Options *options);
@@ -87,6 +97,9 @@ class SPIDevice: public ola::Device {
     static const char HARDWARE_BACKEND[];
     static const char SOFTWARE_BACKEND[];
     static const uint8_t MAX_GPIO_PIN = 25;
+    static const uint8_t MAX_UNIVERSES_PER_PORT = 8;
+    // outputs are numbered with a uint8_t
+    static const unsigned int MAX_OUTPUTS = 256;
 };
 }  // namespace spi
 }  // namespace plugin
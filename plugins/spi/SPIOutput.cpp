@@ -25,6 +25,7 @@
 #  include <config.h>
 #endif
 
+#include <math.h>
 #include <string.h>
 #include <algorithm>
 #include <memory>
@@ -34,6 +35,7 @@
 #include "ola/base/Array.h"
 #include "ola/BaseTypes.h"
 #include "ola/Logging.h"
+#include "ola/StringUtils.h"
 #include "ola/network/NetworkUtils.h"
 #include "ola/rdm/OpenLightingEnums.h"
 #include "ola/rdm/RDMCommand.h"
@@ -69,6 +71,14 @@ const uint8_t SPIOutput::SPI_BITS_PER_WORD = 8;
 const uint8_t SPIOutput::SPI_MODE = 0;
 const uint16_t SPIOutput::WS2801_SLOTS_PER_PIXEL = 3;
 const uint16_t SPIOutput::LPD8806_SLOTS_PER_PIXEL = 3;
+const uint16_t SPIOutput::APA102_SLOTS_PER_PIXEL = 3;
+const uint16_t SPIOutput::APA102_SPI_BYTES_PER_PIXEL = 4;
+const uint16_t SPIOutput::APA102_START_FRAME_BYTES = 4;
+const uint8_t SPIOutput::APA102_HEADER = 0xe0;
+const uint16_t SPIOutput::WS2812_SLOTS_PER_PIXEL = 3;
+const uint16_t SPIOutput::WS2812_SPI_BYTES_PER_PIXEL = 9;
+// At 2.4MHz this is 280uS, which is long enough for the WS2812B.
+const uint16_t SPIOutput::WS2812_RESET_BYTES = 84;
 
 SPIOutput::RDMOps *SPIOutput::RDMOps::instance = NULL;
 
@@ -114,6 +124,8 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
       m_output_number(options.output_number),
       m_uid(uid),
       m_pixel_count(options.pixel_count),
+      m_universe_count(std::max(options.universe_count,
+                                static_cast<uint8_t>(1))),
       m_start_address(1),
       m_identify_mode(false) {
   const string device_path(m_backend->DevicePath());
@@ -121,14 +133,34 @@ SPIOutput::SPIOutput(const UID &uid, SPIBackendInterface *backend,
   if (pos != string::npos)
     m_spi_device_name = device_path.substr(pos + 1);
 
-  m_personality_manager.AddPersonality(m_pixel_count * WS2801_SLOTS_PER_PIXEL,
-                                       "WS2801 Individual Control");
+  m_universe_buffers.resize(m_universe_count - 1);
+  BuildLookupTables(options);
+
+  // The footprint is per universe, long strings continue in the next
+  // universe.
+  const uint16_t pixels_in_first_universe = std::min(
+      m_pixel_count,
+      static_cast<unsigned int>(DMX_UNIVERSE_SIZE / WS2801_SLOTS_PER_PIXEL));
+  m_personality_manager.AddPersonality(
+      pixels_in_first_universe * WS2801_SLOTS_PER_PIXEL,
+      "WS2801 Individual Control");
   m_personality_manager.AddPersonality(WS2801_SLOTS_PER_PIXEL,
                                        "WS2801 Combined Control");
-  m_personality_manager.AddPersonality(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       "LPD8806 Individual Control");
+  m_personality_manager.AddPersonality(
+      pixels_in_first_universe * LPD8806_SLOTS_PER_PIXEL,
+      "LPD8806 Individual Control");
   m_personality_manager.AddPersonality(LPD8806_SLOTS_PER_PIXEL,
                                        "LPD8806 Combined Control");
+  m_personality_manager.AddPersonality(
+      pixels_in_first_universe * APA102_SLOTS_PER_PIXEL,
+      "APA102 Individual Control");
+  m_personality_manager.AddPersonality(APA102_SLOTS_PER_PIXEL,
+                                       "APA102 Combined Control");
+  m_personality_manager.AddPersonality(
+      pixels_in_first_universe * WS2812_SLOTS_PER_PIXEL,
+      "WS2812 Individual Control");
+  m_personality_manager.AddPersonality(WS2812_SLOTS_PER_PIXEL,
+                                       "WS2812 Combined Control");
   m_personality_manager.SetActivePersonality(1);
 }
 
@@ -161,17 +193,34 @@ string SPIOutput::Description() const {
       << static_cast<int>(m_output_number) << ", "
       << m_personality_manager.ActivePersonalityDescription() << ", "
       << m_personality_manager.ActivePersonalityFootprint()
-      << " slots @ " << m_start_address << ". (" << m_uid << ")";
+      << " slots @ " << m_start_address;
+  if (m_universe_count > 1)
+    str << " in " << static_cast<int>(m_universe_count) << " universes";
+  str << ". (" << m_uid << ")";
   return str.str();
 }
 
 /*
  * Send DMX data over SPI.
+ * @param universe the index of the universe within the string, from 0.
+ * @param buffer the DMX data.
+ *
+ * Data for all but the last universe is held until the last universe is
+ * written, at which point the whole string is sent.
  */
-bool SPIOutput::WriteDMX(const DmxBuffer &buffer) {
+bool SPIOutput::WriteDMX(uint8_t universe, const DmxBuffer &buffer) {
   if (m_identify_mode)
     return true;
 
+  if (universe >= m_universe_count)
+    return false;
+
+  if (universe + 1 < m_universe_count) {
+    // avoid the reference counting
+    m_universe_buffers[universe].Set(buffer);
+    return true;
+  }
+
   switch (m_personality_manager.ActivePersonalityNumber()) {
     case 1:
       IndividualWS2801Control(buffer);
@@ -185,6 +234,18 @@ bool SPIOutput::WriteDMX(const DmxBuffer &buffer) {
     case 4:
       CombinedLPD8806Control(buffer);
       break;
+    case 5:
+      IndividualAPA102Control(buffer);
+      break;
+    case 6:
+      CombinedAPA102Control(buffer);
+      break;
+    case 7:
+      IndividualWS2812Control(buffer);
+      break;
+    case 8:
+      CombinedWS2812Control(buffer);
+      break;
     default:
       break;
   }
@@ -213,37 +274,78 @@ void SPIOutput::SendRDMRequest(const RDMRequest *request,
                                        request, callback);
 }
 
+/*
+ * Parse a color order like "GRB".
+ * @param color_order the string to parse.
+ * @param order a 3 element array, which is populated with the RGB slot to send
+ *   for each byte of the pixel.
+ * @returns true if the string was valid.
+ */
+bool SPIOutput::ParseColorOrder(const string &color_order, uint8_t *order) {
+  static const char COLORS[] = "RGB";
+  string upper = color_order;
+  ToUpper(&upper);
+  if (upper.size() != WS2801_SLOTS_PER_PIXEL)
+    return false;
+
+  uint8_t seen = 0;
+  for (unsigned int i = 0; i < upper.size(); i++) {
+    const char *color = strchr(COLORS, upper[i]);
+    if (!color || upper[i] == 0)
+      return false;
+    uint8_t slot = color - COLORS;
+    if (seen & (1 << slot))
+      return false;
+    seen |= 1 << slot;
+    order[i] = slot;
+  }
+  return true;
+}
+
 void SPIOutput::IndividualWS2801Control(const DmxBuffer &buffer) {
   // We always check out the entire string length, even if we only have data
   // for part of it
-  const unsigned int output_length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
+  const unsigned int output_length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
   uint8_t *output = m_backend->Checkout(m_output_number, output_length);
   if (!output)
     return;
 
-  unsigned int new_length = output_length;
-  buffer.GetRange(m_start_address - 1, output, &new_length);
+  const unsigned int pixels_per_universe = PixelsPerUniverse();
+  for (uint8_t universe = 0; universe < m_universe_count; universe++) {
+    const unsigned int first_pixel = universe * pixels_per_universe;
+    if (first_pixel >= m_pixel_count)
+      break;
+    MapPixels(UniverseData(universe, buffer),
+              std::min(pixels_per_universe, m_pixel_count - first_pixel),
+              m_ws2801_lut, m_ws2801_order, true,
+              output + first_pixel * WS2801_SLOTS_PER_PIXEL);
+  }
   m_backend->Commit(m_output_number);
 }
 
 void SPIOutput::CombinedWS2801Control(const DmxBuffer &buffer) {
   unsigned int pixel_data_length = WS2801_SLOTS_PER_PIXEL;
   uint8_t pixel_data[WS2801_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
+  UniverseData(0, buffer).GetRange(m_start_address - 1, pixel_data,
+                                   &pixel_data_length);
   if (pixel_data_length != WS2801_SLOTS_PER_PIXEL) {
     OLA_INFO << "Insufficient DMX data, required " << WS2801_SLOTS_PER_PIXEL
              << ", got " << pixel_data_length;
     return;
   }
 
+  uint8_t pixel[WS2801_SLOTS_PER_PIXEL];
+  for (unsigned int i = 0; i < WS2801_SLOTS_PER_PIXEL; i++)
+    pixel[i] = m_ws2801_lut[pixel_data[m_ws2801_order[i]]];
+
   const unsigned int length = m_pixel_count * WS2801_SLOTS_PER_PIXEL;
   uint8_t *output = m_backend->Checkout(m_output_number, length);
   if (!output)
     return;
 
   for (unsigned int i = 0; i < m_pixel_count; i++) {
-    memcpy(output + (i * WS2801_SLOTS_PER_PIXEL), pixel_data,
-           pixel_data_length);
+    memcpy(output + (i * WS2801_SLOTS_PER_PIXEL), pixel,
+           WS2801_SLOTS_PER_PIXEL);
   }
   m_backend->Commit(m_output_number);
 }
@@ -251,7 +353,14 @@ void SPIOutput::CombinedWS2801Control(const DmxBuffer &buffer) {
 void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
   const uint8_t latch_bytes = (m_pixel_count + 31) / 32;
   const unsigned int first_slot = m_start_address - 1;  // 0 offset
-  if (buffer.Size() - first_slot < LPD8806_SLOTS_PER_PIXEL) {
+
+  bool have_pixel_data = false;
+  for (uint8_t universe = 0; universe < m_universe_count; universe++) {
+    if (UniverseData(universe, buffer).Size() >=
+        first_slot + LPD8806_SLOTS_PER_PIXEL)
+      have_pixel_data = true;
+  }
+  if (!have_pixel_data) {
     // not even 3 bytes of data, don't bother updating
     return;
   }
@@ -264,18 +373,15 @@ void SPIOutput::IndividualLPD8806Control(const DmxBuffer &buffer) {
   if (!output)
     return;
 
-  const unsigned int length = std::min(m_pixel_count * LPD8806_SLOTS_PER_PIXEL,
-                                       buffer.Size() - first_slot);
-
-  for (unsigned int i = 0; i < length / LPD8806_SLOTS_PER_PIXEL; i++) {
-    // Convert RGB to GRB
-    unsigned int offset = first_slot + i * LPD8806_SLOTS_PER_PIXEL;
-    uint8_t r = buffer.Get(offset);
-    uint8_t g = buffer.Get(offset + 1);
-    uint8_t b = buffer.Get(offset + 2);
-    output[i * LPD8806_SLOTS_PER_PIXEL] = 0x80 | (g >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 1] = 0x80 | (r >> 1);
-    output[i * LPD8806_SLOTS_PER_PIXEL + 2] = 0x80 | (b >> 1);
+  const unsigned int pixels_per_universe = PixelsPerUniverse();
+  for (uint8_t universe = 0; universe < m_universe_count; universe++) {
+    const unsigned int first_pixel = universe * pixels_per_universe;
+    if (first_pixel >= m_pixel_count)
+      break;
+    MapPixels(UniverseData(universe, buffer),
+              std::min(pixels_per_universe, m_pixel_count - first_pixel),
+              m_lpd8806_lut, m_lpd8806_order, false,
+              output + first_pixel * LPD8806_SLOTS_PER_PIXEL);
   }
   m_backend->Commit(m_output_number);
 }
@@ -285,17 +391,17 @@ void SPIOutput::CombinedLPD8806Control(const DmxBuffer &buffer) {
   unsigned int pixel_data_length = LPD8806_SLOTS_PER_PIXEL;
 
   uint8_t pixel_data[LPD8806_SLOTS_PER_PIXEL];
-  buffer.GetRange(m_start_address - 1, pixel_data, &pixel_data_length);
+  UniverseData(0, buffer).GetRange(m_start_address - 1, pixel_data,
+                                   &pixel_data_length);
   if (pixel_data_length != LPD8806_SLOTS_PER_PIXEL) {
     OLA_INFO << "Insufficient DMX data, required " << LPD8806_SLOTS_PER_PIXEL
              << ", got " << pixel_data_length;
     return;
   }
 
-  // The leds are GRB format so convert here
-  uint8_t temp = pixel_data[1];
-  pixel_data[1] = pixel_data[0];
-  pixel_data[0] = temp;
+  uint8_t pixel[LPD8806_SLOTS_PER_PIXEL];
+  for (unsigned int i = 0; i < LPD8806_SLOTS_PER_PIXEL; i++)
+    pixel[i] = m_lpd8806_lut[pixel_data[m_lpd8806_order[i]]];
 
   const unsigned int length = m_pixel_count * LPD8806_SLOTS_PER_PIXEL;
   uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
@@ -303,13 +409,350 @@ void SPIOutput::CombinedLPD8806Control(const DmxBuffer &buffer) {
     return;
 
   for (unsigned int i = 0; i < m_pixel_count; i++) {
-    for (unsigned int j = 0; j < LPD8806_SLOTS_PER_PIXEL; j++) {
-      output[i * LPD8806_SLOTS_PER_PIXEL + j] = 0x80 | (pixel_data[j] >> 1);
+    memcpy(output + (i * LPD8806_SLOTS_PER_PIXEL), pixel,
+           LPD8806_SLOTS_PER_PIXEL);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+void SPIOutput::IndividualAPA102Control(const DmxBuffer &buffer) {
+  // The start frame is 32 zero bits. The end frame needs at least
+  // pixel_count / 2 clock edges to push the data down the string, we also
+  // send a further 32 zero bits which the SK9822 requires.
+  const unsigned int latch_bytes = APA102_START_FRAME_BYTES +
+                                   (m_pixel_count + 15) / 16;
+  const unsigned int output_length = APA102_START_FRAME_BYTES +
+                                     m_pixel_count * APA102_SPI_BYTES_PER_PIXEL;
+  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
+                                        latch_bytes);
+  if (!output)
+    return;
+
+  memset(output, 0, APA102_START_FRAME_BYTES);
+  uint8_t *pixels = output + APA102_START_FRAME_BYTES;
+
+  // Pixels we don't have data for keep their previous value, but if this is
+  // a new buffer the frame headers need to be set.
+  for (unsigned int i = 0; i < m_pixel_count; i++) {
+    uint8_t *pixel = pixels + i * APA102_SPI_BYTES_PER_PIXEL;
+    if ((pixel[0] & APA102_HEADER) != APA102_HEADER) {
+      pixel[0] = m_apa102_header;
+      memset(pixel + 1, 0, APA102_SPI_BYTES_PER_PIXEL - 1);
     }
   }
+
+  const unsigned int pixels_per_universe = PixelsPerUniverse();
+  for (uint8_t universe = 0; universe < m_universe_count; universe++) {
+    const unsigned int first_pixel = universe * pixels_per_universe;
+    if (first_pixel >= m_pixel_count)
+      break;
+    EncodeAPA102Pixels(
+        UniverseData(universe, buffer),
+        std::min(pixels_per_universe, m_pixel_count - first_pixel),
+        pixels + first_pixel * APA102_SPI_BYTES_PER_PIXEL);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+void SPIOutput::CombinedAPA102Control(const DmxBuffer &buffer) {
+  unsigned int pixel_data_length = APA102_SLOTS_PER_PIXEL;
+  uint8_t pixel_data[APA102_SLOTS_PER_PIXEL];
+  UniverseData(0, buffer).GetRange(m_start_address - 1, pixel_data,
+                                   &pixel_data_length);
+  if (pixel_data_length != APA102_SLOTS_PER_PIXEL) {
+    OLA_INFO << "Insufficient DMX data, required " << APA102_SLOTS_PER_PIXEL
+             << ", got " << pixel_data_length;
+    return;
+  }
+
+  uint8_t pixel[APA102_SPI_BYTES_PER_PIXEL];
+  pixel[0] = m_apa102_header;
+  for (unsigned int i = 0; i < APA102_SLOTS_PER_PIXEL; i++)
+    pixel[i + 1] = m_apa102_lut[pixel_data[m_apa102_order[i]]];
+
+  const unsigned int latch_bytes = APA102_START_FRAME_BYTES +
+                                   (m_pixel_count + 15) / 16;
+  const unsigned int length = APA102_START_FRAME_BYTES +
+                              m_pixel_count * APA102_SPI_BYTES_PER_PIXEL;
+  uint8_t *output = m_backend->Checkout(m_output_number, length, latch_bytes);
+  if (!output)
+    return;
+
+  memset(output, 0, APA102_START_FRAME_BYTES);
+  uint8_t *pixels = output + APA102_START_FRAME_BYTES;
+  for (unsigned int i = 0; i < m_pixel_count; i++) {
+    memcpy(pixels + (i * APA102_SPI_BYTES_PER_PIXEL), pixel,
+           APA102_SPI_BYTES_PER_PIXEL);
+  }
   m_backend->Commit(m_output_number);
 }
 
+/*
+ * The WS2812 uses a single wire protocol. We generate it using the SPI MOSI
+ * line, clocked at 2.4MHz each data bit becomes 3 SPI bits, 100 for a 0 and
+ * 110 for a 1.
+ */
+void SPIOutput::IndividualWS2812Control(const DmxBuffer &buffer) {
+  const unsigned int output_length = m_pixel_count *
+                                     WS2812_SPI_BYTES_PER_PIXEL;
+  uint8_t *output = m_backend->Checkout(m_output_number, output_length,
+                                        WS2812_RESET_BYTES);
+  if (!output)
+    return;
+
+  // Pixels we don't have data for keep their previous value, but if this is
+  // a new buffer they need to be set to a valid (black) pixel. A zero byte
+  // is never valid since each encoded bit starts with a 1.
+  static const uint8_t BLACK[] = {0, 0, 0};
+  for (unsigned int i = 0; i < m_pixel_count; i++) {
+    uint8_t *pixel = output + i * WS2812_SPI_BYTES_PER_PIXEL;
+    if (pixel[0] == 0)
+      EncodeWS2812Pixel(BLACK, pixel);
+  }
+
+  const unsigned int pixels_per_universe = PixelsPerUniverse();
+  for (uint8_t universe = 0; universe < m_universe_count; universe++) {
+    const unsigned int first_pixel = universe * pixels_per_universe;
+    if (first_pixel >= m_pixel_count)
+      break;
+    EncodeWS2812Pixels(
+        UniverseData(universe, buffer),
+        std::min(pixels_per_universe, m_pixel_count - first_pixel),
+        output + first_pixel * WS2812_SPI_BYTES_PER_PIXEL);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+void SPIOutput::CombinedWS2812Control(const DmxBuffer &buffer) {
+  unsigned int pixel_data_length = WS2812_SLOTS_PER_PIXEL;
+  uint8_t pixel_data[WS2812_SLOTS_PER_PIXEL];
+  UniverseData(0, buffer).GetRange(m_start_address - 1, pixel_data,
+                                   &pixel_data_length);
+  if (pixel_data_length != WS2812_SLOTS_PER_PIXEL) {
+    OLA_INFO << "Insufficient DMX data, required " << WS2812_SLOTS_PER_PIXEL
+             << ", got " << pixel_data_length;
+    return;
+  }
+
+  uint8_t pixel[WS2812_SPI_BYTES_PER_PIXEL];
+  EncodeWS2812Pixel(pixel_data, pixel);
+
+  const unsigned int length = m_pixel_count * WS2812_SPI_BYTES_PER_PIXEL;
+  uint8_t *output = m_backend->Checkout(m_output_number, length,
+                                        WS2812_RESET_BYTES);
+  if (!output)
+    return;
+
+  for (unsigned int i = 0; i < m_pixel_count; i++) {
+    memcpy(output + (i * WS2812_SPI_BYTES_PER_PIXEL), pixel,
+           WS2812_SPI_BYTES_PER_PIXEL);
+  }
+  m_backend->Commit(m_output_number);
+}
+
+/*
+ * Build the gamma / brightness tables and the color orders.
+ */
+void SPIOutput::BuildLookupTables(const Options &options) {
+  const double gamma = options.gamma > 0 ? options.gamma : 1.0;
+  const double brightness = std::min(options.brightness,
+                                     static_cast<uint8_t>(100)) / 100.0;
+
+  for (unsigned int i = 0; i <= DMX_MAX_CHANNEL_VALUE; i++) {
+    double value = static_cast<double>(i) / DMX_MAX_CHANNEL_VALUE;
+    if (gamma != 1.0)
+      value = pow(value, gamma);
+    m_apa102_lut[i] = static_cast<uint8_t>(
+        value * DMX_MAX_CHANNEL_VALUE + 0.5);
+
+    const uint8_t level = static_cast<uint8_t>(
+        value * brightness * DMX_MAX_CHANNEL_VALUE + 0.5);
+    m_ws2801_lut[i] = level;
+    // The LPD8806 uses 7 bit color, the top bit must be set.
+    m_lpd8806_lut[i] = 0x80 | (level >> 1);
+
+    uint32_t bits = 0;
+    for (int bit = 7; bit >= 0; bit--)
+      bits = (bits << 3) | ((level & (1 << bit)) ? 6 : 4);
+    m_ws2812_table[i][0] = bits >> 16;
+    m_ws2812_table[i][1] = bits >> 8;
+    m_ws2812_table[i][2] = bits;
+  }
+
+  // The APA102 has 5 bits of global brightness per pixel
+  m_apa102_header = APA102_HEADER | static_cast<uint8_t>(brightness * 31 + 0.5);
+
+  // WS2801 strings are RGB, LPD8806 & WS2812 are GRB and APA102 is BGR unless
+  // told otherwise
+  static const uint8_t RGB_ORDER[] = {0, 1, 2};
+  static const uint8_t GRB_ORDER[] = {1, 0, 2};
+  static const uint8_t BGR_ORDER[] = {2, 1, 0};
+  if (!options.color_order.empty() &&
+      ParseColorOrder(options.color_order, m_ws2801_order)) {
+    memcpy(m_lpd8806_order, m_ws2801_order, sizeof(m_lpd8806_order));
+    memcpy(m_apa102_order, m_ws2801_order, sizeof(m_apa102_order));
+    memcpy(m_ws2812_order, m_ws2801_order, sizeof(m_ws2812_order));
+    return;
+  }
+
+  if (!options.color_order.empty()) {
+    OLA_WARN << "Invalid color order " << options.color_order
+             << ", using the default";
+  }
+  memcpy(m_ws2801_order, RGB_ORDER, sizeof(m_ws2801_order));
+  memcpy(m_lpd8806_order, GRB_ORDER, sizeof(m_lpd8806_order));
+  memcpy(m_apa102_order, BGR_ORDER, sizeof(m_apa102_order));
+  memcpy(m_ws2812_order, GRB_ORDER, sizeof(m_ws2812_order));
+}
+
+/*
+ * Return the data for a universe in the string.
+ */
+const DmxBuffer &SPIOutput::UniverseData(
+    uint8_t universe,
+    const DmxBuffer &last_universe) const {
+  if (universe + 1 >= m_universe_count)
+    return last_universe;
+  return m_universe_buffers[universe];
+}
+
+/*
+ * The number of pixels that fit in each universe given the start address.
+ */
+unsigned int SPIOutput::PixelsPerUniverse() const {
+  return (DMX_UNIVERSE_SIZE - (m_start_address - 1)) / WS2801_SLOTS_PER_PIXEL;
+}
+
+/*
+ * Apply the lookup table & color order to the pixels in a universe. Both
+ * pixel types use 3 slots per pixel.
+ * @param buffer the DMX data for the universe
+ * @param max_pixels the maximum number of pixels to map
+ * @param lut the lookup table to apply
+ * @param order the color order
+ * @param partial_pixels if true, a trailing pixel that is missing some slots
+ *   is updated with the slots we do have.
+ * @param output where to write the pixel data
+ * @returns the number of complete pixels written
+ */
+unsigned int SPIOutput::MapPixels(const DmxBuffer &buffer,
+                                  unsigned int max_pixels,
+                                  const uint8_t *lut,
+                                  const uint8_t *order,
+                                  bool partial_pixels,
+                                  uint8_t *output) const {
+  const unsigned int first_slot = m_start_address - 1;
+  if (buffer.Size() <= first_slot)
+    return 0;
+
+  const unsigned int slots = std::min(
+      buffer.Size() - first_slot, max_pixels * WS2801_SLOTS_PER_PIXEL);
+  const unsigned int pixels = slots / WS2801_SLOTS_PER_PIXEL;
+  const uint8_t *input = buffer.GetRaw() + first_slot;
+
+  // Hoist the order out of the loop so this is three table lookups per pixel
+  const uint8_t r_slot = order[0];
+  const uint8_t g_slot = order[1];
+  const uint8_t b_slot = order[2];
+  for (unsigned int i = 0; i < pixels; i++) {
+    output[0] = lut[input[r_slot]];
+    output[1] = lut[input[g_slot]];
+    output[2] = lut[input[b_slot]];
+    input += WS2801_SLOTS_PER_PIXEL;
+    output += WS2801_SLOTS_PER_PIXEL;
+  }
+
+  const unsigned int remainder = slots % WS2801_SLOTS_PER_PIXEL;
+  if (partial_pixels && remainder) {
+    for (unsigned int i = 0; i < WS2801_SLOTS_PER_PIXEL; i++) {
+      if (order[i] < remainder)
+        output[i] = lut[input[order[i]]];
+    }
+  }
+  return pixels;
+}
+
+
+/*
+ * Return the number of complete pixels in a universe, up to max_pixels.
+ */
+unsigned int SPIOutput::CompletePixels(const DmxBuffer &buffer,
+                                       unsigned int max_pixels) const {
+  const unsigned int first_slot = m_start_address - 1;
+  if (buffer.Size() <= first_slot)
+    return 0;
+  return std::min((buffer.Size() - first_slot) / APA102_SLOTS_PER_PIXEL,
+                  max_pixels);
+}
+
+/*
+ * Encode the pixels in a universe as APA102 LED frames.
+ * @returns the number of pixels written
+ */
+unsigned int SPIOutput::EncodeAPA102Pixels(const DmxBuffer &buffer,
+                                           unsigned int max_pixels,
+                                           uint8_t *output) const {
+  const unsigned int pixels = CompletePixels(buffer, max_pixels);
+  const uint8_t *input = buffer.GetRaw() + m_start_address - 1;
+
+  const uint8_t first_slot = m_apa102_order[0];
+  const uint8_t second_slot = m_apa102_order[1];
+  const uint8_t third_slot = m_apa102_order[2];
+  for (unsigned int i = 0; i < pixels; i++) {
+    output[0] = m_apa102_header;
+    output[1] = m_apa102_lut[input[first_slot]];
+    output[2] = m_apa102_lut[input[second_slot]];
+    output[3] = m_apa102_lut[input[third_slot]];
+    input += APA102_SLOTS_PER_PIXEL;
+    output += APA102_SPI_BYTES_PER_PIXEL;
+  }
+  return pixels;
+}
+
+/*
+ * Encode the pixels in a universe as the WS2812 bit stream.
+ * @returns the number of pixels written
+ */
+unsigned int SPIOutput::EncodeWS2812Pixels(const DmxBuffer &buffer,
+                                           unsigned int max_pixels,
+                                           uint8_t *output) const {
+  const unsigned int pixels = CompletePixels(buffer, max_pixels);
+  const uint8_t *input = buffer.GetRaw() + m_start_address - 1;
+
+  const uint8_t first_slot = m_ws2812_order[0];
+  const uint8_t second_slot = m_ws2812_order[1];
+  const uint8_t third_slot = m_ws2812_order[2];
+  for (unsigned int i = 0; i < pixels; i++) {
+    const uint8_t *first = m_ws2812_table[input[first_slot]];
+    const uint8_t *second = m_ws2812_table[input[second_slot]];
+    const uint8_t *third = m_ws2812_table[input[third_slot]];
+    output[0] = first[0];
+    output[1] = first[1];
+    output[2] = first[2];
+    output[3] = second[0];
+    output[4] = second[1];
+    output[5] = second[2];
+    output[6] = third[0];
+    output[7] = third[1];
+    output[8] = third[2];
+    input += WS2812_SLOTS_PER_PIXEL;
+    output += WS2812_SPI_BYTES_PER_PIXEL;
+  }
+  return pixels;
+}
+
+/*
+ * Encode a single RGB pixel as the WS2812 bit stream.
+ */
+void SPIOutput::EncodeWS2812Pixel(const uint8_t *pixel,
+                                  uint8_t *output) const {
+  for (unsigned int i = 0; i < WS2812_SLOTS_PER_PIXEL; i++) {
+    memcpy(output + i * sizeof(m_ws2812_table[0]),
+           m_ws2812_table[pixel[m_ws2812_order[i]]],
+           sizeof(m_ws2812_table[0]));
+  }
+}
+
 const RDMResponse *SPIOutput::GetDeviceInfo(const RDMRequest *request) {
   uint16_t footprint = m_personality_manager.ActivePersonalityFootprint();
   if (request->ParamDataSize()) {
@@ -23,6 +23,7 @@
 
 #include <string>
 #include <vector>
+#include "ola/BaseTypes.h"
 #include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMControllerInterface.h"
 #include "ola/rdm/UID.h"
@@ -105,12 +106,27 @@ class PersonalityManager {
 class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
   public:
     struct Options {
-      uint8_t pixel_count;
+      uint16_t pixel_count;
       uint8_t output_number;
+      /*
+       * The number of consecutive universes the string spans. The data is
+       * written to the backend when the last universe is updated.
+       */
+      uint8_t universe_count;
+      float gamma;
+      uint8_t brightness;  // as a percentage
+      /*
+       * The order of the colors on the wire, e.g. "GRB". The DMX data is
+       * always RGB. Empty means use the default order for the pixel type.
+       */
+      string color_order;
 
       explicit Options(uint8_t output_number)
           : pixel_count(25),  // For the https://www.adafruit.com/products/738
-            output_number(output_number) {
+            output_number(output_number),
+            universe_count(1),
+            gamma(1.0),
+            brightness(100) {
       }
     };
 
@@ -123,9 +139,13 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     uint16_t GetStartAddress() const;
     bool SetStartAddress(uint16_t start_address);
     unsigned int PixelCount() const { return m_pixel_count; }
+    uint8_t UniverseCount() const { return m_universe_count; }
 
     string Description() const;
-    bool WriteDMX(const DmxBuffer &buffer);
+    bool WriteDMX(const DmxBuffer &buffer) { return WriteDMX(0, buffer); }
+    bool WriteDMX(uint8_t universe, const DmxBuffer &buffer);
+
+    static bool ParseColorOrder(const string &color_order, uint8_t *order);
 
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
     void RunIncrementalDiscovery(ola::rdm::RDMDiscoveryCallback *callback);
@@ -155,17 +175,57 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     string m_spi_device_name;
     const UID m_uid;
     const unsigned int m_pixel_count;
+    const uint8_t m_universe_count;
     uint16_t m_start_address;  // starts from 1
     bool m_identify_mode;
     PersonalityManager m_personality_manager;
+    // the data for all but the last universe
+    std::vector<DmxBuffer> m_universe_buffers;
+
+    // The per-output lookup tables, these combine gamma, brightness and any
+    // encoding the pixel type requires.
+    uint8_t m_ws2801_lut[DMX_MAX_CHANNEL_VALUE + 1];
+    uint8_t m_lpd8806_lut[DMX_MAX_CHANNEL_VALUE + 1];
+    // The APA102 applies brightness using the per-pixel global brightness
+    // field, so this only contains the gamma correction.
+    uint8_t m_apa102_lut[DMX_MAX_CHANNEL_VALUE + 1];
+    uint8_t m_apa102_header;
+    // Each WS2812 bit is sent as 3 SPI bits, so each slot expands to 3 bytes.
+    uint8_t m_ws2812_table[DMX_MAX_CHANNEL_VALUE + 1][3];
+    // order[i] is the RGB slot that is sent as the i'th byte of each pixel
+    uint8_t m_ws2801_order[3];
+    uint8_t m_lpd8806_order[3];
+    uint8_t m_apa102_order[3];
+    uint8_t m_ws2812_order[3];
 
     // DMX methods
     void IndividualWS2801Control(const DmxBuffer &buffer);
     void CombinedWS2801Control(const DmxBuffer &buffer);
     void IndividualLPD8806Control(const DmxBuffer &buffer);
     void CombinedLPD8806Control(const DmxBuffer &buffer);
-    unsigned int LPD8806BufferSize() const;
-    void WriteSPIData(const uint8_t *data, unsigned int length);
+    void IndividualAPA102Control(const DmxBuffer &buffer);
+    void CombinedAPA102Control(const DmxBuffer &buffer);
+    void IndividualWS2812Control(const DmxBuffer &buffer);
+    void CombinedWS2812Control(const DmxBuffer &buffer);
+    void BuildLookupTables(const Options &options);
+    const DmxBuffer &UniverseData(uint8_t universe,
+                                  const DmxBuffer &last_universe) const;
+    unsigned int PixelsPerUniverse() const;
+    unsigned int MapPixels(const DmxBuffer &buffer,
+                           unsigned int max_pixels,
+                           const uint8_t *lut,
+                           const uint8_t *order,
+                           bool partial_pixels,
+                           uint8_t *output) const;
+    unsigned int CompletePixels(const DmxBuffer &buffer,
+                                unsigned int max_pixels) const;
+    unsigned int EncodeAPA102Pixels(const DmxBuffer &buffer,
+                                    unsigned int max_pixels,
+                                    uint8_t *output) const;
+    unsigned int EncodeWS2812Pixels(const DmxBuffer &buffer,
+                                    unsigned int max_pixels,
+                                    uint8_t *output) const;
+    void EncodeWS2812Pixel(const uint8_t *pixel, uint8_t *output) const;
 
     // RDM methods
     const RDMResponse *GetDeviceInfo(const RDMRequest *request);
@@ -188,6 +248,13 @@ class SPIOutput: public ola::rdm::DiscoverableRDMControllerInterface {
     static const uint32_t SPI_SPEED;
     static const uint16_t WS2801_SLOTS_PER_PIXEL;
     static const uint16_t LPD8806_SLOTS_PER_PIXEL;
+    static const uint16_t APA102_SLOTS_PER_PIXEL;
+    static const uint16_t APA102_SPI_BYTES_PER_PIXEL;
+    static const uint16_t APA102_START_FRAME_BYTES;
+    static const uint8_t APA102_HEADER;
+    static const uint16_t WS2812_SLOTS_PER_PIXEL;
+    static const uint16_t WS2812_SPI_BYTES_PER_PIXEL;
+    static const uint16_t WS2812_RESET_BYTES;
 
     static const ola::rdm::ResponderOps<SPIOutput>::ParamHandler
         PARAM_HANDLERS[];
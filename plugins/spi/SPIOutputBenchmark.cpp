@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * SPIOutputBenchmark.cpp
+ * Measures the cost of encoding pixel data for each SPI personality.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * This isn't run as part of make check, run ./SPIOutputBenchmark by hand.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <stdint.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ola/BaseTypes.h"
+#include "ola/Clock.h"
+#include "ola/DmxBuffer.h"
+#include "ola/rdm/UID.h"
+#include "ola/testing/TestUtils.h"
+#include "plugins/spi/SPIBackend.h"
+#include "plugins/spi/SPIOutput.h"
+
+using ola::Clock;
+using ola::DmxBuffer;
+using ola::TimeInterval;
+using ola::TimeStamp;
+using ola::plugin::spi::FakeSPIBackend;
+using ola::plugin::spi::SPIOutput;
+using ola::rdm::UID;
+using std::string;
+using std::vector;
+
+class SPIOutputBenchmark: public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(SPIOutputBenchmark);
+  CPPUNIT_TEST(testWS2801);
+  CPPUNIT_TEST(testLPD8806);
+  CPPUNIT_TEST(testAPA102);
+  CPPUNIT_TEST(testWS2812);
+  CPPUNIT_TEST_SUITE_END();
+
+  public:
+    SPIOutputBenchmark()
+        : CppUnit::TestFixture(),
+          m_uid(0x707a, 0) {
+    }
+
+    void setUp();
+
+    void testWS2801() { Benchmark("WS2801", 1); }
+    void testLPD8806() { Benchmark("LPD8806", 3); }
+    void testAPA102() { Benchmark("APA102", 5); }
+    void testWS2812() { Benchmark("WS2812", 7); }
+
+  private:
+    // 6 full universes of RGB pixels
+    static const uint8_t UNIVERSE_COUNT = 6;
+    static const unsigned int PIXEL_COUNT =
+      UNIVERSE_COUNT * (DMX_UNIVERSE_SIZE / 3);
+    static const unsigned int ITERATIONS = 2000;
+
+    UID m_uid;
+    Clock m_clock;
+    vector<DmxBuffer> m_universes;
+
+    void Benchmark(const string &description, uint8_t personality);
+};
+
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SPIOutputBenchmark);
+
+
+/*
+ * Fill the universes with pseudo random data.
+ */
+void SPIOutputBenchmark::setUp() {
+  uint32_t seed = 1;
+  m_universes.resize(UNIVERSE_COUNT);
+  for (unsigned int i = 0; i < UNIVERSE_COUNT; i++) {
+    for (unsigned int j = 0; j < DMX_UNIVERSE_SIZE; j++) {
+      seed = seed * 1103515245 + 12345;
+      m_universes[i].SetChannel(j, seed >> 16);
+    }
+  }
+}
+
+
+/*
+ * Write full frames with a personality and print the cost per pixel.
+ */
+void SPIOutputBenchmark::Benchmark(const string &description,
+                                   uint8_t personality) {
+  FakeSPIBackend backend(1);
+  SPIOutput::Options options(0);
+  options.pixel_count = PIXEL_COUNT;
+  options.universe_count = UNIVERSE_COUNT;
+  options.gamma = 2.2;
+  SPIOutput output(m_uid, &backend, options);
+  OLA_ASSERT_TRUE(output.SetPersonality(personality));
+
+  TimeStamp start, end;
+  m_clock.CurrentTime(&start);
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    for (uint8_t universe = 0; universe < UNIVERSE_COUNT; universe++)
+      output.WriteDMX(universe, m_universes[universe]);
+  }
+  m_clock.CurrentTime(&end);
+  OLA_ASSERT_EQ(static_cast<unsigned int>(ITERATIONS), backend.Writes(0));
+
+  unsigned int length;
+  backend.GetData(0, &length);
+  const TimeInterval duration = end - start;
+  const double duration_us = duration.Seconds() * 1000000.0 +
+                             duration.MicroSeconds();
+  const double pixel_ns = duration_us * 1000.0 /
+                          (static_cast<double>(ITERATIONS) * PIXEL_COUNT);
+  std::cout << std::endl << description << ", " << PIXEL_COUNT
+            << " pixels (" << length << " bytes), " << ITERATIONS
+            << " frames: " << duration << "s, " << pixel_ns << " ns / pixel, "
+            << static_cast<int>(1000000000.0 / (pixel_ns * PIXEL_COUNT))
+            << " frames / s" << std::endl;
+}
@@ -44,6 +44,11 @@ class SPIOutputTest: public CppUnit::TestFixture {
   CPPUNIT_TEST(testCombinedWS2801Control);
   CPPUNIT_TEST(testIndividualLPD8806Control);
   CPPUNIT_TEST(testCombinedLPD8806Control);
+  CPPUNIT_TEST(testAPA102Control);
+  CPPUNIT_TEST(testWS2812Control);
+  CPPUNIT_TEST(testMultipleUniverses);
+  CPPUNIT_TEST(testLookupTables);
+  CPPUNIT_TEST(testColorOrder);
   CPPUNIT_TEST_SUITE_END();
 
  public:
@@ -58,6 +63,11 @@ class SPIOutputTest: public CppUnit::TestFixture {
   void testCombinedWS2801Control();
   void testIndividualLPD8806Control();
   void testCombinedLPD8806Control();
+  void testAPA102Control();
+  void testWS2812Control();
+  void testMultipleUniverses();
+  void testLookupTables();
+  void testColorOrder();
 
  private:
   UID m_uid;
@@ -309,3 +319,254 @@ void SPIOutputTest::testCombinedLPD8806Control() {
                 backend.GetData(1, &length));
   OLA_ASSERT_EQ(0u, backend.Writes(1));
 }
+
+/**
+ * Test DMX writes in the APA102 modes.
+ */
+void SPIOutputTest::testAPA102Control() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0);
+  options.pixel_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+  OLA_ASSERT_TRUE(output.SetPersonality(5));
+  OLA_ASSERT_EQ(
+      string("test, output 0, APA102 Individual Control, 6 slots @ 1."
+             " (707a:00000000)"),
+      output.Description());
+
+  DmxBuffer buffer;
+  unsigned int length = 0;
+  const uint8_t *data = NULL;
+
+  // The second pixel has no data, so it's set to black
+  buffer.SetFromString("1, 10, 100");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = {
+    0, 0, 0, 0,
+    0xff, 100, 10, 1,
+    0xff, 0, 0, 0,
+    0, 0, 0, 0, 0
+  };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED0, arraysize(EXPECTED0), data, length);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  buffer.SetFromString("255,128,0,10,20,30");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = {
+    0, 0, 0, 0,
+    0xff, 0, 128, 255,
+    0xff, 30, 20, 10,
+    0, 0, 0, 0, 0
+  };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED1, arraysize(EXPECTED1), data, length);
+
+  // partial pixels are ignored
+  buffer.SetFromString("34,56,78,1");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED2[] = {
+    0, 0, 0, 0,
+    0xff, 78, 56, 34,
+    0xff, 30, 20, 10,
+    0, 0, 0, 0, 0
+  };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED2, arraysize(EXPECTED2), data, length);
+
+  // Combined mode, the brightness uses the global brightness field
+  options.output_number = 1;
+  options.brightness = 50;
+  SPIOutput output2(m_uid, &backend, options);
+  OLA_ASSERT_TRUE(output2.SetPersonality(6));
+  buffer.SetFromString("255,128,0");
+  output2.WriteDMX(buffer);
+  data = backend.GetData(1, &length);
+  const uint8_t EXPECTED3[] = {
+    0, 0, 0, 0,
+    0xf0, 0, 128, 255,
+    0xf0, 0, 128, 255,
+    0, 0, 0, 0, 0
+  };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED3, arraysize(EXPECTED3), data, length);
+  OLA_ASSERT_EQ(1u, backend.Writes(1));
+}
+
+/**
+ * Test DMX writes in the WS2812 modes.
+ */
+void SPIOutputTest::testWS2812Control() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0);
+  options.pixel_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+  OLA_ASSERT_TRUE(output.SetPersonality(7));
+
+  // Each bit is sent as 100 for a 0 and 110 for a 1.
+  const uint8_t ZERO[] = {0x92, 0x49, 0x24};
+  const uint8_t FULL[] = {0xdb, 0x6d, 0xb6};
+  const uint8_t HALF[] = {0xd2, 0x49, 0x24};
+
+  DmxBuffer buffer;
+  buffer.SetFromString("255,0,128");
+  output.WriteDMX(buffer);
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  // 2 pixels & the reset
+  OLA_ASSERT_EQ(18u + 84u, length);
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+
+  // GRB order
+  ASSERT_DATA_EQUALS(__LINE__, ZERO, arraysize(ZERO), data, 3);
+  ASSERT_DATA_EQUALS(__LINE__, FULL, arraysize(FULL), data + 3, 3);
+  ASSERT_DATA_EQUALS(__LINE__, HALF, arraysize(HALF), data + 6, 3);
+  // The second pixel is black
+  for (unsigned int i = 9; i < 18; i += 3)
+    ASSERT_DATA_EQUALS(__LINE__, ZERO, arraysize(ZERO), data + i, 3);
+  for (unsigned int i = 18; i < length; i++)
+    OLA_ASSERT_EQ(static_cast<uint8_t>(0), data[i]);
+
+  // Combined mode
+  OLA_ASSERT_TRUE(output.SetPersonality(8));
+  buffer.SetFromString("128,255,0");
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  OLA_ASSERT_EQ(18u + 84u, length);
+  for (unsigned int i = 0; i < 18; i += 9) {
+    ASSERT_DATA_EQUALS(__LINE__, FULL, arraysize(FULL), data + i, 3);
+    ASSERT_DATA_EQUALS(__LINE__, HALF, arraysize(HALF), data + i + 3, 3);
+    ASSERT_DATA_EQUALS(__LINE__, ZERO, arraysize(ZERO), data + i + 6, 3);
+  }
+}
+
+/**
+ * Test a string that spans more than one universe.
+ */
+void SPIOutputTest::testMultipleUniverses() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0);
+  options.pixel_count = 200;
+  options.universe_count = 2;
+  SPIOutput output(m_uid, &backend, options);
+
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), output.UniverseCount());
+  OLA_ASSERT_EQ(
+      string("test, output 0, WS2801 Individual Control, 510 slots @ 1 in 2"
+             " universes. (707a:00000000)"),
+      output.Description());
+
+  DmxBuffer first_universe;
+  first_universe.SetRangeToValue(0, 5, ola::DMX_UNIVERSE_SIZE);
+  first_universe.SetChannel(509, 9);
+  first_universe.SetChannel(510, 10);  // not part of a pixel
+
+  // Nothing is written until the last universe arrives
+  OLA_ASSERT_TRUE(output.WriteDMX(0, first_universe));
+  OLA_ASSERT_EQ(0u, backend.Writes(0));
+
+  DmxBuffer second_universe;
+  second_universe.SetFromString("1,2,3");
+  OLA_ASSERT_TRUE(output.WriteDMX(1, second_universe));
+  OLA_ASSERT_EQ(1u, backend.Writes(0));
+  OLA_ASSERT_FALSE(output.WriteDMX(2, second_universe));
+
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  OLA_ASSERT_EQ(600u, length);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(5), data[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(9), data[509]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), data[510]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(3), data[512]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), data[513]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), data[599]);
+
+  // The start address applies to each universe
+  OLA_ASSERT_TRUE(output.SetStartAddress(3));
+  second_universe.SetFromString("0,0,7,8,9");
+  output.WriteDMX(1, second_universe);
+  OLA_ASSERT_EQ(2u, backend.Writes(0));
+  data = backend.GetData(0, &length);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(5), data[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(9), data[507]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(10), data[508]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(7), data[510]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(9), data[512]);
+}
+
+/**
+ * Test gamma & brightness correction.
+ */
+void SPIOutputTest::testLookupTables() {
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0);
+  options.pixel_count = 1;
+  options.gamma = 2.0;
+  SPIOutput output(m_uid, &backend, options);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("0,128,255");
+  output.WriteDMX(buffer);
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = { 0, 64, 255 };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED0, arraysize(EXPECTED0), data, length);
+
+  // LPD8806, GRB order & 7 bit color
+  output.SetPersonality(3);
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = { 0xa0, 0x80, 0xff, 0 };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED1, arraysize(EXPECTED1), data, length);
+
+  options.output_number = 1;
+  options.gamma = 1.0;
+  options.brightness = 50;
+  SPIOutput output2(m_uid, &backend, options);
+  output2.SetPersonality(2);
+  buffer.SetFromString("255,100,0");
+  output2.WriteDMX(buffer);
+  data = backend.GetData(1, &length);
+  const uint8_t EXPECTED2[] = { 128, 50, 0 };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED2, arraysize(EXPECTED2), data, length);
+}
+
+/**
+ * Test the color order option.
+ */
+void SPIOutputTest::testColorOrder() {
+  uint8_t order[3];
+  OLA_ASSERT_TRUE(SPIOutput::ParseColorOrder("rgb", order));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), order[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), order[1]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), order[2]);
+  OLA_ASSERT_TRUE(SPIOutput::ParseColorOrder("BRG", order));
+  OLA_ASSERT_EQ(static_cast<uint8_t>(2), order[0]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(0), order[1]);
+  OLA_ASSERT_EQ(static_cast<uint8_t>(1), order[2]);
+  OLA_ASSERT_FALSE(SPIOutput::ParseColorOrder("", order));
+  OLA_ASSERT_FALSE(SPIOutput::ParseColorOrder("RG", order));
+  OLA_ASSERT_FALSE(SPIOutput::ParseColorOrder("RGBW", order));
+  OLA_ASSERT_FALSE(SPIOutput::ParseColorOrder("RRB", order));
+  OLA_ASSERT_FALSE(SPIOutput::ParseColorOrder("RGX", order));
+
+  FakeSPIBackend backend(2);
+  SPIOutput::Options options(0);
+  options.pixel_count = 2;
+  options.color_order = "BGR";
+  SPIOutput output(m_uid, &backend, options);
+
+  DmxBuffer buffer;
+  buffer.SetFromString("1,2,3,4,5");
+  output.WriteDMX(buffer);
+  unsigned int length = 0;
+  const uint8_t *data = backend.GetData(0, &length);
+  const uint8_t EXPECTED0[] = { 3, 2, 1, 0, 5, 4 };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED0, arraysize(EXPECTED0), data, length);
+
+  // The custom order overrides the LPD8806 default as well
+  output.SetPersonality(4);
+  output.WriteDMX(buffer);
+  data = backend.GetData(0, &length);
+  const uint8_t EXPECTED1[] = { 0x81, 0x81, 0x80, 0x81, 0x81, 0x80, 0 };
+  ASSERT_DATA_EQUALS(__LINE__, EXPECTED1, arraysize(EXPECTED1), data, length);
+}
@@ -166,10 +166,28 @@ string SPIPlugin::Description() const {
 "The DMX address to use. e.g. spidev0.1-0-dmx-address = 1\n"
 "\n"
 "<device>-<port>-personality = <int>\n"
-"The RDM personality to use.\n"
+"The RDM personality to use. WS2801, LPD8806, APA102 (and SK9822) and\n"
+"WS2812 pixels are supported. The WS2812 is driven from the MOSI line and\n"
+"requires the SPI speed to be set to 2400000.\n"
 "\n"
 "<device>-<port>-pixel-count = <int>\n"
 "The number of pixels for this port. e.g. spidev0.1-1-pixel-count = 20.\n"
+"\n"
+"<device>-<port>-universes = <int>\n"
+"The number of universes the pixel string spans, range is 1 - 8. Pixels\n"
+"that don't fit in the first universe continue in the next one. Each\n"
+"universe appears as a separate OLA port and the string is written when the\n"
+"last universe is updated.\n"
+"\n"
+"<device>-<port>-gamma = <float>\n"
+"The gamma correction to apply to the DMX data, 1.0 disables correction.\n"
+"\n"
+"<device>-<port>-brightness = <int>\n"
+"Scales the output, range is 0 - 100 percent.\n"
+"\n"
+"<device>-<port>-color-order = <string>\n"
+"The order the pixels expect the colors in, e.g. GRB. The DMX data is\n"
+"always RGB. If empty the default order for the pixel type is used.\n"
 "\n";
 }
 
@@ -18,6 +18,7 @@
  * Copyright (C) 2013 Simon Newton
  */
 
+#include <sstream>
 #include <string>
 #include "ola/BaseTypes.h"
 #include "ola/rdm/RDMCommand.h"
@@ -34,53 +35,46 @@ using ola::rdm::RDMCallback;
 using ola::rdm::RDMRequest;
 using ola::rdm::UID;
 
-SPIOutputPort::SPIOutputPort(SPIDevice *parent, SPIBackendInterface *backend,
-                             const UID &uid,
-                             const SPIOutput::Options &options)
-    : BasicOutputPort(parent, options.output_number, true),
-      m_spi_output(uid, backend, options) {
+SPIOutputPort::SPIOutputPort(SPIDevice *parent, SPIOutput *spi_output,
+                             uint8_t universe, unsigned int port_id)
+    : BasicOutputPort(parent, port_id, universe == 0),
+      m_spi_output(spi_output),
+      m_universe(universe) {
 }
 
 
-uint8_t SPIOutputPort::GetPersonality() const {
-  return m_spi_output.GetPersonality();
-}
-
-bool SPIOutputPort::SetPersonality(uint16_t personality) {
-  return m_spi_output.SetPersonality(personality);
-}
-
-uint16_t SPIOutputPort::GetStartAddress() const {
-  return m_spi_output.GetStartAddress();
-}
-
-bool SPIOutputPort::SetStartAddress(uint16_t address) {
-  return m_spi_output.SetStartAddress(address);
-}
-
-unsigned int SPIOutputPort::PixelCount() const {
-  return m_spi_output.PixelCount();
-}
-
 string SPIOutputPort::Description() const {
-  return m_spi_output.Description();
+  if (m_spi_output->UniverseCount() == 1)
+    return m_spi_output->Description();
+
+  std::ostringstream str;
+  str << m_spi_output->Description() << " Universe "
+      << static_cast<int>(m_universe + 1) << " of "
+      << static_cast<int>(m_spi_output->UniverseCount()) << ".";
+  return str.str();
 }
 
 bool SPIOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t) {
-  return m_spi_output.WriteDMX(buffer);
+  return m_spi_output->WriteDMX(m_universe, buffer);
 }
 
 void SPIOutputPort::RunFullDiscovery(RDMDiscoveryCallback *callback) {
-  return m_spi_output.RunFullDiscovery(callback);
+  if (m_universe)
+    return BasicOutputPort::RunFullDiscovery(callback);
+  return m_spi_output->RunFullDiscovery(callback);
 }
 
 void SPIOutputPort::RunIncrementalDiscovery(RDMDiscoveryCallback *callback) {
-  return m_spi_output.RunIncrementalDiscovery(callback);
+  if (m_universe)
+    return BasicOutputPort::RunIncrementalDiscovery(callback);
+  return m_spi_output->RunIncrementalDiscovery(callback);
 }
 
 void SPIOutputPort::SendRDMRequest(const ola::rdm::RDMRequest *request,
                                    ola::rdm::RDMCallback *callback) {
-  return m_spi_output.SendRDMRequest(request, callback);
+  if (m_universe)
+    return BasicOutputPort::SendRDMRequest(request, callback);
+  return m_spi_output->SendRDMRequest(request, callback);
 }
 }  // namespace spi
 }  // namespace plugin
@@ -32,18 +32,17 @@ namespace ola {
 namespace plugin {
 namespace spi {
 
+/*
+ * A port that feeds one universe of an SPIOutput. An output that spans
+ * multiple universes has one port per universe, the first of which handles
+ * RDM.
+ */
 class SPIOutputPort: public BasicOutputPort {
   public:
-    SPIOutputPort(SPIDevice *parent, class SPIBackendInterface *backend,
-                  const UID &uid, const SPIOutput::Options &options);
+    SPIOutputPort(SPIDevice *parent, SPIOutput *spi_output, uint8_t universe,
+                  unsigned int port_id);
     ~SPIOutputPort() {}
 
-    uint8_t GetPersonality() const;
-    bool SetPersonality(uint16_t personality);
-    uint16_t GetStartAddress() const;
-    bool SetStartAddress(uint16_t start_address);
-    unsigned int PixelCount() const;
-
     string Description() const;
     bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
 
@@ -53,7 +52,8 @@ class SPIOutputPort: public BasicOutputPort {
                         ola::rdm::RDMCallback *callback);
 
   private:
-    SPIOutput m_spi_output;
+    SPIOutput *m_spi_output;
+    const uint8_t m_universe;
 };
 }  // namespace spi
 }  // namespace plugin
@@ -42,9 +42,8 @@ AnymaOutputPort::AnymaOutputPort(AnymaDevice *parent,
                                  libusb_device_handle *usb_handle,
                                  const string &serial)
     : BasicOutputPort(parent, id),
-      m_term(false),
-      m_serial(serial),
-      m_usb_handle(usb_handle) {
+      m_serial(serial) {
+  Attach(usb_handle, 0);
 }
 
 
@@ -52,94 +51,47 @@ AnymaOutputPort::AnymaOutputPort(AnymaDevice *parent,
  * Cleanup
  */
 AnymaOutputPort::~AnymaOutputPort() {
-  {
-    ola::thread::MutexLocker locker(&m_term_mutex);
-    m_term = true;
-  }
-  Join();
+  CancelTransfer();
 }
 
 
 /*
- * Start this thread
+ * Start sending
  */
 bool AnymaOutputPort::Start() {
-  bool ret = ola::thread::Thread::Start();
-  if (!ret) {
-    OLA_WARN << "Failed to start sender thread";
-    libusb_release_interface(m_usb_handle, 0);
-    libusb_close(m_usb_handle);
-    return false;
-  }
-  return true;
+  return m_transfer != NULL;
 }
 
 
 /*
- * Run this thread
- */
-void *AnymaOutputPort::Run() {
-  DmxBuffer buffer;
-  if (!m_usb_handle)
-    return NULL;
-
-  while (1) {
-    {
-      ola::thread::MutexLocker locker(&m_term_mutex);
-      if (m_term)
-        break;
-    }
-
-    {
-      ola::thread::MutexLocker locker(&m_data_mutex);
-      buffer.Set(m_buffer);
-    }
-
-    if (buffer.Size()) {
-      if (!SendDMX(buffer)) {
-        OLA_WARN << "Send failed, stopping thread...";
-        break;
-      }
-    } else {
-      // sleep for a bit
-      usleep(40000);
-    }
-  }
-  libusb_release_interface(m_usb_handle, 0);
-  libusb_close(m_usb_handle);
-  return NULL;
-}
-
-
-/*
- * Store the data in the shared buffer
+ * Send the frame, or queue it if a transfer is in progress.
  */
 bool AnymaOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
-  ola::thread::MutexLocker locker(&m_data_mutex);
-  m_buffer.Set(buffer);
-  return true;
+  return SendDMX(buffer);
   (void) priority;
 }
 
 
 /*
- * Send the dmx out the widget
- * @return true on success, false on failure
+ * Pack the dmx data into a control transfer and submit it.
+ * @return true if the transfer was submitted
  */
-bool AnymaOutputPort::SendDMX(const DmxBuffer &buffer) {
-  int r = libusb_control_transfer(m_usb_handle,
-          LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE |
-          LIBUSB_ENDPOINT_OUT,
-          UDMX_SET_CHANNEL_RANGE,
-          buffer.Size(),
-          0,
-          // the suck
-          const_cast<unsigned char*>(buffer.GetRaw()),
-          buffer.Size(),
-          URB_TIMEOUT_MS);
-
-  // Sometimes we get PIPE errors here, those are non-fatal
-  return r > 0 || r == LIBUSB_ERROR_PIPE || r == LIBUSB_ERROR_OTHER;
+bool AnymaOutputPort::PerformTransfer(const DmxBuffer &buffer) {
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  if (!buffer.Size())
+    return false;
+
+  buffer.Get(m_control_buffer + LIBUSB_CONTROL_SETUP_SIZE, &length);
+  libusb_fill_control_setup(
+      m_control_buffer,
+      LIBUSB_REQUEST_TYPE_VENDOR | LIBUSB_RECIPIENT_DEVICE |
+      LIBUSB_ENDPOINT_OUT,
+      UDMX_SET_CHANNEL_RANGE,
+      length,
+      0,
+      length);
+  FillControlTransfer(m_control_buffer, URB_TIMEOUT_MS);
+  return SubmitTransfer();
 }
 
 
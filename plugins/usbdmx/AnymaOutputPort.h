@@ -17,19 +17,19 @@
  * The output port for a Anyma device.
  * Copyright (C) 2010 Simon Newton
  *
- * It takes around 21ms to send one universe of data. so we do this in a
- * separate thread.
+ * It takes around 21ms to send one universe of data so we use an
+ * asynchronous control transfer.
  */
 
 #ifndef PLUGINS_USBDMX_ANYMAOUTPUTPORT_H_
 #define PLUGINS_USBDMX_ANYMAOUTPUTPORT_H_
 
 #include <libusb.h>
-#include <pthread.h>
 #include <string>
+#include "ola/BaseTypes.h"
 #include "ola/DmxBuffer.h"
-#include "ola/thread/Thread.h"
 #include "olad/Port.h"
+#include "plugins/usbdmx/AsyncUsbSender.h"
 
 namespace ola {
 namespace plugin {
@@ -37,7 +37,7 @@ namespace usbdmx {
 
 class AnymaDevice;
 
-class AnymaOutputPort: public BasicOutputPort, ola::thread::Thread {
+class AnymaOutputPort: public BasicOutputPort, AsyncUsbSender {
   public:
     AnymaOutputPort(AnymaDevice *parent,
                     unsigned int id,
@@ -47,7 +47,6 @@ class AnymaOutputPort: public BasicOutputPort, ola::thread::Thread {
     string SerialNumber() const { return m_serial; }
 
     bool Start();
-    void *Run();
 
     bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
     string Description() const { return ""; }
@@ -56,14 +55,10 @@ class AnymaOutputPort: public BasicOutputPort, ola::thread::Thread {
     static const unsigned int URB_TIMEOUT_MS = 500;
     static const unsigned int UDMX_SET_CHANNEL_RANGE = 0x0002;
 
-    bool m_term;
     string m_serial;
-    libusb_device_handle *m_usb_handle;
-    DmxBuffer m_buffer;
-    ola::thread::Mutex m_data_mutex;
-    ola::thread::Mutex m_term_mutex;
+    uint8_t m_control_buffer[LIBUSB_CONTROL_SETUP_SIZE + DMX_UNIVERSE_SIZE];
 
-    bool SendDMX(const DmxBuffer &buffer_old);
+    bool PerformTransfer(const DmxBuffer &buffer);
     bool GetDescriptorString(libusb_device_handle *usb_handle,
                              uint8_t desc_index,
                              string *data);
@@ -0,0 +1,211 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * AsyncUsbSender.cpp
+ * The base class for output ports that use asynchronous libusb transfers.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include "ola/Logging.h"
+#include "plugins/usbdmx/AsyncUsbSender.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+using ola::thread::MutexLocker;
+
+
+AsyncUsbSender::AsyncUsbSender()
+    : m_usb_handle(NULL),
+      m_transfer(NULL),
+      m_interface_number(0),
+      m_transfer_state(IDLE),
+      m_stopping(false),
+      m_pending_tx(false) {
+}
+
+
+/*
+ * Cancel any in-flight transfer and release the device.
+ */
+AsyncUsbSender::~AsyncUsbSender() {
+  CancelTransfer();
+  if (m_transfer)
+    libusb_free_transfer(m_transfer);
+  if (m_usb_handle) {
+    libusb_release_interface(m_usb_handle, m_interface_number);
+    libusb_close(m_usb_handle);
+  }
+}
+
+
+/*
+ * Send a frame. If a transfer is already in flight the frame is queued and
+ * replaces any frame that was queued before it.
+ * @returns false if the device has gone away, true otherwise.
+ */
+bool AsyncUsbSender::SendDMX(const DmxBuffer &buffer) {
+  MutexLocker locker(&m_mutex);
+  if (!m_transfer || m_stopping)
+    return false;
+
+  switch (m_transfer_state) {
+    case IDLE:
+      PerformTransfer(buffer);
+      break;
+    case IN_PROGRESS:
+      m_pending_buffer.Set(buffer);
+      m_pending_tx = true;
+      break;
+    case DISCONNECTED:
+      return false;
+  }
+  return m_transfer_state != DISCONNECTED;
+}
+
+
+/*
+ * Take ownership of a claimed usb handle and allocate the transfer.
+ * @param usb_handle the claimed handle, this is released & closed when the
+ *   sender is destroyed, even if Attach() fails.
+ * @param interface_number the interface that was claimed.
+ * @returns true if the transfer was allocated.
+ */
+bool AsyncUsbSender::Attach(libusb_device_handle *usb_handle,
+                            int interface_number) {
+  m_usb_handle = usb_handle;
+  m_interface_number = interface_number;
+  m_transfer = libusb_alloc_transfer(0);
+  if (!m_transfer) {
+    OLA_WARN << "Failed to allocate libusb transfer";
+    return false;
+  }
+  return true;
+}
+
+
+/*
+ * Cancel the in-flight transfer, if any, and block until the completion
+ * callback has run. Sub classes must call this from their destructor since
+ * the callback may use their state.
+ */
+void AsyncUsbSender::CancelTransfer() {
+  MutexLocker locker(&m_mutex);
+  m_stopping = true;
+  m_pending_tx = false;
+  if (m_transfer_state != IN_PROGRESS)
+    return;
+
+  libusb_cancel_transfer(m_transfer);
+  while (m_transfer_state == IN_PROGRESS)
+    m_condition.Wait(&m_mutex);
+}
+
+
+/*
+ * Fill m_transfer as a control transfer. The buffer must start with a setup
+ * packet, see libusb_fill_control_setup().
+ */
+void AsyncUsbSender::FillControlTransfer(unsigned char *buffer,
+                                         unsigned int timeout) {
+  libusb_fill_control_transfer(m_transfer, m_usb_handle, buffer,
+                               &AsyncCallback, this, timeout);
+}
+
+
+/*
+ * Fill m_transfer as a bulk transfer.
+ */
+void AsyncUsbSender::FillBulkTransfer(unsigned char endpoint,
+                                      unsigned char *buffer,
+                                      int length,
+                                      unsigned int timeout) {
+  libusb_fill_bulk_transfer(m_transfer, m_usb_handle, endpoint, buffer,
+                            length, &AsyncCallback, this, timeout);
+}
+
+
+/*
+ * Fill m_transfer as an interrupt transfer.
+ */
+void AsyncUsbSender::FillInterruptTransfer(unsigned char endpoint,
+                                           unsigned char *buffer,
+                                           int length,
+                                           unsigned int timeout) {
+  libusb_fill_interrupt_transfer(m_transfer, m_usb_handle, endpoint, buffer,
+                                 length, &AsyncCallback, this, timeout);
+}
+
+
+/*
+ * Submit m_transfer. This must be called with the lock held, which is the
+ * case from within PerformTransfer() & ContinueTransfer().
+ * @returns true if the transfer was submitted.
+ */
+bool AsyncUsbSender::SubmitTransfer() {
+  int ret = libusb_submit_transfer(m_transfer);
+  if (ret) {
+    OLA_WARN << "libusb_submit_transfer returned " << libusb_error_name(ret);
+    if (ret == LIBUSB_ERROR_NO_DEVICE)
+      m_transfer_state = DISCONNECTED;
+    return false;
+  }
+  m_transfer_state = IN_PROGRESS;
+  return true;
+}
+
+
+/*
+ * Called in the libusb thread when a transfer completes.
+ */
+void AsyncUsbSender::TransferComplete(libusb_transfer *transfer) {
+  MutexLocker locker(&m_mutex);
+  if (transfer->status != LIBUSB_TRANSFER_COMPLETED &&
+      transfer->status != LIBUSB_TRANSFER_CANCELLED) {
+    OLA_INFO << "USB transfer failed with status " << transfer->status
+             << ", transferred " << transfer->actual_length;
+  }
+
+  if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE) {
+    OLA_WARN << "USB device was removed";
+    m_transfer_state = DISCONNECTED;
+    m_condition.Signal();
+    return;
+  }
+
+  m_transfer_state = IDLE;
+  if (!m_stopping) {
+    if (transfer->status == LIBUSB_TRANSFER_COMPLETED && ContinueTransfer())
+      return;
+
+    if (m_pending_tx) {
+      m_pending_tx = false;
+      PerformTransfer(m_pending_buffer);
+    }
+  }
+
+  if (m_transfer_state != IN_PROGRESS)
+    m_condition.Signal();
+}
+
+
+void AsyncUsbSender::AsyncCallback(libusb_transfer *transfer) {
+  AsyncUsbSender *sender = static_cast<AsyncUsbSender*>(transfer->user_data);
+  sender->TransferComplete(transfer);
+}
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,100 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * AsyncUsbSender.h
+ * The base class for output ports that use asynchronous libusb transfers.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * Rather than running a thread per port, each port owns a single
+ * libusb_transfer which is submitted from WriteDMX(). Completion callbacks
+ * run on the LibUsbThread. If a new frame arrives while a transfer is in
+ * flight it's held as pending and submitted as soon as the current transfer
+ * completes, so only the most recent frame is ever sent.
+ */
+
+#ifndef PLUGINS_USBDMX_ASYNCUSBSENDER_H_
+#define PLUGINS_USBDMX_ASYNCUSBSENDER_H_
+
+#include <libusb.h>
+#include "ola/DmxBuffer.h"
+#include "ola/thread/Mutex.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+class AsyncUsbSender {
+  public:
+    AsyncUsbSender();
+    virtual ~AsyncUsbSender();
+
+    bool SendDMX(const DmxBuffer &buffer);
+
+  protected:
+    libusb_device_handle *m_usb_handle;
+    libusb_transfer *m_transfer;
+
+    bool Attach(libusb_device_handle *usb_handle, int interface_number);
+    void CancelTransfer();
+
+    void FillControlTransfer(unsigned char *buffer, unsigned int timeout);
+    void FillBulkTransfer(unsigned char endpoint,
+                          unsigned char *buffer,
+                          int length,
+                          unsigned int timeout);
+    void FillInterruptTransfer(unsigned char endpoint,
+                               unsigned char *buffer,
+                               int length,
+                               unsigned int timeout);
+    bool SubmitTransfer();
+
+    /*
+     * Pack the buffer into m_transfer and submit it. This is called with the
+     * internal lock held.
+     * @returns true if the transfer was submitted.
+     */
+    virtual bool PerformTransfer(const DmxBuffer &buffer) = 0;
+
+    /*
+     * Called with the lock held once a transfer completes successfully.
+     * Senders that split a frame into multiple transfers can submit the next
+     * one here.
+     * @returns true if another transfer was submitted.
+     */
+    virtual bool ContinueTransfer() { return false; }
+
+  private:
+    typedef enum {
+      IDLE,
+      IN_PROGRESS,
+      DISCONNECTED
+    } TransferState;
+
+    int m_interface_number;
+    TransferState m_transfer_state;
+    bool m_stopping;
+    bool m_pending_tx;
+    DmxBuffer m_pending_buffer;
+    ola::thread::Mutex m_mutex;
+    ola::thread::ConditionVariable m_condition;
+
+    void TransferComplete(libusb_transfer *transfer);
+
+    static void AsyncCallback(libusb_transfer *transfer);
+};
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBDMX_ASYNCUSBSENDER_H_
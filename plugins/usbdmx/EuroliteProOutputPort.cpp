@@ -47,10 +47,9 @@ EuroliteProOutputPort::EuroliteProOutputPort(EuroliteProDevice *parent,
                                              unsigned int id,
                                              libusb_device *usb_device)
     : BasicOutputPort(parent, id),
-      m_term(false),
+      m_interface_number(0),
       m_serial(""),
-      m_usb_device(usb_device),
-      m_usb_handle(NULL) {
+      m_usb_device(usb_device) {
 }
 
 
@@ -58,16 +57,12 @@ EuroliteProOutputPort::EuroliteProOutputPort(EuroliteProDevice *parent,
  * Cleanup
  */
 EuroliteProOutputPort::~EuroliteProOutputPort() {
-  {
-    ola::thread::MutexLocker locker(&m_term_mutex);
-    m_term = true;
-  }
-  Join();
+  CancelTransfer();
 }
 
 
 /*
- * Start this thread
+ * Open & claim the device.
  */
 bool EuroliteProOutputPort::Start() {
   libusb_device_handle *usb_handle;
@@ -141,98 +136,41 @@ bool EuroliteProOutputPort::Start() {
     return false;
   }
 
-  m_usb_handle = usb_handle;
-  bool ret = ola::thread::Thread::Start();
-  if (!ret) {
-    OLA_WARN << "pthread create failed";
-    libusb_release_interface(m_usb_handle, m_interface_number);
-    libusb_close(usb_handle);
-    return false;
-  }
-  return true;
-}
-
-
-/*
- * The main loop for the sender thread.
- */
-void *EuroliteProOutputPort::Run() {
-  DmxBuffer buffer;
-
-  if (!m_usb_handle)
-    return NULL;
-
-  while (1) {
-    {
-      ola::thread::MutexLocker locker(&m_term_mutex);
-      if (m_term)
-        break;
-    }
-
-    {
-      ola::thread::MutexLocker locker(&m_data_mutex);
-      buffer.Set(m_buffer);
-    }
-
-    if (buffer.Size()) {
-      if (!SendDMX(buffer)) {
-        OLA_WARN << "Send bufferfailed, stopping thread...";
-        break;
-      }
-    } else {
-      // sleep for a bit
-      usleep(40000);
-    }
-  }
-  libusb_release_interface(m_usb_handle, m_interface_number);
-  libusb_close(m_usb_handle);
-  return NULL;
+  return Attach(usb_handle, m_interface_number);
 }
 
 
 /*
- * Store the data in the shared buffer
+ * Send the frame, or queue it if a transfer is in progress.
  */
 bool EuroliteProOutputPort::WriteDMX(const DmxBuffer &buffer,
                                      uint8_t priority) {
-  ola::thread::MutexLocker locker(&m_data_mutex);
-  m_buffer.Set(buffer);
-  return true;
+  return SendDMX(buffer);
   (void) priority;
 }
 
 
 /*
- * Send the dmx out the widget
- * @return true on success, false on failure
+ * Pack the dmx data into a frame and submit the transfer.
+ * @return true if the transfer was submitted
  */
-bool EuroliteProOutputPort::SendDMX(const DmxBuffer &buffer) {
-  uint8_t usb_data[FRAME_SIZE];
+bool EuroliteProOutputPort::PerformTransfer(const DmxBuffer &buffer) {
   unsigned int frame_size = buffer.Size();
+  if (!frame_size)
+    return false;
 
   // header
-  usb_data[0] = 0x7E;   // Start message delimiter
-  usb_data[1] = DMX_LABEL;      // Label
-  usb_data[4] = DMX512_START_CODE;
-  buffer.Get(usb_data + 5, &frame_size);
-  usb_data[2] = (DMX_UNIVERSE_SIZE + 1) & 0xff;  // Data length LSB.
-  usb_data[3] = ((DMX_UNIVERSE_SIZE + 1) >> 8);  // Data length MSB
-  memset(usb_data + 5 + frame_size, 0, DMX_UNIVERSE_SIZE - frame_size);
-  usb_data[FRAME_SIZE - 1] =  0xE7;  // End message delimiter
-
-  int transferred = 0;
-  int ret = libusb_bulk_transfer(
-        m_usb_handle,
-        ENDPOINT,
-        usb_data,
-        FRAME_SIZE,
-        &transferred,
-        URB_TIMEOUT_MS);
-
-  if (ret)
-    OLA_INFO << "return code was: " << ret << ", transferred bytes  " <<
-      transferred;
-  return ret == 0;
+  m_frame[0] = 0x7E;   // Start message delimiter
+  m_frame[1] = DMX_LABEL;      // Label
+  m_frame[4] = DMX512_START_CODE;
+  buffer.Get(m_frame + 5, &frame_size);
+  m_frame[2] = (DMX_UNIVERSE_SIZE + 1) & 0xff;  // Data length LSB.
+  m_frame[3] = ((DMX_UNIVERSE_SIZE + 1) >> 8);  // Data length MSB
+  memset(m_frame + 5 + frame_size, 0, DMX_UNIVERSE_SIZE - frame_size);
+  m_frame[FRAME_SIZE - 1] =  0xE7;  // End message delimiter
+
+  FillBulkTransfer(ENDPOINT, m_frame, FRAME_SIZE, URB_TIMEOUT_MS);
+  return SubmitTransfer();
 }
 
 
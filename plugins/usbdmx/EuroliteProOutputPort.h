@@ -25,15 +25,15 @@
 #include <libusb.h>
 #include <string>
 #include "ola/DmxBuffer.h"
-#include "ola/thread/Thread.h"
 #include "olad/Port.h"
+#include "plugins/usbdmx/AsyncUsbSender.h"
 
 namespace ola {
 namespace plugin {
 namespace usbdmx {
 
 
-class EuroliteProOutputPort: public BasicOutputPort, ola::thread::Thread {
+class EuroliteProOutputPort: public BasicOutputPort, AsyncUsbSender {
   public:
     EuroliteProOutputPort(class EuroliteProDevice *parent,
                           unsigned int id,
@@ -42,7 +42,6 @@ class EuroliteProOutputPort: public BasicOutputPort, ola::thread::Thread {
     string SerialNumber() const { return m_serial; }
 
     bool Start();
-    void *Run();
 
     bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
     string Description() const { return ""; }
@@ -55,25 +54,21 @@ class EuroliteProOutputPort: public BasicOutputPort, ola::thread::Thread {
     static const char EXPECTED_PRODUCT[];
     static const uint8_t DMX_LABEL = 6;
 
-    bool m_term;
+    // 513 + header + code + size(2) + footer
+    enum { FRAME_SIZE = 518 };
+
     int m_interface_number;
     string m_serial;
 
     libusb_device *m_usb_device;
-    libusb_device_handle *m_usb_handle;
-    DmxBuffer m_buffer;
-    ola::thread::Mutex m_data_mutex;
-    ola::thread::Mutex m_term_mutex;
+    uint8_t m_frame[FRAME_SIZE];
 
-    bool SendDMX(const DmxBuffer &buffer_old);
+    bool PerformTransfer(const DmxBuffer &buffer);
 
     bool GetDescriptorString(libusb_device_handle *usb_handle,
                              uint8_t desc_index,
                              string *data);
     bool LocateInterface();
-
-    // 513 + header + code + size(2) + footer
-    enum { FRAME_SIZE = 518 };
 };
 }  // namespace usbdmx
 }  // namespace plugin
@@ -0,0 +1,64 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * LibUsbThread.cpp
+ * The thread that runs the libusb event loop.
+ * Copyright (C) 2013 Simon Newton
+ */
+
+#include <sys/time.h>
+#include "ola/Logging.h"
+#include "plugins/usbdmx/LibUsbThread.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+
+/*
+ * Stop the event loop and wait for the thread to exit. All devices should
+ * be closed before this is called.
+ */
+bool LibUsbThread::Terminate() {
+  {
+    ola::thread::MutexLocker locker(&m_term_mutex);
+    m_term = true;
+  }
+  return Join();
+}
+
+
+/*
+ * Handle libusb events until we're told to stop.
+ */
+void *LibUsbThread::Run() {
+  OLA_DEBUG << "libusb event thread started";
+  while (true) {
+    {
+      ola::thread::MutexLocker locker(&m_term_mutex);
+      if (m_term)
+        break;
+    }
+    struct timeval tv;
+    tv.tv_sec = EVENT_TIMEOUT_MS / 1000;
+    tv.tv_usec = (EVENT_TIMEOUT_MS % 1000) * 1000;
+    libusb_handle_events_timeout(m_context, &tv);
+  }
+  OLA_DEBUG << "libusb event thread exiting";
+  return NULL;
+}
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
@@ -0,0 +1,58 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ * LibUsbThread.h
+ * The thread that runs the libusb event loop.
+ * Copyright (C) 2013 Simon Newton
+ *
+ * All asynchronous transfers, and hence all completion callbacks, are
+ * handled by this single thread.
+ */
+
+#ifndef PLUGINS_USBDMX_LIBUSBTHREAD_H_
+#define PLUGINS_USBDMX_LIBUSBTHREAD_H_
+
+#include <libusb.h>
+#include "ola/thread/Mutex.h"
+#include "ola/thread/Thread.h"
+
+namespace ola {
+namespace plugin {
+namespace usbdmx {
+
+class LibUsbThread: public ola::thread::Thread {
+  public:
+    explicit LibUsbThread(libusb_context *context)
+        : m_context(context),
+          m_term(false) {
+    }
+    ~LibUsbThread() {}
+
+    bool Terminate();
+    void *Run();
+
+  private:
+    libusb_context *m_context;
+    bool m_term;
+    ola::thread::Mutex m_term_mutex;
+
+    // Closing a device wakes the event loop, this just bounds how long we
+    // take to exit when no devices were ever opened.
+    static const unsigned int EVENT_TIMEOUT_MS = 500;
+};
+}  // namespace usbdmx
+}  // namespace plugin
+}  // namespace ola
+#endif  // PLUGINS_USBDMX_LIBUSBTHREAD_H_
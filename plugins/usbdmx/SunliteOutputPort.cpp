@@ -40,10 +40,7 @@ SunliteOutputPort::SunliteOutputPort(SunliteDevice *parent,
                                      unsigned int id,
                                      libusb_device *usb_device)
     : BasicOutputPort(parent, id),
-      m_term(false),
-      m_new_data(false),
-      m_usb_device(usb_device),
-      m_usb_handle(NULL) {
+      m_usb_device(usb_device) {
   InitPacket();
 }
 
@@ -52,16 +49,12 @@ SunliteOutputPort::SunliteOutputPort(SunliteDevice *parent,
  * Cleanup
  */
 SunliteOutputPort::~SunliteOutputPort() {
-  {
-    ola::thread::MutexLocker locker(&m_term_mutex);
-    m_term = true;
-  }
-  Join();
+  CancelTransfer();
 }
 
 
 /*
- * Start this thread
+ * Open & claim the device.
  */
 bool SunliteOutputPort::Start() {
   libusb_device_handle *usb_handle;
@@ -76,67 +69,15 @@ bool SunliteOutputPort::Start() {
     libusb_close(usb_handle);
     return false;
   }
-
-  m_usb_handle = usb_handle;
-  bool ret = ola::thread::Thread::Start();
-  if (!ret) {
-    OLA_WARN << "pthread create failed";
-    libusb_release_interface(m_usb_handle, 0);
-    libusb_close(usb_handle);
-    return false;
-  }
-  return true;
-}
-
-
-/*
- * Run this thread
- */
-void *SunliteOutputPort::Run() {
-  DmxBuffer buffer;
-  bool new_data;
-
-  if (!m_usb_handle)
-    return NULL;
-
-  while (true) {
-    {
-      ola::thread::MutexLocker locker(&m_term_mutex);
-      if (m_term)
-        break;
-    }
-
-    {
-      ola::thread::MutexLocker locker(&m_data_mutex);
-      buffer.Set(m_buffer);
-      new_data = m_new_data;
-      m_new_data = false;
-    }
-
-    if (new_data) {
-      if (!SendDMX(buffer)) {
-        OLA_WARN << "Send failed, stopping thread...";
-        break;
-      }
-    } else {
-      // sleep for a bit
-      usleep(40000);
-    }
-  }
-  libusb_release_interface(m_usb_handle, 0);
-  libusb_close(m_usb_handle);
-  return NULL;
+  return Attach(usb_handle, 0);
 }
 
 
 /*
- * Store the data in the shared buffer
+ * Send the frame, or queue it if a transfer is in progress.
  */
 bool SunliteOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
-  ola::thread::MutexLocker locker(&m_data_mutex);
-  m_buffer.Set(buffer);
-  m_new_data = true;
-  return true;
+  return SendDMX(buffer);
   (void) priority;
 }
 
@@ -177,25 +118,15 @@ void SunliteOutputPort::InitPacket() {
 
 
 /*
- * Send DMX to the widget
+ * Pack the DMX data into the packet and submit the transfer.
  */
-bool SunliteOutputPort::SendDMX(const DmxBuffer &buffer) {
+bool SunliteOutputPort::PerformTransfer(const DmxBuffer &buffer) {
   for (unsigned int i = 0; i < buffer.Size(); i++)
     m_packet[(i / CHANNELS_PER_CHUNK) * CHUNK_SIZE +
              ((i / 4) % 5) * 6 + 3 + (i % 4)] = buffer.Get(i);
 
-  int transferred;
-  int r = libusb_bulk_transfer(
-      m_usb_handle,
-      ENDPOINT,
-      (unsigned char*) m_packet,
-      SUNLITE_PACKET_SIZE,
-      &transferred,
-      TIMEOUT);
-  if (transferred != SUNLITE_PACKET_SIZE)
-    // not sure if this is fatal or not
-    OLA_WARN << "Sunlite driver failed to transfer all data";
-  return r == 0;
+  FillBulkTransfer(ENDPOINT, m_packet, SUNLITE_PACKET_SIZE, TIMEOUT);
+  return SubmitTransfer();
 }
 }  // namespace usbdmx
 }  // namespace plugin
@@ -26,11 +26,10 @@
 #define PLUGINS_USBDMX_SUNLITEOUTPUTPORT_H_
 
 #include <libusb.h>
-#include <pthread.h>
 #include <string>
 #include "ola/DmxBuffer.h"
-#include "ola/thread/Thread.h"
 #include "olad/Port.h"
+#include "plugins/usbdmx/AsyncUsbSender.h"
 
 namespace ola {
 namespace plugin {
@@ -38,7 +37,7 @@ namespace usbdmx {
 
 class SunliteDevice;
 
-class SunliteOutputPort: public BasicOutputPort, ola::thread::Thread {
+class SunliteOutputPort: public BasicOutputPort, AsyncUsbSender {
   public:
     SunliteOutputPort(SunliteDevice *parent,
                       unsigned int id,
@@ -46,7 +45,6 @@ class SunliteOutputPort: public BasicOutputPort, ola::thread::Thread {
     ~SunliteOutputPort();
 
     bool Start();
-    void *Run();
 
     bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
     string Description() const { return ""; }
@@ -60,17 +58,11 @@ class SunliteOutputPort: public BasicOutputPort, ola::thread::Thread {
     static const uint8_t ENDPOINT = 1;
     static const unsigned int TIMEOUT = 50;  // 50ms is ok
 
-    bool m_term;
-    bool m_new_data;
     uint8_t m_packet[SUNLITE_PACKET_SIZE];
     libusb_device *m_usb_device;
-    libusb_device_handle *m_usb_handle;
-    DmxBuffer m_buffer;
-    ola::thread::Mutex m_data_mutex;
-    ola::thread::Mutex m_term_mutex;
 
     void InitPacket();
-    bool SendDMX(const DmxBuffer &buffer);
+    bool PerformTransfer(const DmxBuffer &buffer);
 };
 }  // namespace usbdmx
 }  // namespace plugin
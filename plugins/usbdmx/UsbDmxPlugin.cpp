@@ -37,6 +37,7 @@
 #include "plugins/usbdmx/AnymaDevice.h"
 #include "plugins/usbdmx/EuroliteProDevice.h"
 #include "plugins/usbdmx/FirmwareLoader.h"
+#include "plugins/usbdmx/LibUsbThread.h"
 #include "plugins/usbdmx/SunliteDevice.h"
 #include "plugins/usbdmx/SunliteFirmwareLoader.h"
 #include "plugins/usbdmx/UsbDevice.h"
@@ -96,6 +97,15 @@ bool UsbDmxPlugin::StartHook() {
   OLA_DEBUG << "libusb debug level set to " << debug_level;
   libusb_set_debug(NULL, debug_level);
 
+  m_usb_thread = new LibUsbThread(NULL);
+  if (!m_usb_thread->Start()) {
+    OLA_WARN << "Failed to start the libusb thread";
+    delete m_usb_thread;
+    m_usb_thread = NULL;
+    libusb_exit(NULL);
+    return false;
+  }
+
   if (LoadFirmware()) {
     // we loaded firmware for at least one device, set up a callback to run in
     // a couple of seconds to re-scan for devices
@@ -229,6 +239,13 @@ bool UsbDmxPlugin::StopHook() {
   m_devices.clear();
   m_registered_devices.clear();
 
+  // all transfers have completed now so we can stop the event thread
+  if (m_usb_thread) {
+    m_usb_thread->Terminate();
+    delete m_usb_thread;
+    m_usb_thread = NULL;
+  }
+
   libusb_exit(NULL);
 
   if (!m_descriptors.empty()) {
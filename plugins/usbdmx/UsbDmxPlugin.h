@@ -40,7 +40,8 @@ class UsbDmxPlugin: public ola::Plugin {
   public:
     explicit UsbDmxPlugin(PluginAdaptor *plugin_adaptor):
       Plugin(plugin_adaptor),
-      m_anyma_devices_missing_serial_numbers(false) {
+      m_anyma_devices_missing_serial_numbers(false),
+      m_usb_thread(NULL) {
     }
 
     string Name() const { return PLUGIN_NAME; }
@@ -62,6 +63,7 @@ class UsbDmxPlugin: public ola::Plugin {
     bool m_anyma_devices_missing_serial_numbers;
     vector<class UsbDevice*> m_devices;  // list of our devices
     vector<ola::io::DeviceDescriptor*> m_descriptors;
+    class LibUsbThread *m_usb_thread;
     set<std::pair<uint8_t, uint8_t> > m_registered_devices;
 
     bool StartHook();
@@ -44,10 +44,9 @@ VellemanOutputPort::VellemanOutputPort(VellemanDevice *parent,
                                        unsigned int id,
                                        libusb_device *usb_device)
     : BasicOutputPort(parent, id),
-      m_term(false),
       m_chunk_size(8),  // the standard unit uses 8
       m_usb_device(usb_device),
-      m_usb_handle(NULL) {
+      m_next_chunk(0) {
 }
 
 
@@ -55,16 +54,12 @@ VellemanOutputPort::VellemanOutputPort(VellemanDevice *parent,
  * Cleanup
  */
 VellemanOutputPort::~VellemanOutputPort() {
-  {
-    ola::thread::MutexLocker locker(&m_term_mutex);
-    m_term = true;
-  }
-  Join();
+  CancelTransfer();
 }
 
 
 /*
- * Start this thread
+ * Open & claim the device.
  */
 bool VellemanOutputPort::Start() {
   libusb_device_handle *usb_handle;
@@ -119,61 +114,15 @@ bool VellemanOutputPort::Start() {
     return false;
   }
 
-  m_usb_handle = usb_handle;
-  bool ret = ola::thread::Thread::Start();
-  if (!ret) {
-    OLA_WARN << "pthread create failed";
-    libusb_release_interface(m_usb_handle, INTERFACE);
-    libusb_close(usb_handle);
-    return false;
-  }
-  return true;
+  return Attach(usb_handle, INTERFACE);
 }
 
 
 /*
- * Run this thread
- */
-void *VellemanOutputPort::Run() {
-  DmxBuffer buffer;
-  if (!m_usb_handle)
-    return NULL;
-
-  while (1) {
-    {
-      ola::thread::MutexLocker locker(&m_term_mutex);
-      if (m_term)
-        break;
-    }
-
-    {
-      ola::thread::MutexLocker locker(&m_data_mutex);
-      buffer.Set(m_buffer);
-    }
-
-    if (buffer.Size()) {
-      if (!SendDMX(buffer)) {
-        OLA_WARN << "Send failed, stopping thread...";
-        break;
-      }
-    } else {
-      // sleep for a bit
-      usleep(40000);
-    }
-  }
-  libusb_release_interface(m_usb_handle, 0);
-  libusb_close(m_usb_handle);
-  return NULL;
-}
-
-
-/*
- * Store the data in the shared buffer
+ * Send the frame, or queue it if a transfer is in progress.
  */
 bool VellemanOutputPort::WriteDMX(const DmxBuffer &buffer, uint8_t priority) {
-  ola::thread::MutexLocker locker(&m_data_mutex);
-  m_buffer.Set(buffer);
-  return true;
+  return SendDMX(buffer);
   (void) priority;
 }
 
@@ -190,11 +139,33 @@ string VellemanOutputPort::Description() const {
 
 
 /*
- * Send the dmx out the widget
- * @return true on success, false on failure
+ * Encode the frame and submit the first chunk.
+ * @return true if the transfer was submitted
+ */
+bool VellemanOutputPort::PerformTransfer(const DmxBuffer &buffer) {
+  if (!buffer.Size())
+    return false;
+
+  EncodeFrame(buffer);
+  m_next_chunk = 0;
+  return SubmitNextChunk();
+}
+
+
+/*
+ * Called when a chunk has been sent, move onto the next one.
+ * @return true if there was another chunk to send.
+ */
+bool VellemanOutputPort::ContinueTransfer() {
+  return SubmitNextChunk();
+}
+
+
+/*
+ * Encode a frame into the sequence of chunks we need to send.
  */
-bool VellemanOutputPort::SendDMX(const DmxBuffer &buffer) {
-  unsigned char usb_data[m_chunk_size];
+void VellemanOutputPort::EncodeFrame(const DmxBuffer &buffer) {
+  uint8_t usb_data[UPGRADED_CHUNK_SIZE];
   unsigned int size = buffer.Size();
   const uint8_t *data = buffer.GetRaw();
   unsigned int i = 0;
@@ -209,6 +180,7 @@ bool VellemanOutputPort::SendDMX(const DmxBuffer &buffer) {
   unsigned int channel_count = m_chunk_size - 1;
 
   memset(usb_data, 0, sizeof(usb_data));
+  m_frame.clear();
 
   if (m_chunk_size == UPGRADED_CHUNK_SIZE && size <= m_chunk_size - 2) {
     // if the upgrade is present and we can fit the data in a single packet
@@ -229,8 +201,7 @@ bool VellemanOutputPort::SendDMX(const DmxBuffer &buffer) {
     i += n + compressed_channel_count;
   }
 
-  if (!SendDataChunk(usb_data))
-    return false;
+  AppendChunk(usb_data);
 
   while (i < size - channel_count) {
     for (n = 0;
@@ -249,8 +220,7 @@ bool VellemanOutputPort::SendDMX(const DmxBuffer &buffer) {
       memcpy(usb_data + 1, data + i, channel_count);
       i += channel_count;
     }
-    if (!SendDataChunk(usb_data))
-      return false;
+    AppendChunk(usb_data);
   }
 
   // send the last channels
@@ -260,39 +230,41 @@ bool VellemanOutputPort::SendDMX(const DmxBuffer &buffer) {
     usb_data[0] = 6;
     usb_data[1] = size - i;
     memcpy(usb_data + 2, data + i, size - i);
-    if (!SendDataChunk(usb_data))
-      return false;
+    AppendChunk(usb_data);
 
   } else {
     // else we use the 3 message type to send one at a time
     for (; i != size; i++) {
       usb_data[0] = 3;
       usb_data[1] = data[i];
-      if (!SendDataChunk(usb_data))
-        return false;
+      AppendChunk(usb_data);
     }
   }
-  return true;
 }
 
 
 /*
- * Send 8 bytes to the usb device
- * @returns false if there was an error, true otherwise
+ * Add a chunk to the end of the encoded frame.
  */
-bool VellemanOutputPort::SendDataChunk(uint8_t *usb_data) {
-  int transferred;
-  int ret = libusb_interrupt_transfer(
-      m_usb_handle,
-      ENDPOINT,
-      reinterpret_cast<unsigned char*>(usb_data),
-      m_chunk_size,
-      &transferred,
-      URB_TIMEOUT_MS);
-  if (ret)
-    OLA_INFO << "USB return code was " << ret << ", transferred " <<
-      transferred;
-  return ret == 0;
+void VellemanOutputPort::AppendChunk(const uint8_t *usb_data) {
+  m_frame.insert(m_frame.end(), usb_data, usb_data + m_chunk_size);
+}
+
+
+/*
+ * Submit the next chunk of the encoded frame.
+ * @returns true if a chunk was submitted, false if there are no chunks left
+ *   or the submit failed.
+ */
+bool VellemanOutputPort::SubmitNextChunk() {
+  unsigned int offset = m_next_chunk * m_chunk_size;
+  if (offset >= m_frame.size())
+    return false;
+
+  FillInterruptTransfer(ENDPOINT, &m_frame[offset], m_chunk_size,
+                        URB_TIMEOUT_MS);
+  m_next_chunk++;
+  return SubmitTransfer();
 }
 }  // namespace usbdmx
 }  // namespace plugin
@@ -17,9 +17,10 @@
  * The output port for a Velleman 8062 device.
  * Copyright (C) 2010 Simon Newton
  *
- * Because this interface is so slow we run the output in a separate thread. It
- * takes around 8ms to respond to an urb and in the worst case we send 74 urbs
- * per universe.
+ * This interface is slow, it takes around 8ms to respond to an urb and in the
+ * worst case we send 74 urbs per universe. Each frame is encoded into chunks
+ * up front and the chunks are sent as a chain of asynchronous interrupt
+ * transfers.
  *
  * It would be interesting to see if you can pipeline the urbs to improve the
  * performance.
@@ -29,11 +30,11 @@
 #define PLUGINS_USBDMX_VELLEMANOUTPUTPORT_H_
 
 #include <libusb.h>
-#include <pthread.h>
 #include <string>
+#include <vector>
 #include "ola/DmxBuffer.h"
-#include "ola/thread/Thread.h"
 #include "olad/Port.h"
+#include "plugins/usbdmx/AsyncUsbSender.h"
 
 namespace ola {
 namespace plugin {
@@ -41,7 +42,7 @@ namespace usbdmx {
 
 class VellemanDevice;
 
-class VellemanOutputPort: public BasicOutputPort, ola::thread::Thread {
+class VellemanOutputPort: public BasicOutputPort, AsyncUsbSender {
   public:
     VellemanOutputPort(VellemanDevice *parent,
                        unsigned int id,
@@ -49,7 +50,6 @@ class VellemanOutputPort: public BasicOutputPort, ola::thread::Thread {
     ~VellemanOutputPort();
 
     bool Start();
-    void *Run();
 
     bool WriteDMX(const DmxBuffer &buffer, uint8_t priority);
     string Description() const;
@@ -62,16 +62,16 @@ class VellemanOutputPort: public BasicOutputPort, ola::thread::Thread {
     static const int INTERFACE = 0;
     static const unsigned int UPGRADED_CHUNK_SIZE = 64;
 
-    bool m_term;
     unsigned int m_chunk_size;
     libusb_device *m_usb_device;
-    libusb_device_handle *m_usb_handle;
-    DmxBuffer m_buffer;
-    ola::thread::Mutex m_data_mutex;
-    ola::thread::Mutex m_term_mutex;
+    std::vector<uint8_t> m_frame;  // the encoded chunks for the current frame
+    unsigned int m_next_chunk;
 
-    bool SendDMX(const DmxBuffer &buffer_old);
-    bool SendDataChunk(uint8_t *usb_data);
+    bool PerformTransfer(const DmxBuffer &buffer);
+    bool ContinueTransfer();
+    void EncodeFrame(const DmxBuffer &buffer);
+    void AppendChunk(const uint8_t *usb_data);
+    bool SubmitNextChunk();
 };
 }  // namespace usbdmx
 }  // namespace plugin
@@ -79,6 +79,13 @@ class ArduinoRGBOutputPort: public BasicOutputPort {
       return m_widget->SendRDMRequest(request, callback);
     }
 
+    void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_widget->SendRDMRequest(request, callback, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_widget->RunFullDiscovery(callback);
     }
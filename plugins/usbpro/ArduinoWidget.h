@@ -105,6 +105,13 @@ class ArduinoWidget: public SerialWidgetInterface,
       m_controller->SendRDMRequest(request, on_complete);
     }
 
+    void SendRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *on_complete,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_controller->SendRDMRequest(request, on_complete, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_impl->RunFullDiscovery(callback);
     }
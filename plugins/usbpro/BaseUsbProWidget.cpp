@@ -44,8 +44,7 @@ const unsigned int BaseUsbProWidget::HEADER_SIZE =
 BaseUsbProWidget::BaseUsbProWidget(
     ola::io::ConnectedDescriptor *descriptor)
     : m_descriptor(descriptor),
-      m_state(PRE_SOM),
-      m_bytes_received(0) {
+      m_recv_size(0) {
   m_descriptor->SetOnData(
       NewCallback(this, &BaseUsbProWidget::DescriptorReady));
 }
@@ -57,12 +56,17 @@ BaseUsbProWidget::~BaseUsbProWidget() {
 
 
 /*
- * Read data from the widget
+ * Read data from the widget. We read as much as will fit in the buffer, and
+ * only read again if the buffer was filled.
  */
 void BaseUsbProWidget::DescriptorReady() {
-  while (m_descriptor->DataRemaining() > 0) {
-    ReceiveMessage();
-  }
+  unsigned int space, count;
+  do {
+    space = RECEIVE_BUFFER_SIZE - m_recv_size;
+    m_descriptor->Receive(m_recv_buffer + m_recv_size, space, count);
+    m_recv_size += count;
+    ExtractFrames();
+  } while (count && count == space);
 }
 
 
@@ -71,17 +75,9 @@ void BaseUsbProWidget::DescriptorReady() {
  * @returns true if we sent ok, false otherwise
  */
 bool BaseUsbProWidget::SendDMX(const DmxBuffer &buffer) {
-  struct {
-    uint8_t start_code;
-    uint8_t dmx[DMX_UNIVERSE_SIZE];
-  } widget_dmx;
-
-  widget_dmx.start_code = DMX512_START_CODE;
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  buffer.Get(widget_dmx.dmx, &length);
-  return SendMessage(DMX_LABEL,
-                     reinterpret_cast<uint8_t*>(&widget_dmx),
-                     length + 1);
+  uint8_t message[MAX_DMX_MESSAGE_SIZE];
+  unsigned int size = PackDMXMessage(DMX_LABEL, buffer, message);
+  return SendRawMessages(message, size);
 }
 
 
@@ -105,9 +101,18 @@ bool BaseUsbProWidget::SendMessage(uint8_t label,
 
   memcpy(frame + sizeof(message_header), data, length);
   frame[frame_size - 1] = EOM;
+  return SendRawMessages(frame, frame_size);
+}
+
 
-  ssize_t bytes_sent = m_descriptor->Send(frame, frame_size);
-  if (bytes_sent != frame_size)
+/*
+ * Write one or more already framed messages to the widget.
+ * @return true if successful, false otherwise
+ */
+bool BaseUsbProWidget::SendRawMessages(const uint8_t *data,
+                                       unsigned int length) const {
+  ssize_t bytes_sent = m_descriptor->Send(data, length);
+  if (bytes_sent != static_cast<ssize_t>(length))
     // we've probably screwed framing at this point
     return false;
 
@@ -115,6 +120,31 @@ bool BaseUsbProWidget::SendMessage(uint8_t label,
 }
 
 
+/*
+ * Pack a DMX frame into a Usb Pro message. The slot data is copied straight
+ * from the DmxBuffer into the message.
+ * @param label the label to use
+ * @param buffer the DMX data
+ * @param message the output, must be at least MAX_DMX_MESSAGE_SIZE bytes.
+ * @returns the size of the message.
+ */
+unsigned int BaseUsbProWidget::PackDMXMessage(uint8_t label,
+                                              const DmxBuffer &buffer,
+                                              uint8_t *message) {
+  unsigned int length = DMX_UNIVERSE_SIZE;
+  buffer.Get(message + HEADER_SIZE + 1, &length);
+
+  message_header *header = reinterpret_cast<message_header*>(message);
+  header->som = SOM;
+  header->label = label;
+  header->len = (length + 1) & 0xFF;
+  header->len_hi = ((length + 1) & 0xFF00) >> 8;
+  message[HEADER_SIZE] = DMX512_START_CODE;
+  message[HEADER_SIZE + length + 1] = EOM;
+  return HEADER_SIZE + length + 2;
+}
+
+
 /**
  * Open a path and apply the settings required for talking to widgets.
  */
@@ -140,76 +170,49 @@ ola::io::ConnectedDescriptor *BaseUsbProWidget::OpenDevice(
 
 
 /*
- * Read the data and handle the messages.
+ * Handle all the complete frames in the receive buffer.
  */
-void BaseUsbProWidget::ReceiveMessage() {
-  unsigned int count, packet_length;
-
-  switch (m_state) {
-    case PRE_SOM:
-      do {
-        m_descriptor->Receive(&m_header.som, 1, count);
-        if (count != 1)
-          return;
-      } while (m_header.som != SOM);
-      m_state = RECV_LABEL;
-    case RECV_LABEL:
-      m_descriptor->Receive(&m_header.label, 1, count);
-      if (count != 1)
-        return;
-      m_state = RECV_SIZE_LO;
-    case RECV_SIZE_LO:
-      m_descriptor->Receive(&m_header.len, 1, count);
-      if (count != 1)
-        return;
-      m_state = RECV_SIZE_HI;
-    case RECV_SIZE_HI:
-      m_descriptor->Receive(&m_header.len_hi, 1, count);
-      if (count != 1)
-        return;
-
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-      if (packet_length == 0) {
-        m_state = RECV_EOM;
-        return;
-      } else if (packet_length > MAX_DATA_SIZE) {
-        m_state = PRE_SOM;
-        return;
-      }
-
-      m_bytes_received = 0;
-      m_state = RECV_BODY;
-    case RECV_BODY:
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-      m_descriptor->Receive(
-          reinterpret_cast<uint8_t*>(&m_recv_buffer) + m_bytes_received,
-          packet_length - m_bytes_received,
-          count);
-
-      if (!count)
-        return;
-
-      m_bytes_received += count;
-      if (m_bytes_received != packet_length)
-        return;
-
-      m_state = RECV_EOM;
-    case RECV_EOM:
-      // check this is a valid frame with an end byte
-      uint8_t eom;
-      m_descriptor->Receive(&eom, 1, count);
-      if (count != 1)
-        return;
-
-      packet_length = (m_header.len_hi << 8) + m_header.len;
-
-      if (eom == EOM)
-        HandleMessage(m_header.label,
-                      packet_length ? m_recv_buffer : NULL,
-                      packet_length);
-      m_state = PRE_SOM;
+void BaseUsbProWidget::ExtractFrames() {
+  unsigned int offset = 0;
+
+  while (offset < m_recv_size) {
+    // skip to the next SOM
+    const uint8_t *som = reinterpret_cast<const uint8_t*>(
+        memchr(m_recv_buffer + offset, SOM, m_recv_size - offset));
+    if (!som) {
+      offset = m_recv_size;
+      break;
+    }
+    offset = som - m_recv_buffer;
+
+    if (m_recv_size - offset < HEADER_SIZE)
+      break;
+
+    const message_header *header = reinterpret_cast<const message_header*>(
+        som);
+    unsigned int packet_length = (header->len_hi << 8) + header->len;
+    if (packet_length > MAX_DATA_SIZE) {
+      // drop the header and look for the next SOM.
+      offset += HEADER_SIZE;
+      continue;
+    }
+
+    if (m_recv_size - offset < HEADER_SIZE + packet_length + 1)
+      break;
+
+    const uint8_t *data = som + HEADER_SIZE;
+    offset += HEADER_SIZE + packet_length + 1;
+
+    // check this is a valid frame with an end byte
+    if (data[packet_length] == EOM)
+      HandleMessage(header->label, packet_length ? data : NULL,
+                    packet_length);
   }
-  return;
+
+  // move any partial frame to the start of the buffer
+  m_recv_size -= offset;
+  if (offset && m_recv_size)
+    memmove(m_recv_buffer, m_recv_buffer + offset, m_recv_size);
 }
 }  // namespace usbpro
 }  // namespace plugin
@@ -24,6 +24,7 @@
 
 #include <stdint.h>
 #include <string>
+#include "ola/BaseTypes.h"
 #include "ola/Callback.h"
 #include "ola/DmxBuffer.h"
 #include "ola/io/Descriptor.h"
@@ -56,23 +57,28 @@ class BaseUsbProWidget: public SerialWidgetInterface {
 
     static ola::io::ConnectedDescriptor *OpenDevice(const string &path);
 
+    // The size of a complete DMX message: the header, start code, slot data
+    // and the EOM byte.
+    enum {MAX_DMX_MESSAGE_SIZE = 4 + DMX_UNIVERSE_SIZE + 2};
+
+    static unsigned int PackDMXMessage(uint8_t label,
+                                       const DmxBuffer &buffer,
+                                       uint8_t *message);
+
     static const uint8_t DMX_LABEL = 6;
     static const uint8_t SERIAL_LABEL = 10;
     static const uint8_t MANUFACTURER_LABEL = 77;
     static const uint8_t DEVICE_LABEL = 78;
     static const uint8_t HARDWARE_VERSION_LABEL = 14;
 
-  private:
-    typedef enum {
-      PRE_SOM,
-      RECV_LABEL,
-      RECV_SIZE_LO,
-      RECV_SIZE_HI,
-      RECV_BODY,
-      RECV_EOM,
-    } receive_state;
+  protected:
+    bool SendRawMessages(const uint8_t *data, unsigned int length) const;
 
+  private:
     enum {MAX_DATA_SIZE = 600};
+    // Large enough to hold several DMX frames. It must be larger than
+    // HEADER_SIZE + MAX_DATA_SIZE + 1 so a complete frame always fits.
+    enum {RECEIVE_BUFFER_SIZE = 2048};
 
     typedef struct {
       uint8_t som;
@@ -82,12 +88,13 @@ class BaseUsbProWidget: public SerialWidgetInterface {
     } message_header;
 
     ola::io::ConnectedDescriptor *m_descriptor;
-    receive_state m_state;
-    unsigned int m_bytes_received;
-    message_header m_header;
-    uint8_t m_recv_buffer[MAX_DATA_SIZE];
+    // Data is read into m_recv_buffer, and complete frames are handled in
+    // place. Any partial frame is moved to the start of the buffer once
+    // we've handled everything we can.
+    uint8_t m_recv_buffer[RECEIVE_BUFFER_SIZE];
+    unsigned int m_recv_size;
 
-    void ReceiveMessage();
+    void ExtractFrames();
     virtual void HandleMessage(uint8_t label,
                                const uint8_t *data,
                                unsigned int length) = 0;
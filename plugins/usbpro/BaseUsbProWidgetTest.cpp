@@ -19,6 +19,7 @@
  */
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <algorithm>
 #include <memory>
 #include <queue>
 
@@ -43,6 +44,9 @@ class BaseUsbProWidgetTest: public CommonWidgetTest {
   CPPUNIT_TEST(testSend);
   CPPUNIT_TEST(testSendDMX);
   CPPUNIT_TEST(testReceive);
+  CPPUNIT_TEST(testReceiveFragmented);
+  CPPUNIT_TEST(testReceiveBurst);
+  CPPUNIT_TEST(testFuzz);
   CPPUNIT_TEST(testRemove);
   CPPUNIT_TEST_SUITE_END();
 
@@ -52,11 +56,16 @@ class BaseUsbProWidgetTest: public CommonWidgetTest {
     void testSend();
     void testSendDMX();
     void testReceive();
+    void testReceiveFragmented();
+    void testReceiveBurst();
+    void testFuzz();
     void testRemove();
 
   private:
     auto_ptr<ola::plugin::usbpro::DispatchingUsbProWidget> m_widget;
     bool m_removed;
+    unsigned int m_message_count;
+    uint32_t m_seed;
 
     typedef struct {
       uint8_t label;
@@ -73,10 +82,14 @@ class BaseUsbProWidgetTest: public CommonWidgetTest {
     void ReceiveMessage(uint8_t label,
                         const uint8_t *data,
                         unsigned int size);
+    void CountMessage(uint8_t label,
+                      const uint8_t *data,
+                      unsigned int size);
     void DeviceRemoved() {
       m_removed = true;
       m_ss.Terminate();
     }
+    uint8_t Random();
 
     static const uint8_t DMX_FRAME_LABEL = 0x06;
 };
@@ -93,6 +106,8 @@ void BaseUsbProWidgetTest::setUp() {
         ola::NewCallback(this, &BaseUsbProWidgetTest::ReceiveMessage)));
 
   m_removed = false;
+  m_message_count = 0;
+  m_seed = 1;
 
   m_ss.RegisterSingleTimeout(
       30,  // 30ms should be enough
@@ -130,6 +145,27 @@ void BaseUsbProWidgetTest::ReceiveMessage(uint8_t label,
 }
 
 
+/**
+ * Called when a new message arrives during the fuzz test.
+ */
+void BaseUsbProWidgetTest::CountMessage(uint8_t,
+                                        const uint8_t *data,
+                                        unsigned int size) {
+  OLA_ASSERT_TRUE(size <= 600);
+  OLA_ASSERT_EQ(size == 0, data == NULL);
+  m_message_count++;
+}
+
+
+/**
+ * A simple, repeatable pseudo random number generator.
+ */
+uint8_t BaseUsbProWidgetTest::Random() {
+  m_seed = m_seed * 1103515245 + 12345;
+  return m_seed >> 16;
+}
+
+
 /*
  * Test sending works
  */
@@ -236,6 +272,112 @@ void BaseUsbProWidgetTest::testReceive() {
 }
 
 
+/*
+ * Check that frames split across reads are reassembled.
+ */
+void BaseUsbProWidgetTest::testReceiveFragmented() {
+  uint8_t data[] = {
+    0x7e, 0x0b, 4, 0, 0xde, 0xad, 0xbe, 0xef, 0xe7,
+    0xaa,  // a random byte
+    0x7e, 0, 0, 0, 0xe7,
+    0x7e, 0xa, 4, 0, 0xe7, 0xe7, 0x7e, 0xe7, 0xe7,  // data contains 0xe7
+  };
+  uint32_t data_chunk = ola::network::HostToNetwork(0xdeadbeef);
+  uint32_t data_chunk2 = ola::network::HostToNetwork(0xe7e77ee7);
+
+  // try every chunk size, from one byte at a time up to the whole lot.
+  for (unsigned int chunk_size = 1; chunk_size <= sizeof(data);
+       chunk_size++) {
+    AddExpectedMessage(0x0b,
+                       sizeof(data_chunk),
+                       reinterpret_cast<uint8_t*>(&data_chunk));
+    AddExpectedMessage(0x0, 0, NULL);
+    AddExpectedMessage(0x0a,
+                       sizeof(data_chunk2),
+                       reinterpret_cast<uint8_t*>(&data_chunk2));
+
+    for (unsigned int offset = 0; offset < sizeof(data);
+         offset += chunk_size) {
+      unsigned int size = std::min(chunk_size,
+                                   static_cast<unsigned int>(sizeof(data)) -
+                                   offset);
+      OLA_ASSERT_EQ(static_cast<ssize_t>(size),
+                    m_other_end->Send(data + offset, size));
+      m_widget->DescriptorReady();
+    }
+    OLA_ASSERT_EQ(static_cast<size_t>(0), m_messages.size());
+  }
+}
+
+
+/*
+ * Check that a burst of frames, larger than the receive buffer, is handled
+ * in one go.
+ */
+void BaseUsbProWidgetTest::testReceiveBurst() {
+  const unsigned int FRAME_COUNT = 50;
+  uint8_t dmx[DMX_UNIVERSE_SIZE + 1];
+  dmx[0] = DMX512_START_CODE;
+  for (unsigned int i = 1; i < sizeof(dmx); i++)
+    dmx[i] = i;
+
+  unsigned int frame_size;
+  uint8_t *frame = BuildUsbProMessage(DMX_FRAME_LABEL, dmx, sizeof(dmx),
+                                      &frame_size);
+  for (unsigned int i = 0; i < FRAME_COUNT; i++) {
+    AddExpectedMessage(DMX_FRAME_LABEL, sizeof(dmx), dmx);
+    OLA_ASSERT_EQ(static_cast<ssize_t>(frame_size),
+                  m_other_end->Send(frame, frame_size));
+  }
+  delete[] frame;
+
+  m_widget->DescriptorReady();
+  OLA_ASSERT_EQ(static_cast<size_t>(0), m_messages.size());
+}
+
+
+/*
+ * Feed the widget random data, interleaved with valid frames. The random data
+ * doesn't contain a SOM so all the valid frames should be received. Then
+ * feed it completely random data, to check nothing breaks.
+ */
+void BaseUsbProWidgetTest::testFuzz() {
+  const unsigned int ITERATIONS = 500;
+  m_widget->SetHandler(
+      ola::NewCallback(this, &BaseUsbProWidgetTest::CountMessage));
+
+  uint8_t payload[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  unsigned int frame_size;
+  uint8_t *frame = BuildUsbProMessage(0x10, payload, sizeof(payload),
+                                      &frame_size);
+
+  uint8_t noise[64];
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    unsigned int noise_size = Random() % sizeof(noise);
+    for (unsigned int j = 0; j < noise_size; j++) {
+      noise[j] = Random();
+      if (noise[j] == 0x7e)
+        noise[j] = 0;
+    }
+    m_other_end->Send(noise, noise_size);
+    m_other_end->Send(frame, frame_size);
+    if (Random() % 4 == 0)
+      m_widget->DescriptorReady();
+  }
+  m_widget->DescriptorReady();
+  delete[] frame;
+  OLA_ASSERT_EQ(ITERATIONS, m_message_count);
+
+  for (unsigned int i = 0; i < ITERATIONS; i++) {
+    unsigned int noise_size = Random() % sizeof(noise);
+    for (unsigned int j = 0; j < noise_size; j++)
+      noise[j] = Random();
+    m_other_end->Send(noise, noise_size);
+    m_widget->DescriptorReady();
+  }
+}
+
+
 /**
  * Test on remove works.
  */
@@ -72,6 +72,13 @@ class DmxTriOutputPort: public BasicOutputPort {
       m_tri_widget->SendRDMRequest(request, callback);
     }
 
+    void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_tri_widget->SendRDMRequest(request, callback, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_tri_widget->RunFullDiscovery(callback);
     }
@@ -69,6 +69,13 @@ class DmxterOutputPort: public BasicOutputPort {
       m_widget->SendRDMRequest(request, callback);
     }
 
+    void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_widget->SendRDMRequest(request, callback, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *on_complete) {
       m_widget->RunFullDiscovery(on_complete);
     }
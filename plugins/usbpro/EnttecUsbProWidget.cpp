@@ -26,6 +26,7 @@
 #include <vector>
 #include "ola/BaseTypes.h"
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/Logging.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/RDMCommandSerializer.h"
@@ -49,6 +50,8 @@ using ola::rdm::RDMResponse;
 using ola::rdm::UID;
 using ola::rdm::UIDSet;
 using std::auto_ptr;
+using ola::TimeInterval;
+using ola::TimeStamp;
 
 
 const uint16_t EnttecUsbProWidget::ENTTEC_ESTA_ID = 0x454E;
@@ -85,8 +88,10 @@ OperationLabels OperationLabels::Port2Operations() {
 }
 
 EnttecPortImpl::EnttecPortImpl(const OperationLabels &ops, const UID &uid,
-                               SendCallback *send_cb)
+                               SendCallback *send_cb,
+                               SendDMXCallback *send_dmx_cb)
     : m_send_cb(send_cb),
+      m_send_dmx_cb(send_dmx_cb),
       m_ops(ops),
       m_active(true),
       m_dmx_callback(NULL),
@@ -123,21 +128,10 @@ void EnttecPortImpl::Stop() {
 
 
 /**
- * Send a DMX message
+ * Send a DMX message. The widget decides when the frame is actually written.
  */
 bool EnttecPortImpl::SendDMX(const DmxBuffer &buffer) {
-  struct {
-    uint8_t start_code;
-    uint8_t dmx[DMX_UNIVERSE_SIZE];
-  } widget_dmx;
-
-  widget_dmx.start_code = DMX512_START_CODE;
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  buffer.Get(widget_dmx.dmx, &length);
-  OLA_DEBUG << "sending frame with label "
-            << static_cast<int>(m_ops.send_dmx);
-  return m_send_cb->Run(m_ops.send_dmx, reinterpret_cast<uint8_t*>(&widget_dmx),
-                        length + 1);
+  return m_send_dmx_cb->Run(m_ops.send_dmx, buffer);
 }
 
 
@@ -681,6 +675,7 @@ bool EnttecPort::SetParameters(uint8_t break_time, uint8_t mab_time,
 class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
   public:
     EnttecUsbProWidgetImpl(
+        ola::thread::SchedulerInterface *scheduler,
         ola::io::ConnectedDescriptor *descriptor,
         const EnttecUsbProWidget::EnttecUsbProWidgetOptions &options);
     ~EnttecUsbProWidgetImpl();
@@ -691,19 +686,40 @@ class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
 
     unsigned int PortCount() const { return m_ports.size(); }
     EnttecPort *GetPort(unsigned int i);
+    void SetFrameRateLimit(unsigned int fps);
 
     bool SendCommand(uint8_t label, const uint8_t *data, unsigned int length);
+    bool ScheduleDMX(uint8_t label, const DmxBuffer &buffer);
 
   private:
     typedef vector<EnttecUsbProWidget::EnttecUsbProPortAssignmentCallback*>
       PortAssignmentCallbacks;
 
+    static const unsigned int MAX_PORTS = 2;
+
+    // The most recent frame for each port that hasn't been written yet.
+    typedef struct {
+      uint8_t label;
+      bool pending;
+      DmxBuffer buffer;
+    } OutputFrame;
+
     vector<EnttecPort*> m_ports;
     vector<EnttecPortImpl*> m_port_impls;
     auto_ptr<EnttecPortImpl::SendCallback> m_send_cb;
+    auto_ptr<EnttecPortImpl::SendDMXCallback> m_send_dmx_cb;
     UID m_uid;
     PortAssignmentCallbacks m_port_assignment_callbacks;
 
+    // DMX output scheduling
+    ola::thread::SchedulerInterface *m_scheduler;
+    ola::Clock m_clock;
+    TimeInterval m_frame_interval;
+    TimeStamp m_last_write;
+    ola::thread::timeout_id m_write_timeout;
+    vector<OutputFrame> m_output_frames;
+    uint8_t m_output_buffer[MAX_PORTS * MAX_DMX_MESSAGE_SIZE];
+
     // We override handle message to catch the messages, and dispatch them to
     // the correct port.
     void HandleMessage(uint8_t label, const uint8_t *data, unsigned int length);
@@ -712,6 +728,8 @@ class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
     void HandlePortAssignment(const uint8_t *data, unsigned int length);
     void AddPort(const OperationLabels &ops, unsigned int queue_size);
     void EnableSecondPort();
+    bool WritePendingFrames();
+    void WriteTimeout();
 
     static const uint8_t PORT_ASSIGNMENT_LABEL = 141;
     static const uint8_t SET_PORT_ASSIGNMENT_LABEL = 145;
@@ -723,13 +741,18 @@ class EnttecUsbProWidgetImpl : public BaseUsbProWidget {
  * This also works for the RDM Pro with the standard firmware loaded.
  */
 EnttecUsbProWidgetImpl::EnttecUsbProWidgetImpl(
+  ola::thread::SchedulerInterface *scheduler,
   ola::io::ConnectedDescriptor *descriptor,
   const EnttecUsbProWidget::EnttecUsbProWidgetOptions &options)
     : BaseUsbProWidget(descriptor),
       m_send_cb(NewCallback(this, &EnttecUsbProWidgetImpl::SendCommand)),
+      m_send_dmx_cb(NewCallback(this, &EnttecUsbProWidgetImpl::ScheduleDMX)),
       m_uid(options.esta_id ? options.esta_id :
                               EnttecUsbProWidget::ENTTEC_ESTA_ID,
-            options.serial) {
+            options.serial),
+      m_scheduler(scheduler),
+      m_frame_interval(0, 0),
+      m_write_timeout(ola::thread::INVALID_TIMEOUT) {
   AddPort(OperationLabels::Port1Operations(), options.queue_size);
 
   if (options.dual_ports) {
@@ -765,6 +788,17 @@ void EnttecUsbProWidgetImpl::GetPortAssignments(
  * Stop this widget
  */
 void EnttecUsbProWidgetImpl::Stop() {
+  if (m_write_timeout != ola::thread::INVALID_TIMEOUT) {
+    m_scheduler->RemoveTimeout(m_write_timeout);
+    m_write_timeout = ola::thread::INVALID_TIMEOUT;
+  }
+
+  vector<OutputFrame>::iterator frame_iter = m_output_frames.begin();
+  for (; frame_iter != m_output_frames.end(); ++frame_iter) {
+    frame_iter->pending = false;
+    frame_iter->buffer = DmxBuffer();
+  }
+
   vector<EnttecPortImpl*>::iterator iter = m_port_impls.begin();
   for (; iter != m_port_impls.end(); ++iter)
     (*iter)->Stop();
@@ -787,6 +821,18 @@ EnttecPort *EnttecUsbProWidgetImpl::GetPort(unsigned int i) {
 }
 
 
+/**
+ * Limit the rate at which DMX frames are written to the widget. Frames sent
+ * faster than this are coalesced, only the latest frame for each port is
+ * written.
+ * @param fps the maximum number of writes per second, 0 means no limit.
+ */
+void EnttecUsbProWidgetImpl::SetFrameRateLimit(unsigned int fps) {
+  m_frame_interval = fps ? TimeInterval(0, USEC_IN_SECONDS / fps) :
+                           TimeInterval(0, 0);
+}
+
+
 /**
  * Send a command to the widget
  */
@@ -796,6 +842,49 @@ bool EnttecUsbProWidgetImpl::SendCommand(uint8_t label, const uint8_t *data,
 }
 
 
+/**
+ * Queue a DMX frame for a port. If we haven't written to the widget within
+ * the last frame interval the pending frames are written immediately,
+ * otherwise a single write is scheduled for the end of the interval. Frames
+ * for both ports go out in the same write.
+ */
+bool EnttecUsbProWidgetImpl::ScheduleDMX(uint8_t label,
+                                         const DmxBuffer &buffer) {
+  OutputFrame *frame = NULL;
+  vector<OutputFrame>::iterator iter = m_output_frames.begin();
+  for (; iter != m_output_frames.end(); ++iter) {
+    if (iter->label == label) {
+      frame = &(*iter);
+      break;
+    }
+  }
+
+  if (!frame)
+    return false;
+
+  frame->buffer = buffer;
+  frame->pending = true;
+
+  if (m_write_timeout != ola::thread::INVALID_TIMEOUT)
+    // the scheduled write will pick this frame up
+    return true;
+
+  if (!m_scheduler || m_frame_interval == TimeInterval(0, 0))
+    return WritePendingFrames();
+
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  const TimeStamp next_write = m_last_write + m_frame_interval;
+  if (!m_last_write.IsSet() || now >= next_write)
+    return WritePendingFrames();
+
+  m_write_timeout = m_scheduler->RegisterSingleTimeout(
+      next_write - now,
+      NewSingleCallback(this, &EnttecUsbProWidgetImpl::WriteTimeout));
+  return true;
+}
+
+
 /*
  * Handle a message received from the widget
  */
@@ -860,8 +949,13 @@ void EnttecUsbProWidgetImpl::HandlePortAssignment(const uint8_t *data,
  */
 void EnttecUsbProWidgetImpl::AddPort(const OperationLabels &ops,
                                      unsigned int queue_size) {
-  EnttecPortImpl *impl = new EnttecPortImpl(ops, m_uid, m_send_cb.get());
+  EnttecPortImpl *impl = new EnttecPortImpl(ops, m_uid, m_send_cb.get(),
+                                            m_send_dmx_cb.get());
   m_port_impls.push_back(impl);
+  OutputFrame frame;
+  frame.label = ops.send_dmx;
+  frame.pending = false;
+  m_output_frames.push_back(frame);
   EnttecPort *port = new EnttecPort(impl, queue_size);
   m_ports.push_back(port);
 }
@@ -873,6 +967,36 @@ void EnttecUsbProWidgetImpl::EnableSecondPort() {
     OLA_INFO << "Failed to enable second port";
 }
 
+
+/**
+ * Write the pending frames for all ports to the widget in a single write.
+ */
+bool EnttecUsbProWidgetImpl::WritePendingFrames() {
+  unsigned int size = 0;
+  vector<OutputFrame>::iterator iter = m_output_frames.begin();
+  for (; iter != m_output_frames.end(); ++iter) {
+    if (!iter->pending)
+      continue;
+    size += PackDMXMessage(iter->label, iter->buffer, m_output_buffer + size);
+    iter->pending = false;
+    // drop our reference so the universe doesn't need to copy-on-write.
+    iter->buffer = DmxBuffer();
+  }
+
+  m_clock.CurrentTime(&m_last_write);
+  return size ? SendRawMessages(m_output_buffer, size) : true;
+}
+
+
+/**
+ * Called when the frame interval expires and there is data to write.
+ */
+void EnttecUsbProWidgetImpl::WriteTimeout() {
+  m_write_timeout = ola::thread::INVALID_TIMEOUT;
+  if (!WritePendingFrames())
+    OLA_WARN << "Failed to write DMX frames";
+}
+
 // EnttecUsbProWidget
 // ----------------------------------------------------------------------------
 
@@ -880,9 +1004,10 @@ void EnttecUsbProWidgetImpl::EnableSecondPort() {
  * EnttecUsbProWidget Constructor
  */
 EnttecUsbProWidget::EnttecUsbProWidget(
+    ola::thread::SchedulerInterface *scheduler,
     ola::io::ConnectedDescriptor *descriptor,
     const EnttecUsbProWidgetOptions &options) {
-  m_impl = new EnttecUsbProWidgetImpl(descriptor, options);
+  m_impl = new EnttecUsbProWidgetImpl(scheduler, descriptor, options);
 }
 
 
@@ -910,6 +1035,10 @@ EnttecPort *EnttecUsbProWidget::GetPort(unsigned int i) {
   return m_impl->GetPort(i);
 }
 
+void EnttecUsbProWidget::SetFrameRateLimit(unsigned int fps) {
+  m_impl->SetFrameRateLimit(fps);
+}
+
 ola::io::ConnectedDescriptor *EnttecUsbProWidget::GetDescriptor() const {
   return m_impl->GetDescriptor();
 }
@@ -65,6 +65,13 @@ class EnttecPort
       m_controller->SendRDMRequest(request, on_complete);
     }
 
+    void SendRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *on_complete,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_controller->SendRDMRequest(request, on_complete, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_controller->RunFullDiscovery(callback);
     }
@@ -117,7 +124,8 @@ class EnttecUsbProWidget: public SerialWidgetInterface {
       }
     };
 
-    EnttecUsbProWidget(ola::io::ConnectedDescriptor *descriptor,
+    EnttecUsbProWidget(ola::thread::SchedulerInterface *scheduler,
+                       ola::io::ConnectedDescriptor *descriptor,
                        const EnttecUsbProWidgetOptions &options);
     ~EnttecUsbProWidget();
 
@@ -126,6 +134,7 @@ class EnttecUsbProWidget: public SerialWidgetInterface {
     void Stop();
     unsigned int PortCount() const;
     EnttecPort *GetPort(unsigned int i);
+    void SetFrameRateLimit(unsigned int fps);
     ola::io::ConnectedDescriptor *GetDescriptor() const;
 
     static const uint16_t ENTTEC_ESTA_ID;
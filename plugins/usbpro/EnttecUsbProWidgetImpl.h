@@ -24,6 +24,7 @@
 #include <deque>
 #include "ola/BaseTypes.h"
 #include "ola/Callback.h"
+#include "ola/DmxBuffer.h"
 #include "ola/rdm/RDMCommand.h"
 #include "ola/rdm/UID.h"
 #include "ola/rdm/UIDSet.h"
@@ -87,9 +88,11 @@ class EnttecPortImpl
   public:
     typedef ola::Callback3<bool, uint8_t, const uint8_t*, unsigned int>
       SendCallback;
+    typedef ola::Callback2<bool, uint8_t, const DmxBuffer&> SendDMXCallback;
 
     EnttecPortImpl(const OperationLabels &ops, const UID &uid,
-                   SendCallback *send_cb);
+                   SendCallback *send_cb,
+                   SendDMXCallback *send_dmx_cb);
 
     void Stop();
 
@@ -123,6 +126,7 @@ class EnttecPortImpl
 
   private:
     SendCallback *m_send_cb;
+    SendDMXCallback *m_send_dmx_cb;
     OperationLabels m_ops;
     bool m_active;
 
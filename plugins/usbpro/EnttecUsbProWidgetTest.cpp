@@ -54,6 +54,9 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
   CPPUNIT_TEST(testParams);
   CPPUNIT_TEST(testReceiveDMX);
   CPPUNIT_TEST(testChangeMode);
+  CPPUNIT_TEST(testSendDMX);
+  CPPUNIT_TEST(testCoalesceDMX);
+  CPPUNIT_TEST(testDualPortDMX);
   CPPUNIT_TEST(testSendRDMRequest);
   CPPUNIT_TEST(testSendRDMMute);
   CPPUNIT_TEST(testSendRDMDUB);
@@ -68,6 +71,9 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
     void testParams();
     void testReceiveDMX();
     void testChangeMode();
+    void testSendDMX();
+    void testCoalesceDMX();
+    void testDualPortDMX();
     void testSendRDMRequest();
     void testSendRDMMute();
     void testSendRDMDUB();
@@ -122,6 +128,9 @@ class EnttecUsbProWidgetTest: public CommonWidgetTest {
     static const uint8_t RDM_TIMEOUT_PACKET = 12;
     static const uint8_t RECEIVE_DMX_LABEL = 5;
     static const uint8_t SET_PARAM_LABEL = 4;
+    static const uint8_t SEND_DMX_LABEL = 6;
+    static const uint8_t SEND_DMX_2_LABEL = 135;
+    static const uint8_t SET_PORT_ASSIGNMENT_LABEL = 145;
     static const uint8_t TEST_RDM_DATA[];
     static const unsigned int FOOTER_SIZE = 1;
     static const unsigned int HEADER_SIZE = 4;
@@ -141,6 +150,7 @@ void EnttecUsbProWidgetTest::setUp() {
   CommonWidgetTest::setUp();
   m_widget.reset(
       new EnttecUsbProWidget(
+          &m_ss,
           &m_descriptor,
           EnttecUsbProWidget::EnttecUsbProWidgetOptions(
             EnttecUsbProWidget::ENTTEC_ESTA_ID, 1)));
@@ -487,6 +497,122 @@ void EnttecUsbProWidgetTest::testChangeMode() {
 }
 
 
+/**
+ * Check that DMX frames are sent immediately when there is no rate limit.
+ */
+void EnttecUsbProWidgetTest::testSendDMX() {
+  EnttecPort *port = m_widget->GetPort(0);
+  OLA_ASSERT_NOT_NULL(port);
+
+  const uint8_t expected_frame1[] = {0, 1, 2, 3};
+  const uint8_t expected_frame2[] = {0, 4, 5, 6, 7};
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame1,
+      sizeof(expected_frame1));
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame2,
+      sizeof(expected_frame2),
+      ola::NewSingleCallback(this, &EnttecUsbProWidgetTest::Terminate));
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(port->SendDMX(buffer));
+  buffer.SetFromString("4,5,6,7");
+  OLA_ASSERT(port->SendDMX(buffer));
+  m_ss.Run();
+  m_endpoint->Verify();
+}
+
+
+/**
+ * Check that frames sent within the frame interval are coalesced.
+ */
+void EnttecUsbProWidgetTest::testCoalesceDMX() {
+  EnttecPort *port = m_widget->GetPort(0);
+  OLA_ASSERT_NOT_NULL(port);
+  m_widget->SetFrameRateLimit(20);
+
+  // the first frame goes out immediately, the second is dropped and the
+  // third is written once the interval expires.
+  const uint8_t expected_frame1[] = {0, 1, 2, 3};
+  const uint8_t expected_frame3[] = {0, 7, 8, 9};
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame1,
+      sizeof(expected_frame1));
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame3,
+      sizeof(expected_frame3),
+      ola::NewSingleCallback(this, &EnttecUsbProWidgetTest::Terminate));
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(port->SendDMX(buffer));
+  buffer.SetFromString("4,5,6");
+  OLA_ASSERT(port->SendDMX(buffer));
+  buffer.SetFromString("7,8,9");
+  OLA_ASSERT(port->SendDMX(buffer));
+  m_ss.Run();
+  m_endpoint->Verify();
+}
+
+
+/**
+ * Check that frames for both ports of a Mk II are written together.
+ */
+void EnttecUsbProWidgetTest::testDualPortDMX() {
+  const uint8_t assignment_data[] = {1, 1};
+  m_endpoint->AddExpectedUsbProMessage(
+      SET_PORT_ASSIGNMENT_LABEL,
+      assignment_data,
+      sizeof(assignment_data));
+
+  EnttecUsbProWidget::EnttecUsbProWidgetOptions options(
+      EnttecUsbProWidget::ENTTEC_ESTA_ID, 1);
+  options.dual_ports = true;
+  m_widget.reset();
+  m_widget.reset(new EnttecUsbProWidget(&m_ss, &m_descriptor, options));
+  m_widget->SetFrameRateLimit(20);
+  OLA_ASSERT_EQ(2u, m_widget->PortCount());
+
+  EnttecPort *port1 = m_widget->GetPort(0);
+  EnttecPort *port2 = m_widget->GetPort(1);
+  OLA_ASSERT_NOT_NULL(port1);
+  OLA_ASSERT_NOT_NULL(port2);
+
+  const uint8_t expected_frame1[] = {0, 1, 2, 3};
+  const uint8_t expected_frame2[] = {0, 10, 11};
+  const uint8_t expected_frame3[] = {0, 4, 5, 6};
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame1,
+      sizeof(expected_frame1));
+  // port 1 comes first, regardless of the order the frames were sent in.
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_LABEL,
+      expected_frame3,
+      sizeof(expected_frame3));
+  m_endpoint->AddExpectedUsbProMessage(
+      SEND_DMX_2_LABEL,
+      expected_frame2,
+      sizeof(expected_frame2),
+      ola::NewSingleCallback(this, &EnttecUsbProWidgetTest::Terminate));
+
+  ola::DmxBuffer buffer;
+  buffer.SetFromString("1,2,3");
+  OLA_ASSERT(port1->SendDMX(buffer));
+  buffer.SetFromString("10,11");
+  OLA_ASSERT(port2->SendDMX(buffer));
+  buffer.SetFromString("4,5,6");
+  OLA_ASSERT(port1->SendDMX(buffer));
+  m_ss.Run();
+  m_endpoint->Verify();
+}
+
+
 /**
  * Check that we send RDM messages correctly.
  */
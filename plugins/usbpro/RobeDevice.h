@@ -98,6 +98,13 @@ class RobeOutputPort: public BasicOutputPort {
       m_widget->SendRDMRequest(request, callback);
     }
 
+    void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_widget->SendRDMRequest(request, callback, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_widget->RunFullDiscovery(callback);
     }
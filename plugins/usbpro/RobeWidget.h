@@ -137,6 +137,13 @@ class RobeWidget: public SerialWidgetInterface,
       m_controller->SendRDMRequest(request, on_complete);
     }
 
+    void SendRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *on_complete,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_controller->SendRDMRequest(request, on_complete, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_impl->RunFullDiscovery(callback);
     }
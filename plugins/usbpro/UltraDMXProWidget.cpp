@@ -46,17 +46,9 @@ bool UltraDMXProWidget::SendSecondaryDMX(const DmxBuffer &buffer) {
 
 bool UltraDMXProWidget::SendDMXWithLabel(uint8_t label,
                                          const DmxBuffer &data) {
-  struct {
-    uint8_t start_code;
-    uint8_t dmx[DMX_UNIVERSE_SIZE];
-  } widget_dmx;
-
-  widget_dmx.start_code = DMX512_START_CODE;
-  unsigned int length = DMX_UNIVERSE_SIZE;
-  data.Get(widget_dmx.dmx, &length);
-  return SendMessage(label,
-                     reinterpret_cast<uint8_t*>(&widget_dmx),
-                     length + 1);
+  uint8_t message[MAX_DMX_MESSAGE_SIZE];
+  unsigned int size = PackDMXMessage(label, data, message);
+  return SendRawMessages(message, size);
 }
 }  // namespace usbpro
 }  // namespace plugin
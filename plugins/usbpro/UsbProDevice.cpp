@@ -71,10 +71,7 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
     AddPort(input_port);
 
     OutputPort *output_port = new UsbProOutputPort(
-        this, enttec_port, i, m_serial,
-        plugin_adaptor->WakeUpTime(),
-        5,  // allow up to 5 burst frames
-        fps_limit);  // 200 frames per second seems to be the limit
+        this, enttec_port, i, m_serial);
     AddPort(output_port);
 
     PortParams port_params = {false, 0, 0, 0};
@@ -82,6 +79,9 @@ UsbProDevice::UsbProDevice(ola::PluginAdaptor *plugin_adaptor,
     enttec_port->GetParameters(
       NewSingleCallback(this, &UsbProDevice::UpdateParams, i));
   }
+  // 200 frames per second seems to be the limit. Frames sent faster than
+  // this are coalesced by the widget.
+  widget->SetFrameRateLimit(fps_limit);
   Start();  // this does nothing but set IsEnabled() to true
 }
 
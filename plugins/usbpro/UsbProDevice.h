@@ -24,7 +24,6 @@
 #include <string>
 #include <vector>
 #include "ola/DmxBuffer.h"
-#include "olad/TokenBucket.h"
 #include "olad/PluginAdaptor.h"
 #include "olad/Port.h"
 
@@ -147,22 +146,13 @@ class UsbProOutputPort: public BasicOutputPort {
     UsbProOutputPort(UsbProDevice *parent,
                      EnttecPort *port,
                      unsigned int id,
-                     const string &serial,
-                     const TimeStamp *wake_time,
-                     unsigned int max_burst,
-                     unsigned int rate)
+                     const string &serial)
         : BasicOutputPort(parent, id, true, true),
           m_serial(serial),
-          m_port(port),
-          m_bucket(max_burst, rate, max_burst, *wake_time),
-          m_wake_time(wake_time) {}
+          m_port(port) {}
 
     bool WriteDMX(const DmxBuffer &buffer, uint8_t) {
-      if (m_bucket.GetToken(*m_wake_time))
-        return m_port->SendDMX(buffer);
-      else
-        OLA_INFO << "Port rated limited, dropping frame";
-      return true;
+      return m_port->SendDMX(buffer);
     }
 
     void PostSetUniverse(Universe*, Universe *new_universe) {
@@ -175,6 +165,13 @@ class UsbProOutputPort: public BasicOutputPort {
       m_port->SendRDMRequest(request, callback);
     }
 
+    void SendPrioritizedRDMRequest(
+        const ola::rdm::RDMRequest *request,
+        ola::rdm::RDMCallback *callback,
+        ola::rdm::QueueingRDMController::RequestPriority priority) {
+      m_port->SendRDMRequest(request, callback, priority);
+    }
+
     void RunFullDiscovery(ola::rdm::RDMDiscoveryCallback *callback) {
       m_port->RunFullDiscovery(callback);
     }
@@ -188,8 +185,6 @@ class UsbProOutputPort: public BasicOutputPort {
   private:
     const string m_serial;
     EnttecPort *m_port;
-    TokenBucket m_bucket;
-    const TimeStamp *m_wake_time;
 };
 }  // namespace usbpro
 }  // namespace plugin
@@ -49,6 +49,7 @@ namespace usbpro {
 using std::auto_ptr;
 
 const char UsbSerialPlugin::DEFAULT_DEVICE_DIR[] = "/dev";
+const char UsbSerialPlugin::DEFAULT_MAX_CONCURRENT_PROBES[] = "0";
 const char UsbSerialPlugin::DEFAULT_PRO_FPS_LIMIT[] = "190";
 const char UsbSerialPlugin::DEFAULT_ULTRA_FPS_LIMIT[] = "40";
 const char UsbSerialPlugin::DEVICE_DIR_KEY[] = "device_dir";
@@ -57,6 +58,8 @@ const char UsbSerialPlugin::IGNORED_DEVICES_KEY[] = "ignore_device";
 const char UsbSerialPlugin::LINUX_DEVICE_PREFIX[] = "ttyUSB";
 const char UsbSerialPlugin::BSD_DEVICE_PREFIX[] = "ttyU";
 const char UsbSerialPlugin::MAC_DEVICE_PREFIX[] = "cu.usbserial-";
+const char UsbSerialPlugin::MAX_CONCURRENT_PROBES_KEY[] =
+  "max_concurrent_probes";
 const char UsbSerialPlugin::PLUGIN_NAME[] = "Serial USB";
 const char UsbSerialPlugin::PLUGIN_PREFIX[] = "usbserial";
 const char UsbSerialPlugin::ROBE_DEVICE_NAME[] = "Robe Universal Interface";
@@ -64,6 +67,7 @@ const char UsbSerialPlugin::TRI_USE_RAW_RDM_KEY[] = "tri_use_raw_rdm";
 const char UsbSerialPlugin::USBPRO_DEVICE_NAME[] = "Enttec Usb Pro Device";
 const char UsbSerialPlugin::USB_PRO_FPS_LIMIT_KEY[] = "pro_fps_limit";
 const char UsbSerialPlugin::ULTRA_FPS_LIMIT_KEY[] = "ultra_fps_limit";
+const char UsbSerialPlugin::WIDGET_TYPE_KEY[] = "widget_type";
 
 UsbSerialPlugin::UsbSerialPlugin(PluginAdaptor *plugin_adaptor)
     : Plugin(plugin_adaptor),
@@ -101,14 +105,23 @@ string UsbSerialPlugin::Description() const {
 "ignore_device = /dev/ttyUSB\n"
 "Ignore the device matching this string. Multiple keys are allowed.\n"
 "\n"
+"max_concurrent_probes = 0\n"
+"The maximum number of devices to probe at once, 0 means no limit.\n"
+"\n"
 "pro_fps_limit = 190\n"
-"The max frames per second to send to a Usb Pro or DMXKing device.\n"
+"The max frames per second to send to a Usb Pro or DMXKing device. Frames\n"
+"sent faster than this are merged, so the latest frame is always sent.\n"
 "\n"
 "tri_use_raw_rdm = [true|false]\n"
 "Bypass RDM handling in the {DMX,RDM}-TRI widgets.\n"
 "\n"
 "ultra_fps_limit = 40\n"
 "The max frames per second to send to a Ultra DMX Pro device.\n"
+"\n"
+"widget_type = /dev/ttyUSB0:usbpro\n"
+"The type of widget last found on a device, [usbpro|robe]. This is used to\n"
+"speed up detection and is updated when the plugin stops. Multiple keys are\n"
+"allowed.\n"
 "\n";
 }
 
@@ -261,6 +274,8 @@ bool UsbSerialPlugin::StartHook() {
       m_preferences->GetValue(DEVICE_DIR_KEY));
   m_detector_thread.SetDevicePrefixes(
       m_preferences->GetMultipleValue(DEVICE_PREFIX_KEY));
+  m_detector_thread.SetMaxConcurrentProbes(GetMaxConcurrentProbes());
+  LoadDetectorHints();
   if (!m_detector_thread.Start()) {
     OLA_FATAL << "Failed to start the widget discovery thread";
     return false;
@@ -280,6 +295,7 @@ bool UsbSerialPlugin::StopHook() {
     DeleteDevice(*iter);
   m_detector_thread.Join(NULL);
   m_devices.clear();
+  SaveDetectorHints();
   return true;
 }
 
@@ -313,6 +329,11 @@ bool UsbSerialPlugin::SetDefaultPreferences() {
                                          IntValidator(0, MAX_ULTRA_FPS_LIMIT),
                                          DEFAULT_ULTRA_FPS_LIMIT);
 
+  save |= m_preferences->SetDefaultValue(
+      MAX_CONCURRENT_PROBES_KEY,
+      IntValidator(0, MAX_CONCURRENT_PROBES),
+      DEFAULT_MAX_CONCURRENT_PROBES);
+
   save |= m_preferences->SetDefaultValue(TRI_USE_RAW_RDM_KEY,
                                          BoolValidator(),
                                          BoolValidator::DISABLED);
@@ -372,6 +393,65 @@ unsigned int UsbSerialPlugin::GetUltraDMXProFrameLimit() {
     StringToInt(DEFAULT_ULTRA_FPS_LIMIT, &fps_limit);
   return fps_limit;
 }
+
+
+/*
+ * Get the maximum number of devices to probe at once.
+ */
+unsigned int UsbSerialPlugin::GetMaxConcurrentProbes() {
+  unsigned int max_probes;
+  if (!StringToInt(m_preferences->GetValue(MAX_CONCURRENT_PROBES_KEY),
+                   &max_probes))
+    StringToInt(DEFAULT_MAX_CONCURRENT_PROBES, &max_probes);
+  return max_probes;
+}
+
+
+/*
+ * Pass the widget types from the last run to the detector thread. Each entry
+ * is of the form <path>:<detector>.
+ */
+void UsbSerialPlugin::LoadDetectorHints() {
+  WidgetDetectorThread::DetectorHints hints;
+  const vector<string> entries =
+      m_preferences->GetMultipleValue(WIDGET_TYPE_KEY);
+  vector<string>::const_iterator iter = entries.begin();
+  for (; iter != entries.end(); ++iter) {
+    string::size_type pos = iter->rfind(':');
+    if (pos == string::npos || pos == 0 || pos + 1 == iter->size()) {
+      OLA_WARN << "Invalid " << WIDGET_TYPE_KEY << " entry: " << *iter;
+      continue;
+    }
+    hints[iter->substr(0, pos)] = iter->substr(pos + 1);
+  }
+  m_detector_thread.SetDetectorHints(hints);
+}
+
+
+/*
+ * Save the widget types found by the detector thread so we can try the right
+ * detector first next time.
+ */
+void UsbSerialPlugin::SaveDetectorHints() {
+  WidgetDetectorThread::DetectorHints hints;
+  m_detector_thread.GetDetectorHints(&hints);
+
+  const vector<string> old_entries =
+      m_preferences->GetMultipleValue(WIDGET_TYPE_KEY);
+  vector<string> entries;
+  WidgetDetectorThread::DetectorHints::const_iterator iter = hints.begin();
+  for (; iter != hints.end(); ++iter)
+    entries.push_back(iter->first + ":" + iter->second);
+
+  if (entries == old_entries)
+    return;
+
+  m_preferences->RemoveValue(WIDGET_TYPE_KEY);
+  vector<string>::const_iterator entry_iter = entries.begin();
+  for (; entry_iter != entries.end(); ++entry_iter)
+    m_preferences->SetMultipleValue(WIDGET_TYPE_KEY, *entry_iter);
+  m_preferences->Save();
+}
 }  // namespace usbpro
 }  // namespace plugin
 }  // namespace ola
@@ -68,11 +68,15 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     unsigned int GetProFrameLimit();
     unsigned int GetDmxTriFrameLimit();
     unsigned int GetUltraDMXProFrameLimit();
+    unsigned int GetMaxConcurrentProbes();
+    void LoadDetectorHints();
+    void SaveDetectorHints();
 
     vector<UsbSerialDevice*> m_devices;  // list of our devices
     WidgetDetectorThread m_detector_thread;
 
     static const char DEFAULT_DEVICE_DIR[];
+    static const char DEFAULT_MAX_CONCURRENT_PROBES[];
     static const char DEFAULT_PRO_FPS_LIMIT[];
     static const char DEFAULT_ULTRA_FPS_LIMIT[];
     static const char DEVICE_DIR_KEY[];
@@ -81,6 +85,7 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     static const char LINUX_DEVICE_PREFIX[];
     static const char BSD_DEVICE_PREFIX[];
     static const char MAC_DEVICE_PREFIX[];
+    static const char MAX_CONCURRENT_PROBES_KEY[];
     static const char PLUGIN_NAME[];
     static const char PLUGIN_PREFIX[];
     static const char ROBE_DEVICE_NAME[];
@@ -88,6 +93,8 @@ class UsbSerialPlugin: public ola::Plugin, public NewWidgetHandler {
     static const char USBPRO_DEVICE_NAME[];
     static const char USB_PRO_FPS_LIMIT_KEY[];
     static const char ULTRA_FPS_LIMIT_KEY[];
+    static const char WIDGET_TYPE_KEY[];
+    static const unsigned int MAX_CONCURRENT_PROBES = 64;
     static const unsigned int MAX_PRO_FPS_LIMIT = 1000;
     static const unsigned int MAX_ULTRA_FPS_LIMIT = 1000;
 };
@@ -21,6 +21,7 @@
 
 
 #include <string.h>
+#include <map>
 #include <string>
 #include <vector>
 
@@ -45,6 +46,10 @@ namespace ola {
 namespace plugin {
 namespace usbpro {
 
+using ola::thread::MutexLocker;
+
+const char WidgetDetectorThread::USB_PRO_DETECTOR[] = "usbpro";
+const char WidgetDetectorThread::ROBE_DETECTOR[] = "robe";
 
 /**
  * Constructor
@@ -63,7 +68,9 @@ WidgetDetectorThread::WidgetDetectorThread(
       m_handler(handler),
       m_is_running(false),
       m_usb_pro_timeout(usb_pro_timeout),
-      m_robe_timeout(robe_timeout) {
+      m_robe_timeout(robe_timeout),
+      m_max_probes(0),
+      m_probes_in_progress(0) {
   if (!m_handler)
     OLA_FATAL << "No new widget handler registered.";
 }
@@ -102,6 +109,40 @@ void WidgetDetectorThread::SetIgnoredDevices(const vector<string> &devices) {
 }
 
 
+/**
+ * Set the maximum number of devices to probe at once. Devices found beyond
+ * this are queued until a probe completes. This should be called before Run()
+ * since it doesn't do any locking.
+ * @param max_probes the maximum number of probes, 0 means no limit.
+ */
+void WidgetDetectorThread::SetMaxConcurrentProbes(unsigned int max_probes) {
+  m_max_probes = max_probes;
+}
+
+
+/**
+ * Set the detector to try first for each device path. This is usually the
+ * result of GetDetectorHints() from a previous run. This should be called
+ * before Run().
+ * @param hints a map of device path to detector name.
+ */
+void WidgetDetectorThread::SetDetectorHints(const DetectorHints &hints) {
+  MutexLocker locker(&m_hint_mutex);
+  m_detector_hints = hints;
+}
+
+
+/**
+ * Get the detector that found a widget for each device path. This can be
+ * called from any thread.
+ * @param hints a map which is populated with device path to detector name.
+ */
+void WidgetDetectorThread::GetDetectorHints(DetectorHints *hints) const {
+  MutexLocker locker(&m_hint_mutex);
+  *hints = m_detector_hints;
+}
+
+
 /**
  * Run the discovery thread.
  */
@@ -114,11 +155,13 @@ void *WidgetDetectorThread::Run() {
         ola::NewCallback(this, &WidgetDetectorThread::UsbProWidgetReady),
         ola::NewCallback(this, &WidgetDetectorThread::DescriptorFailed),
         m_usb_pro_timeout));
+    m_detector_names.push_back(USB_PRO_DETECTOR);
     m_widget_detectors.push_back(new RobeWidgetDetector(
         &m_ss,
         ola::NewCallback(this, &WidgetDetectorThread::RobeWidgetReady),
         ola::NewCallback(this, &WidgetDetectorThread::DescriptorFailed),
         m_robe_timeout));
+    m_detector_names.push_back(ROBE_DETECTOR);
   }
   RunScan();
   m_ss.RegisterRepeatingTimeout(
@@ -128,6 +171,7 @@ void *WidgetDetectorThread::Run() {
       ola::NewSingleCallback(this, &WidgetDetectorThread::MarkAsRunning));
   m_ss.Run();
 
+  m_queued_paths.clear();
   vector<WidgetDetectorInterface*>::const_iterator iter =
   m_widget_detectors.begin();
   for (; iter != m_widget_detectors.end(); ++iter)
@@ -142,6 +186,7 @@ void *WidgetDetectorThread::Run() {
     OLA_INFO  << iter2->first;
   }
   m_widget_detectors.clear();
+  m_detector_names.clear();
   return NULL;
 }
 
@@ -198,15 +243,32 @@ bool WidgetDetectorThread::RunScan() {
       continue;
 
     OLA_INFO << "Found potential USB Serial device at " << *it;
-    ConnectedDescriptor *descriptor =
-      BaseUsbProWidget::OpenDevice(*it);
-    if (!descriptor)
+    m_active_paths.insert(*it);
+    m_queued_paths.push_back(*it);
+  }
+  StartQueuedProbes();
+  return true;
+}
+
+
+/**
+ * Open and probe queued devices until we hit the concurrent probe limit.
+ */
+void WidgetDetectorThread::StartQueuedProbes() {
+  while (!m_queued_paths.empty() &&
+         (m_max_probes == 0 || m_probes_in_progress < m_max_probes)) {
+    const string path = m_queued_paths.front();
+    m_queued_paths.pop_front();
+
+    ConnectedDescriptor *descriptor = BaseUsbProWidget::OpenDevice(path);
+    if (!descriptor) {
+      m_active_paths.erase(path);
       continue;
+    }
 
-    OLA_INFO << "new descriptor @ " << descriptor << " for " << *it;
-    PerformDiscovery(*it, descriptor);
+    OLA_INFO << "new descriptor @ " << descriptor << " for " << path;
+    PerformDiscovery(path, descriptor);
   }
-  return true;
 }
 
 
@@ -215,8 +277,26 @@ bool WidgetDetectorThread::RunScan() {
  */
 void WidgetDetectorThread::PerformDiscovery(const string &path,
                                             ConnectedDescriptor *descriptor) {
-  m_active_descriptors[descriptor] = DescriptorInfo(path, -1);
+  DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
+  descriptor_info.path = path;
+  descriptor_info.stage = -1;
+  descriptor_info.first_detector = 0;
+  m_clock.CurrentTime(&descriptor_info.start_time);
+
+  // if a widget was found here last time, try that detector first
+  {
+    MutexLocker locker(&m_hint_mutex);
+    DetectorHints::const_iterator hint = m_detector_hints.find(path);
+    if (hint != m_detector_hints.end()) {
+      for (unsigned int i = 0; i < m_detector_names.size(); i++) {
+        if (m_detector_names[i] == hint->second)
+          descriptor_info.first_detector = i;
+      }
+    }
+  }
+
   m_active_paths.insert(path);
+  m_probes_in_progress++;
   PerformNextDiscoveryStep(descriptor);
 }
 
@@ -228,6 +308,7 @@ void WidgetDetectorThread::PerformDiscovery(const string &path,
 void WidgetDetectorThread::UsbProWidgetReady(
     ConnectedDescriptor *descriptor,
     const UsbProWidgetInformation *information) {
+  ProbeComplete(descriptor, USB_PRO_DETECTOR);
   // we're no longer interested in events from this widget
   m_ss.RemoveReadDescriptor(descriptor);
 
@@ -251,7 +332,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
         EnttecUsbProWidget::EnttecUsbProWidgetOptions options(
             information->esta_id, information->serial);
         DispatchWidget(
-            new EnttecUsbProWidget(descriptor, options),
+            new EnttecUsbProWidget(m_other_ss, descriptor, options),
             information);
         return;
       }
@@ -301,7 +382,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
   EnttecUsbProWidget::EnttecUsbProWidgetOptions options(
       information->esta_id, information->serial);
   options.dual_ports = information->dual_port;
-  DispatchWidget(new EnttecUsbProWidget(descriptor, options),
+  DispatchWidget(new EnttecUsbProWidget(m_other_ss, descriptor, options),
                  information);
 }
 
@@ -312,6 +393,7 @@ void WidgetDetectorThread::UsbProWidgetReady(
 void WidgetDetectorThread::RobeWidgetReady(
     ConnectedDescriptor *descriptor,
     const RobeWidgetInformation *info) {
+  ProbeComplete(descriptor, ROBE_DETECTOR);
   // we're no longer interested in events from this descriptor
   m_ss.RemoveReadDescriptor(descriptor);
   RobeWidget *widget = new RobeWidget(descriptor, info->uid);
@@ -335,6 +417,7 @@ void WidgetDetectorThread::DescriptorFailed(
   if (descriptor->ValidReadDescriptor()) {
     PerformNextDiscoveryStep(descriptor);
   } else {
+    ProbeComplete(descriptor, NULL);
     FreeDescriptor(descriptor);
   }
 }
@@ -348,25 +431,68 @@ void WidgetDetectorThread::PerformNextDiscoveryStep(
     ConnectedDescriptor *descriptor) {
 
   DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
-  descriptor_info.second++;
+  descriptor_info.stage++;
 
-  if (static_cast<unsigned int>(descriptor_info.second) ==
+  if (static_cast<unsigned int>(descriptor_info.stage) ==
       m_widget_detectors.size()) {
     OLA_INFO << "no more detectors to try for  " << descriptor;
+    ProbeComplete(descriptor, NULL);
     FreeDescriptor(descriptor);
   } else {
-    OLA_INFO << "trying stage " << descriptor_info.second << " for " <<
-      descriptor;
+    unsigned int detector = (descriptor_info.first_detector +
+                             descriptor_info.stage) % m_widget_detectors.size();
+    OLA_INFO << "trying stage " << descriptor_info.stage << " ("
+             << m_detector_names[detector] << ") for " << descriptor;
     m_ss.AddReadDescriptor(descriptor);
-    bool ok = m_widget_detectors[descriptor_info.second]->Discover(descriptor);
+    bool ok = m_widget_detectors[detector]->Discover(descriptor);
     if (!ok) {
       m_ss.RemoveReadDescriptor(descriptor);
+      ProbeComplete(descriptor, NULL);
       FreeDescriptor(descriptor);
     }
   }
 }
 
 
+/**
+ * Called when the probe for a descriptor finishes. This logs the detection
+ * time, updates the hints and schedules any queued probes.
+ * @param descriptor the descriptor that was probed
+ * @param detector the name of the detector that found a widget, or NULL if
+ *   none did.
+ */
+void WidgetDetectorThread::ProbeComplete(ConnectedDescriptor *descriptor,
+                                         const char *detector) {
+  const DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
+  TimeStamp now;
+  m_clock.CurrentTime(&now);
+  TimeInterval elapsed = now - descriptor_info.start_time;
+
+  {
+    MutexLocker locker(&m_hint_mutex);
+    if (detector) {
+      OLA_INFO << "Detected " << detector << " widget on "
+               << descriptor_info.path << " in " << elapsed.InMilliSeconds()
+               << "ms";
+      m_detector_hints[descriptor_info.path] = detector;
+    } else {
+      OLA_INFO << "No widget found on " << descriptor_info.path << " after "
+               << elapsed.InMilliSeconds() << "ms";
+      m_detector_hints.erase(descriptor_info.path);
+    }
+  }
+
+  if (m_probes_in_progress)
+    m_probes_in_progress--;
+
+  // Start the queued probes once we've unwound from this detector's stack.
+  if (!m_queued_paths.empty()) {
+    m_ss.Execute(
+        ola::NewSingleCallback(this, &WidgetDetectorThread::StartQueuedProbes));
+  }
+}
+
+
 /**
  * Free the widget and the associated descriptor.
  */
@@ -385,7 +511,7 @@ void WidgetDetectorThread::InternalFreeWidget(SerialWidgetInterface *widget) {
  */
 void WidgetDetectorThread::FreeDescriptor(ConnectedDescriptor *descriptor) {
   DescriptorInfo &descriptor_info = m_active_descriptors[descriptor];
-  m_active_paths.erase(descriptor_info.first);
+  m_active_paths.erase(descriptor_info.path);
   m_active_descriptors.erase(descriptor);
   delete descriptor;
 }
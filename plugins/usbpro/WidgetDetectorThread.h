@@ -22,12 +22,14 @@
 #ifndef PLUGINS_USBPRO_WIDGETDETECTORTHREAD_H_
 #define PLUGINS_USBPRO_WIDGETDETECTORTHREAD_H_
 
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
 #include <vector>
 #include <utility>
 #include "ola/Callback.h"
+#include "ola/Clock.h"
 #include "ola/io/Descriptor.h"
 #include "ola/io/SelectServer.h"
 #include "ola/thread/Thread.h"
@@ -81,6 +83,10 @@ class NewWidgetHandler {
  */
 class WidgetDetectorThread: public ola::thread::Thread {
   public:
+    // Maps device paths to the name of the detector that found a widget
+    // there, see USB_PRO_DETECTOR & ROBE_DETECTOR.
+    typedef std::map<string, string> DetectorHints;
+
     explicit WidgetDetectorThread(NewWidgetHandler *widget_handler,
                                   ola::io::SelectServerInterface *ss,
                                   unsigned int usb_pro_timeout = 200,
@@ -93,6 +99,13 @@ class WidgetDetectorThread: public ola::thread::Thread {
     void SetDevicePrefixes(const vector<string> &prefixes);
     // Must be called before Run()
     void SetIgnoredDevices(const vector<string> &devices);
+    // Must be called before Run()
+    void SetMaxConcurrentProbes(unsigned int max_probes);
+    // Must be called before Run()
+    void SetDetectorHints(const DetectorHints &hints);
+
+    // Can be called from any thread.
+    void GetDetectorHints(DetectorHints *hints) const;
 
     // Start the thread, this will call the SuccessHandler whenever a new
     // Widget is located.
@@ -107,15 +120,31 @@ class WidgetDetectorThread: public ola::thread::Thread {
     // blocks until the thread is running
     void WaitUntilRunning();
 
+    static const char USB_PRO_DETECTOR[];
+    static const char ROBE_DETECTOR[];
+
   protected:
     virtual bool RunScan();
     void PerformDiscovery(const string &path,
                           ConnectedDescriptor *descriptor);
 
   private:
+    // The state of a descriptor in the discovery process
+    struct DescriptorInfo {
+      string path;
+      // the number of detectors tried, -1 until the first one starts
+      int stage;
+      // the index of the detector to try first
+      unsigned int first_detector;
+      TimeStamp start_time;
+
+      DescriptorInfo() : stage(-1), first_detector(0) {}
+    };
+
     ola::io::SelectServerInterface *m_other_ss;
     ola::io::SelectServer m_ss;  // ss for this thread
     vector<WidgetDetectorInterface*> m_widget_detectors;
+    vector<string> m_detector_names;
     string m_directory;  // directory to look for widgets in
     vector<string> m_prefixes;  // prefixes to try
     set<string> m_ignored_devices;  // devices to ignore
@@ -123,13 +152,19 @@ class WidgetDetectorThread: public ola::thread::Thread {
     bool m_is_running;
     unsigned int m_usb_pro_timeout;
     unsigned int m_robe_timeout;
+    unsigned int m_max_probes;
+    unsigned int m_probes_in_progress;
     Mutex m_mutex;
     ConditionVariable m_condition;
+    Clock m_clock;
+
+    DetectorHints m_detector_hints;  // GUARDED_BY(m_hint_mutex)
+    mutable Mutex m_hint_mutex;
 
-    // those paths that are either in discovery, or in use
+    // those paths that are either queued, in discovery, or in use
     set<string> m_active_paths;
-    // holds the path and current widget detector offset
-    typedef std::pair<string, int> DescriptorInfo;
+    // paths waiting for a free probe slot
+    std::deque<string> m_queued_paths;
     // map of descriptor to DescriptorInfo
     typedef map<ConnectedDescriptor*, DescriptorInfo>
       ActiveDescriptors;
@@ -144,6 +179,8 @@ class WidgetDetectorThread: public ola::thread::Thread {
 
     void DescriptorFailed(ConnectedDescriptor *descriptor);
     void PerformNextDiscoveryStep(ConnectedDescriptor *descriptor);
+    void StartQueuedProbes();
+    void ProbeComplete(ConnectedDescriptor *descriptor, const char *detector);
     void InternalFreeWidget(SerialWidgetInterface *widget);
     void FreeDescriptor(ConnectedDescriptor *descriptor);
 
@@ -94,6 +94,7 @@ class WidgetDetectorThreadTest: public CppUnit::TestFixture,
   CPPUNIT_TEST(testUsbProWidget);
   CPPUNIT_TEST(testUsbProMkIIWidget);
   CPPUNIT_TEST(testRobeWidget);
+  CPPUNIT_TEST(testDetectorHints);
   CPPUNIT_TEST(testUltraDmxWidget);
   CPPUNIT_TEST(testTimeout);
   CPPUNIT_TEST(testClose);
@@ -109,6 +110,7 @@ class WidgetDetectorThreadTest: public CppUnit::TestFixture,
     void testUsbProWidget();
     void testUsbProMkIIWidget();
     void testRobeWidget();
+    void testDetectorHints();
     void testUltraDmxWidget();
     void testTimeout();
     void testClose();
@@ -400,6 +402,37 @@ void WidgetDetectorThreadTest::testRobeWidget() {
   m_thread->WaitUntilRunning();
   m_ss.Run();
   OLA_ASSERT_EQ(ROBE, m_received_widget_type);
+
+  WidgetDetectorThread::DetectorHints hints;
+  m_thread->GetDetectorHints(&hints);
+  OLA_ASSERT_EQ(static_cast<size_t>(1), hints.size());
+  OLA_ASSERT_EQ(string(WidgetDetectorThread::ROBE_DETECTOR),
+                hints["/mock_device"]);
+}
+
+
+/**
+ * Check that a hint from a previous run skips the usb pro probe.
+ */
+void WidgetDetectorThreadTest::testDetectorHints() {
+  WidgetDetectorThread::DetectorHints hints;
+  hints["/mock_device"] = WidgetDetectorThread::ROBE_DETECTOR;
+  m_thread->SetDetectorHints(hints);
+
+  // only robe messages are expected
+  uint8_t info_data[] = {1, 11, 3, 0, 0};
+  uint8_t uid_data[] = {0x52, 0x53, 2, 0, 0, 10};
+  m_endpoint->AddExpectedRobeDataAndReturn(
+      BaseRobeWidget::INFO_REQUEST, NULL, 0,
+      BaseRobeWidget::INFO_RESPONSE, info_data, sizeof(info_data));
+  m_endpoint->AddExpectedRobeDataAndReturn(
+      BaseRobeWidget::UID_REQUEST, NULL, 0,
+      BaseRobeWidget::UID_RESPONSE, uid_data, sizeof(uid_data));
+
+  m_thread->Start();
+  m_thread->WaitUntilRunning();
+  m_ss.Run();
+  OLA_ASSERT_EQ(ROBE, m_received_widget_type);
 }
 
 
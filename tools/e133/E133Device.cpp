@@ -26,6 +26,7 @@
 #include <ola/network/IPV4Address.h>
 #include <ola/network/SocketAddress.h>
 #include <ola/rdm/RDMCommandSerializer.h>
+#include <ola/rdm/RDMCommandView.h>
 #include <ola/rdm/RDMControllerInterface.h>
 #include <ola/rdm/RDMHelper.h>
 
@@ -190,9 +191,11 @@ void E133Device::EndpointRequest(
   }
 
   // attempt to unpack as a request
-  const ola::rdm::RDMRequest *request = ola::rdm::RDMRequest::InflateFromData(
-    reinterpret_cast<const uint8_t*>(raw_request.data()),
-    raw_request.size());
+  ola::rdm::RDMCommandView view;
+  const ola::rdm::RDMRequest *request = NULL;
+  if (view.Init(reinterpret_cast<const uint8_t*>(raw_request.data()),
+                raw_request.size()) == ola::rdm::RDM_COMPLETED_OK)
+    request = view.ToRequest();
 
   if (!request) {
     OLA_WARN << "Failed to unpack E1.33 RDM message, ignoring request.";
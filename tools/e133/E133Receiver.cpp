@@ -23,6 +23,7 @@
 #include <ola/e133/E133Receiver.h>
 #include <ola/network/IPV4Address.h>
 #include <ola/network/SocketAddress.h>
+#include <ola/rdm/RDMCommandView.h>
 
 #include <memory>
 #include <string>
@@ -39,6 +40,7 @@ namespace e133 {
 using ola::NewCallback;
 using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
+using ola::rdm::RDMCommandView;
 using ola::rdm::RDMResponse;
 using std::auto_ptr;
 using std::string;
@@ -117,11 +119,13 @@ void E133Receiver::HandlePacket(
   OLA_INFO << "Got E1.33 data from " << transport_header->Source();
 
   // Attempt to unpack as a response for now.
-  ola::rdm::rdm_response_code response_code;
-  const RDMResponse *response = RDMResponse::InflateFromData(
+  RDMCommandView view;
+  ola::rdm::rdm_response_code response_code = view.Init(
     reinterpret_cast<const uint8_t*>(raw_response.data()),
-    raw_response.size(),
-    &response_code);
+    raw_response.size());
+  const RDMResponse *response = NULL;
+  if (response_code == ola::rdm::RDM_COMPLETED_OK)
+    response = view.ToResponse();
 
   if (!response) {
     OLA_WARN << "Failed to unpack E1.33 RDM message, ignoring request.";
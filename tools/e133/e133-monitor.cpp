@@ -39,6 +39,7 @@
 #include <ola/rdm/CommandPrinter.h>
 #include <ola/rdm/PidStoreHelper.h>
 #include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMCommandView.h>
 #include <ola/rdm/RDMHelper.h>
 #include <ola/rdm/UID.h>
 #include <ola/slp/URLEntry.h>
@@ -53,6 +54,7 @@ using ola::network::IPV4Address;
 using ola::network::IPV4SocketAddress;
 using ola::rdm::PidStoreHelper;
 using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandView;
 using ola::rdm::UID;
 using ola::slp::URLEntries;
 using std::auto_ptr;
@@ -197,9 +199,11 @@ bool SimpleE133Monitor::EndpointRequest(
     raw_request.data());
 
   cout << "From " << source << ":" << endpoint << endl;
-  auto_ptr<RDMCommand> command(
-      RDMCommand::Inflate(reinterpret_cast<const uint8_t*>(raw_request.data()),
-                          raw_request.size()));
+  RDMCommandView view;
+  auto_ptr<RDMCommand> command;
+  if (view.Init(rdm_data, slot_count) == ola::rdm::RDM_COMPLETED_OK)
+    command.reset(view.ToCommand());
+
   if (command.get()) {
     command->Print(&m_command_printer, false, true);
   } else {
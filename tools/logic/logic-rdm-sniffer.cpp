@@ -42,6 +42,7 @@
 #include <ola/rdm/CommandPrinter.h>
 #include <ola/rdm/PidStoreHelper.h>
 #include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMCommandView.h>
 #include <ola/rdm/RDMEnums.h>
 #include <ola/rdm/RDMHelper.h>
 #include <ola/rdm/RDMResponseCodes.h>
@@ -69,6 +70,7 @@ using ola::messaging::Message;
 using ola::rdm::CommandPrinter;
 using ola::rdm::PidStoreHelper;
 using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandView;
 using ola::rdm::UID;
 
 
@@ -265,8 +267,12 @@ void LogicReader::DisplayDMXFrame(const uint8_t *data, unsigned int length) {
 }
 
 void LogicReader::DisplayRDMFrame(const uint8_t *data, unsigned int length) {
-  auto_ptr<RDMCommand> command(
-      RDMCommand::Inflate(reinterpret_cast<const uint8_t*>(data), length));
+  // Only create an RDMCommand for the frames we can print.
+  RDMCommandView view;
+  auto_ptr<RDMCommand> command;
+  if (view.Init(data, length) == ola::rdm::RDM_COMPLETED_OK)
+    command.reset(view.ToCommand());
+
   if (command.get()) {
     if (!FLAGS_summarize_rdm)
       cout << "---------------------------------------" << endl;
@@ -32,6 +32,7 @@
 #include <ola/rdm/CommandPrinter.h>
 #include <ola/rdm/PidStoreHelper.h>
 #include <ola/rdm/RDMCommand.h>
+#include <ola/rdm/RDMCommandView.h>
 #include <ola/rdm/RDMEnums.h>
 #include <ola/rdm/RDMHelper.h>
 #include <ola/rdm/RDMResponseCodes.h>
@@ -59,6 +60,7 @@ using ola::messaging::Message;
 using ola::rdm::CommandPrinter;
 using ola::rdm::PidStoreHelper;
 using ola::rdm::RDMCommand;
+using ola::rdm::RDMCommandView;
 using ola::rdm::UID;
 
 typedef struct {
@@ -338,9 +340,14 @@ void RDMSniffer::DisplayAlternateFrame() {
 void RDMSniffer::DisplayRDMFrame() {
   unsigned int slot_count = m_frame.Size() - 1;
 
-  auto_ptr<RDMCommand> command(
-      RDMCommand::Inflate(reinterpret_cast<const uint8_t*>(&m_frame[1]),
-                          slot_count));
+  // Corrupt frames are common on the line, so check the frame with a view
+  // and only create an RDMCommand for the frames we can print.
+  RDMCommandView view;
+  auto_ptr<RDMCommand> command;
+  if (view.Init(reinterpret_cast<const uint8_t*>(&m_frame[1]), slot_count) ==
+      ola::rdm::RDM_COMPLETED_OK)
+    command.reset(view.ToCommand());
+
   if (command.get()) {
     if (!m_options.summarize_rdm_frames)
       cout << "---------------------------------------" << endl;